@@ -49,7 +49,23 @@ enum
   PROP_DTCP_BLOCKSIZE,
   PROP_IS_LIVE,
   PROP_IN_TSB,
-  PROP_TSB_SLIDE
+  PROP_TSB_SLIDE,
+  PROP_PIPELINED_HEAD,
+  PROP_MAX_CONNS_PER_HOST,
+  PROP_IDLE_TIMEOUT,
+  PROP_CAPS_CACHE_TTL,
+  PROP_CAPS_CACHE_FILE,
+  PROP_BLOCK_DURATION,
+  PROP_PREFETCH_DURATION,
+  PROP_CACHE_SIZE,
+  PROP_CONNECTIONS,
+  PROP_HEAD_FRESHNESS,
+  PROP_MAX_STALENESS,
+  PROP_FAST_START,
+  PROP_STATS,
+  PROP_STATS_INTERVAL,
+  PROP_TRACE,
+  PROP_SEEK_DEBOUNCE
 };
 
 typedef enum
@@ -59,24 +75,266 @@ typedef enum
    URI_PARSER_KEY_NOT_FOUND
 }uri_parser_retcode;
 
+/* Discovery headers sent in the first HEAD request of a tune.  The value of
+ * each level is the number of entries of the probe header table used. */
+typedef enum
+{
+   HEAD_PROBE_UNKNOWN = 0,
+   HEAD_PROBE_LEGACY = 1,     /* contentFeatures only, second HEAD follows */
+   HEAD_PROBE_SEEK_RANGE = 2, /* + getAvailableSeekRange */
+   HEAD_PROBE_FULL = 3        /* + TimeSeekRange npt=0- */
+}head_probe_level;
+
+/* Probe level a server accepted and when it was learned */
+typedef struct
+{
+   head_probe_level probe_level;
+   gint64           store_time;
+}dlna_src_head_probe_entry;
+
+/* Probe level sent and probe level the server is known to accept packed into
+ * the user data of a revalidation HEAD request */
+#define HEAD_PROBE_PACK(probe_level, host_level) \
+   GUINT_TO_POINTER (((host_level) << 4) | (probe_level))
+#define HEAD_PROBE_SENT(data) (GPOINTER_TO_UINT (data) & 0xf)
+#define HEAD_PROBE_HOST(data) (GPOINTER_TO_UINT (data) >> 4)
+
+/* Called on the HEAD worker thread once a HEAD request has completed */
+typedef void (*dlna_src_head_callback) (GstDlnaSrc * dlna_src,
+    gboolean success, gpointer user_data);
+
+/* HEAD request in flight on the HEAD worker */
+typedef struct
+{
+   GstDlnaSrc             *dlna_src;
+   SoupMessage            *soup_msg;
+   GstDlnaSrcHeadResponse *head_response;
+   gboolean               do_update_overall_info;
+   dlna_src_head_callback callback;
+   gpointer               user_data;
+   gchar                  *flight_key;
+   GstDlnaSrcLatency      purpose;
+   gint64                 issue_time;
+   guint32                seek_seqnum;
+}dlna_src_head_request;
+
+/* HEAD request shared by identical requests issued while it is in flight,
+ * kept once landed to answer them from memory while fresh */
+typedef struct
+{
+   gboolean in_flight;
+   gint64   land_time;
+   GList    *followers;
+}dlna_src_head_flight;
+
+/* HEAD worker and soup session shared by all instances in the process */
+typedef struct
+{
+   gint          refcount;
+   GThread      *thread;
+   GMainContext *context;
+   GMainLoop    *loop;
+   SoupSession  *session;
+}dlna_src_session_pool;
+
+/* Completion of a HEAD request waited on by a synchronous caller */
+typedef struct
+{
+   GMutex   mutex;
+   GCond    cond;
+   gboolean done;
+   gboolean success;
+}dlna_src_head_future;
+
+/* Known npt to byte offset mapping of a position in the content */
+typedef struct
+{
+   guint64 npt_nanos;
+   guint64 bytes;
+}dlna_src_seek_point;
+
+/* Preview windows fetched for a "fetch-previews" caller, which waits for
+ * pending to drop to zero or gives up and cancels the batch.  Referenced by
+ * the caller and by each pending window */
+typedef struct
+{
+   GstDlnaSrc *dlna_src;
+   gint       refcount;
+   GMutex     mutex;
+   GCond      cond;
+   guint      pending;
+   gboolean   cancelled;
+   gboolean   cancel_done;
+   guint      n_windows;
+   guint64    *npt_nanos;
+   guint64    *offsets;
+   GBytes     **windows;
+}dlna_src_preview_batch;
+
+/* Time seek range HEAD request converting the position of a preview window */
+typedef struct
+{
+   dlna_src_preview_batch *batch;
+   guint                  i;
+   GstDlnaSrcHeadResponse *head_response;
+}dlna_src_preview_conversion;
+
+/* Server capabilities and content info learned from HEAD responses for one
+ * URI */
+typedef struct
+{
+   gint64                                 store_time;
+   gint64                                 use_time;
+   GstDlnaSrcHeadResponseContentFeatures *content_features;
+   gchar                                 *dtcp_host;
+   guint                                  dtcp_port;
+   guint64                                byte_total;
+   guint64                                npt_duration_nanos;
+}dlna_src_caps_entry;
+
 #define MAX_PTS_45KHZ                (0xFFFFFFFFUL)
 #define DEFAULT_DTCP_BLOCKSIZE       524288
 #define SOUPHTTPSRC_BLOCKSIZE        (32 * 1024)
 
+/* Adaptive blocksize: target duration of a block, bounds and granularity of
+ * block sizes, how often throughput is measured and how much a new size must
+ * differ from the current one before it is applied */
+#define DEFAULT_BLOCK_DURATION_MS    (100)
+#define MIN_ADAPTIVE_BLOCKSIZE       (16 * 1024)
+#define MAX_ADAPTIVE_BLOCKSIZE       (2 * 1024 * 1024)
+#define MAX_TRICK_BLOCKSIZE          (256 * 1024)
+#define ADAPTIVE_BLOCKSIZE_ALIGN     (4 * 1024)
+#define THROUGHPUT_INTERVAL_MSECS    (1000)
+#define BLOCKSIZE_HYSTERESIS_PCT     (25)
+
+/* Buffer pool offered to souphttpsrc: buffers are aligned and sized in
+ * multiples of the DTCP AES block so dtcpip can decrypt in place */
+#define DTCP_AES_BLOCK_SIZE          (16)
+#define BUFFER_POOL_MIN_BUFFERS      (4)
+
+/* Speculative prefetch during trick play: content fetched around the
+ * predicted landing position (off by default, it opens a second connection
+ * to the server), how often and how far ahead of the current position
+ * landing is predicted, and bounds of a prefetched range */
+#define DEFAULT_PREFETCH_DURATION_MS (0)
+#define PREFETCH_INTERVAL_MSECS      (500)
+#define PREFETCH_LEAD_MSECS          (1000)
+#define MIN_PREFETCH_BYTES           (256 * 1024)
+#define MAX_PREFETCH_BYTES           (8 * 1024 * 1024)
+
+/* Bytes of recently played data kept to serve seeks back into it,
+ * 0 = no cache */
+#define DEFAULT_CACHE_SIZE           (0)
+
+/* Parallel range fetching: concurrent requests (1 = single souphttpsrc
+ * request), bytes fetched per request, chunks fetched ahead of the one
+ * being pushed per connection, attempts per chunk and seconds a stalled
+ * connection is given before its chunk is requested again */
+#define DEFAULT_CONNECTIONS          (1)
+#define PARALLEL_CHUNK_SIZE          (2 * 1024 * 1024)
+#define PARALLEL_CHUNKS_AHEAD        (2)
+#define PARALLEL_MAX_RETRIES         (3)
+#define PARALLEL_STALL_TIMEOUT_SECS  (5)
+
+/* Rate ladder: content byte rate assumed when the duration is unknown,
+ * chunks fetched per second of playback and bytes per chunk when striding
+ * over the content, a whole number of transport stream packets */
+#define TRICK_DEFAULT_BYTES_PER_SEC  (1024 * 1024)
+#define TRICK_STRIDE_CHUNKS_PER_SEC  (4)
+#define TRICK_STRIDE_CHUNK_SIZE      (188 * 1024)
+
+/* Transport stream packets, plain and with a 4 byte timestamp */
+#define TS_SYNC_BYTE                 (0x47)
+#define TS_PACKET_SIZE               (188)
+#define TTS_PACKET_SIZE              (192)
+
+/* Scrub previews: bytes fetched around each position, and the offsets of a
+ * position which could not be converted to bytes and of one converted with a
+ * HEAD request */
+#define PREVIEW_WINDOW_SIZE          (188 * 1024)
+#define PREVIEW_SKIPPED              G_MAXUINT64
+#define PREVIEW_CONVERT              (G_MAXUINT64 - 1)
+
+/* Longest a "fetch-previews" caller waits for its windows, and then for the
+ * requests still outstanding to be cancelled */
+#define PREVIEW_TIMEOUT_SECS         (10)
+#define PREVIEW_CANCEL_TIMEOUT_SECS  (2)
+
 #define ELEMENT_NAME_SOUP_HTTP_SRC "soup-http-source"
 #define ELEMENT_NAME_DTCP_DECRYPTER "dtcp-decrypter"
+#define ELEMENT_NAME_PARALLEL_SRC "parallel-source"
 
 #define MAX_HTTP_BUF_SIZE 2048
 
-#define BOUNDARY_THREAD_SLEEP_SECS (2)
+/* TSB boundary tracking: usual and adaptive range of timer intervals,
+ * longest time the local estimate is trusted and how far it may drift */
+#define BOUNDARY_INTERVAL_SECS (2)
+#define BOUNDARY_MIN_INTERVAL_SECS (1)
+#define BOUNDARY_MAX_INTERVAL_SECS (8)
+#define BOUNDARY_REVALIDATE_SECS (30)
+#define BOUNDARY_DRIFT_SECS (1)
 
-#define MIN_BUF_SECS_TSB_START_TO_PLAY_POS (8 + BOUNDARY_THREAD_SLEEP_SECS)
+#define MIN_BUF_SECS_TSB_START_TO_PLAY_POS (8 + BOUNDARY_INTERVAL_SECS)
 
 /* TODO - MAX_TSB_DURATION will be removed when the max_duration is passed
  * to the DLNA server in the URL.
  */
 #define MAX_TSB_DURATION (7200)
 
+#define DEFAULT_PIPELINED_HEAD TRUE
+#define DEFAULT_FAST_START FALSE
+
+/* Seconds between stats messages posted on the bus, 0 = none */
+#define DEFAULT_STATS_INTERVAL_SECS (0)
+
+/* Seeks arriving within this many ms of the last one executed are coalesced,
+ * only the latest of them is executed once the window has passed.  Off by
+ * default since coalesced seeks are acknowledged before they complete */
+#define DEFAULT_SEEK_DEBOUNCE_MS (0)
+
+#define HEAD_REQUEST_TIMEOUT_SECS (10)
+#define DEFAULT_MAX_CONNS_PER_HOST (2)
+#define DEFAULT_IDLE_TIMEOUT_SECS (60)
+#define DEFAULT_CAPS_CACHE_TTL_SECS (300)
+
+/* Capability cache entries kept, least recently used ones are dropped
+ * beyond this, and how long changes are collected before the cache file
+ * is written */
+#define CAPS_CACHE_MAX_ENTRIES (256)
+#define CAPS_CACHE_SAVE_DELAY_MSECS (2000)
+#define DEFAULT_HEAD_FRESHNESS_MS (500)
+#define DEFAULT_MAX_STALENESS_MS (10000)
+
+/* Seconds a server's probe level is trusted before probing richer again */
+#define HEAD_PROBE_CACHE_TTL_SECS (600)
+
+#define SEEK_INDEX_MAX_POINTS (512)
+#define SEEK_INDEX_MAX_GAP_SECS (5)
+
+/* Richest HEAD probe level each server (host:port) has accepted, shared by
+ * all instances in the process so later tunes take a single round trip.
+ * Entries expire so a server is probed with all headers again. */
+static GHashTable *head_probe_cache = NULL;
+G_LOCK_DEFINE_STATIC (head_probe_cache);
+
+/* Server capabilities keyed by "host:port|<SHA-1 of URI>" and the file they
+ * persist to, shared by all instances in the process.  Content features such
+ * as the live and link protected flags belong to one item, so an entry is
+ * only used for the URI it was learned from. */
+static GHashTable *caps_cache = NULL;
+static gchar *caps_cache_file = NULL;
+static gboolean caps_cache_loaded = FALSE;
+static gboolean caps_cache_save_pending = FALSE;
+static gboolean caps_cache_saving = FALSE;
+G_LOCK_DEFINE_STATIC (caps_cache);
+
+/* Connection limits of the shared session, set through the properties of
+ * any instance and applied to all */
+static dlna_src_session_pool *session_pool = NULL;
+static guint session_max_conns_per_host = DEFAULT_MAX_CONNS_PER_HOST;
+static guint session_idle_timeout = DEFAULT_IDLE_TIMEOUT_SECS;
+G_LOCK_DEFINE_STATIC (session_pool);
+
 static const gchar CRLF[] = "\r\n";
 
 static const gchar COLON[] = ":";
@@ -177,24 +435,71 @@ static const gchar *CONTENT_TYPE_HEADERS[] = {
  * protocol info dlna org flags represented by primary flags followed
  * by reserved data of 24 hexadecimal digits (zeros)
  */
-static const gint SP_FLAG = 1 << 31;    /* Sender Paced Flag - content src is clock  */
-static const gint LOP_NPT = 1 << 30;    /* Limited Operations Flags: Time-Based Seek */
-static const gint LOP_BYTES = 1 << 29;  /* Limited Operations Flags: Byte-Based Seek */
-static const gint PLAYCONTAINER_PARAM = 1 << 28;        /* DLNA PlayContainer Flag */
-static const gint S0_INCREASING = 1 << 27;      /* UCDAM s0 Increasing Flag - content has no fixed beginning */
-static const gint SN_INCREASING = 1 << 26;      /* UCDAM sN Increasing Flag - content has no fixed ending */
-static const gint RTSP_PAUSE = 1 << 25; /* Pause media operation support for RTP Serving Endpoints */
-static const gint TM_S = 1 << 24;       /* Streaming Mode Flag - av content must have this set */
-static const gint TM_I = 1 << 23;       /* Interactive Mode Flag */
-static const gint TM_B = 1 << 22;       /* Background Mode Flag */
-static const gint HTTP_STALLING = 1 << 21;      /* HTTP Connection Stalling Flag */
-static const gint DLNA_V15_FLAG = 1 << 20;      /* DLNA v1.5 versioning flag */
-static const gint LP_FLAG = 1 << 16;    /* Link Content Flag */
-static const gint CLEARTEXTBYTESEEK_FULL_FLAG = 1 << 15;        /* Support for Full RADA ClearTextByteSeek header */
-static const gint LOP_CLEARTEXTBYTES = 1 << 14; /* Support for Limited RADA ClearTextByteSeek header */
+#define SP_FLAG (1U << 31)              /* Sender Paced Flag - content src is clock  */
+#define LOP_NPT (1U << 30)              /* Limited Operations Flags: Time-Based Seek */
+#define LOP_BYTES (1U << 29)            /* Limited Operations Flags: Byte-Based Seek */
+#define PLAYCONTAINER_PARAM (1U << 28)  /* DLNA PlayContainer Flag */
+#define S0_INCREASING (1U << 27)        /* UCDAM s0 Increasing Flag - content has no fixed beginning */
+#define SN_INCREASING (1U << 26)        /* UCDAM sN Increasing Flag - content has no fixed ending */
+#define RTSP_PAUSE (1U << 25)           /* Pause media operation support for RTP Serving Endpoints */
+#define TM_S (1U << 24)                 /* Streaming Mode Flag - av content must have this set */
+#define TM_I (1U << 23)                 /* Interactive Mode Flag */
+#define TM_B (1U << 22)                 /* Background Mode Flag */
+#define HTTP_STALLING (1U << 21)        /* HTTP Connection Stalling Flag */
+#define DLNA_V15_FLAG (1U << 20)        /* DLNA v1.5 versioning flag */
+#define LP_FLAG (1U << 16)              /* Link Content Flag */
+#define CLEARTEXTBYTESEEK_FULL_FLAG (1U << 15) /* Support for Full RADA ClearTextByteSeek header */
+#define LOP_CLEARTEXTBYTES (1U << 14)   /* Support for Limited RADA ClearTextByteSeek header */
 
 static const int RESERVED_FLAGS_LENGTH = 24;
 
+/* Content features bits in the order they are listed in HEAD response dumps,
+ * with the primary flag each is expanded from, if any */
+static const struct
+{
+  guint32 primary;
+  GstDlnaSrcContentFlags flag;
+  const gchar *title;
+} CONTENT_FLAGS[] = {
+  {0, DLNA_SRC_CF_OP_TIME_SEEK, "Time Seek Supported Flag?: "},
+  {0, DLNA_SRC_CF_OP_RANGE, "Byte Seek Supported Flag?: "},
+  {SP_FLAG, DLNA_SRC_CF_SENDER_PACED, "Sender Paced?: "},
+  {LOP_NPT, DLNA_SRC_CF_LIMITED_TIME_SEEK, "Limited Time Seek?: "},
+  {LOP_BYTES, DLNA_SRC_CF_LIMITED_BYTE_SEEK, "Limited Byte Seek?: "},
+  {PLAYCONTAINER_PARAM, DLNA_SRC_CF_PLAY_CONTAINER, "Play Container?: "},
+  {S0_INCREASING, DLNA_SRC_CF_SO_INCREASING, "S0 Increasing?: "},
+  {SN_INCREASING, DLNA_SRC_CF_SN_INCREASING, "Sn Increasing?: "},
+  {RTSP_PAUSE, DLNA_SRC_CF_RTSP_PAUSE, "RTSP Pause?: "},
+  {TM_S, DLNA_SRC_CF_STREAMING_MODE, "Streaming Mode Supported?: "},
+  {TM_I, DLNA_SRC_CF_INTERACTIVE_MODE, "Interactive Mode Supported?: "},
+  {TM_B, DLNA_SRC_CF_BACKGROUND_MODE, "Background Mode Supported?: "},
+  {HTTP_STALLING, DLNA_SRC_CF_STALLING, "Connection Stalling Supported?: "},
+  {DLNA_V15_FLAG, DLNA_SRC_CF_DLNA_V15, "DLNA Ver. 1.5?: "},
+  {LP_FLAG, DLNA_SRC_CF_LINK_PROTECTED, "Link Protected?: "},
+  {CLEARTEXTBYTESEEK_FULL_FLAG, DLNA_SRC_CF_FULL_CLEAR_TEXT,
+      "Full Clear Text?: "},
+  {LOP_CLEARTEXTBYTES, DLNA_SRC_CF_LIMITED_CLEAR_TEXT, "Limited Clear Text?: "}
+};
+
+/* Content features bits of the DLNA.ORG_OP characters, in order */
+static const GstDlnaSrcContentFlags OPERATIONS_FLAGS[] = {
+  DLNA_SRC_CF_OP_TIME_SEEK,     /* TimeSeekRange.dlna.org */
+  DLNA_SRC_CF_OP_RANGE          /* Range */
+};
+
+/* Playspeeds listed in DLNA.ORG_PS by most servers, matched as is rather
+ * than converted */
+static const struct
+{
+  const gchar *str;
+  gfloat rate;
+} DLNA_PLAYSPEEDS[] = {
+  {"-64", -64.0}, {"-32", -32.0}, {"-16", -16.0}, {"-8", -8.0},
+  {"-4", -4.0}, {"-2", -2.0}, {"-1", -1.0}, {"-1/2", -0.5},
+  {"-1/4", -0.25}, {"1/4", 0.25}, {"1/2", 0.5}, {"2", 2.0},
+  {"4", 4.0}, {"8", 8.0}, {"16", 16.0}, {"32", 32.0}, {"64", 64.0}
+};
+
 #define HTTP_STATUS_OK 200
 #define HTTP_STATUS_CREATED 201
 #define HTTP_STATUS_PARTIAL 206
@@ -216,6 +521,53 @@ static const int RESERVED_FLAGS_LENGTH = 24;
 #define HEADER_TIME_SEEK_RANGE_TITLE "TimeSeekRange.dlna.org"
 #define HEADER_TIME_SEEK_RANGE_VALUE "npt=0-"
 
+/* Discovery headers of the first HEAD request, ordered so that the first
+ * probe level entries form the request */
+static gchar *PROBE_HEAD_REQUEST_HEADERS[][2] = {
+  {HEADER_GET_CONTENT_FEATURES_TITLE, HEADER_GET_CONTENT_FEATURES_VALUE},
+  {HEADER_GET_AVAILABLE_SEEK_RANGE_TITLE, HEADER_GET_AVAILABLE_SEEK_RANGE_VALUE},
+  {HEADER_TIME_SEEK_RANGE_TITLE, HEADER_TIME_SEEK_RANGE_VALUE}
+};
+
+/* Second HEAD request, chosen based on the first response */
+static gchar *REMAINING_HEAD_REQUEST_HEADERS[][2] = {
+  {HEADER_GET_AVAILABLE_SEEK_RANGE_TITLE, HEADER_GET_AVAILABLE_SEEK_RANGE_VALUE},
+  {HEADER_TIME_SEEK_RANGE_TITLE, HEADER_TIME_SEEK_RANGE_VALUE},
+  {HEADER_DTCP_RANGE_BYTES_TITLE, HEADER_DTCP_RANGE_BYTES_VALUE},
+  {HEADER_RANGE_BYTES_TITLE, HEADER_RANGE_BYTES_VALUE}
+};
+
+static const gchar *REMAINING_HEAD_DESCRIPTIONS[] = {
+  "live/recInProgess content",
+  "time seek",
+  "dtcp range",
+  "range"
+};
+
+static const GstDlnaSrcLatency REMAINING_HEAD_LATENCIES[] = {
+  DLNA_SRC_LATENCY_HEAD_AVAILABLE_RANGE,
+  DLNA_SRC_LATENCY_HEAD_TIME_SEEK,
+  DLNA_SRC_LATENCY_HEAD_BYTE_RANGE,
+  DLNA_SRC_LATENCY_HEAD_BYTE_RANGE
+};
+
+#define REMAINING_HEAD_LIVE 0
+#define REMAINING_HEAD_TIME_SEEK 1
+#define REMAINING_HEAD_DTCP_RANGE 2
+#define REMAINING_HEAD_RANGE 3
+
+/* Names of the latency histograms in the stats structure */
+static const gchar *LATENCY_NAMES[DLNA_SRC_LATENCY_CNT] = {
+  "head-content-features",
+  "head-time-seek",
+  "head-byte-range",
+  "head-available-range",
+  "head-npt-to-bytes",
+  "head-boundary-poll",
+  "seek-to-first-buffer",
+  "rate-change-to-first-buffer"
+};
+
 static GstStaticPadTemplate gst_dlna_src_pad_template =
 GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
@@ -243,7 +595,190 @@ static gboolean gst_dlna_src_event (GstPad * pad, GstEvent * event);
 static gboolean gst_dlna_src_query (GstPad * pad, GstQuery * query);
 #endif
 
-static gpointer gst_dlna_src_update_boundary_thread(gpointer data);
+static gboolean dlna_src_query_current_pts(GstDlnaSrc *dlna_src, guint32 *current_pts_45khz);
+
+static gboolean dlna_src_get_tsb_headroom(GstDlnaSrc *dlna_src, gint64 *headroom);
+
+static gboolean dlna_src_boundary_timer_start (GstDlnaSrc * dlna_src);
+
+static void dlna_src_stats_record (GstDlnaSrc * dlna_src,
+    GstDlnaSrcLatency latency, gint64 usecs);
+
+static void dlna_src_stats_mark (GstDlnaSrc * dlna_src,
+    GstDlnaSrcLatency latency);
+
+static GstStructure *dlna_src_stats_to_structure (GstDlnaSrc * dlna_src);
+
+static void dlna_src_stats_timer_start (GstDlnaSrc * dlna_src);
+
+static void dlna_src_stats_timer_stop (GstDlnaSrc * dlna_src);
+
+static void dlna_src_trace_record (GstDlnaSrc * dlna_src,
+    GstDlnaSrcTraceEntry * entry);
+
+static void dlna_src_trace_head (GstDlnaSrc * dlna_src,
+    GstDlnaSrcLatency purpose, guint status, gint64 usecs,
+    GstDlnaSrcHeadResponse * head_response);
+
+static gchar *dlna_src_trace_to_string (GstDlnaSrc * dlna_src);
+
+static void dlna_src_trace_dump (GstDlnaSrc * dlna_src, const gchar * reason);
+
+static void dlna_src_boundary_timer_stop (GstDlnaSrc * dlna_src);
+
+static gboolean dlna_src_boundary_timer_remove (gpointer data);
+
+static void dlna_src_boundary_timer_schedule (GstDlnaSrc * dlna_src,
+    guint interval_secs);
+
+static void dlna_src_boundary_extrapolate (GstDlnaSrc * dlna_src, gint64 now,
+    guint32 * start_pts, guint32 * end_pts);
+
+static gboolean dlna_src_boundary_timer_cb (gpointer data);
+
+static void dlna_src_boundary_sync (GstDlnaSrc * dlna_src);
+
+static void dlna_src_boundary_report_request (GstDlnaSrc * dlna_src);
+
+static void dlna_src_boundary_report (GstDlnaSrc * dlna_src);
+
+static gpointer dlna_src_boundary_thread_func (gpointer data);
+
+static void dlna_src_boundary_thread_stop (GstDlnaSrc * dlna_src);
+
+static void dlna_src_prefetch_start (GstDlnaSrc * dlna_src, guint64 npt_nanos,
+    gfloat rate);
+
+static void dlna_src_prefetch_stop (GstDlnaSrc * dlna_src);
+
+static gboolean dlna_src_prefetch_remove (gpointer data);
+
+static gboolean dlna_src_prefetch_timer_cb (gpointer data);
+
+static void dlna_src_prefetch_aim (GstDlnaSrc * dlna_src);
+
+static void dlna_src_prefetch_done (SoupSession * session,
+    SoupMessage * soup_msg, gpointer user_data);
+
+static void dlna_src_prefetch_clear (GstDlnaSrc * dlna_src);
+
+static gboolean dlna_src_prefetch_serve (GstDlnaSrc * dlna_src,
+    GstFormat format, guint64 start, guint32 seqnum);
+
+static gboolean dlna_src_splice_start (GstDlnaSrc * dlna_src, GBytes * data,
+    guint64 data_offset, guint64 offset, guint32 seqnum);
+
+static void dlna_src_splice_join (GstDlnaSrc * dlna_src);
+
+static void dlna_src_cache_write (GstDlnaSrc * dlna_src, guint64 offset,
+    const guint8 * data, gsize size);
+
+static gboolean dlna_src_cache_serve (GstDlnaSrc * dlna_src, guint64 offset,
+    guint32 seqnum);
+
+static void dlna_src_cache_clear (GstDlnaSrc * dlna_src);
+
+static gboolean dlna_src_parallel_serve (GstDlnaSrc * dlna_src,
+    GstFormat format, guint64 start, guint32 seqnum);
+
+static gboolean dlna_src_stride_serve (GstDlnaSrc * dlna_src,
+    GstFormat format, guint64 start, const GstDlnaSrcTrickPlan * plan,
+    guint32 seqnum);
+
+static void dlna_src_parallel_stop (GstDlnaSrc * dlna_src);
+
+static void dlna_src_parallel_leave (GstDlnaSrc * dlna_src);
+
+static guint64 dlna_src_parallel_chunk_start (GstDlnaSrc * dlna_src,
+    guint chunk);
+
+static gboolean dlna_src_parallel_fill (gpointer data);
+
+static void dlna_src_parallel_request (GstDlnaSrc * dlna_src, guint chunk,
+    guint retries);
+
+static void dlna_src_parallel_done (SoupSession * session,
+    SoupMessage * soup_msg, gpointer user_data);
+
+static gboolean dlna_src_parallel_cancel (gpointer data);
+
+static void dlna_src_parallel_clear (GstDlnaSrc * dlna_src);
+
+#if GST_CHECK_VERSION(1,0,0)
+static gboolean dlna_src_splice_begin (GstDlnaSrc * dlna_src, guint64 resume,
+    guint32 seqnum);
+
+static GstFlowReturn dlna_src_splice_push_segment (GstDlnaSrc * dlna_src,
+    guint64 offset, guint32 seqnum);
+
+static GstFlowReturn dlna_src_splice_push_data (GstDlnaSrc * dlna_src,
+    GBytes * data, gsize pos, guint64 data_offset, gboolean discont);
+
+static gpointer dlna_src_splice_thread_func (gpointer data);
+
+static gboolean dlna_src_parallel_enter (GstDlnaSrc * dlna_src,
+    guint64 offset, guint32 seqnum);
+
+static void dlna_src_parallel_need_data (GstElement * appsrc, guint length,
+    gpointer user_data);
+
+static gboolean dlna_src_parallel_seek_data (GstElement * appsrc,
+    guint64 offset, gpointer user_data);
+
+static GstFlowReturn dlna_src_parallel_push (GstDlnaSrc * dlna_src,
+    GBytes * data, guint64 data_offset, gboolean discont);
+
+static gboolean dlna_src_parallel_fetch (GstDlnaSrc * dlna_src,
+    guint64 offset, gint64 stride, guint chunk_size, gboolean random_access,
+    gdouble applied_rate, guint32 seqnum);
+
+static gboolean dlna_src_ts_find_random_access (const guint8 * data,
+    gsize size, gsize * start, gsize * end);
+
+static GstBufferList *gst_dlna_src_fetch_previews (GstDlnaSrc * dlna_src,
+    GArray * positions);
+
+static dlna_src_preview_batch *dlna_src_preview_batch_new (GstDlnaSrc *
+    dlna_src, guint n_windows);
+
+static dlna_src_preview_batch *dlna_src_preview_batch_ref (
+    dlna_src_preview_batch * batch);
+
+static void dlna_src_preview_batch_unref (gpointer data);
+
+static gboolean dlna_src_preview_queue (gpointer data);
+
+static gboolean dlna_src_preview_cancel (gpointer data);
+
+static void dlna_src_preview_request (dlna_src_preview_batch * batch,
+    guint i, guint64 offset);
+
+static void dlna_src_preview_convert (dlna_src_preview_batch * batch,
+    guint i);
+
+static void dlna_src_preview_convert_done (GstDlnaSrc * dlna_src,
+    gboolean success, gpointer user_data);
+
+static void dlna_src_preview_done (SoupSession * session,
+    SoupMessage * soup_msg, gpointer user_data);
+
+static void dlna_src_preview_complete (dlna_src_preview_batch * batch,
+    guint i, GBytes * window);
+
+static gboolean dlna_src_preview_cancelled (dlna_src_preview_batch * batch);
+
+static gboolean dlna_src_internal_event (GstPad * pad, GstObject * parent,
+    GstEvent * event);
+
+static GstFlowReturn dlna_src_internal_chain (GstPad * pad,
+    GstObject * parent, GstBuffer * buffer);
+
+static void dlna_src_stats_delivered (GstDlnaSrc * dlna_src, gsize size,
+    GstFlowReturn flow);
+
+static GstPadProbeReturn dlna_src_cache_probe (GstPad * pad,
+    GstPadProbeInfo * info, gpointer user_data);
+#endif
 
 static GstStateChangeReturn gst_dlna_src_change_state (GstElement * element,
     GstStateChange transition);
@@ -265,25 +800,132 @@ static gboolean dlna_src_uri_assign (GstDlnaSrc * dlna_src, const gchar * uri);
 #endif
 
 static gboolean dlna_src_uri_init (GstDlnaSrc * dlna_src);
+static gboolean dlna_src_uri_parse_max_tsb_duration (GstDlnaSrc * dlna_src);
+static void dlna_src_fast_start_done (GstDlnaSrc * dlna_src);
 
 static gboolean dlna_src_uri_gather_info (GstDlnaSrc * dlna_src);
 
+static gint dlna_src_uri_remaining_head_idx (GstDlnaSrc * dlna_src,
+    head_probe_level probe_level);
+
+static gboolean dlna_src_uri_gather_remaining_info (GstDlnaSrc * dlna_src,
+    head_probe_level probe_level);
+
+static gboolean dlna_src_uri_revalidate_async (GstDlnaSrc * dlna_src,
+    head_probe_level probe_level, head_probe_level host_level);
+
+static void dlna_src_uri_revalidate_done (GstDlnaSrc * dlna_src,
+    gboolean success, gpointer user_data);
+
+static void dlna_src_uri_revalidate_remaining_done (GstDlnaSrc * dlna_src,
+    gboolean success, gpointer user_data);
+
+static gchar *dlna_src_server_key (GstDlnaSrc * dlna_src);
+
+static head_probe_level dlna_src_head_probe_cache_lookup (const gchar * key);
+
+static void dlna_src_head_probe_cache_store (const gchar * key,
+    head_probe_level probe_level);
+
+static gboolean dlna_src_head_probe_refused_by_item (GstDlnaSrc * dlna_src);
+
+static gchar *dlna_src_caps_cache_key (GstDlnaSrc * dlna_src);
+
+static gboolean dlna_src_caps_cache_apply (GstDlnaSrc * dlna_src);
+
+static void dlna_src_caps_cache_store (GstDlnaSrc * dlna_src,
+    GstDlnaSrcHeadResponse * head_response);
+
+static void dlna_src_caps_cache_invalidate (const gchar * server_key);
+
+static void dlna_src_caps_cache_set_file (const gchar * file);
+
+static void dlna_src_caps_cache_load_locked (guint ttl);
+
+static void dlna_src_caps_cache_trim_locked (void);
+
+static void dlna_src_caps_cache_save_locked (void);
+
+static gchar *dlna_src_caps_cache_to_data_locked (gsize * length);
+
+static gpointer dlna_src_caps_cache_save_thread_func (gpointer data);
+
+static void dlna_src_caps_entry_free (dlna_src_caps_entry * entry);
+
 static gboolean dlna_src_setup_bin (GstDlnaSrc * dlna_src);
 
+static void dlna_src_blocksize_update (GstDlnaSrc * dlna_src);
+
+#if GST_CHECK_VERSION(1,0,0)
+static gboolean dlna_src_internal_query (GstPad * pad, GstObject * parent,
+    GstQuery * query);
+
+static gboolean dlna_src_propose_allocation (GstDlnaSrc * dlna_src,
+    GstQuery * query);
+#endif
+
+#if GST_CHECK_VERSION(1,0,0)
+static GstPadProbeReturn dlna_src_throughput_probe (GstPad * pad,
+    GstPadProbeInfo * info, gpointer user_data);
+#else
+static gboolean dlna_src_throughput_probe (GstPad * pad, GstBuffer * buffer,
+    gpointer user_data);
+#endif
+
 static gboolean dlna_src_setup_dtcp (GstDlnaSrc * dlna_src);
+#if GST_CHECK_VERSION(1,0,0)
+static void gst_dlna_src_handle_message (GstBin * bin, GstMessage * message);
+static gboolean dlna_src_setup_dtcp_lazy (GstDlnaSrc * dlna_src,
+    const gchar * content_type);
+static void dlna_src_harvest_response_headers (GstDlnaSrc * dlna_src,
+    const GstStructure * headers);
+static gboolean dlna_src_harvest_boundary_sync (gpointer data);
+#endif
 
 static gboolean dlna_src_soup_session_open (GstDlnaSrc * dlna_src);
 static void dlna_src_soup_session_close (GstDlnaSrc * dlna_src);
+static gboolean dlna_src_head_cancel_all (gpointer data);
+static void dlna_src_session_pool_free (dlna_src_session_pool * pool);
+static gpointer dlna_src_session_pool_thread_func (gpointer data);
+static gboolean dlna_src_session_pool_thread_stop (gpointer data);
+static void dlna_src_session_pool_configure (GstDlnaSrc * dlna_src);
+
+static gboolean dlna_src_session_pool_apply (gpointer data);
 static void
 dlna_src_soup_log_msg (GstDlnaSrc * dlna_src, SoupMessage *soup_msg);
 static gboolean
 dlna_src_soup_issue_head (GstDlnaSrc * dlna_src, gsize header_array_size,
     gchar * headers[][2], GstDlnaSrcHeadResponse * head_response,
-    gboolean do_update_overall_info);
+    gboolean do_update_overall_info, GstDlnaSrcLatency purpose);
 
 static gboolean
+dlna_src_soup_issue_head_async (GstDlnaSrc * dlna_src, gsize header_array_size,
+    gchar * headers[][2], GstDlnaSrcHeadResponse * head_response,
+    gboolean do_update_overall_info, GstDlnaSrcLatency purpose,
+    dlna_src_head_callback callback, gpointer user_data);
+static void dlna_src_head_future_complete (GstDlnaSrc * dlna_src,
+    gboolean success, gpointer user_data);
+static gboolean dlna_src_head_request_queue (gpointer data);
+static void dlna_src_head_request_done (SoupSession * session,
+    SoupMessage * soup_msg, gpointer user_data);
+static void dlna_src_head_request_complete (dlna_src_head_request * request,
+    gboolean success);
+static void dlna_src_head_flight_land (dlna_src_head_request * request,
+    gboolean success);
+static gboolean dlna_src_head_flight_expired (gpointer key, gpointer value,
+    gpointer user_data);
+static void dlna_src_head_flight_free (dlna_src_head_flight * flight);
+static void dlna_src_refresh_live_info_async (GstDlnaSrc * dlna_src,
+    GstDlnaSrcLatency purpose);
+static void dlna_src_refresh_live_info_done (GstDlnaSrc * dlna_src,
+    gboolean success, gpointer user_data);
+static gboolean dlna_src_is_live_range_current (GstDlnaSrc * dlna_src,
+    guint64 npt_nanos);
+static gboolean
 dlna_src_head_response_parse (GstDlnaSrc * dlna_src, SoupMessage *soup_msg,
     GstDlnaSrcHeadResponse * head_response);
+static void dlna_src_head_response_assign_fields (GstDlnaSrc * dlna_src,
+    GstDlnaSrcHeadResponse * head_response, const gchar ** field_values);
 
 static gint dlna_src_head_response_get_field_idx (GstDlnaSrc * dlna_src,
     const gchar * field_str);
@@ -304,22 +946,25 @@ static gboolean dlna_src_head_response_parse_content_features (GstDlnaSrc *
     const gchar * field_str);
 
 static gboolean dlna_src_head_response_parse_profile (GstDlnaSrc * dlna_src,
-    GstDlnaSrcHeadResponse * head_response, gint idx, const gchar * field_str);
+    GstDlnaSrcHeadResponse * head_response, const gchar * value, gsize len);
 
 static gboolean dlna_src_head_response_parse_operations (GstDlnaSrc *
-    dlna_src, GstDlnaSrcHeadResponse * head_response, gint idx,
-    const gchar * field_str);
+    dlna_src, GstDlnaSrcHeadResponse * head_response, const gchar * value,
+    gsize len);
 
 static gboolean dlna_src_head_response_parse_playspeeds (GstDlnaSrc *
-    dlna_src, GstDlnaSrcHeadResponse * head_response, gint idx,
-    const gchar * field_str);
+    dlna_src, GstDlnaSrcHeadResponse * head_response, const gchar * value,
+    gsize len);
+
+static gboolean dlna_src_scan_playspeed (const gchar * str, gsize len,
+    gfloat * rate);
 
 static gboolean dlna_src_head_response_parse_flags (GstDlnaSrc * dlna_src,
-    GstDlnaSrcHeadResponse * head_response, gint idx, const gchar * field_str);
+    GstDlnaSrcHeadResponse * head_response, const gchar * value, gsize len);
 
 static gboolean
 dlna_src_head_response_parse_conversion_indicator (GstDlnaSrc * dlna_src,
-    GstDlnaSrcHeadResponse * head_response, gint idx, const gchar * field_str);
+    GstDlnaSrcHeadResponse * head_response, const gchar * value, gsize len);
 
 static gboolean dlna_src_head_response_parse_content_type (GstDlnaSrc *
     dlna_src, GstDlnaSrcHeadResponse * head_response, gint idx,
@@ -328,15 +973,47 @@ static gboolean dlna_src_head_response_parse_content_type (GstDlnaSrc *
 static gboolean dlna_src_head_response_parse_presentation_timestamps (GstDlnaSrc * 
     dlna_src, const gchar * field_str, guint32 * start_pts, guint32 * end_pts);
 
-static gboolean dlna_src_head_response_is_flag_set (GstDlnaSrc * dlna_src,
-    const gchar * flags_str, gint flag);
+static gboolean dlna_src_head_response_parse_primary_flags (GstDlnaSrc *
+    dlna_src, const gchar * flags_str, gsize len, guint32 * primary);
 
 static gboolean dlna_src_update_overall_info (GstDlnaSrc * dlna_src,
     GstDlnaSrcHeadResponse * head_response);
 
+static void dlna_src_range_publish (GstDlnaSrc * dlna_src);
+
+static void dlna_src_range_publish_pts (GstDlnaSrc * dlna_src,
+    guint32 start_pts, guint32 end_pts);
+
+static void dlna_src_range_swap (GstDlnaSrc * dlna_src,
+    GstDlnaSrcRange * range);
+
+static GstDlnaSrcRange *dlna_src_range_get (GstDlnaSrc * dlna_src);
+
+static void dlna_src_range_unref (GstDlnaSrcRange * range);
+static GstDlnaSrcRange *dlna_src_range_get_fresh (GstDlnaSrc * dlna_src);
+static void dlna_src_range_extrapolate (GstDlnaSrc * dlna_src,
+    GstDlnaSrcRange * range, guint64 * npt_start, guint64 * npt_end,
+    guint64 * npt_duration);
+
 static gboolean dlna_src_head_response_init_struct (GstDlnaSrc * dlna_src,
     GstDlnaSrcHeadResponse ** head_response);
 
+static GstDlnaSrcHeadResponseContentFeatures
+    * dlna_src_content_features_new (void);
+
+static GstDlnaSrcHeadResponseContentFeatures
+    * dlna_src_content_features_copy (const
+    GstDlnaSrcHeadResponseContentFeatures * content_features);
+
+static void dlna_src_content_features_free (GstDlnaSrcHeadResponseContentFeatures
+    * content_features);
+
+static guint32 dlna_src_content_features_get_flags (const
+    GstDlnaSrcHeadResponseContentFeatures * content_features);
+
+static void dlna_src_content_features_set_flags
+    (GstDlnaSrcHeadResponseContentFeatures * content_features, guint32 flags);
+
 static void dlna_src_head_response_free_struct (GstDlnaSrc * dlna_src,
     GstDlnaSrcHeadResponse * head_response);
 
@@ -363,6 +1040,21 @@ static gboolean dlna_src_send_tsb_boundary_event(GstDlnaSrc *dlna_src);
 static gboolean dlna_src_handle_event_seek (GstDlnaSrc * dlna_src,
     GstPad * pad, GstEvent * event);
 
+static gboolean dlna_src_seek_schedule (GstDlnaSrc * dlna_src, GstPad * pad,
+    GstEvent * event);
+
+static gboolean dlna_src_seek_is_executable (GstDlnaSrc * dlna_src,
+    GstEvent * event);
+
+static gboolean dlna_src_seek_execute (GstDlnaSrc * dlna_src, GstPad * pad,
+    GstEvent * event);
+
+static gpointer dlna_src_seek_thread_func (gpointer data);
+
+static void dlna_src_seek_thread_stop (GstDlnaSrc * dlna_src);
+
+static gboolean dlna_src_seek_cancel_superseded (gpointer data);
+
 static gboolean dlna_src_handle_query_duration (GstDlnaSrc * dlna_src,
     GstQuery * query);
 
@@ -375,6 +1067,16 @@ static gboolean dlna_src_handle_query_segment (GstDlnaSrc * dlna_src,
 static gboolean dlna_src_handle_query_convert (GstDlnaSrc * dlna_src,
     GstQuery * query);
 
+static const gchar *dlna_src_find_token (const gchar * str,
+    const gchar * token);
+
+static gboolean dlna_src_scan_guint64 (const gchar ** str, guint64 * value);
+
+static gboolean dlna_src_scan_hex32 (const gchar ** str, guint32 * value);
+
+static void dlna_src_assign_span (gchar ** str, const gchar * start,
+    gsize len);
+
 static gboolean dlna_src_parse_byte_range (GstDlnaSrc * dlna_src,
     const gchar * field_str, gint header_idx, guint64 * start_byte,
     guint64 * end_byte, guint64 * total_bytes);
@@ -388,12 +1090,29 @@ static gboolean dlna_src_is_change_valid (GstDlnaSrc * dlna_src, gfloat rate,
     GstFormat format, guint64 start,
     GstSeekType start_type, guint64 stop, GstSeekType stop_type);
 
-static gboolean dlna_src_is_rate_supported (GstDlnaSrc * dlna_src, gfloat rate);
+static gboolean dlna_src_rate_ladder_plan (GstDlnaSrc * dlna_src, gfloat rate,
+    GstDlnaSrcTrickPlan * plan);
+
+static gboolean dlna_src_is_transport_stream (GstDlnaSrc * dlna_src);
 
 static gboolean dlna_src_adjust_http_src_headers (GstDlnaSrc * dlna_src,
     gfloat rate, GstFormat format, guint64 start, guint64 stop,
     guint32 new_seqnum);
 
+static void dlna_src_seek_index_add (GstDlnaSrc * dlna_src,
+    guint64 npt_nanos, guint64 bytes);
+
+static void dlna_src_seek_index_prune (GstDlnaSrc * dlna_src,
+    guint64 npt_nanos);
+
+static void dlna_src_seek_index_clear (GstDlnaSrc * dlna_src);
+
+static guint dlna_src_seek_index_find (GArray * index, gboolean by_npt,
+    guint64 value);
+
+static gboolean dlna_src_seek_index_lookup (GstDlnaSrc * dlna_src,
+    gboolean from_npt, guint64 value, guint64 max_gap, guint64 * result);
+
 static gboolean dlna_src_npt_to_nanos (GstDlnaSrc * dlna_src, gchar * string,
     guint64 * media_time_nanos);
 
@@ -409,6 +1128,16 @@ static void
 dlna_src_nanos_to_npt (GstDlnaSrc * dlna_src, guint64 npt_nanos,
     GString * npt_str);
 
+#if GST_CHECK_VERSION(1,0,0)
+enum
+{
+  SIGNAL_FETCH_PREVIEWS,
+  LAST_SIGNAL
+};
+
+static guint gst_dlna_src_signals[LAST_SIGNAL] = { 0 };
+#endif
+
 #define gst_dlna_src_parent_class parent_class
 G_DEFINE_TYPE_WITH_CODE (GstDlnaSrc, gst_dlna_src, GST_TYPE_BIN,
     G_IMPLEMENT_INTERFACE (GST_TYPE_URI_HANDLER,
@@ -453,6 +1182,9 @@ gst_dlna_src_class_init (GstDlnaSrcClass * klass)
 
   GstElementClass *gstelement_klass;
   gstelement_klass = (GstElementClass *) klass;
+#if GST_CHECK_VERSION(1,0,0)
+  GstBinClass *gstbin_klass = (GstBinClass *) klass;
+#endif
 
 #if GST_CHECK_VERSION(1,0,0)
   gst_element_class_set_static_metadata (gstelement_klass,
@@ -468,6 +1200,16 @@ gst_dlna_src_class_init (GstDlnaSrcClass * klass)
   gobject_klass->set_property = gst_dlna_src_set_property;
   gobject_klass->get_property = gst_dlna_src_get_property;
 
+#if GST_CHECK_VERSION(1,0,0)
+  /* Fetches the data around npt positions without disturbing the stream */
+  gst_dlna_src_signals[SIGNAL_FETCH_PREVIEWS] =
+      g_signal_new ("fetch-previews", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+      G_STRUCT_OFFSET (GstDlnaSrcClass, fetch_previews), NULL, NULL,
+      g_cclosure_marshal_generic, GST_TYPE_BUFFER_LIST, 1, G_TYPE_ARRAY);
+  klass->fetch_previews = gst_dlna_src_fetch_previews;
+#endif
+
   g_object_class_install_property (gobject_klass, PROP_URI,
       g_param_spec_string ("uri", "Stream URI",
           "Sets URI A/V stream", NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
@@ -495,8 +1237,130 @@ gst_dlna_src_class_init (GstDlnaSrcClass * klass)
       g_param_spec_uint ("tsb-slide", "tsb slide", "TSB slide since tune in secs(current_tsb_start - tune_start)",
           0, G_MAXUINT, 0, G_PARAM_READABLE));
 
+  g_object_class_install_property (gobject_klass, PROP_PIPELINED_HEAD,
+      g_param_spec_boolean ("pipelined-head", "pipelined head",
+          "Send all discovery headers in the first HEAD request, falling back "
+          "to separate requests for servers which reject it (must be set "
+          "before the uri)",
+          DEFAULT_PIPELINED_HEAD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_FAST_START,
+      g_param_spec_boolean ("fast-start", "fast start",
+          "Start streaming right away and learn content features from HEAD "
+          "requests issued in parallel, inserting the DTCP decrypter once "
+          "the GET response shows the content is encrypted (must be set "
+          "before the uri, ignored with GStreamer 0.10)",
+          DEFAULT_FAST_START, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_STATS,
+      g_param_spec_boxed ("stats", "stats",
+          "Latency histograms of HEAD requests by purpose, of seeks and "
+          "rate changes until the first buffer, and byte counters",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_STATS_INTERVAL,
+      g_param_spec_uint ("stats-interval", "stats interval",
+          "Seconds between element messages carrying the stats while "
+          "paused or playing (0 = none)",
+          0, G_MAXUINT, DEFAULT_STATS_INTERVAL_SECS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_TRACE,
+      g_param_spec_string ("trace", "trace",
+          "Recent HEAD requests, GET responses and seeks, oldest first",
+          NULL, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_SEEK_DEBOUNCE,
+      g_param_spec_uint ("seek-debounce", "seek debounce",
+          "Milliseconds after a seek during which further seeks are "
+          "coalesced, only the latest of them is executed.  Coalesced "
+          "flushing seeks complete asynchronously, ASYNC_DONE follows once "
+          "the window has passed (0 = none)",
+          0, G_MAXUINT, DEFAULT_SEEK_DEBOUNCE_MS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_MAX_CONNS_PER_HOST,
+      g_param_spec_uint ("max-conns-per-host", "max conns per host",
+          "Maximum number of HEAD connections per server, process-wide: "
+          "shared by all dlnasrc instances, the value set last applies to all",
+          1, G_MAXUINT, DEFAULT_MAX_CONNS_PER_HOST,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_IDLE_TIMEOUT,
+      g_param_spec_uint ("idle-timeout", "idle timeout",
+          "Seconds an idle HEAD connection is kept alive for reuse (0 = never "
+          "closed), process-wide: shared by all dlnasrc instances, the value "
+          "set last applies to all",
+          0, G_MAXUINT, DEFAULT_IDLE_TIMEOUT_SECS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_CAPS_CACHE_TTL,
+      g_param_spec_uint ("caps-cache-ttl", "caps cache ttl",
+          "Seconds cached server capabilities of a URI are used before being "
+          "learned again (0 = capabilities are not cached)",
+          0, G_MAXUINT, DEFAULT_CAPS_CACHE_TTL_SECS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_CAPS_CACHE_FILE,
+      g_param_spec_string ("caps-cache-file", "caps cache file",
+          "File server capabilities are persisted to across runs, shared by "
+          "all dlnasrc instances in the process (NULL = memory only)",
+          NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_BLOCK_DURATION,
+      g_param_spec_uint ("block-duration", "block duration",
+          "Milliseconds of content each block read from the server should "
+          "hold, sized from content bitrate and play rate and capped by "
+          "measured throughput, not used with DTCP (0 = fixed blocksize)",
+          0, G_MAXUINT, DEFAULT_BLOCK_DURATION_MS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_PREFETCH_DURATION,
+      g_param_spec_uint ("prefetch-duration", "prefetch duration",
+          "Milliseconds of content prefetched around the predicted landing "
+          "position during trick play, so that resuming 1x playback there "
+          "is served from memory (0 = disabled)",
+          0, G_MAXUINT, DEFAULT_PREFETCH_DURATION_MS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_CACHE_SIZE,
+      g_param_spec_uint ("cache-size", "cache size",
+          "Bytes of recently played data kept in memory, so that byte "
+          "seeks back into it are served without a new request to the "
+          "server, not used for content going through dtcpip (0 = disabled)",
+          0, G_MAXUINT, DEFAULT_CACHE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_CONNECTIONS,
+      g_param_spec_uint ("connections", "connections",
+          "Number of concurrent range requests content which is not live "
+          "is fetched over, in chunks reassembled in order (1 = single "
+          "request by souphttpsrc, must be set before playback)",
+          1, G_MAXUINT, DEFAULT_CONNECTIONS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_HEAD_FRESHNESS,
+      g_param_spec_uint ("head-freshness", "head freshness",
+          "Milliseconds the response to a HEAD request is reused for "
+          "identical requests, e.g. duration queries and seeks asking for "
+          "the range of live content (0 = only share requests in flight)",
+          0, G_MAXUINT, DEFAULT_HEAD_FRESHNESS_MS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_klass, PROP_MAX_STALENESS,
+      g_param_spec_uint ("max-staleness", "max staleness",
+          "Milliseconds the last known range of live content may be old "
+          "and still answer duration and seeking queries, extrapolated "
+          "and refreshed in the background (0 = always wait for server)",
+          0, G_MAXUINT, DEFAULT_MAX_STALENESS_MS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_klass->finalize = GST_DEBUG_FUNCPTR (gst_dlna_src_finalize);
   gstelement_klass->change_state = gst_dlna_src_change_state;
+#if GST_CHECK_VERSION(1,0,0)
+  gstbin_klass->handle_message =
+      GST_DEBUG_FUNCPTR (gst_dlna_src_handle_message);
+#endif
 }
 
 /*
@@ -510,6 +1374,9 @@ gst_dlna_src_init (GstDlnaSrc * dlna_src)
 {
   GST_INFO_OBJECT (dlna_src, "Initializing");
   gchar *max_tsb_duration_env_val = NULL;
+  gchar *pipelined_head_env_val = NULL;
+  gchar *fast_start_env_val = NULL;
+  gchar *caps_cache_file_env_val = NULL;
   guint32 max_tsb_duration = 0; 
 
   dlna_src->http_src = NULL;
@@ -517,16 +1384,66 @@ gst_dlna_src_init (GstDlnaSrc * dlna_src)
   dlna_src->src_pad = NULL;
 
   dlna_src->dtcp_blocksize = DEFAULT_DTCP_BLOCKSIZE;
+  dlna_src->block_duration = DEFAULT_BLOCK_DURATION_MS;
+  dlna_src->blocksize = 0;
+  dlna_src->throughput_bytes = 0;
+  dlna_src->throughput_start = 0;
+  dlna_src->throughput = 0;
+  dlna_src->buffer_pool_size = 0;
   dlna_src->src_pad = NULL;
   dlna_src->dtcp_key_storage = NULL;
   dlna_src->dlna_uri = NULL;
   dlna_src->http_uri = NULL;
   dlna_src->soup_session = NULL;
+  dlna_src->head_context = NULL;
+  dlna_src->head_closing = FALSE;
+  dlna_src->head_requests = NULL;
+  dlna_src->head_requests_pending = 0;
+  dlna_src->head_cancel_done = FALSE;
+  g_mutex_init (&dlna_src->head_mutex);
+  g_cond_init (&dlna_src->head_cond);
+  dlna_src->head_refresh_pending = 0;
+  dlna_src->head_update_time = 0;
+  dlna_src->head_flights = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, (GDestroyNotify) dlna_src_head_flight_free);
+  dlna_src->head_flights_generation = 0;
+  dlna_src->head_freshness = DEFAULT_HEAD_FRESHNESS_MS;
+  dlna_src->max_staleness = DEFAULT_MAX_STALENESS_MS;
+  dlna_src->stats_interval = DEFAULT_STATS_INTERVAL_SECS;
+  dlna_src->seek_debounce = DEFAULT_SEEK_DEBOUNCE_MS;
+  dlna_src->seek_thread = NULL;
+  g_mutex_init (&dlna_src->seek_mutex);
+  g_cond_init (&dlna_src->seek_cond);
+  dlna_src->seek_executing = FALSE;
+  dlna_src->seek_owner = NULL;
+  dlna_src->seek_executing_seqnum = 0;
+  dlna_src->seek_latest_seqnum = 0;
+  dlna_src->seek_pending = NULL;
+  dlna_src->seek_pending_pad = NULL;
+  dlna_src->seek_last_time = 0;
+  g_mutex_init (&dlna_src->stats_mutex);
+  memset (dlna_src->stats_latency, 0, sizeof (dlna_src->stats_latency));
+  dlna_src->stats_bytes_delivered = 0;
+  dlna_src->stats_bytes_dropped = 0;
+  dlna_src->stats_mark = DLNA_SRC_LATENCY_CNT;
+  dlna_src->stats_mark_time = 0;
+  dlna_src->stats_source = NULL;
+  memset (dlna_src->trace_ring, 0, sizeof (dlna_src->trace_ring));
+  dlna_src->trace_next = 0;
+  dlna_src->server_key = NULL;
+  dlna_src->caps_cache_ttl = DEFAULT_CAPS_CACHE_TTL_SECS;
+  dlna_src->seek_index = g_array_new (FALSE, FALSE,
+      sizeof (dlna_src_seek_point));
+  g_mutex_init (&dlna_src->seek_index_mutex);
 
   dlna_src->server_info = NULL;
 
   dlna_src->rate = 1.0;
   dlna_src->requested_rate = 1.0;
+  memset (&dlna_src->trick_plan, 0, sizeof (dlna_src->trick_plan));
+  dlna_src->trick_plan.mode = DLNA_SRC_TRICK_NONE;
+  dlna_src->trick_plan.server_rate = 1.0;
+  dlna_src->trick_plan.client_factor = 1.0;
   dlna_src->requested_format = GST_FORMAT_BYTES;
   dlna_src->requested_start = 0;
   dlna_src->requested_stop = -1;
@@ -561,14 +1478,76 @@ gst_dlna_src_init (GstDlnaSrc * dlna_src)
   dlna_src->start_pts = MAX_PTS_45KHZ;
   dlna_src->end_pts = MAX_PTS_45KHZ;
 
+  dlna_src->boundary_source = NULL;
+  g_cond_init(&dlna_src->boundary_cond);
+  g_mutex_init(&dlna_src->boundary_mutex);
+  dlna_src->boundary_stopped = TRUE;
   dlna_src->boundary_thread = NULL;
-  g_cond_init(&dlna_src->boundary_thread_cond);
-
-  dlna_src->kill_boundary_thread = FALSE;
-  g_mutex_init(&dlna_src->boundary_thread_mutex);
+  dlna_src->boundary_report_pending = FALSE;
+  dlna_src->boundary_base_time = 0;
+  dlna_src->boundary_base_start_pts = MAX_PTS_45KHZ;
+  dlna_src->boundary_base_end_pts = MAX_PTS_45KHZ;
+  dlna_src->boundary_resync = FALSE;
   g_mutex_init(&dlna_src->parse_msg_mutex);
+  g_mutex_init (&dlna_src->range_mutex);
+  dlna_src->range = NULL;
+  dlna_src_range_publish (dlna_src);
+
+  dlna_src->prefetch_duration = DEFAULT_PREFETCH_DURATION_MS;
+  g_mutex_init (&dlna_src->prefetch_mutex);
+  g_cond_init (&dlna_src->prefetch_cond);
+  dlna_src->prefetch_source = NULL;
+  dlna_src->prefetch_stopped = TRUE;
+  dlna_src->prefetch_msg = NULL;
+  dlna_src->prefetch_session = NULL;
+  dlna_src->prefetch_aim_start = 0;
+  dlna_src->prefetch_aim_end = 0;
+  dlna_src->prefetch_base_time = 0;
+  dlna_src->prefetch_base_npt = 0;
+  dlna_src->prefetch_rate = 1.0;
+  dlna_src->prefetch_data = NULL;
+  dlna_src->prefetch_offset = 0;
+
+  dlna_src->splice_thread = NULL;
+  g_mutex_init (&dlna_src->splice_mutex);
+  g_cond_init (&dlna_src->splice_cond);
+  dlna_src->splice_pending = FALSE;
+  dlna_src->splice_pushing = FALSE;
+  dlna_src->splice_seeking = FALSE;
+  dlna_src->splice_data = NULL;
+  dlna_src->splice_data_offset = 0;
+  dlna_src->splice_offset = 0;
+  dlna_src->splice_seqnum = 0;
+
+  dlna_src->cache_size = DEFAULT_CACHE_SIZE;
+  g_mutex_init (&dlna_src->cache_mutex);
+  dlna_src->cache_data = NULL;
+  dlna_src->cache_head = 0;
+  dlna_src->cache_fill = 0;
+  dlna_src->cache_end = 0;
+  dlna_src->cache_next = 0;
+
+  dlna_src->parallel_connections = DEFAULT_CONNECTIONS;
+  dlna_src->parallel_session = NULL;
+  dlna_src->preview_session = NULL;
+  dlna_src->preview_msgs = NULL;
+  g_mutex_init (&dlna_src->parallel_mutex);
+  g_cond_init (&dlna_src->parallel_cond);
+  dlna_src->parallel_src = NULL;
+  dlna_src->parallel_generation = 0;
+  dlna_src->parallel_active = FALSE;
+  dlna_src->parallel_stopping = TRUE;
+  dlna_src->parallel_flushing = FALSE;
+  dlna_src->parallel_failed = FALSE;
+  dlna_src->parallel_seqnum = 0;
+  dlna_src->parallel_offset = 0;
+  dlna_src->parallel_chunks = NULL;
+  dlna_src->parallel_n_chunks = 0;
+  dlna_src->parallel_next_fetch = 0;
+  dlna_src->parallel_next_push = 0;
+  dlna_src->parallel_in_flight = 0;
+  dlna_src->parallel_msgs = NULL;
 
-  dlna_src->last_tsb_slide = 0;
 
   /* TODO - remove getting the max_tsb_duration from the env var
    * when the max_tsb_duration is part of the URL
@@ -600,6 +1579,40 @@ gst_dlna_src_init (GstDlnaSrc * dlna_src)
            MAX_TSB_DURATION);
   }
 
+  /* The uri is usually assigned by the URI handler before any property can be
+   * set, so allow the probing mode to be selected from the environment too */
+  dlna_src->pipelined_head = DEFAULT_PIPELINED_HEAD;
+  pipelined_head_env_val = getenv("DLNA_PIPELINED_HEAD");
+  if(NULL != pipelined_head_env_val)
+  {
+     dlna_src->pipelined_head = (0 != strtoul(pipelined_head_env_val, NULL, 10));
+     GST_INFO_OBJECT(dlna_src, "DLNA_PIPELINED_HEAD env value: %d",
+           dlna_src->pipelined_head);
+  }
+
+  dlna_src->fast_start = DEFAULT_FAST_START;
+  dlna_src->tune_pending = FALSE;
+  fast_start_env_val = getenv("DLNA_FAST_START");
+  if(NULL != fast_start_env_val)
+  {
+#if GST_CHECK_VERSION(1,0,0)
+     dlna_src->fast_start = (0 != strtoul(fast_start_env_val, NULL, 10));
+     GST_INFO_OBJECT(dlna_src, "DLNA_FAST_START env value: %d",
+           dlna_src->fast_start);
+#else
+     /* Inserting dtcpip while streaming needs GStreamer 1.0 */
+     GST_WARNING_OBJECT(dlna_src, "DLNA_FAST_START ignored with GStreamer 0.10");
+#endif
+  }
+
+  caps_cache_file_env_val = getenv("DLNA_CAPS_CACHE_FILE");
+  if(NULL != caps_cache_file_env_val)
+  {
+     GST_INFO_OBJECT(dlna_src, "DLNA_CAPS_CACHE_FILE env value: %s",
+           caps_cache_file_env_val);
+     dlna_src_caps_cache_set_file (caps_cache_file_env_val);
+  }
+
   GST_LOG_OBJECT (dlna_src, "Initialization complete");
 }
 
@@ -615,7 +1628,19 @@ gst_dlna_src_finalize (GObject * object)
 
   GST_INFO_OBJECT (dlna_src, " Disposing the dlna src");
 
+  dlna_src_seek_thread_stop (dlna_src);
+  dlna_src_boundary_thread_stop (dlna_src);
+  if (!dlna_src->prefetch_stopped)
+    dlna_src_prefetch_stop (dlna_src);
+  dlna_src_parallel_stop (dlna_src);
+  dlna_src_splice_join (dlna_src);
   dlna_src_soup_session_close (dlna_src);
+  g_mutex_clear (&dlna_src->head_mutex);
+  g_cond_clear (&dlna_src->head_cond);
+  g_hash_table_destroy (dlna_src->head_flights);
+  g_mutex_clear (&dlna_src->stats_mutex);
+  g_mutex_clear (&dlna_src->seek_mutex);
+  g_cond_clear (&dlna_src->seek_cond);
 
   g_free (dlna_src->npt_start_str);
   dlna_src->npt_start_str = NULL;
@@ -633,6 +1658,25 @@ gst_dlna_src_finalize (GObject * object)
   dlna_src->dlna_uri = NULL;
   g_free (dlna_src->http_uri);
   dlna_src->http_uri = NULL;
+  g_free (dlna_src->server_key);
+  dlna_src->server_key = NULL;
+  g_array_free (dlna_src->seek_index, TRUE);
+  g_mutex_clear (&dlna_src->seek_index_mutex);
+  g_mutex_clear (&dlna_src->boundary_mutex);
+  g_cond_clear (&dlna_src->boundary_cond);
+  dlna_src_prefetch_clear (dlna_src);
+  g_mutex_clear (&dlna_src->prefetch_mutex);
+  g_cond_clear (&dlna_src->prefetch_cond);
+  g_mutex_clear (&dlna_src->splice_mutex);
+  g_cond_clear (&dlna_src->splice_cond);
+  dlna_src_cache_clear (dlna_src);
+  g_mutex_clear (&dlna_src->cache_mutex);
+  dlna_src_parallel_clear (dlna_src);
+  g_mutex_clear (&dlna_src->parallel_mutex);
+  dlna_src_range_unref (dlna_src->range);
+  dlna_src->range = NULL;
+  g_mutex_clear (&dlna_src->range_mutex);
+  g_cond_clear (&dlna_src->parallel_cond);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -662,6 +1706,7 @@ gst_dlna_src_set_property (GObject * object, guint prop_id,
 #else
       if (!dlna_src_uri_assign (dlna_src, g_value_get_string (value))) {
 #endif
+        dlna_src_trace_dump (dlna_src, "Unable to set URI");
         GST_ELEMENT_ERROR (dlna_src, RESOURCE, READ,
             ("%s() - unable to set URI: %s",
                 __FUNCTION__, g_value_get_string (value)), NULL);
@@ -673,6 +1718,89 @@ gst_dlna_src_set_property (GObject * object, guint prop_id,
       GST_INFO_OBJECT (dlna_src, "Set DTCP blocksize: %d",
           dlna_src->dtcp_blocksize);
       break;
+    case PROP_PIPELINED_HEAD:
+      dlna_src->pipelined_head = g_value_get_boolean (value);
+      GST_INFO_OBJECT (dlna_src, "Set pipelined HEAD: %d",
+          dlna_src->pipelined_head);
+      break;
+    case PROP_FAST_START:
+#if GST_CHECK_VERSION(1,0,0)
+      dlna_src->fast_start = g_value_get_boolean (value);
+      GST_INFO_OBJECT (dlna_src, "Set fast start: %d", dlna_src->fast_start);
+#else
+      /* Inserting dtcpip while streaming needs GStreamer 1.0 */
+      if (g_value_get_boolean (value))
+        GST_WARNING_OBJECT (dlna_src, "Fast start ignored with GStreamer 0.10");
+#endif
+      break;
+    case PROP_MAX_CONNS_PER_HOST:
+      G_LOCK (session_pool);
+      session_max_conns_per_host = g_value_get_uint (value);
+      G_UNLOCK (session_pool);
+      dlna_src_session_pool_configure (dlna_src);
+      break;
+    case PROP_IDLE_TIMEOUT:
+      G_LOCK (session_pool);
+      session_idle_timeout = g_value_get_uint (value);
+      G_UNLOCK (session_pool);
+      dlna_src_session_pool_configure (dlna_src);
+      break;
+    case PROP_CAPS_CACHE_TTL:
+      dlna_src->caps_cache_ttl = g_value_get_uint (value);
+      GST_INFO_OBJECT (dlna_src, "Set caps cache TTL: %u",
+          dlna_src->caps_cache_ttl);
+      break;
+    case PROP_HEAD_FRESHNESS:
+      dlna_src->head_freshness = g_value_get_uint (value);
+      GST_INFO_OBJECT (dlna_src, "Set HEAD freshness: %u ms",
+          dlna_src->head_freshness);
+      break;
+    case PROP_MAX_STALENESS:
+      dlna_src->max_staleness = g_value_get_uint (value);
+      GST_INFO_OBJECT (dlna_src, "Set max staleness: %u ms",
+          dlna_src->max_staleness);
+      break;
+    case PROP_STATS_INTERVAL:
+      dlna_src->stats_interval = g_value_get_uint (value);
+      GST_INFO_OBJECT (dlna_src, "Set stats interval: %u secs",
+          dlna_src->stats_interval);
+      break;
+    case PROP_SEEK_DEBOUNCE:
+      g_mutex_lock (&dlna_src->seek_mutex);
+      dlna_src->seek_debounce = g_value_get_uint (value);
+      g_mutex_unlock (&dlna_src->seek_mutex);
+      GST_INFO_OBJECT (dlna_src, "Set seek debounce: %u ms",
+          dlna_src->seek_debounce);
+      break;
+    case PROP_CAPS_CACHE_FILE:
+      dlna_src_caps_cache_set_file (g_value_get_string (value));
+      GST_INFO_OBJECT (dlna_src, "Set caps cache file: %s",
+          g_value_get_string (value));
+      break;
+    case PROP_BLOCK_DURATION:
+      dlna_src->block_duration = g_value_get_uint (value);
+      GST_INFO_OBJECT (dlna_src, "Set block duration: %u ms",
+          dlna_src->block_duration);
+      dlna_src_blocksize_update (dlna_src);
+      break;
+    case PROP_PREFETCH_DURATION:
+      dlna_src->prefetch_duration = g_value_get_uint (value);
+      GST_INFO_OBJECT (dlna_src, "Set prefetch duration: %u ms",
+          dlna_src->prefetch_duration);
+      break;
+    case PROP_CACHE_SIZE:
+      g_mutex_lock (&dlna_src->cache_mutex);
+      dlna_src->cache_size = g_value_get_uint (value);
+      g_mutex_unlock (&dlna_src->cache_mutex);
+      dlna_src_cache_clear (dlna_src);
+      GST_INFO_OBJECT (dlna_src, "Set cache size: %u bytes",
+          dlna_src->cache_size);
+      break;
+    case PROP_CONNECTIONS:
+      dlna_src->parallel_connections = g_value_get_uint (value);
+      GST_INFO_OBJECT (dlna_src, "Set connections: %u",
+          dlna_src->parallel_connections);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -698,6 +1826,7 @@ gst_dlna_src_get_property (GObject * object, guint prop_id, GValue * value,
   gfloat rate = 0;
   int psCnt = 0;
   guint32 tsb_slide = 0;
+  GstDlnaSrcRange *range = NULL;
 
   switch (prop_id) {
 
@@ -712,13 +1841,12 @@ gst_dlna_src_get_property (GObject * object, guint prop_id, GValue * value,
 
     case PROP_SUPPORTED_RATES:
       GST_LOG_OBJECT (dlna_src, "Getting property: supported rates");
-      if ((dlna_src->server_info != NULL) &&
-          (dlna_src->server_info->content_features != NULL) &&
-          (dlna_src->server_info->content_features->playspeeds_cnt > 0)) {
-        psCnt = dlna_src->server_info->content_features->playspeeds_cnt;
+      range = dlna_src_range_get (dlna_src);
+      if (range->playspeeds_cnt > 0) {
+        psCnt = range->playspeeds_cnt;
         garray = g_array_sized_new (TRUE, TRUE, sizeof (gfloat), psCnt);
         for (i = 0; i < psCnt; i++) {
-          rate = dlna_src->server_info->content_features->playspeeds[i];
+          rate = range->playspeeds[i];
           g_array_append_val (garray, rate);
           GST_LOG_OBJECT (dlna_src, "Rate %d: %f", (i + 1),
               g_array_index (garray, gfloat, i));
@@ -728,6 +1856,7 @@ gst_dlna_src_get_property (GObject * object, guint prop_id, GValue * value,
         g_value_init (value, G_TYPE_ARRAY);
         g_value_take_boxed (value, garray);
       }
+      dlna_src_range_unref (range);
       break;
 
     case PROP_DTCP_BLOCKSIZE:
@@ -743,2040 +1872,7123 @@ gst_dlna_src_get_property (GObject * object, guint prop_id, GValue * value,
       break;
 
     case PROP_TSB_SLIDE:
-      GST_INFO_OBJECT(dlna_src, "tune_start_pts: 0x%x", dlna_src->tune_start_pts);
-      GST_INFO_OBJECT(dlna_src, "start_pts: 0x%x", dlna_src->start_pts);
-      if(MAX_PTS_45KHZ != dlna_src->tune_start_pts)
-      {
-         if(dlna_src->start_pts >= dlna_src->tune_start_pts)
-         {
-            tsb_slide = (dlna_src->start_pts - dlna_src->tune_start_pts) / 45000;
-            dlna_src->last_tsb_slide = tsb_slide;
-         }
-         else if((dlna_src->tune_start_pts - dlna_src->start_pts) > (MAX_PTS_45KHZ / 2))
-         {
-            tsb_slide = (dlna_src->start_pts + (MAX_PTS_45KHZ - dlna_src->tune_start_pts)) / 45000;
-            dlna_src->last_tsb_slide = tsb_slide;
-         }
-         else
-         {
-            GST_ERROR_OBJECT(dlna_src, "Invalid TSB current start PTS: 0x%lx > tune tsb start pts: 0x%lx\n",
-                  dlna_src->start_pts, dlna_src->tune_start_pts);
-            GST_WARNING_OBJECT(dlna_src, "Returning old TSBSlide value\n");
-            tsb_slide = dlna_src->last_tsb_slide;
-         }
-      }
-      else
-      {
-         tsb_slide = 0;
-      }
+      range = dlna_src_range_get (dlna_src);
+      GST_INFO_OBJECT(dlna_src, "tune_start_pts: 0x%x", range->tune_start_pts);
+      GST_INFO_OBJECT(dlna_src, "start_pts: 0x%x", range->start_pts);
+      tsb_slide = range->tsb_slide;
+      dlna_src_range_unref (range);
       g_value_set_uint (value, tsb_slide);
       break;
 
-    default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
-  }
-}
+    case PROP_PIPELINED_HEAD:
+      g_value_set_boolean (value, dlna_src->pipelined_head);
+      break;
 
-static gpointer gst_dlna_src_update_boundary_thread(gpointer data)
-{
-   GstDlnaSrc    *dlna_src = (GstDlnaSrc *)data;
-   gint64        end_time = 0;
-   GstQuery      *query = NULL;
-   GstStructure  *structure = NULL;
-   const GValue  *val = NULL;
-   gpointer      *ptr = NULL;
-   gboolean      rc;
-   guint32       current_pts_45khz = 0;
-   guint32       pts_45khz_diff = 0;
-   guint32       tsb_start_pts = 0;
-   GstPad        *peer_pad = NULL;
-   
-   gchar *live_content_head_request_headers[][2] =
-   { {HEADER_GET_AVAILABLE_SEEK_RANGE_TITLE,
-        HEADER_GET_AVAILABLE_SEEK_RANGE_VALUE}
-   };
-   gsize live_content_head_request_headers_size = 1;
-      
-   GST_WARNING_OBJECT(dlna_src, "boundary_thread created");
-      
-   if(NULL == dlna_src)
-   {
-      GST_ERROR_OBJECT(dlna_src, "invalid data parameter");
-      GST_INFO_OBJECT(dlna_src, "boundary_thread exiting due to error");
-      return NULL;
-   }
+    case PROP_FAST_START:
+      g_value_set_boolean (value, dlna_src->fast_start);
+      break;
 
-   /* Reason for using kill_boundary_thread var.
-    * As with g_cond_wait() it is possible that a spurious or stolen wakeup could occur. 
-    * For that reason, waiting on a condition variable should always be in a loop, based on an explicitly-checked predicate.
-    */
-   while(TRUE != dlna_src->kill_boundary_thread) 
-   {
-      tsb_start_pts = dlna_src->start_pts;
+    case PROP_MAX_CONNS_PER_HOST:
+      G_LOCK (session_pool);
+      g_value_set_uint (value, session_max_conns_per_host);
+      G_UNLOCK (session_pool);
+      break;
 
-      if (!dlna_src_soup_issue_head (dlna_src,
-               live_content_head_request_headers_size,
-               live_content_head_request_headers, dlna_src->server_info,
-               TRUE)) 
-      {
-         GST_ERROR_OBJECT (dlna_src,
-               "Problems issuing HEAD request to get live/recInProgress content information");
-      }
-    
-      if(TRUE != dlna_src_send_tsb_boundary_event(dlna_src))
-      {
-         GST_WARNING_OBJECT(dlna_src, "Failed to send tsb_boundary event downstream");
-      }
+    case PROP_IDLE_TIMEOUT:
+      G_LOCK (session_pool);
+      g_value_set_uint (value, session_idle_timeout);
+      G_UNLOCK (session_pool);
+      break;
 
-      if(GST_STATE_PAUSED == GST_STATE(dlna_src))
-      {
-         do
-         {
-            structure = gst_structure_new("get_current_pts", "current_pts", G_TYPE_UINT, 0, NULL);
+    case PROP_CAPS_CACHE_TTL:
+      g_value_set_uint (value, dlna_src->caps_cache_ttl);
+      break;
+    case PROP_HEAD_FRESHNESS:
+      g_value_set_uint (value, dlna_src->head_freshness);
+      break;
+    case PROP_MAX_STALENESS:
+      g_value_set_uint (value, dlna_src->max_staleness);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, dlna_src_stats_to_structure (dlna_src));
+      break;
+    case PROP_STATS_INTERVAL:
+      g_value_set_uint (value, dlna_src->stats_interval);
+      break;
+    case PROP_TRACE:
+      g_value_take_string (value, dlna_src_trace_to_string (dlna_src));
+      break;
+    case PROP_SEEK_DEBOUNCE:
+      g_value_set_uint (value, dlna_src->seek_debounce);
+      break;
 
-#if GST_CHECK_VERSION(1,0,0)
-            query = gst_query_new_custom(GST_QUERY_CUSTOM, structure);
-#else
-            query = gst_query_new_application(GST_QUERY_CUSTOM, structure);
-#endif
-            if(NULL == query)
-            {
-               GST_ERROR_OBJECT(dlna_src, "Unable to create get_current_pts query");
-               gst_structure_free(structure);
-               structure = NULL;
-               break;
-            }
-           
-            peer_pad = gst_pad_get_peer(dlna_src->src_pad);
-            if(NULL == peer_pad)
-            {
-               GST_ERROR_OBJECT(dlna_src, "Unable to get peer_pad");
-               break;
-            }
+    case PROP_CAPS_CACHE_FILE:
+      G_LOCK (caps_cache);
+      g_value_set_string (value, caps_cache_file);
+      G_UNLOCK (caps_cache);
+      break;
 
-            rc = gst_pad_query(peer_pad, query);
-            if (!rc)
-            {
-               GST_ERROR_OBJECT(dlna_src, "could not get pts");
-               break;
-            }
+    case PROP_BLOCK_DURATION:
+      g_value_set_uint (value, dlna_src->block_duration);
+      break;
 
-            structure = (GstStructure *)gst_query_get_structure(query);
-            val = gst_structure_get_value(structure, "current_pts");
-            if (val == NULL)
-            {
-               GST_ERROR_OBJECT(dlna_src, "could not get pts query structure");
-               break;
-            }    
+    case PROP_PREFETCH_DURATION:
+      g_value_set_uint (value, dlna_src->prefetch_duration);
+      break;
 
-            ptr = g_value_get_pointer(val);
-            if(NULL == ptr)
-            {
-               GST_ERROR_OBJECT(dlna_src, "pts ptr is NULL\n");
-               break;
-            }
+    case PROP_CACHE_SIZE:
+      g_value_set_uint (value, dlna_src->cache_size);
+      break;
 
-            memcpy((gchar *)&current_pts_45khz, (gchar *)&ptr, sizeof(current_pts_45khz));
+    case PROP_CONNECTIONS:
+      g_value_set_uint (value, dlna_src->parallel_connections);
+      break;
 
-            if(MAX_PTS_45KHZ == current_pts_45khz)
-            {
-               GST_ERROR_OBJECT(dlna_src, "Invalid current PTS\n");
-               break;
-            }
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+  }
+}
 
-            GST_DEBUG_OBJECT(dlna_src, "Current 45khz based PTS %u, tsb_start_pts = %u\n", 
-                             current_pts_45khz, dlna_src->start_pts);
-            
-            /* Handle PTS Rollover */
-            if(dlna_src->start_pts > current_pts_45khz)
-            {
-               /* If the PTS difference is greater than .5 the entire PTS range, assume a roll over */
-               if((dlna_src->start_pts - current_pts_45khz) > (MAX_PTS_45KHZ / 2))
-               {
-                  pts_45khz_diff = current_pts_45khz + (MAX_PTS_45KHZ - dlna_src->start_pts);
-               }
-               else if(((dlna_src->start_pts - current_pts_45khz) / 45000) <= (2 * BOUNDARY_THREAD_SLEEP_SECS))
-               {
-                  GST_WARNING_OBJECT(dlna_src, "tsb_start_pts > current_pts - Did we miss the TSB slide start?");
-                  pts_45khz_diff = dlna_src->start_pts - current_pts_45khz;
-               }
-               else
-               {
-                  GST_WARNING_OBJECT(dlna_src, "(startPTS > currentPTS) and " 
-                        "(startPTS - currentPTS) < MAX_PTS_45KHZ / 2) and "
-                        "(StartPTS - currentPTS > (2 * BOUNDARY_THREAD_SLEEP_SECS)");
-                  break;
-               }
-            }
-            else
-            {
-               pts_45khz_diff = current_pts_45khz - dlna_src->start_pts;
-            }
-            
-            GST_DEBUG_OBJECT(dlna_src, "current_pts_45khz - tsb_start_pts_45khz / 45000 =  %u\n", 
-                             pts_45khz_diff / 45000);
-            
-            if(((pts_45khz_diff / 45000) + dlna_src->max_tsb_duration - (dlna_src->npt_duration_nanos / GST_SECOND)) 
-               <= MIN_BUF_SECS_TSB_START_TO_PLAY_POS)
-            {
-               GST_WARNING_OBJECT(dlna_src, "TSB start near play/pause pos");
-               gst_element_post_message(GST_ELEMENT_CAST(dlna_src),
-                     gst_message_new_element(GST_OBJECT_CAST(dlna_src),
-                        gst_structure_new("extended_notification",
-                           "notification", G_TYPE_STRING, "tsb_start_near_pause_position",
-                           NULL)));
-            }
-         }while(0);
+/**
+ * Ask downstream for the PTS currently being presented, answered by the
+ * sink through a "get_current_pts" custom query.
+ *
+ * @param dlna_src              this element
+ * @param current_pts_45khz     returns current 45khz based PTS
+ *
+ * @return  TRUE if current PTS was returned, FALSE otherwise
+ */
+static gboolean dlna_src_query_current_pts(GstDlnaSrc *dlna_src, guint32 *current_pts_45khz)
+{
+   GstQuery      *query = NULL;
+   GstStructure  *structure = NULL;
+   const GValue  *val = NULL;
+   gpointer      *ptr = NULL;
+   GstPad        *peer_pad = NULL;
+   gboolean      ret = FALSE;
 
-         if(NULL != peer_pad)
-         {
-            gst_object_unref(peer_pad);
-            peer_pad = NULL;
-         }
+   do
+   {
+      structure = gst_structure_new("get_current_pts", "current_pts", G_TYPE_UINT, 0, NULL);
 
-         if(NULL != query)
-         {
-            gst_query_unref(query);
-            query = NULL;
-         }
+#if GST_CHECK_VERSION(1,0,0)
+      query = gst_query_new_custom(GST_QUERY_CUSTOM, structure);
+#else
+      query = gst_query_new_application(GST_QUERY_CUSTOM, structure);
+#endif
+      if(NULL == query)
+      {
+         GST_ERROR_OBJECT(dlna_src, "Unable to create get_current_pts query");
+         gst_structure_free(structure);
+         structure = NULL;
+         break;
       }
 
-      g_mutex_lock(&dlna_src->boundary_thread_mutex);
-      
-      end_time = g_get_monotonic_time() + BOUNDARY_THREAD_SLEEP_SECS * G_TIME_SPAN_SECOND;
-
-      if(TRUE == g_cond_wait_until(&dlna_src->boundary_thread_cond, 
-                                   &dlna_src->boundary_thread_mutex,
-                                   end_time))
+      peer_pad = gst_pad_get_peer(dlna_src->src_pad);
+      if(NULL == peer_pad)
       {
-         GST_WARNING_OBJECT(dlna_src, "boundary_thread_cond signalled"); 
+         GST_ERROR_OBJECT(dlna_src, "Unable to get peer_pad");
+         break;
       }
-      
-      g_mutex_unlock(&dlna_src->boundary_thread_mutex);
-   }
-
-   GST_WARNING_OBJECT(dlna_src, "boundary_thread exiting");
-
-   return NULL;
-}
 
-static GstStateChangeReturn
-gst_dlna_src_change_state (GstElement * element, GstStateChange transition)
-{
-  GstStateChangeReturn ret = GST_STATE_CHANGE_SUCCESS;
-  GstDlnaSrc *dlna_src = GST_DLNA_SRC (element);
+      if (!gst_pad_query(peer_pad, query))
+      {
+         GST_ERROR_OBJECT(dlna_src, "could not get pts");
+         break;
+      }
 
-  GST_LOG_OBJECT (dlna_src, "Changing state from %s to %s",
-      gst_element_state_get_name (GST_STATE_TRANSITION_CURRENT (transition)),
-      gst_element_state_get_name (GST_STATE_TRANSITION_NEXT (transition)));
+      structure = (GstStructure *)gst_query_get_structure(query);
+      val = gst_structure_get_value(structure, "current_pts");
+      if (val == NULL)
+      {
+         GST_ERROR_OBJECT(dlna_src, "could not get pts query structure");
+         break;
+      }    
 
-  switch (transition) {
-    case GST_STATE_CHANGE_NULL_TO_READY:
-      break;
-    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      ptr = g_value_get_pointer(val);
+      if(NULL == ptr)
       {
-         if((TRUE == dlna_src->is_live) && (NULL == dlna_src->boundary_thread))
-         {
-            dlna_src->boundary_thread = g_thread_new("boundary_thread",
-                                                     gst_dlna_src_update_boundary_thread, 
-                                                     dlna_src);
-            if(NULL == dlna_src->boundary_thread)
-            {
-               GST_ERROR_OBJECT(dlna_src, "Failed to create boundary_thread");
-               ret = GST_STATE_CHANGE_FAILURE;
-            }
-         }
+         GST_ERROR_OBJECT(dlna_src, "pts ptr is NULL\n");
+         break;
       }
-      break;
-    case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
-      break;
-    default:
-      break;
-  }
 
-  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
-  if (ret == GST_STATE_CHANGE_FAILURE) {
-    GST_ERROR_OBJECT (dlna_src, "Problems with parent class state change");
-    return ret;
-  }
+      memcpy((gchar *)current_pts_45khz, (gchar *)&ptr, sizeof(*current_pts_45khz));
 
-  switch (transition) {
-    case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
-      break;
-    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      if(MAX_PTS_45KHZ == *current_pts_45khz)
       {
-         if(NULL != dlna_src->boundary_thread)
-         {
-            dlna_src->kill_boundary_thread = TRUE;
+         GST_ERROR_OBJECT(dlna_src, "Invalid current PTS\n");
+         break;
+      }
 
-            g_mutex_lock(&dlna_src->boundary_thread_mutex);
-            g_cond_signal(&dlna_src->boundary_thread_cond);
-            g_mutex_unlock(&dlna_src->boundary_thread_mutex);
+      ret = TRUE;
+   }while(0);
 
-            g_thread_join(dlna_src->boundary_thread);
-            dlna_src->boundary_thread = NULL;
-         }
-      }
-      break;
-    case GST_STATE_CHANGE_READY_TO_NULL:
-      break;
-    default:
-      break;
-  }
+   if(NULL != peer_pad)
+   {
+      gst_object_unref(peer_pad);
+      peer_pad = NULL;
+   }
 
-  return ret;
+   if(NULL != query)
+   {
+      gst_query_unref(query);
+      query = NULL;
+   }
+
+   return ret;
 }
 
 /**
- * Processes the supplied event
+ * Seconds left before the start of the TSB slides past the current play
+ * position, from the PTS being presented downstream and the extrapolated
+ * TSB window.  Queries downstream, so must not be called on the HEAD worker.
  *
- * @param pad	    pad where event was received
- * @param parent    parent of pad
- * @param event	    received event
+ * @param dlna_src  this element
+ * @param headroom  returns seconds left
  *
- * @return	true if event was handled, false otherwise
+ * @return  TRUE if headroom could be determined, FALSE otherwise
  */
-#if GST_CHECK_VERSION(1,0,0)
-static gboolean
-gst_dlna_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
-#else
-static gboolean
-gst_dlna_src_event (GstPad * pad, GstEvent * event)
-#endif
+static gboolean dlna_src_get_tsb_headroom(GstDlnaSrc *dlna_src, gint64 *headroom)
 {
-  gboolean ret = FALSE;
-  GstDlnaSrc *dlna_src = GST_DLNA_SRC (gst_pad_get_parent (pad));
+   guint32 current_pts_45khz = 0;
+   guint32 pts_45khz_diff = 0;
+   GstDlnaSrcRange *range = NULL;
+   guint32 start_pts;
+   guint64 npt_start;
+   guint64 npt_end;
+   guint64 npt_duration;
+
+   range = dlna_src_range_get(dlna_src);
+   start_pts = range->start_pts;
+   dlna_src_range_extrapolate(dlna_src, range, &npt_start, &npt_end, &npt_duration);
+   dlna_src_range_unref(range);
+
+   if(MAX_PTS_45KHZ == start_pts)
+   {
+      return FALSE;
+   }
 
-  switch (GST_EVENT_TYPE (event)) {
-    case GST_EVENT_SEEK:
-      GST_INFO_OBJECT (dlna_src, "Got src event: %s",
-          GST_EVENT_TYPE_NAME (event));
-      ret = dlna_src_handle_event_seek (dlna_src, pad, event);
-      break;
+   if(TRUE != dlna_src_query_current_pts(dlna_src, &current_pts_45khz))
+   {
+      return FALSE;
+   }
 
-    case GST_EVENT_FLUSH_START:
-      GST_DEBUG_OBJECT (dlna_src, "Got src event: %s",
-          GST_EVENT_TYPE_NAME (event));
-      break;
+   GST_DEBUG_OBJECT(dlna_src, "Current 45khz based PTS %u, tsb_start_pts = %u\n", 
+                    current_pts_45khz, start_pts);
 
-    case GST_EVENT_FLUSH_STOP:
-      GST_DEBUG_OBJECT (dlna_src, "Got src event: %s",
-          GST_EVENT_TYPE_NAME (event));
-      break;
+   /* Handle PTS Rollover */
+   if(start_pts > current_pts_45khz)
+   {
+      /* If the PTS difference is greater than .5 the entire PTS range, assume a roll over */
+      if((start_pts - current_pts_45khz) > (MAX_PTS_45KHZ / 2))
+      {
+         pts_45khz_diff = current_pts_45khz + (MAX_PTS_45KHZ - start_pts);
+      }
+      else if(((start_pts - current_pts_45khz) / 45000) <= (2 * BOUNDARY_INTERVAL_SECS))
+      {
+         /* Start already slid past the play position */
+         GST_WARNING_OBJECT(dlna_src, "tsb_start_pts > current_pts - Did we miss the TSB slide start?");
+         *headroom = 0;
+         return TRUE;
+      }
+      else
+      {
+         GST_WARNING_OBJECT(dlna_src, "(startPTS > currentPTS) and " 
+               "(startPTS - currentPTS) < MAX_PTS_45KHZ / 2) and "
+               "(StartPTS - currentPTS > (2 * BOUNDARY_INTERVAL_SECS)");
+         return FALSE;
+      }
+   }
+   else
+   {
+      pts_45khz_diff = current_pts_45khz - start_pts;
+   }
 
-    case GST_EVENT_QOS:
-    case GST_EVENT_LATENCY:
-    case GST_EVENT_NAVIGATION:
-#if GST_CHECK_VERSION(1,0,0)
-    case GST_EVENT_RECONFIGURE:
-#endif
-      /* Just call default handler to handle */
-      break;     
+   GST_DEBUG_OBJECT(dlna_src, "current_pts_45khz - tsb_start_pts_45khz / 45000 =  %u\n", 
+                    pts_45khz_diff / 45000);
 
-    default:
-      GST_DEBUG_OBJECT (dlna_src, "Unsupported event: %s",
-          GST_EVENT_TYPE_NAME (event));
-      break;
-  }
+   *headroom = (gint64)(pts_45khz_diff / 45000) + (gint64)dlna_src->max_tsb_duration -
+      (gint64)(npt_duration / GST_SECOND);
 
-  if((!ret) && (TRUE != dlna_src->forward_event))
-  {
-     dlna_src->forward_event = TRUE;
-  }
+   return TRUE;
+}
+
+/**
+ * Index of the histogram bucket counting a latency.
+ *
+ * @param usecs latency in microseconds
+ *
+ * @return  bucket index
+ */
+static guint
+dlna_src_histogram_index (guint64 usecs)
+{
+  guint msb;
+
+  if (usecs >= (G_GUINT64_CONSTANT (1) << LATENCY_MAX_BITS))
+    usecs = (G_GUINT64_CONSTANT (1) << LATENCY_MAX_BITS) - 1;
+  if (usecs < LATENCY_SUB_BUCKETS)
+    return (guint) usecs;
+
+  if (usecs >> 32)
+    msb = 32 + g_bit_storage ((gulong) (usecs >> 32)) - 1;
   else
-  {
-     /* If not handled, pass on to default pad handler */
-     if (!ret) {
-#if GST_CHECK_VERSION(1,0,0)
-        ret = gst_pad_event_default (pad, parent, event);
-#else    
-        ret = gst_pad_event_default (pad, event);
-#endif
-     }
-  }
+    msb = g_bit_storage ((gulong) usecs) - 1;
 
-  gst_object_unref (dlna_src);
+  return (msb - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS +
+      (guint) ((usecs >> (msb - LATENCY_SUB_BUCKET_BITS)) -
+      LATENCY_SUB_BUCKETS);
+}
 
-  return ret;
+/**
+ * Smallest latency counted in a histogram bucket.
+ *
+ * @param index bucket index, may be one past the last bucket
+ *
+ * @return  latency in microseconds
+ */
+static guint64
+dlna_src_histogram_lower (guint index)
+{
+  if (index < LATENCY_SUB_BUCKETS)
+    return index;
+
+  return ((guint64) (LATENCY_SUB_BUCKETS + index % LATENCY_SUB_BUCKETS)) <<
+      (index / LATENCY_SUB_BUCKETS - 1);
 }
 
 /**
- * Handles queries on the pad
+ * Latency below which the given fraction of the recorded latencies fall,
+ * accurate to the width of the bucket it falls in.
  *
- * @param pad       pad where query was received
- * @param parent    parent of pad
- * @param event     received query
+ * @param histogram histogram to look in, stats_mutex held
+ * @param fraction  fraction of recorded latencies, 0 < fraction <= 1
  *
- * @return true if query could be performed, false otherwise
+ * @return  latency in microseconds, 0 if nothing was recorded
  */
-#if GST_CHECK_VERSION(1,0,0)
-static gboolean
-gst_dlna_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
-#else
-static gboolean
-gst_dlna_src_query (GstPad * pad, GstQuery * query)
-#endif
+static guint64
+dlna_src_histogram_percentile (const GstDlnaSrcHistogram * histogram,
+    gdouble fraction)
 {
-  gboolean ret = FALSE;
-  GstDlnaSrc *dlna_src = GST_DLNA_SRC (gst_pad_get_parent (pad));
+  guint64 target;
+  guint64 seen = 0;
+  guint64 usecs;
+  guint i;
 
-  GST_LOG_OBJECT (dlna_src, "Got src query: %s", GST_QUERY_TYPE_NAME (query));
+  if (!histogram->count)
+    return 0;
 
-  switch (GST_QUERY_TYPE (query)) {
-    case GST_QUERY_DURATION:
-      ret = dlna_src_handle_query_duration (dlna_src, query);
-      break;
+  target = (guint64) (fraction * histogram->count + 0.5);
+  if (target < 1)
+    target = 1;
 
-    case GST_QUERY_SEEKING:
-      ret = dlna_src_handle_query_seeking (dlna_src, query);
+  for (i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+    seen += histogram->buckets[i];
+    if (seen >= target)
       break;
+  }
 
-    case GST_QUERY_SEGMENT:
-      ret = dlna_src_handle_query_segment (dlna_src, query);
-      break;
+  usecs = dlna_src_histogram_lower (i + 1) - 1;
+  return CLAMP (usecs, histogram->min, histogram->max);
+}
 
-    case GST_QUERY_CONVERT:
-      ret = dlna_src_handle_query_convert (dlna_src, query);
-      break;
-
-    case GST_QUERY_URI:
-      GST_INFO_OBJECT (dlna_src, "query uri");
-      gst_query_set_uri (query, dlna_src->dlna_uri);
-      ret = TRUE;
-      break;
-
-    case GST_QUERY_FORMATS:
-      GST_INFO_OBJECT (dlna_src, "format query");
-      gst_query_set_formats (query, 2, GST_FORMAT_BYTES, GST_FORMAT_TIME);
-      ret = TRUE;
-      break;
-
-    case GST_QUERY_LATENCY:
-      /* Don't know latency, let some other element handle this */
-      break;
-
-    case GST_QUERY_POSITION:
-      /* Don't know current position in stream, let some other element handle this */
-      break;
-      
-    case GST_QUERY_CUSTOM:
-    {
-       ret = FALSE;
-       GST_DEBUG_OBJECT(dlna_src, "Custom query");
-       GstStructure *pStruct = (GstStructure *)gst_query_get_structure(query);
-       if(gst_structure_has_name(pStruct, "getTrickSpeeds"))
-       {
-          GST_DEBUG_OBJECT(dlna_src, "getTrickSpeeds query");
-          int ii = 0;
-
-          if((NULL == dlna_src) || (NULL == dlna_src->server_info) || (NULL == dlna_src->server_info->content_features))
-          {
-             GST_WARNING_OBJECT(dlna_src, "Invalid ptr to playspeeds");
-             break;
-          }
+/**
+ * Record the latency of an operation in its histogram.
+ *
+ * @param dlna_src  this element
+ * @param latency   operation
+ * @param usecs     how long it took in microseconds
+ */
+static void
+dlna_src_stats_record (GstDlnaSrc * dlna_src, GstDlnaSrcLatency latency,
+    gint64 usecs)
+{
+  GstDlnaSrcHistogram *histogram = &dlna_src->stats_latency[latency];
+  guint64 value = (usecs > 0) ? (guint64) usecs : 0;
+
+  g_mutex_lock (&dlna_src->stats_mutex);
+  if (!histogram->count || value < histogram->min)
+    histogram->min = value;
+  if (value > histogram->max)
+    histogram->max = value;
+  histogram->count++;
+  histogram->sum += value;
+  histogram->buckets[dlna_src_histogram_index (value)]++;
+  g_mutex_unlock (&dlna_src->stats_mutex);
+}
 
-          if(dlna_src->server_info->content_features->playspeeds_cnt <= 0)
-          {
-             GST_WARNING_OBJECT(dlna_src, "playspeeds count is <=0");
-             break;
-          }
-          
-          GString *speeds = g_string_sized_new(256);
-          if(NULL == speeds)
-          {
-             GST_WARNING_OBJECT(dlna_src, "Failed to alloc trickspeeds str");
-             break;
-          }
-          
-          GST_DEBUG_OBJECT(dlna_src, "playspeed count = %u\n", 
-                           dlna_src->server_info->content_features->playspeeds_cnt);
-         
-          if(dlna_src->server_info->content_features->playspeeds_cnt > 0)
-          {
-             for (ii = 0; ii < (gint)(dlna_src->server_info->content_features->playspeeds_cnt - 1); ii++) 
-             {
-                g_string_append_printf(speeds, "%.2f,", dlna_src->server_info->content_features->playspeeds[ii]);
-                GST_LOG_OBJECT(dlna_src, "playspeed[%d] = %f", ii, 
-                      dlna_src->server_info->content_features->playspeeds[ii]);
-             }
-             g_string_append_printf(speeds, "%.2f", dlna_src->server_info->content_features->playspeeds[ii]);
-          }
+/**
+ * Note a seek or rate change was requested, its latency is recorded once
+ * the first buffer after it leaves the bin.
+ *
+ * @param dlna_src  this element
+ * @param latency   DLNA_SRC_LATENCY_SEEK or DLNA_SRC_LATENCY_RATE_CHANGE
+ */
+static void
+dlna_src_stats_mark (GstDlnaSrc * dlna_src, GstDlnaSrcLatency latency)
+{
+  g_mutex_lock (&dlna_src->stats_mutex);
+  dlna_src->stats_mark = latency;
+  dlna_src->stats_mark_time = g_get_monotonic_time ();
+  g_mutex_unlock (&dlna_src->stats_mutex);
+}
 
-          GST_INFO_OBJECT(dlna_src, "Trick Speeds str: %s\n", speeds->str);
-                
-          gst_structure_set(pStruct, "trickSpeedsStr", G_TYPE_STRING, speeds->str, NULL);
-          
-          g_string_free (speeds, TRUE);
-          ret = TRUE;
-       }
-       break;
+#if GST_CHECK_VERSION(1,0,0)
+/**
+ * Count a buffer pushed out of the bin, and complete a pending seek or rate
+ * change latency with it.  Buffers refused because downstream is flushing
+ * are counted as dropped.
+ *
+ * @param dlna_src  this element
+ * @param size      size of the buffer in bytes
+ * @param flow      result of pushing the buffer
+ */
+static void
+dlna_src_stats_delivered (GstDlnaSrc * dlna_src, gsize size,
+    GstFlowReturn flow)
+{
+  GstDlnaSrcLatency mark = DLNA_SRC_LATENCY_CNT;
+  gint64 usecs = 0;
+
+  g_mutex_lock (&dlna_src->stats_mutex);
+  if (flow == GST_FLOW_OK) {
+    dlna_src->stats_bytes_delivered += size;
+    if (dlna_src->stats_mark != DLNA_SRC_LATENCY_CNT) {
+      mark = dlna_src->stats_mark;
+      usecs = g_get_monotonic_time () - dlna_src->stats_mark_time;
+      dlna_src->stats_mark = DLNA_SRC_LATENCY_CNT;
     }
+  } else if (flow == GST_FLOW_FLUSHING)
+    dlna_src->stats_bytes_dropped += size;
+  g_mutex_unlock (&dlna_src->stats_mutex);
 
-    default:
-      GST_LOG_OBJECT (dlna_src,
-          "Got unsupported src query: %s, passing to default handler",
-          GST_QUERY_TYPE_NAME (query));
-      break;
-  }
-
-  if (!ret) {
-#if GST_CHECK_VERSION(1,0,0)
-    ret = gst_pad_query_default (pad, parent, query);
-#else
-    ret = gst_pad_query_default (pad, query);
+  if (mark != DLNA_SRC_LATENCY_CNT)
+    dlna_src_stats_record (dlna_src, mark, usecs);
+}
 #endif
-  }
 
-  gst_object_unref (dlna_src);
+/**
+ * Snapshot of the stats, as returned by the "stats" property and posted in
+ * "dlnasrc-stats" element messages.  Holds the byte counters and a structure
+ * per latency with its count, min, max, mean and percentiles in usecs.
+ *
+ * @param dlna_src  this element
+ *
+ * @return  new structure, free with gst_structure_free()
+ */
+static GstStructure *
+dlna_src_stats_to_structure (GstDlnaSrc * dlna_src)
+{
+  GstStructure *stats;
+  GstStructure *latency;
+  GstDlnaSrcHistogram *histogram;
+  guint i;
+
+  g_mutex_lock (&dlna_src->stats_mutex);
+  stats = gst_structure_new ("dlnasrc-stats",
+      "bytes-delivered", G_TYPE_UINT64, dlna_src->stats_bytes_delivered,
+      "bytes-dropped", G_TYPE_UINT64, dlna_src->stats_bytes_dropped, NULL);
+
+  for (i = 0; i < DLNA_SRC_LATENCY_CNT; i++) {
+    histogram = &dlna_src->stats_latency[i];
+    latency = gst_structure_new (LATENCY_NAMES[i],
+        "count", G_TYPE_UINT64, histogram->count,
+        "min", G_TYPE_UINT64, histogram->min,
+        "max", G_TYPE_UINT64, histogram->max,
+        "mean", G_TYPE_UINT64,
+        histogram->count ? histogram->sum / histogram->count : 0,
+        "p50", G_TYPE_UINT64, dlna_src_histogram_percentile (histogram, 0.5),
+        "p90", G_TYPE_UINT64, dlna_src_histogram_percentile (histogram, 0.9),
+        "p99", G_TYPE_UINT64, dlna_src_histogram_percentile (histogram, 0.99),
+        "p999", G_TYPE_UINT64,
+        dlna_src_histogram_percentile (histogram, 0.999), NULL);
+    gst_structure_set (stats, LATENCY_NAMES[i], GST_TYPE_STRUCTURE, latency,
+        NULL);
+    gst_structure_free (latency);
+  }
+  g_mutex_unlock (&dlna_src->stats_mutex);
 
-  return ret;
+  return stats;
 }
 
 /**
- * Responds to a duration query by returning the size of content/stream
- *
- * @param	dlna_src	this element
- * @param	query		received duration query to respond to
- *
- * @return	true if responded to query, false otherwise
+ * Runs on the HEAD worker every stats-interval seconds, posts the stats.
  */
 static gboolean
-dlna_src_handle_query_duration (GstDlnaSrc * dlna_src, GstQuery * query)
+dlna_src_stats_timer_cb (gpointer data)
 {
-  gboolean ret = FALSE;
-  gint64 duration = 0;
-  GstFormat format;
-  gchar *live_content_head_request_headers[][2] =
-      { {HEADER_GET_AVAILABLE_SEEK_RANGE_TITLE,
-      HEADER_GET_AVAILABLE_SEEK_RANGE_VALUE}
-  };
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) data;
 
-  gsize live_content_head_request_headers_size = 1;
+  gst_element_post_message (GST_ELEMENT_CAST (dlna_src),
+      gst_message_new_element (GST_OBJECT_CAST (dlna_src),
+          dlna_src_stats_to_structure (dlna_src)));
 
-  GST_LOG_OBJECT (dlna_src, "Called");
+  return TRUE;
+}
 
-  if ((dlna_src->dlna_uri == NULL) || (dlna_src->server_info == NULL)) {
-    GST_INFO_OBJECT (dlna_src,
-        "No URI and/or HEAD response info, unable to handle query");
-    return FALSE;
+/**
+ * Start posting the stats every stats-interval seconds, if set.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_stats_timer_start (GstDlnaSrc * dlna_src)
+{
+  if (!dlna_src->stats_interval || !dlna_src->head_context ||
+      dlna_src->stats_source)
+    return;
+
+  dlna_src->stats_source = g_timeout_source_new_seconds
+      (dlna_src->stats_interval);
+  g_source_set_callback (dlna_src->stats_source, dlna_src_stats_timer_cb,
+      gst_object_ref (dlna_src), (GDestroyNotify) gst_object_unref);
+  g_source_attach (dlna_src->stats_source, dlna_src->head_context);
+}
+
+/**
+ * Stop posting the stats.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_stats_timer_stop (GstDlnaSrc * dlna_src)
+{
+  if (dlna_src->stats_source) {
+    g_source_destroy (dlna_src->stats_source);
+    g_source_unref (dlna_src->stats_source);
+    dlna_src->stats_source = NULL;
   }
+}
 
-  gst_query_parse_duration (query, &format, &duration);
+/**
+ * Add an entry to the trace ring, overwriting the oldest one.  Writers
+ * never wait for each other or for readers; an entry is stamped with its
+ * sequence number once written, so readers can skip one which is being
+ * overwritten.
+ *
+ * @param dlna_src  this element
+ * @param entry     entry to add, its seq is ignored
+ */
+static void
+dlna_src_trace_record (GstDlnaSrc * dlna_src, GstDlnaSrcTraceEntry * entry)
+{
+  GstDlnaSrcTraceEntry *slot;
+  guint ticket;
+
+  ticket = (guint) g_atomic_int_add (&dlna_src->trace_next, 1);
+  slot = &dlna_src->trace_ring[ticket & (TRACE_RING_SIZE - 1)];
+
+  g_atomic_int_set (&slot->seq, 0);
+  entry->time = g_get_monotonic_time ();
+  memcpy ((guint8 *) slot + sizeof (slot->seq),
+      (guint8 *) entry + sizeof (entry->seq),
+      sizeof (*entry) - sizeof (entry->seq));
+  /* Zero marks an entry being written, skip it when the ticket wraps */
+  g_atomic_int_set (&slot->seq, (ticket + 1) ? (gint) (ticket + 1) : 1);
+}
 
-  if (format == GST_FORMAT_BYTES) {
-    if (dlna_src->byte_total) {
-      gst_query_set_duration (query, GST_FORMAT_BYTES, dlna_src->byte_total);
-      ret = TRUE;
-      GST_DEBUG_OBJECT (dlna_src,
-          "Duration in bytes for this content on the server: %"
-          G_GUINT64_FORMAT, dlna_src->byte_total);
+/**
+ * Add a HEAD request to the trace ring, with the key fields parsed from its
+ * response.
+ *
+ * @param dlna_src      this element
+ * @param purpose       latency histogram the request is recorded in
+ * @param status        HTTP or soup status of the response
+ * @param usecs         time from issuing the request to its response
+ * @param head_response parsed response, NULL if not parsed
+ */
+static void
+dlna_src_trace_head (GstDlnaSrc * dlna_src, GstDlnaSrcLatency purpose,
+    guint status, gint64 usecs, GstDlnaSrcHeadResponse * head_response)
+{
+  GstDlnaSrcTraceEntry entry;
+
+  memset (&entry, 0, sizeof (entry));
+  entry.kind = DLNA_SRC_TRACE_HEAD;
+  entry.purpose = purpose;
+  entry.status = status;
+  entry.usecs = (guint32) CLAMP (usecs, 0, G_MAXUINT32);
+
+  if (!head_response)
+    entry.flags |= TRACE_FLAG_PARSE_FAILED;
+  else {
+    if (head_response->content_range_total) {
+      entry.byte_start = head_response->content_range_start;
+      entry.byte_end = head_response->content_range_end;
+      entry.byte_total = head_response->content_range_total;
     } else
-      GST_DEBUG_OBJECT (dlna_src,
-          "Duration in bytes not available for content item");
-  } else if (format == GST_FORMAT_TIME) {
-    if ((dlna_src->is_live) || (dlna_src->is_recInProgress)) {
-      GST_INFO_OBJECT (dlna_src, "Update live/recInProgress content range info");
-      if (!dlna_src_soup_issue_head (dlna_src,
-              live_content_head_request_headers_size,
-              live_content_head_request_headers, dlna_src->server_info,
-              TRUE)) {
-        GST_ERROR_OBJECT (dlna_src,
-            "Problems issuing HEAD request to get live/recInProgress content information");
-        return FALSE;
-      }
+      entry.byte_total = head_response->content_length;
+
+    if (head_response->available_seek_npt_end_str) {
+      entry.flags |= TRACE_FLAG_AVAILABLE_RANGE;
+      entry.npt_start = head_response->available_seek_npt_start;
+      entry.npt_end = head_response->available_seek_npt_end;
+    } else {
+      entry.npt_start = head_response->time_seek_npt_start;
+      entry.npt_end = head_response->time_seek_npt_end;
     }
 
-    if (dlna_src->npt_duration_nanos) {
-      gst_query_set_duration (query, GST_FORMAT_TIME,
-          dlna_src->npt_duration_nanos);
-      ret = TRUE;
-      GST_DEBUG_OBJECT (dlna_src,
-          "Duration in media time for this content on the server, npt: %"
-          GST_TIME_FORMAT ", nanosecs: %" G_GUINT64_FORMAT,
-          GST_TIME_ARGS (dlna_src->npt_duration_nanos),
-          dlna_src->npt_duration_nanos);
-    } else
-      GST_DEBUG_OBJECT (dlna_src,
-          "Duration in media time not available for content item");
-  } else {
-    GST_DEBUG_OBJECT (dlna_src,
-        "Got duration query with non-supported format type: %s, passing to default handler",
-        gst_format_get_name (format));
+    if (head_response->accept_byte_ranges)
+      entry.flags |= TRACE_FLAG_BYTE_SEEK;
+    if (head_response->content_features) {
+      if (DLNA_SRC_CF_IS_SET (head_response->content_features,
+              DLNA_SRC_CF_OP_RANGE))
+        entry.flags |= TRACE_FLAG_BYTE_SEEK;
+      if (DLNA_SRC_CF_IS_SET (head_response->content_features,
+              DLNA_SRC_CF_OP_TIME_SEEK))
+        entry.flags |= TRACE_FLAG_TIME_SEEK;
+    }
+    if (head_response->dtcp_host)
+      entry.flags |= TRACE_FLAG_ENCRYPTED;
   }
-  return ret;
+
+  dlna_src_trace_record (dlna_src, &entry);
 }
 
 /**
- * Responds to a seeking query by returning whether or not seeking is supported
+ * Format the trace ring, oldest entry first, one line per entry.
  *
- * @param	dlna_src	this element
- * @param	query		received seeking query to respond to
+ * @param dlna_src  this element
  *
- * @return	true if responded to query, false otherwise
+ * @return  new string, free with g_free()
  */
-static gboolean
-dlna_src_handle_query_seeking (GstDlnaSrc * dlna_src, GstQuery * query)
+static gchar *
+dlna_src_trace_to_string (GstDlnaSrc * dlna_src)
 {
-  gboolean ret = FALSE;
-  GstFormat format;
-  gboolean supports_seeking = FALSE;
-  gint64 seek_start = 0;
-  gint64 seek_end = 0;
-
-  GST_DEBUG_OBJECT (dlna_src, "Called");
-
-  if ((dlna_src->dlna_uri == NULL) || (dlna_src->server_info == NULL)) {
-    GST_INFO_OBJECT (dlna_src,
-        "No URI and/or HEAD response info, unable to handle query");
-    return FALSE;
+  static const gchar *kind_names[] = { "HEAD", "GET", "SEEK" };
+  GstDlnaSrcTraceEntry entry;
+  GstDlnaSrcTraceEntry *slot;
+  GString *str = g_string_sized_new (TRACE_RING_SIZE * 96);
+  gint64 now = g_get_monotonic_time ();
+  guint next;
+  guint i;
+  gint seq;
+
+  next = (guint) g_atomic_int_get (&dlna_src->trace_next);
+  for (i = 0; i < TRACE_RING_SIZE; i++) {
+    slot = &dlna_src->trace_ring[(next + i) & (TRACE_RING_SIZE - 1)];
+    seq = g_atomic_int_get (&slot->seq);
+    if (!seq)
+      continue;
+    memcpy (&entry, slot, sizeof (entry));
+    if (g_atomic_int_get (&slot->seq) != seq)
+      continue;
+
+    g_string_append_printf (str, "\n#%u -%" G_GINT64_FORMAT "ms %s",
+        (guint) seq, (now - entry.time) / 1000, kind_names[entry.kind]);
+    switch (entry.kind) {
+      case DLNA_SRC_TRACE_HEAD:
+        g_string_append_printf (str, " %s status %u in %uus",
+            LATENCY_NAMES[entry.purpose], entry.status, entry.usecs);
+        break;
+      case DLNA_SRC_TRACE_SEEK:
+        g_string_append_printf (str, " %s rate %.2f",
+            gst_format_get_name ((GstFormat) entry.status), entry.rate);
+        break;
+      default:
+        break;
+    }
+    if (entry.flags & TRACE_FLAG_PARSE_FAILED) {
+      g_string_append (str, " unparsed");
+      continue;
+    }
+    g_string_append_printf (str, " bytes %" G_GUINT64_FORMAT "-%"
+        G_GUINT64_FORMAT "/%" G_GUINT64_FORMAT " npt %" GST_TIME_FORMAT
+        "-%" GST_TIME_FORMAT "%s%s%s%s%s", entry.byte_start, entry.byte_end,
+        entry.byte_total, GST_TIME_ARGS (entry.npt_start),
+        GST_TIME_ARGS (entry.npt_end),
+        (entry.flags & TRACE_FLAG_BYTE_SEEK) ? " byte-seek" : "",
+        (entry.flags & TRACE_FLAG_TIME_SEEK) ? " time-seek" : "",
+        (entry.flags & TRACE_FLAG_ENCRYPTED) ? " encrypted" : "",
+        (entry.flags & TRACE_FLAG_AVAILABLE_RANGE) ? " available-range" : "",
+        (entry.flags & TRACE_FLAG_REJECTED) ? " rejected" : "");
   }
 
-  gst_query_parse_seeking (query, &format, &supports_seeking, &seek_start,
-      &seek_end);
-
-  if (format == GST_FORMAT_BYTES) {
-    if (dlna_src->byte_seek_supported) {
-      gst_query_set_seeking (query, GST_FORMAT_BYTES, TRUE,
-          dlna_src->byte_start, dlna_src->byte_end);
-      ret = TRUE;
-
-      GST_INFO_OBJECT (dlna_src,
-          "Byte seeks supported for this content by the server, start %"
-          G_GUINT64_FORMAT ", end %" G_GUINT64_FORMAT,
-          dlna_src->byte_start, dlna_src->byte_end);
+  return g_string_free (str, FALSE);
+}
 
-    } else
-      GST_INFO_OBJECT (dlna_src,
-          "Seeking in bytes not available for content item");
-  } else if (format == GST_FORMAT_TIME) {
-    if (dlna_src->time_seek_supported) {
-      gst_query_set_seeking (query, GST_FORMAT_TIME, TRUE,
-          dlna_src->npt_start_nanos, dlna_src->npt_end_nanos);
-      ret = TRUE;
+/**
+ * Log the trace ring as a warning, after something went wrong.
+ *
+ * @param dlna_src  this element
+ * @param reason    what went wrong
+ */
+static void
+dlna_src_trace_dump (GstDlnaSrc * dlna_src, const gchar * reason)
+{
+  gchar *trace;
 
-      GST_DEBUG_OBJECT (dlna_src,
-          "Time based seeks supported for this content by the server, start %"
-          GST_TIME_FORMAT ", end %" GST_TIME_FORMAT,
-          GST_TIME_ARGS (dlna_src->npt_start_nanos),
-          GST_TIME_ARGS (dlna_src->npt_end_nanos));
-    } else
-      GST_DEBUG_OBJECT (dlna_src,
-          "Seeking in media time not available for content item");
-  } else {
-    GST_DEBUG_OBJECT (dlna_src,
-        "Got seeking query with non-supported format type: %s, passing to default handler",
-        GST_QUERY_TYPE_NAME (query));
-  }
+  if (gst_debug_category_get_threshold (gst_dlna_src_debug) <
+      GST_LEVEL_WARNING)
+    return;
 
-  return ret;
+  trace = dlna_src_trace_to_string (dlna_src);
+  GST_WARNING_OBJECT (dlna_src, "%s, recent requests:%s", reason, trace);
+  g_free (trace);
 }
 
 /**
- * Responds to a segment query by returning rate along with start and stop
+ * Start tracking the TSB boundaries of live content.  Instead of a thread per
+ * instance polling the server, each instance gets a timer on the HEAD worker
+ * shared by all instances, which extrapolates the window from the last PTS
+ * received and the wall clock, and only asks the server again when needed.
  *
- * @param	dlna_src	this element
- * @param	query		received segment query to respond to
+ * @param dlna_src  this element
  *
- * @return	true if responded to query, false otherwise
+ * @return  TRUE if started, FALSE otherwise
  */
 static gboolean
-dlna_src_handle_query_segment (GstDlnaSrc * dlna_src, GstQuery * query)
+dlna_src_boundary_timer_start (GstDlnaSrc * dlna_src)
 {
-  gboolean ret = FALSE;
-  GstFormat format;
-  gdouble rate = 1.0;
-  gint64 start = 0;
-  gint64 end = 0;
-
-  GST_LOG_OBJECT (dlna_src, "Called");
-
-  if ((dlna_src->dlna_uri == NULL) || (dlna_src->server_info == NULL)) {
-    GST_INFO_OBJECT (dlna_src,
-        "No URI and/or HEAD response info, unable to handle query");
+  if (!dlna_src->head_context) {
+    GST_ERROR_OBJECT (dlna_src, "No HEAD worker to track TSB boundaries on");
     return FALSE;
   }
-  gst_query_parse_segment (query, &rate, &format, &start, &end);
 
-  if (format == GST_FORMAT_BYTES) {
-    if (dlna_src->byte_seek_supported) {
+  dlna_src->boundary_stopped = FALSE;
+  dlna_src->boundary_base_time = g_get_monotonic_time ();
+  dlna_src->boundary_base_start_pts = dlna_src->start_pts;
+  dlna_src->boundary_base_end_pts = dlna_src->end_pts;
+  dlna_src->boundary_resync = TRUE;
+  g_atomic_int_set (&dlna_src->boundary_interval, BOUNDARY_INTERVAL_SECS);
 
-      gst_query_set_segment (query, dlna_src->rate, GST_FORMAT_BYTES,
-          dlna_src->byte_start, dlna_src->byte_end);
-      ret = TRUE;
+  dlna_src_boundary_timer_schedule (dlna_src, BOUNDARY_INTERVAL_SECS);
 
-      GST_DEBUG_OBJECT (dlna_src,
-          "Segment info in bytes for this content, rate %f, start %"
-          G_GUINT64_FORMAT ", end %" G_GUINT64_FORMAT,
-          dlna_src->rate, dlna_src->byte_start, dlna_src->byte_end);
-    } else
-      GST_DEBUG_OBJECT (dlna_src,
-          "Segment info in bytes not available for content item");
-  } else if (format == GST_FORMAT_TIME) {
+  return TRUE;
+}
 
-    if (dlna_src->time_seek_supported) {
-      gst_query_set_segment (query, dlna_src->rate, GST_FORMAT_TIME,
-          dlna_src->npt_start_nanos, dlna_src->npt_end_nanos);
-      ret = TRUE;
+/**
+ * Stop tracking the TSB boundaries.  Returns once the timer is removed and
+ * can no longer run, and the boundary report thread has stopped.  A report
+ * already requested is dropped.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_boundary_timer_stop (GstDlnaSrc * dlna_src)
+{
+  g_main_context_invoke (dlna_src->head_context,
+      dlna_src_boundary_timer_remove, dlna_src);
 
-      GST_DEBUG_OBJECT (dlna_src,
-          "Time based segment info for this content by the server, rate %f, start %"
-          GST_TIME_FORMAT ", end %" GST_TIME_FORMAT,
-          dlna_src->rate,
-          GST_TIME_ARGS (dlna_src->npt_start_nanos),
-          GST_TIME_ARGS (dlna_src->npt_end_nanos));
-    } else
-      GST_DEBUG_OBJECT (dlna_src,
-          "Segment info in media time not available for content item");
-  } else {
-    GST_DEBUG_OBJECT (dlna_src,
-        "Got segment query with non-supported format type: %s, passing to default handler",
-        GST_QUERY_TYPE_NAME (query));
-  }
+  g_mutex_lock (&dlna_src->boundary_mutex);
+  while (!dlna_src->boundary_stopped)
+    g_cond_wait (&dlna_src->boundary_cond, &dlna_src->boundary_mutex);
+  g_mutex_unlock (&dlna_src->boundary_mutex);
 
-  return ret;
+  dlna_src_boundary_thread_stop (dlna_src);
 }
 
 /**
- * Responds to a convert query by issuing head and returning conversion value
- *
- * @param	dlna_src	this element
- * @param	query		received query to respond to
- *
- * @return	true if responded to query, false otherwise
+ * Runs on the HEAD worker, removes the boundary timer.
  */
 static gboolean
-dlna_src_handle_query_convert (GstDlnaSrc * dlna_src, GstQuery * query)
+dlna_src_boundary_timer_remove (gpointer data)
 {
-  /* Always return true since no other element can do this */
-  gboolean ret = TRUE;
-  GstFormat src_fmt, dest_fmt;
-  gint64 src_val, dest_val;
-  gint64 start_byte = 0;
-  gint64 start_npt = 0;
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) data;
 
-  GST_LOG_OBJECT (dlna_src, "Called");
-
-  if (dlna_src->dlna_uri == NULL || !dlna_src->time_seek_supported) {
-    GST_INFO_OBJECT (dlna_src, "Not enough info to handle conversion query");
-    return FALSE;
+  if (dlna_src->boundary_source) {
+    g_source_destroy (dlna_src->boundary_source);
+    g_source_unref (dlna_src->boundary_source);
+    dlna_src->boundary_source = NULL;
   }
 
-  gst_query_parse_convert (query, &src_fmt, &src_val, &dest_fmt, &dest_val);
+  g_mutex_lock (&dlna_src->boundary_mutex);
+  dlna_src->boundary_stopped = TRUE;
+  g_cond_broadcast (&dlna_src->boundary_cond);
+  g_mutex_unlock (&dlna_src->boundary_mutex);
 
-  GST_DEBUG_OBJECT (dlna_src,
-      "Got conversion query: src fmt: %s, dest fmt: %s, src val: %"
-      G_GUINT64_FORMAT ", dest: val %" G_GUINT64_FORMAT,
-      gst_format_get_name (src_fmt),
-      gst_format_get_name (dest_fmt), src_val, dest_val);
+  return FALSE;
+}
 
-  if (src_fmt == GST_FORMAT_BYTES) {
-    start_byte = src_val;
-  } else if (src_fmt == GST_FORMAT_TIME) {
-    start_npt = src_val;
-  } else {
-    GST_WARNING_OBJECT (dlna_src,
-        "Got segment query with non-supported format type: %s",
-        GST_QUERY_TYPE_NAME (query));
-    return ret;
-  }
+/**
+ * Arm the boundary timer to fire after supplied interval.  Second based
+ * timers let the worker wake once for all instances due at the same time.
+ */
+static void
+dlna_src_boundary_timer_schedule (GstDlnaSrc * dlna_src, guint interval_secs)
+{
+  if (dlna_src->boundary_source)
+    g_source_unref (dlna_src->boundary_source);
 
-  if (dest_fmt == GST_FORMAT_TIME) {
-    if (!dlna_src_convert_bytes_to_npt_nanos (dlna_src, start_byte,
-            (guint64 *) & dest_val)) {
-      GST_WARNING_OBJECT (dlna_src, "Problems converting to time");
-      return ret;
-    }
-  } else if (dest_fmt == GST_FORMAT_BYTES) {
-    if (!dlna_src_convert_npt_nanos_to_bytes (dlna_src, start_npt,
-            (guint64 *) & dest_val)) {
-      GST_WARNING_OBJECT (dlna_src, "Problems converting to bytes");
-      return ret;
-    }
-  } else {
-    GST_INFO_OBJECT (dlna_src, "Unsupported format: %s",
-        gst_format_get_name (dest_fmt));
-    return FALSE;
-  }
+  dlna_src->boundary_source = g_timeout_source_new_seconds (interval_secs);
+  g_source_set_callback (dlna_src->boundary_source,
+      dlna_src_boundary_timer_cb, dlna_src, NULL);
+  g_source_attach (dlna_src->boundary_source, dlna_src->head_context);
+}
 
-  gst_query_set_convert (query, src_fmt, src_val, dest_fmt, dest_val);
+/**
+ * Estimate the current TSB window from the last one received from the server.
+ * The end advances in real time, the start too once the TSB is full.
+ *
+ * @param dlna_src  this element
+ * @param now       current monotonic time
+ * @param start_pts returns estimated start PTS
+ * @param end_pts   returns estimated end PTS
+ */
+static void
+dlna_src_boundary_extrapolate (GstDlnaSrc * dlna_src, gint64 now,
+    guint32 * start_pts, guint32 * end_pts)
+{
+  guint32 elapsed_45khz =
+      (guint32) (((now - dlna_src->boundary_base_time) * 45000) /
+      G_TIME_SPAN_SECOND);
 
-  return ret;
+  *start_pts = dlna_src->boundary_base_start_pts;
+  *end_pts = dlna_src->boundary_base_end_pts;
+
+  if ((MAX_PTS_45KHZ == *start_pts) || (MAX_PTS_45KHZ == *end_pts))
+    return;
+
+  /* PTS wraps around at 32 bits */
+  *end_pts += elapsed_45khz;
+  if ((dlna_src->npt_duration_nanos / GST_SECOND) >= dlna_src->max_tsb_duration)
+    *start_pts += elapsed_45khz;
 }
 
-static gboolean dlna_src_send_tsb_boundary_event(GstDlnaSrc *dlna_src)
+/**
+ * Boundary timer callback, runs on the HEAD worker.  Publishes the estimated
+ * TSB boundaries in a range snapshot, the boundaries last received from the
+ * server are left as they are, and revalidates with the server when the
+ * estimate went stale or drifted.  Sending the boundaries downstream and
+ * checking the play position are left to the boundary report thread, as the
+ * worker is shared by all instances and must not wait on any pipeline.  The
+ * next run comes sooner the closer playback was to the edge on the last
+ * report.
+ */
+static gboolean
+dlna_src_boundary_timer_cb (gpointer data)
 {
-  gboolean      ret = FALSE; 
-   GstEvent     *event = NULL;
-   GstStructure *structure = NULL;
-
-   do 
-   {
-      if(MAX_PTS_45KHZ == dlna_src->start_pts)
-      {
-         GST_WARNING("Not sending tsb-boundary event because TSB start_pts is invalid\n");
-         ret = TRUE;
-         break;
-      }
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) data;
+  gint64 now = g_get_monotonic_time ();
+  gboolean revalidate = dlna_src->boundary_resync;
+  guint32 start_pts;
+  guint32 end_pts;
 
-      structure = gst_structure_new("tsb-boundary",
-                                    "start-pts", G_TYPE_UINT, dlna_src->start_pts, 
-                                    "end-pts", G_TYPE_UINT, dlna_src->end_pts, 
-                                    NULL);
-      if(NULL == structure)
-      {
-         GST_WARNING("Error creating tsb-boundary structure\n");
-         break;
-      }
+  dlna_src_boundary_extrapolate (dlna_src, now, &start_pts, &end_pts);
+  dlna_src_range_publish_pts (dlna_src, start_pts, end_pts);
 
-      event = gst_event_new_custom(GST_EVENT_CUSTOM_DOWNSTREAM_OOB, structure);
-      if(NULL == event)
-      {
-         gst_structure_free(structure);
-         structure = NULL;
-         GST_WARNING("Error creating custom downstream OOB event\n");
-         break;
-      }
+  dlna_src_boundary_report_request (dlna_src);
 
-      GST_DEBUG("Sending tsb-boundary custom downstream OOB event\n");
+  if ((now - dlna_src->boundary_base_time) >
+      (BOUNDARY_REVALIDATE_SECS * G_TIME_SPAN_SECOND))
+    revalidate = TRUE;
 
-      if (gst_pad_push_event (dlna_src->src_pad, event) != TRUE)
-      {
-         event = NULL;
-         GST_WARNING("Sending custom downstream OOB event failed!");
-         break;
-      }
+  if (revalidate)
+    dlna_src_refresh_live_info_async (dlna_src,
+        DLNA_SRC_LATENCY_HEAD_BOUNDARY_POLL);
 
-      ret = TRUE;
-   
-   }while(0);
+  dlna_src_boundary_timer_schedule (dlna_src,
+      (guint) g_atomic_int_get (&dlna_src->boundary_interval));
 
-   return ret;
+  return FALSE;
 }
 
 /**
- * Perform action necessary when seek event is received
- *
- * @param dlna_src		this element
- * @param seek_event	seek event which has been received
+ * Have the boundary report thread send the TSB boundaries downstream and
+ * check the play position, starting the thread if needed.  Requests made
+ * before the previous one was handled are merged.
  *
- * @return	true if this event has been handled, false otherwise
+ * @param dlna_src  this element
  */
-static gboolean
-dlna_src_handle_event_seek (GstDlnaSrc * dlna_src, GstPad * pad,
-    GstEvent * event)
+static void
+dlna_src_boundary_report_request (GstDlnaSrc * dlna_src)
 {
-  GST_LOG_OBJECT (dlna_src, "Handle seek event");
+  g_mutex_lock (&dlna_src->boundary_mutex);
+  dlna_src->boundary_report_pending = TRUE;
+  if (!dlna_src->boundary_thread) {
+    dlna_src->boundary_thread = g_thread_new ("dlnasrc_boundary",
+        dlna_src_boundary_thread_func, dlna_src);
+  }
+  g_cond_broadcast (&dlna_src->boundary_cond);
+  g_mutex_unlock (&dlna_src->boundary_mutex);
+}
 
-  gboolean ret = FALSE;
-  gdouble rate;
-  GstFormat format;
-  GstSeekFlags flags;
-  GstSeekType start_type;
-  gint64 start;
-  GstSeekType stop_type;
-  gint64 stop;
-  guint32 new_seqnum;
-  gboolean convert_start = FALSE;
+/**
+ * Boundary report thread, sends the reports requested by the HEAD worker
+ * one at a time.  Kept apart from the seek thread so reports never wait for
+ * a seek, nor seeks for a report.
+ */
+static gpointer
+dlna_src_boundary_thread_func (gpointer data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) data;
+
+  /* A thread started after this one was stopped takes over */
+  g_mutex_lock (&dlna_src->boundary_mutex);
+  while (dlna_src->boundary_thread == g_thread_self ()) {
+    if (!dlna_src->boundary_report_pending) {
+      g_cond_wait (&dlna_src->boundary_cond, &dlna_src->boundary_mutex);
+      continue;
+    }
 
-  if ((dlna_src->dlna_uri == NULL) || (dlna_src->server_info == NULL)) {
-    GST_INFO_OBJECT (dlna_src,
-        "No URI and/or HEAD response info, event handled");
-    return TRUE;
+    dlna_src->boundary_report_pending = FALSE;
+    g_mutex_unlock (&dlna_src->boundary_mutex);
+    dlna_src_boundary_report (dlna_src);
+    g_mutex_lock (&dlna_src->boundary_mutex);
   }
+  g_mutex_unlock (&dlna_src->boundary_mutex);
 
-  new_seqnum = gst_event_get_seqnum (event);
-  if (new_seqnum == dlna_src->time_seek_seqnum) {
-    if (dlna_src->handled_time_seek_seqnum) {
-      GST_INFO_OBJECT (dlna_src, "Already processed seek event %d", new_seqnum);
-      return TRUE;
-    } else
-      /* *TODO* - see dlnasrc issue #63
-         Got same event now byte based since some element converted it to bytes
-         Convert here if time seek is supported since it is more accurate */
-    if (dlna_src->time_seek_supported) {
-      convert_start = TRUE;
-      GST_INFO_OBJECT (dlna_src,
-          "Set flag to convert time based seek to byte since server does support time seeks");
-    } else
-      GST_INFO_OBJECT (dlna_src,
-          "Unable to convert time based seek to byte since server does not support time seeks");
-  } else {
-    dlna_src->handled_time_seek_seqnum = FALSE;
-    dlna_src->time_seek_seqnum = new_seqnum;
-    dlna_src->time_seek_event_start = 0;
-  }
+  return NULL;
+}
 
-  gst_event_parse_seek (event, &rate, (GstFormat *) & format,
-      (GstSeekFlags *) & flags,
-      (GstSeekType *) & start_type, (gint64 *) & start,
-      (GstSeekType *) & stop_type, (gint64 *) & stop);
+/**
+ * Stop the boundary report thread and drop the report requested, if any.
+ * A report the thread is sending completes first.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_boundary_thread_stop (GstDlnaSrc * dlna_src)
+{
+  GThread *thread = NULL;
 
-  GST_INFO_OBJECT (dlna_src,
-      "Got Seek event %d: rate: %3.1f, format: %s, flags: %d, start type: %d,  start: %"
-      G_GUINT64_FORMAT ", stop type: %d, stop: %"
-      G_GUINT64_FORMAT, gst_event_get_seqnum (event), rate,
-      gst_format_get_name (format), flags, start_type, start, stop_type, stop);
+  g_mutex_lock (&dlna_src->boundary_mutex);
+  thread = dlna_src->boundary_thread;
+  dlna_src->boundary_thread = NULL;
+  dlna_src->boundary_report_pending = FALSE;
+  g_cond_broadcast (&dlna_src->boundary_cond);
+  g_mutex_unlock (&dlna_src->boundary_mutex);
 
-  if (convert_start) {
-    GST_INFO_OBJECT (dlna_src,
-        "Supplied start byte %" G_GUINT64_FORMAT
-        " ignored, converting seek event start time %" GST_TIME_FORMAT
-        " to bytes", start, GST_TIME_ARGS (dlna_src->time_seek_event_start));
-    if (!dlna_src_convert_npt_nanos_to_bytes (dlna_src,
-            dlna_src->time_seek_event_start, (guint64 *) & start)) {
-      GST_WARNING_OBJECT (dlna_src, "Problems converting to bytes");
-      return TRUE;
+  if (thread)
+    g_thread_join (thread);
+}
+
+/**
+ * Runs on the boundary report thread.  Sends the TSB boundaries downstream, warns when
+ * the TSB start nears the position of paused or rewinding playback and
+ * revalidates with the server when playback is close to the edge.  Sets the
+ * interval of the next boundary timer run from the headroom left.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_boundary_report (GstDlnaSrc * dlna_src)
+{
+  gint64 headroom = 0;
+  guint interval = BOUNDARY_INTERVAL_SECS;
+
+  if (!dlna_src_send_tsb_boundary_event (dlna_src))
+    GST_WARNING_OBJECT (dlna_src, "Failed to send tsb_boundary event downstream");
+
+  /* Play position only falls behind the live edge when paused or slowed */
+  if (((GST_STATE_PAUSED == GST_STATE (dlna_src)) || (dlna_src->rate < 1.0))
+      && dlna_src_get_tsb_headroom (dlna_src, &headroom)) {
+    GST_DEBUG_OBJECT (dlna_src, "TSB start is %" G_GINT64_FORMAT
+        " secs from play position", headroom);
+
+    if (headroom <= MIN_BUF_SECS_TSB_START_TO_PLAY_POS) {
+      GST_WARNING_OBJECT (dlna_src, "TSB start near play/pause pos");
+      gst_element_post_message (GST_ELEMENT_CAST (dlna_src),
+          gst_message_new_element (GST_OBJECT_CAST (dlna_src),
+              gst_structure_new ("extended_notification",
+                  "notification", G_TYPE_STRING,
+                  "tsb_start_near_pause_position", NULL)));
     }
-  }
-  
-  /* 2 second error margin to handle double rounding errors 
-   * npt_end_nanos might be 0 initially for live content.
-   */
-  if((dlna_src->npt_end_nanos > 0) && (start > dlna_src->npt_end_nanos) 
-     && ((gint64)(start - dlna_src->npt_end_nanos) < (gint64)(2 * GST_SECOND)))
-  {
-     start = dlna_src->npt_end_nanos;
+
+    if (headroom <= 2 * MIN_BUF_SECS_TSB_START_TO_PLAY_POS)
+      dlna_src_refresh_live_info_async (dlna_src,
+          DLNA_SRC_LATENCY_HEAD_BOUNDARY_POLL);
+
+    interval = (guint) CLAMP ((headroom - MIN_BUF_SECS_TSB_START_TO_PLAY_POS) / 2,
+        BOUNDARY_MIN_INTERVAL_SECS, BOUNDARY_MAX_INTERVAL_SECS);
   }
 
-  if (!dlna_src_is_change_valid
-      (dlna_src, rate, format, start, start_type, stop, stop_type)) {
-    GST_WARNING_OBJECT (dlna_src, "Requested change is invalid, event handled");
+  g_atomic_int_set (&dlna_src->boundary_interval, (gint) interval);
+}
 
-    dlna_src->handled_time_seek_seqnum = TRUE;
-    dlna_src->forward_event = FALSE;
-    return FALSE;
-  }
-  /* *TODO* - is this needed here??? Assign play rate to supplied rate */
-  dlna_src->rate = rate;
+/**
+ * Runs on the HEAD worker once fresh live range info was received, restarts
+ * the TSB window estimate from it and resyncs sooner if it had drifted.
+ */
+static void
+dlna_src_boundary_sync (GstDlnaSrc * dlna_src)
+{
+  gint64 now = dlna_src->head_update_time;
+  guint32 start_pts;
+  guint32 end_pts;
+  gint32 drift_45khz;
 
-  dlna_src->requested_rate = rate;
-  dlna_src->requested_format = format;
-  dlna_src->requested_start = start;
-  dlna_src->requested_stop = GST_CLOCK_TIME_NONE;
-  if (stop > -1)
-    dlna_src->requested_stop = stop;
+  if (!dlna_src->boundary_source || (MAX_PTS_45KHZ == dlna_src->end_pts))
+    return;
 
-  /* The commented code block below is not needed as we need to play all
-   * the data in the TSB to reach the live point.
-   * An EOS will be received when playback reaches the end of TSB.
-   * And setting the duration as stop for rewind request does not make sense.
-   */
-#if 0
-  if (dlna_src->is_live && stop < 0) {
-    dlna_src->requested_stop = dlna_src->npt_end_nanos;
-    GST_INFO_OBJECT (dlna_src,
-        "Set requested stop to end of range since content is live: %"
-        G_GUINT64_FORMAT, dlna_src->requested_stop);
-  }
-#endif
+  dlna_src_boundary_extrapolate (dlna_src, now, &start_pts, &end_pts);
+  drift_45khz = (gint32) (dlna_src->end_pts - end_pts);
+  dlna_src->boundary_resync = (MAX_PTS_45KHZ == end_pts) ||
+      (ABS (drift_45khz) > (BOUNDARY_DRIFT_SECS * 45000));
 
-  if ((dlna_src->dlna_uri) && (dlna_src->server_info) &&
-      (dlna_src->server_info->content_features != NULL)) {
-    if (!dlna_src_adjust_http_src_headers (dlna_src, dlna_src->requested_rate,
-            dlna_src->requested_format, dlna_src->requested_start,
-            dlna_src->requested_stop, new_seqnum)) {
-      GST_ERROR_OBJECT (dlna_src, "Problems adjusting soup http src headers");
-      /* Returning true to prevent further processing */
-      return TRUE;
-    }
-  } else
-    GST_INFO_OBJECT (dlna_src,
-        "No header adjustments since server only supports Range requests");
+  GST_DEBUG_OBJECT (dlna_src, "TSB end estimate drifted %d/45000 secs%s",
+      drift_45khz, dlna_src->boundary_resync ? ", resyncing" : "");
 
-  /* Souphttpsrc does not handle time based seeks, so return TRUE */
-  if(GST_FORMAT_TIME == format)
-  {
-     do 
-     {
-        /* Send a dummy bytes based request to restart the gst_pad_task in 
-         * basesrc(base class of souphttpsrc) */
-        if(TRUE != gst_element_seek_simple(dlna_src->http_src, GST_FORMAT_BYTES, GST_SEEK_FLAG_FLUSH, 0))
-        {
-           GST_WARNING("Sending seek to basesrc(souphttpsrc) failed\n");
-           break;
-        }
-        
-        GstEvent     *event = NULL;
-        GstStructure *structure = NULL;
-        gboolean      enable = FALSE;
-        gchar         video_mask_str[16] = "";
+  dlna_src->boundary_base_time = now;
+  dlna_src->boundary_base_start_pts = dlna_src->start_pts;
+  dlna_src->boundary_base_end_pts = dlna_src->end_pts;
 
-        /* A seek will make the server stream from TSB */
-        if(dlna_src->is_live)
-        {
-           dlna_src->in_tsb = TRUE;
-        }
-        
-        /* TODO - Figure out whehter the DMS is pacing and sending I/IP/all frames during trick modes */
-        if((rate > 1.0) || (rate < -1.0))
-        {
-           enable = TRUE;
-        }
+  dlna_src_boundary_report_request (dlna_src);
+}
 
-        if(TRUE == dlna_src->is_live)
-        {
-           if(TRUE != dlna_src_send_tsb_boundary_event(dlna_src))
-           {
-              break;
-           }
-        }
+/**
+ * Start prefetching content around the position trick play is predicted to
+ * land on, or update the prediction when trick play continues at another
+ * rate or position.  Prefetching runs on the HEAD worker so the pipeline is
+ * never blocked by it.  Encrypted content is not prefetched since the data
+ * is spliced in after the decrypter.
+ *
+ * @param dlna_src  this element
+ * @param npt_nanos position trick play started from
+ * @param rate      trick play rate
+ */
+static void
+dlna_src_prefetch_start (GstDlnaSrc * dlna_src, guint64 npt_nanos,
+    gfloat rate)
+{
+#if GST_CHECK_VERSION(1,0,0)
+  if (!dlna_src->prefetch_duration || !dlna_src->head_context ||
+      !dlna_src->byte_seek_supported || dlna_src->is_encrypted ||
+      dlna_src->dtcp_decrypter)
+    return;
+
+  g_mutex_lock (&dlna_src->prefetch_mutex);
+  dlna_src->prefetch_base_time = g_get_monotonic_time ();
+  dlna_src->prefetch_base_npt = npt_nanos;
+  dlna_src->prefetch_rate = rate;
+  g_mutex_unlock (&dlna_src->prefetch_mutex);
+
+  if (dlna_src->prefetch_stopped) {
+    GST_DEBUG_OBJECT (dlna_src, "Starting prefetch at rate %.1f", rate);
+    dlna_src->prefetch_stopped = FALSE;
+    dlna_src->prefetch_aim_start = 0;
+    dlna_src->prefetch_aim_end = 0;
+    g_main_context_invoke (dlna_src->head_context,
+        dlna_src_prefetch_timer_cb, dlna_src);
+  }
+#endif
+}
 
-        structure = gst_structure_new("serverside-pacing",
-                                      "enable", G_TYPE_BOOLEAN, enable,
-                                      "rate", G_TYPE_DOUBLE, rate,
-                                      NULL);
-        if(NULL == structure)
-        {
-           GST_WARNING("Error creating serverside-pacing structure\n");
-           break;
-        }
+/**
+ * Stop prefetching, cancelling a prefetch in flight.  Data already
+ * prefetched is kept so it can still be served.  Returns once the timer is
+ * removed and can no longer run.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_prefetch_stop (GstDlnaSrc * dlna_src)
+{
+  g_main_context_invoke (dlna_src->head_context, dlna_src_prefetch_remove,
+      dlna_src);
 
-        event = gst_event_new_custom(GST_EVENT_CUSTOM_DOWNSTREAM, structure);
-        if(NULL == event)
-        {
-           gst_structure_free(structure);
-           structure = NULL;
-           GST_WARNING("Error creating custom downstream event\n");
-           break;
-        }
+  g_mutex_lock (&dlna_src->prefetch_mutex);
+  while (!dlna_src->prefetch_stopped)
+    g_cond_wait (&dlna_src->prefetch_cond, &dlna_src->prefetch_mutex);
+  g_mutex_unlock (&dlna_src->prefetch_mutex);
+}
 
-        GST_DEBUG("Sending serverside_pacing custom downstream event\n");
+/**
+ * Runs on the HEAD worker, removes the prefetch timer and cancels the
+ * prefetch in flight.
+ */
+static gboolean
+dlna_src_prefetch_remove (gpointer data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) data;
 
-        if (gst_pad_push_event (dlna_src->src_pad, event) != TRUE)
-        {
-           event = NULL;
-           GST_WARNING("Sending custom downstream event failed!");
-           break;
-        }
+  if (dlna_src->prefetch_source) {
+    g_source_destroy (dlna_src->prefetch_source);
+    g_source_unref (dlna_src->prefetch_source);
+    dlna_src->prefetch_source = NULL;
+  }
 
-        if(TRUE == enable)
-        {
-           strncpy(video_mask_str, "i_only", sizeof(video_mask_str));
-        }
-        else
-        {
-           strncpy(video_mask_str, "all", sizeof(video_mask_str));
-        }
+  if (dlna_src->prefetch_msg)
+    soup_session_cancel_message (dlna_src->prefetch_session,
+        dlna_src->prefetch_msg, SOUP_STATUS_CANCELLED);
 
-        structure = gst_structure_new("video-mask", "video-mask-str", G_TYPE_STRING, video_mask_str, NULL);
-        if(NULL == structure)
-        {
-           GST_ERROR("Error creating video-mask structure\n");
-           break;
-        }
+  g_mutex_lock (&dlna_src->prefetch_mutex);
+  dlna_src->prefetch_stopped = TRUE;
+  g_cond_broadcast (&dlna_src->prefetch_cond);
+  g_mutex_unlock (&dlna_src->prefetch_mutex);
 
-        event = gst_event_new_custom(GST_EVENT_CUSTOM_DOWNSTREAM, structure);
-        if(NULL == event)
-        {
-           gst_structure_free(structure);
-           structure = NULL;
-           GST_ERROR("Error creating video-mask event\n");
-           break;
-        }
+  return FALSE;
+}
 
-        GST_DEBUG("Sending video-mask custom downstream event\n");
+/**
+ * Prefetch timer callback, runs on the HEAD worker.  Re-aims the prefetch
+ * and arms the timer again.
+ */
+static gboolean
+dlna_src_prefetch_timer_cb (gpointer data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) data;
 
-        if (gst_pad_push_event (dlna_src->src_pad, event) != TRUE)
-        {
-           event = NULL;
-           GST_WARNING("Sending custom downstream event failed!");
-           break;
-        }
-        ret = TRUE;
+  if (dlna_src->prefetch_source)
+    g_source_unref (dlna_src->prefetch_source);
+
+  dlna_src_prefetch_aim (dlna_src);
+
+  dlna_src->prefetch_source = g_timeout_source_new (PREFETCH_INTERVAL_MSECS);
+  g_source_set_callback (dlna_src->prefetch_source,
+      dlna_src_prefetch_timer_cb, dlna_src, NULL);
+  g_source_attach (dlna_src->prefetch_source, dlna_src->head_context);
 
-     }while(0);
-     
-     return ret;
-  }
-  
-  GST_DEBUG_OBJECT (dlna_src,
-      "returning false to make sure souphttpsrc gets chance to process");
   return FALSE;
 }
 
 /**
- * Determines if the requested rate and/or position change is valid.  Seek type is
- * ignored since the position is always treated as absolute since a position must be
- * included as part of the HTTP request otherwise zero is assumed.
- *
- * @param	dlna_src    this element
- * @param	rate        new requested rate
- * @param	format      format of change, either bytes or time
- * @param	start       new starting position, either in bytes or time depending on format
- * @param   start_type  starting seek type, either none, relative or absolute
- * @param   stop        new stop position, either in bytes or time depending on format
- * @param   stop_type   stop seek type, either none, relative or absolute
- *
- * @return	true if change is valid, false otherwise
+ * Predict where trick play will be left from the rate and the time since
+ * it started, and fetch a range of bytes centered on that position unless
+ * the range already fetched or in flight is close enough.  Runs on the HEAD
+ * worker, so positions are converted from the seek index, or from the
+ * average bitrate, without asking the server.
  *
+ * @param dlna_src  this element
  */
-static gboolean
-dlna_src_is_change_valid (GstDlnaSrc * dlna_src, gfloat rate,
-    GstFormat format, guint64 start,
-    GstSeekType start_type, guint64 stop, GstSeekType stop_type)
+static void
+dlna_src_prefetch_aim (GstDlnaSrc * dlna_src)
 {
-  gchar *live_content_head_request_headers[][2] =
-      { {HEADER_GET_AVAILABLE_SEEK_RANGE_TITLE,
-      HEADER_GET_AVAILABLE_SEEK_RANGE_VALUE}
-  };
-
-  gsize live_content_head_request_headers_size = 1;
-  GST_INFO_OBJECT (dlna_src, "Called");
-
-  if ((rate == 1.0) || (dlna_src_is_rate_supported (dlna_src, rate))) {
-    GST_INFO_OBJECT (dlna_src, "New rate of %4.1f is supported by server",
-        rate);
-  } else {
-    GST_WARNING_OBJECT (dlna_src, "Rate of %4.1f is not supported by server",
-        rate);
-    return FALSE;
+  SoupMessage *msg = NULL;
+  gint64 base_time;
+  guint64 base_npt;
+  gfloat rate;
+  gdouble landing_npt;
+  guint64 npt_end;
+  guint64 landing;
+  guint64 size;
+  guint64 start;
+  guint64 end;
+  gchar range[64];
+
+  if (dlna_src->head_closing || !dlna_src->http_uri ||
+      !dlna_src->byte_total || !dlna_src->npt_duration_nanos)
+    return;
+
+  g_mutex_lock (&dlna_src->prefetch_mutex);
+  base_time = dlna_src->prefetch_base_time;
+  base_npt = dlna_src->prefetch_base_npt;
+  rate = dlna_src->prefetch_rate;
+  g_mutex_unlock (&dlna_src->prefetch_mutex);
+
+  npt_end = dlna_src->npt_end_nanos ? dlna_src->npt_end_nanos :
+      dlna_src->npt_duration_nanos;
+  landing_npt = (gdouble) base_npt + rate *
+      ((g_get_monotonic_time () - base_time) / G_TIME_SPAN_MILLISECOND +
+      PREFETCH_LEAD_MSECS) * GST_MSECOND;
+  landing_npt = CLAMP (landing_npt, (gdouble) dlna_src->npt_start_nanos,
+      (gdouble) npt_end);
+
+  if (!dlna_src_seek_index_lookup (dlna_src, TRUE, (guint64) landing_npt,
+          SEEK_INDEX_MAX_GAP_SECS * GST_SECOND, &landing))
+    landing = gst_util_uint64_scale ((guint64) landing_npt,
+        dlna_src->byte_total, dlna_src->npt_duration_nanos);
+
+  size = gst_util_uint64_scale (dlna_src->byte_total,
+      (guint64) dlna_src->prefetch_duration * GST_MSECOND,
+      dlna_src->npt_duration_nanos);
+  size = CLAMP (size, MIN_PREFETCH_BYTES, MAX_PREFETCH_BYTES);
+
+  start = (landing > size / 2) ? landing - size / 2 : 0;
+  start = MAX (start, dlna_src->byte_start);
+  end = MIN (start + size, dlna_src->byte_total);
+  if (end <= start)
+    return;
+
+  /* Still close to the range fetched or in flight */
+  if ((dlna_src->prefetch_aim_end > dlna_src->prefetch_aim_start) &&
+      (ABS ((gint64) start - (gint64) dlna_src->prefetch_aim_start) <
+          (gint64) (size / 4)))
+    return;
+
+  if (dlna_src->prefetch_msg)
+    soup_session_cancel_message (dlna_src->prefetch_session,
+        dlna_src->prefetch_msg, SOUP_STATUS_CANCELLED);
+
+  /* Own connection so prefetched ranges never queue behind, or hold up,
+   * the HEAD requests of every instance on the shared session */
+  if (!dlna_src->prefetch_session)
+    dlna_src->prefetch_session =
+        soup_session_async_new_with_options (SOUP_SESSION_ASYNC_CONTEXT,
+        dlna_src->head_context, SOUP_SESSION_TIMEOUT,
+        PARALLEL_STALL_TIMEOUT_SECS, SOUP_SESSION_MAX_CONNS, 1,
+        SOUP_SESSION_MAX_CONNS_PER_HOST, 1, NULL);
+
+  msg = soup_message_new (SOUP_METHOD_GET, dlna_src->http_uri);
+  if (!msg) {
+    GST_WARNING_OBJECT (dlna_src, "Unable to create prefetch request");
+    return;
   }
 
-  if (format == GST_FORMAT_BYTES) {
-    if (dlna_src->byte_seek_supported) {
+  g_snprintf (range, sizeof (range), "bytes=%" G_GUINT64_FORMAT "-%"
+      G_GUINT64_FORMAT, start, end - 1);
+  soup_message_headers_append (msg->request_headers,
+      HEADER_RANGE_BYTES_TITLE, range);
+  soup_message_headers_append (msg->request_headers,
+      "transferMode.dlna.org", "Streaming");
 
-      if (start < dlna_src->byte_start || start > dlna_src->byte_end) {
-        GST_WARNING_OBJECT (dlna_src,
-            "Specified start byte %" G_GUINT64_FORMAT
-            " is not valid, valid range: %" G_GUINT64_FORMAT
-            " to %" G_GUINT64_FORMAT, start,
-            dlna_src->byte_start, dlna_src->byte_end);
-        return FALSE;
-      } else
-        GST_INFO_OBJECT (dlna_src,
-            "Specified start byte %"
-            G_GUINT64_FORMAT " is valid, valid range: %" G_GUINT64_FORMAT
-            " to %" G_GUINT64_FORMAT, start,
-            dlna_src->byte_start, dlna_src->byte_end);
-    } else {
-      GST_WARNING_OBJECT (dlna_src, "Server does not support byte based seeks");
-      return FALSE;
-    }
-  } else if (format == GST_FORMAT_TIME) {
-    if (dlna_src->time_seek_supported) {
+  GST_DEBUG_OBJECT (dlna_src, "Prefetching %s around %" GST_TIME_FORMAT,
+      range, GST_TIME_ARGS ((guint64) landing_npt));
 
-      if ((dlna_src->is_live) || (dlna_src->is_recInProgress)) {
-        GST_INFO_OBJECT (dlna_src, "Update live content range info");
-        if (!dlna_src_soup_issue_head (dlna_src,
-                live_content_head_request_headers_size,
-                live_content_head_request_headers, dlna_src->server_info,
-                TRUE)) {
-          GST_ERROR_OBJECT (dlna_src,
-              "Problems issuing HEAD request to get live content information");
-          return FALSE;
-        }
+  dlna_src->prefetch_aim_start = start;
+  dlna_src->prefetch_aim_end = end;
 
-        g_object_set (G_OBJECT (dlna_src->http_src), "content-size",
-            dlna_src->byte_total, NULL);
-        GST_INFO_OBJECT (dlna_src,
-            "Set HTTP src content size: %" G_GUINT64_FORMAT,
-            dlna_src->byte_total);
-      }
+  /* Counted as a HEAD request so the session outlives it */
+  g_mutex_lock (&dlna_src->head_mutex);
+  dlna_src->head_requests_pending++;
+  g_mutex_unlock (&dlna_src->head_mutex);
 
-      if (start < dlna_src->npt_start_nanos || start > dlna_src->npt_end_nanos) {
-        GST_WARNING_OBJECT (dlna_src,
-            "Specified start time %" GST_TIME_FORMAT
-            " is not valid, valid range: %" GST_TIME_FORMAT
-            " to %" GST_TIME_FORMAT, GST_TIME_ARGS (start),
-            GST_TIME_ARGS (dlna_src->npt_start_nanos),
-            GST_TIME_ARGS (dlna_src->npt_end_nanos));
-        return FALSE;
-      }
-    } else {
-      GST_WARNING_OBJECT (dlna_src, "Server does not support time based seeks");
-      return FALSE;
-    }
-  } else {
-    GST_WARNING_OBJECT (dlna_src, "Supplied format type is not supported: %d",
-        format);
-    return FALSE;
-  }
+  dlna_src->prefetch_msg = msg;
+  /* Session takes ownership of the message */
+  soup_session_queue_message (dlna_src->prefetch_session, msg,
+      dlna_src_prefetch_done, dlna_src);
+}
 
-  GST_DEBUG_OBJECT (dlna_src, "Requested change is valid");
+/**
+ * Session callback of a prefetch request, keeps the data received.
+ */
+static void
+dlna_src_prefetch_done (SoupSession * session, SoupMessage * soup_msg,
+    gpointer user_data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) user_data;
+  SoupBuffer *body = NULL;
+  goffset start = 0;
+  goffset end = 0;
+  goffset total = 0;
+
+  if (dlna_src->prefetch_msg == soup_msg)
+    dlna_src->prefetch_msg = NULL;
+
+  if ((soup_msg->status_code == HTTP_STATUS_PARTIAL) &&
+      (soup_msg->response_body->length > 0) &&
+      soup_message_headers_get_content_range (soup_msg->response_headers,
+          &start, &end, &total)) {
+    body = soup_message_body_flatten (soup_msg->response_body);
+
+    g_mutex_lock (&dlna_src->prefetch_mutex);
+    if (dlna_src->prefetch_data)
+      g_bytes_unref (dlna_src->prefetch_data);
+    dlna_src->prefetch_data = g_bytes_new_with_free_func (body->data,
+        body->length, (GDestroyNotify) soup_buffer_free, body);
+    dlna_src->prefetch_offset = start;
+    g_mutex_unlock (&dlna_src->prefetch_mutex);
+
+    GST_DEBUG_OBJECT (dlna_src, "Prefetched %" G_GSIZE_FORMAT
+        " bytes at offset %" G_GINT64_FORMAT, body->length, (gint64) start);
+  } else if (soup_msg->status_code != SOUP_STATUS_CANCELLED)
+    GST_INFO_OBJECT (dlna_src, "Prefetch failed: %d %s",
+        soup_msg->status_code, soup_msg->reason_phrase);
 
-  return TRUE;
+  g_mutex_lock (&dlna_src->head_mutex);
+  dlna_src->head_requests_pending--;
+  g_cond_broadcast (&dlna_src->head_cond);
+  g_mutex_unlock (&dlna_src->head_mutex);
 }
 
 /**
- * Determines if current rate is supported by server based on current
- * URI and HEAD response.
+ * Drop prefetched data, e.g. when the content changes.
  *
- * @param dlna_src		this element
- * @param rate			requested rate
- *
- * @return	true if requested rate is supported by server, false otherwise
+ * @param dlna_src  this element
  */
-static gboolean
-dlna_src_is_rate_supported (GstDlnaSrc * dlna_src, gfloat rate)
+static void
+dlna_src_prefetch_clear (GstDlnaSrc * dlna_src)
 {
-  gboolean is_supported = FALSE;
-  int i = 0;
+  g_mutex_lock (&dlna_src->prefetch_mutex);
+  if (dlna_src->prefetch_data) {
+    g_bytes_unref (dlna_src->prefetch_data);
+    dlna_src->prefetch_data = NULL;
+  }
+  dlna_src->prefetch_offset = 0;
+  g_mutex_unlock (&dlna_src->prefetch_mutex);
+}
 
-  if (!dlna_src->time_seek_supported) {
-    GST_WARNING_OBJECT (dlna_src,
-        "Unable to change rate, not supported by server");
+/**
+ * Serve a 1x seek from prefetched data when it holds the new position.
+ *
+ * @param dlna_src  this element
+ * @param format    format of start
+ * @param start     position to resume from
+ * @param seqnum    sequence number of the seek event
+ *
+ * @return  TRUE if served from prefetched data, FALSE otherwise
+ */
+static gboolean
+dlna_src_prefetch_serve (GstDlnaSrc * dlna_src, GstFormat format,
+    guint64 start, guint32 seqnum)
+{
+#if GST_CHECK_VERSION(1,0,0)
+  GBytes *data = NULL;
+  guint64 data_offset = 0;
+  guint64 data_end;
+  guint64 offset = start;
+  gsize size;
+
+  g_mutex_lock (&dlna_src->prefetch_mutex);
+  if (dlna_src->prefetch_data) {
+    data = g_bytes_ref (dlna_src->prefetch_data);
+    data_offset = dlna_src->prefetch_offset;
+  }
+  g_mutex_unlock (&dlna_src->prefetch_mutex);
+
+  if (!data)
+    return FALSE;
+
+  size = g_bytes_get_size (data);
+  data_end = data_offset + size;
+
+  if ((format == GST_FORMAT_TIME) &&
+      !dlna_src_convert_npt_nanos_to_bytes (dlna_src, start, &offset)) {
+    g_bytes_unref (data);
     return FALSE;
   }
 
-  /* Look through list of server supported playspeeds and verify rate is supported */
-  for (i = 0; i < dlna_src->server_info->content_features->playspeeds_cnt; i++) {
-    if (dlna_src->server_info->content_features->playspeeds[i] == rate) {
-      is_supported = TRUE;
-      break;
-    }
+  /* Only worth it when a good part of the data is still ahead */
+  if ((offset < data_offset) || (offset + size / 4 > data_end)) {
+    GST_DEBUG_OBJECT (dlna_src, "Offset %" G_GUINT64_FORMAT
+        " not in prefetched %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT,
+        offset, data_offset, data_end);
+    g_bytes_unref (data);
+    return FALSE;
   }
 
-  return is_supported;
+  GST_INFO_OBJECT (dlna_src, "Serving %" G_GUINT64_FORMAT
+      " prefetched bytes from offset %" G_GUINT64_FORMAT,
+      data_end - offset, offset);
+
+  return dlna_src_splice_start (dlna_src, data, data_offset, offset, seqnum);
+#else
+  return FALSE;
+#endif
 }
 
+#if GST_CHECK_VERSION(1,0,0)
 /**
- * Create extra headers to supply to soup http src based on requested starting
- * postion and rate.  Instruct souphttpsrc to exclude range header if it conflicts
- * with any of the extra headers which have been added.
+ * Prepare to resume from data dlnasrc pushes itself: souphttpsrc is
+ * restarted at the end of that data, so playback resumes without waiting
+ * for the server.  The segment souphttpsrc sends once its request completes
+ * is held until the splice thread has pushed the data and then dropped, so
+ * its data follows on seamlessly.  On success the caller starts the splice
+ * thread.
  *
- * @param	dlna_src 	this element
- * @param	rate		requested rate to include in playspeed header
- * @param	format		create either time or byte based seek header
- * @param	start		starting position to include, will be either bytes or time depending on format
- * @param   stop        stopping position to include, will be -1 if unspecified
+ * @param dlna_src  this element
+ * @param resume    byte offset souphttpsrc resumes from
+ * @param seqnum    sequence number of the seek event
  *
- * @return	true if extra headers were successfully created, false otherwise
+ * @return  TRUE if souphttpsrc was restarted, FALSE otherwise
  */
 static gboolean
-dlna_src_adjust_http_src_headers (GstDlnaSrc * dlna_src, gfloat rate,
-    GstFormat format, guint64 start, guint64 stop, guint32 new_seqnum)
+dlna_src_splice_begin (GstDlnaSrc * dlna_src, guint64 resume, guint32 seqnum)
 {
-  GValue struct_value = G_VALUE_INIT;
-  GstStructure *extra_headers_struct;
-
-  gboolean disable_range_header = FALSE;
-  int i = 0;
-  gchar *rateStr = NULL;
-
-  const gchar *playspeed_field_name = "PlaySpeed.dlna.org";
-  const gchar *playspeed_field_value_prefix = "speed=";
-  gchar playspeed_field_value[64] = { 0 };
-
-  const gchar *time_seek_range_field_name = "TimeSeekRange.dlna.org";
-  const gchar *time_seek_range_field_value_prefix = "npt=";
-  gchar time_seek_range_field_value[64] = { 0 };
-  guint64 start_time_nanos;
-  guint64 start_time_secs;
-  guint64 stop_time_nanos = GST_CLOCK_TIME_NONE;
-  guint64 stop_time_secs;
-
-  const gchar *range_dtcp_field_name = "Range.dtcp.com";
-  const gchar *range_dtcp_field_value_prefix = "bytes=";
-  gchar range_dtcp_field_value[64] = { 0 };
-
-  /* Make sure range header is included by default */
-  GValue boolean_value = G_VALUE_INIT;
-  g_value_init (&boolean_value, G_TYPE_BOOLEAN);
-  g_value_set_boolean (&boolean_value, FALSE);
-  g_object_set_property (G_OBJECT (dlna_src->http_src), "exclude-range-header",
-      &boolean_value);
+  gboolean seeked = FALSE;
+
+  dlna_src_parallel_leave (dlna_src);
+
+  g_mutex_lock (&dlna_src->splice_mutex);
+  dlna_src->splice_pending = TRUE;
+  dlna_src->splice_seeking = TRUE;
+  g_mutex_unlock (&dlna_src->splice_mutex);
+
+  if (!dlna_src->dlna_uri || !dlna_src->server_info ||
+      !dlna_src->server_info->content_features ||
+      dlna_src_adjust_http_src_headers (dlna_src, 1.0, GST_FORMAT_BYTES,
+          resume, GST_CLOCK_TIME_NONE, seqnum)) {
+    if (g_object_class_find_property (G_OBJECT_GET_CLASS (dlna_src->http_src),
+            "dlna-time-seek"))
+      g_object_set (dlna_src->http_src, "dlna-time-seek", FALSE, NULL);
+    seeked = gst_element_seek_simple (dlna_src->http_src, GST_FORMAT_BYTES,
+        GST_SEEK_FLAG_FLUSH, resume);
+  }
 
-  /* Create header structure with dlna transfer mode header */
-  extra_headers_struct = gst_structure_new ("extraHeadersStruct",
-      "transferMode.dlna.org", G_TYPE_STRING, "Streaming", NULL);
-  if (extra_headers_struct == NULL) {
-    GST_WARNING_OBJECT (dlna_src, "Problems creating extra headers structure");
+  /* A previous splice ended with the flush */
+  dlna_src_splice_join (dlna_src);
+
+  g_mutex_lock (&dlna_src->splice_mutex);
+  dlna_src->splice_seeking = FALSE;
+  if (!seeked) {
+    dlna_src->splice_pending = FALSE;
+    g_cond_broadcast (&dlna_src->splice_cond);
+    g_mutex_unlock (&dlna_src->splice_mutex);
+
+    GST_WARNING_OBJECT (dlna_src, "Unable to restart souphttpsrc after "
+        "spliced data");
+    if (dlna_src->dlna_uri && dlna_src->server_info &&
+        dlna_src->server_info->content_features)
+      dlna_src_adjust_http_src_headers (dlna_src, dlna_src->requested_rate,
+          dlna_src->requested_format, dlna_src->requested_start,
+          dlna_src->requested_stop, seqnum);
     return FALSE;
   }
+  dlna_src->splice_pushing = TRUE;
+  dlna_src->splice_seqnum = seqnum;
+  g_mutex_unlock (&dlna_src->splice_mutex);
 
-  /* If rate != 1.0, add playspeed header and time seek range header */
-  if (rate != 1.0) {
-    /* Get string representation of rate (use original values to make fractions easy like 1/3) */
-    for (i = 0; i < dlna_src->server_info->content_features->playspeeds_cnt;
-        i++) {
-      if (dlna_src->server_info->content_features->playspeeds[i] == rate) {
-        rateStr = dlna_src->server_info->content_features->playspeed_strs[i];
-        break;
-      }
-    }
-    if (rateStr == NULL) {
-      GST_ERROR_OBJECT (dlna_src,
-          "Unable to get string representation of supported rate: %lf", rate);
-      return FALSE;
-    }
-    g_snprintf (playspeed_field_value, 64, "%s%s",
-        playspeed_field_value_prefix, rateStr);
+  return TRUE;
+}
+#endif
 
-    gst_structure_set (extra_headers_struct, playspeed_field_name,
-        G_TYPE_STRING, &playspeed_field_value, NULL);
-    GST_INFO_OBJECT (dlna_src,
-        "Adjust headers by including playspeed header value: %s",
-        playspeed_field_value);
+/**
+ * Resume from data held in memory, spliced in ahead of souphttpsrc.
+ *
+ * @param dlna_src      this element
+ * @param data          data to push, ownership is taken
+ * @param data_offset   byte offset of data in the content
+ * @param offset        byte offset to resume from, within data
+ * @param seqnum        sequence number of the seek event
+ *
+ * @return  TRUE if splicing started, FALSE otherwise
+ */
+static gboolean
+dlna_src_splice_start (GstDlnaSrc * dlna_src, GBytes * data,
+    guint64 data_offset, guint64 offset, guint32 seqnum)
+{
+#if GST_CHECK_VERSION(1,0,0)
+  if (!dlna_src_splice_begin (dlna_src,
+          data_offset + g_bytes_get_size (data), seqnum)) {
+    g_bytes_unref (data);
+    return FALSE;
   }
 
-  /* Add time seek header for all non 1x rates or for time based seeks */
-  if (rate != 1.0 || (format == GST_FORMAT_TIME
-          && dlna_src->time_seek_supported)) {
-    if (format != GST_FORMAT_TIME) {
-      if (!dlna_src_convert_bytes_to_npt_nanos (dlna_src, start,
-              &start_time_nanos)) {
-        GST_WARNING_OBJECT (dlna_src,
-            "Problems converting start %" G_GUINT64_FORMAT " to npt ", start);
-        return FALSE;
-      } else
-        GST_INFO_OBJECT (dlna_src,
-            "Due to non 1x playspeed, converted start %" G_GUINT64_FORMAT
-            " bytes into time %" G_GUINT64_FORMAT, start, start_time_nanos);
+  g_mutex_lock (&dlna_src->splice_mutex);
+  dlna_src->splice_data = data;
+  dlna_src->splice_data_offset = data_offset;
+  dlna_src->splice_offset = offset;
+  g_mutex_unlock (&dlna_src->splice_mutex);
 
-      if (stop > GST_CLOCK_TIME_NONE) {
-        if (!dlna_src_convert_bytes_to_npt_nanos (dlna_src, stop,
-                &stop_time_nanos)) {
-          GST_WARNING_OBJECT (dlna_src,
-              "Problems converting stop %" G_GUINT64_FORMAT " to npt ", stop);
-          return FALSE;
-        } else
-          GST_INFO_OBJECT (dlna_src,
-              "Due to non 1x playspeed, converted stop %" G_GUINT64_FORMAT
-              " bytes into time %" G_GUINT64_FORMAT, start, start_time_nanos);
-      } else
-        GST_INFO_OBJECT (dlna_src, "Stop undefined, no conversion needed");
-    } else {
-      /* Already in time format, no conversion necessary */
-      start_time_nanos = start;
-      stop_time_nanos = stop;
-      GST_INFO_OBJECT (dlna_src,
-          "Using start %" G_GUINT64_FORMAT " and stop %" G_GUINT64_FORMAT,
-          start_time_nanos, stop_time_nanos);
-    }
+  dlna_src->splice_thread = g_thread_new ("dlnasrc_splice",
+      dlna_src_splice_thread_func, dlna_src);
 
-    /* Convert time from nanos into secs for header value string */
-    start_time_secs = start_time_nanos / GST_SECOND;
+  return TRUE;
+#else
+  g_bytes_unref (data);
+  return FALSE;
+#endif
+}
 
-    if (stop_time_nanos == GST_CLOCK_TIME_NONE) {
-      GST_INFO_OBJECT (dlna_src,
-          "Stop time is undefined, just including start time");
-      g_snprintf (time_seek_range_field_value, 64,
-          "%s%" G_GUINT64_FORMAT ".0-", time_seek_range_field_value_prefix,
-          start_time_secs);
-    } else {
-      stop_time_secs = stop_time_nanos / GST_SECOND;
-      GST_INFO_OBJECT (dlna_src, "Including stop secs: %" G_GUINT64_FORMAT,
-          stop_time_secs);
-      g_snprintf (time_seek_range_field_value, 64,
-          "%s%" G_GUINT64_FORMAT ".0-%" G_GUINT64_FORMAT ".0",
-          time_seek_range_field_value_prefix, start_time_secs, stop_time_secs);
-    }
-    gst_structure_set (extra_headers_struct, time_seek_range_field_name,
-        G_TYPE_STRING, &time_seek_range_field_value, NULL);
+/**
+ * Append data on its way out of the bin to the cache, a ring holding the
+ * most recent cache-size bytes.  Data fetched again after a seek replaces
+ * what the cache holds from its offset on, data at any other offset starts
+ * the cache over.
+ *
+ * @param dlna_src  this element
+ * @param offset    byte offset of data in the content
+ * @param data      data to append
+ * @param size      number of bytes in data
+ */
+static void
+dlna_src_cache_write (GstDlnaSrc * dlna_src, guint64 offset,
+    const guint8 * data, gsize size)
+{
+  gsize drop;
+  gsize len;
 
-    GST_INFO_OBJECT (dlna_src,
-        "Adjust headers by including TimeSeekRange header value: %s",
-        time_seek_range_field_value);
+  g_mutex_lock (&dlna_src->cache_mutex);
+  if (!dlna_src->cache_size) {
+    g_mutex_unlock (&dlna_src->cache_mutex);
+    return;
+  }
 
-    /* Set flag so range header is not included by souphttpsrc */
-    disable_range_header = TRUE;
+  if (!dlna_src->cache_data) {
+    dlna_src->cache_data = g_malloc (dlna_src->cache_size);
+    dlna_src->cache_head = 0;
+    dlna_src->cache_fill = 0;
+    dlna_src->cache_end = offset;
+  }
 
-    /* Record seqnum since have handled this event as time based seek */
-    dlna_src->handled_time_seek_seqnum = TRUE;
-  } else
-    GST_INFO_OBJECT (dlna_src,
-        "Not adjusting with playspeed or time seek range ");
+  if ((offset < dlna_src->cache_end) &&
+      (offset >= dlna_src->cache_end - dlna_src->cache_fill)) {
+    drop = dlna_src->cache_end - offset;
+    dlna_src->cache_head = (dlna_src->cache_head + dlna_src->cache_size -
+        drop) % dlna_src->cache_size;
+    dlna_src->cache_fill -= drop;
+  } else if (offset != dlna_src->cache_end) {
+    GST_DEBUG_OBJECT (dlna_src, "Restarting cache at offset %"
+        G_GUINT64_FORMAT, offset);
+    dlna_src->cache_head = 0;
+    dlna_src->cache_fill = 0;
+  }
+  dlna_src->cache_end = offset + size;
+  dlna_src->cache_fill = MIN (dlna_src->cache_fill + size,
+      dlna_src->cache_size);
+
+  /* Only the tail of data larger than the cache is kept */
+  if (size > dlna_src->cache_size) {
+    data += size - dlna_src->cache_size;
+    size = dlna_src->cache_size;
+  }
 
-  if (format == GST_FORMAT_TIME && !dlna_src->time_seek_supported) {
-    GST_INFO_OBJECT (dlna_src,
-        "Saving start time incase get this event again in bytes in order to do acurate conversion");
-    dlna_src->time_seek_event_start = start;
+  while (size > 0) {
+    len = MIN (size, dlna_src->cache_size - dlna_src->cache_head);
+    memcpy (dlna_src->cache_data + dlna_src->cache_head, data, len);
+    dlna_src->cache_head = (dlna_src->cache_head + len) %
+        dlna_src->cache_size;
+    data += len;
+    size -= len;
   }
+  g_mutex_unlock (&dlna_src->cache_mutex);
+}
 
-  /* If dtcp protected content and rate = 1.0, add range.dtcp.com header */
-  if (rate == 1.0 && format == GST_FORMAT_BYTES
-      && dlna_src->is_encrypted && dlna_src->byte_seek_supported) {
-    g_snprintf (range_dtcp_field_value, 64, "%s%" G_GUINT64_FORMAT "-",
-        range_dtcp_field_value_prefix, start);
+/**
+ * Serve a 1x byte seek from the cache when it holds the new position, by
+ * splicing the cached data from there on.  Encrypted content and content
+ * going through dtcpip is never served, the offsets of data leaving dtcpip
+ * do not match those of the encrypted stream a byte seek refers to.
+ *
+ * @param dlna_src  this element
+ * @param offset    byte offset to resume from
+ * @param seqnum    sequence number of the seek event
+ *
+ * @return  TRUE if served from the cache, FALSE otherwise
+ */
+static gboolean
+dlna_src_cache_serve (GstDlnaSrc * dlna_src, guint64 offset, guint32 seqnum)
+{
+#if GST_CHECK_VERSION(1,0,0)
+  guint8 *copy;
+  gsize size;
+  gsize pos;
+  gsize len;
 
-    gst_structure_set (extra_headers_struct, range_dtcp_field_name,
-        G_TYPE_STRING, &range_dtcp_field_value, NULL);
+  if (dlna_src->is_encrypted || dlna_src->dtcp_decrypter)
+    return FALSE;
 
-    GST_INFO_OBJECT (dlna_src,
-        "Adjust headers by including Range.dtcp.com header value: %s",
-        range_dtcp_field_value);
+  g_mutex_lock (&dlna_src->cache_mutex);
+  if (!dlna_src->cache_fill ||
+      (offset < dlna_src->cache_end - dlna_src->cache_fill) ||
+      (offset >= dlna_src->cache_end)) {
+    GST_DEBUG_OBJECT (dlna_src, "Offset %" G_GUINT64_FORMAT
+        " not in cached %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT, offset,
+        dlna_src->cache_end - dlna_src->cache_fill, dlna_src->cache_end);
+    g_mutex_unlock (&dlna_src->cache_mutex);
+    return FALSE;
+  }
 
-    /* Set flag so range header is not included by souphttpsrc */
-    disable_range_header = TRUE;
-  } else
-    GST_INFO_OBJECT (dlna_src, "Not adjusting with range.dtcp.com");
+  size = dlna_src->cache_end - offset;
+  copy = g_malloc (size);
+  pos = (dlna_src->cache_head + dlna_src->cache_size - size) %
+      dlna_src->cache_size;
+  len = MIN (size, dlna_src->cache_size - pos);
+  memcpy (copy, dlna_src->cache_data + pos, len);
+  memcpy (copy + len, dlna_src->cache_data, size - len);
+  g_mutex_unlock (&dlna_src->cache_mutex);
 
-  g_value_init (&struct_value, GST_TYPE_STRUCTURE);
-  gst_value_set_structure (&struct_value, extra_headers_struct);
-  g_object_set_property (G_OBJECT (dlna_src->http_src), "extra-headers",
-      &struct_value);
-  gst_structure_free (extra_headers_struct);
+  GST_INFO_OBJECT (dlna_src, "Serving %" G_GSIZE_FORMAT
+      " cached bytes from offset %" G_GUINT64_FORMAT, size, offset);
 
-  if(GST_FORMAT_TIME == format)
-  {
-     g_value_set_boolean (&boolean_value, TRUE);
-     g_object_set_property (G_OBJECT (dlna_src->http_src),
-           "dlna-time-seek", &boolean_value);
+  return dlna_src_splice_start (dlna_src, g_bytes_new_take (copy, size),
+      offset, offset, seqnum);
+#else
+  return FALSE;
+#endif
+}
+
+/**
+ * Empty the cache and release its memory, e.g. when the content changes.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_cache_clear (GstDlnaSrc * dlna_src)
+{
+  g_mutex_lock (&dlna_src->cache_mutex);
+  g_free (dlna_src->cache_data);
+  dlna_src->cache_data = NULL;
+  dlna_src->cache_head = 0;
+  dlna_src->cache_fill = 0;
+  dlna_src->cache_end = 0;
+  g_mutex_unlock (&dlna_src->cache_mutex);
+}
+
+#if GST_CHECK_VERSION(1,0,0)
+/**
+ * Probe on the internal pad of the src ghost pad which caches data on its
+ * way out of the bin.  Offsets are tracked from byte segments and from
+ * souphttpsrc buffer offsets.  Nothing is cached with dtcpip in the bin,
+ * its output does not line up with the offsets of the encrypted stream.
+ */
+static GstPadProbeReturn
+dlna_src_cache_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstDlnaSrc *dlna_src = GST_DLNA_SRC (user_data);
+  const GstSegment *segment;
+  GstEvent *event;
+  GstBuffer *buffer;
+  GstMapInfo map;
+
+  if (!dlna_src->cache_size || dlna_src->is_encrypted ||
+      dlna_src->dtcp_decrypter)
+    return GST_PAD_PROBE_OK;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+    event = GST_PAD_PROBE_INFO_EVENT (info);
+    if (GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT) {
+      gst_event_parse_segment (event, &segment);
+      if (segment->format == GST_FORMAT_BYTES)
+        dlna_src->cache_next = segment->start;
+    }
+    return GST_PAD_PROBE_OK;
   }
 
-  /* Disable range header if necessary */
-  if (disable_range_header || !dlna_src->byte_seek_supported) {
-    g_value_set_boolean (&boolean_value, TRUE);
-    g_object_set_property (G_OBJECT (dlna_src->http_src),
-        "exclude-range-header", &boolean_value);
-    GST_INFO_OBJECT (dlna_src,
-        "Adjust headers by excluding range header, flag: %d, supported: %d",
-        disable_range_header, dlna_src->byte_seek_supported);
+  buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+  if (GST_BUFFER_OFFSET_IS_VALID (buffer))
+    dlna_src->cache_next = GST_BUFFER_OFFSET (buffer);
+
+  if (gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+    dlna_src_cache_write (dlna_src, dlna_src->cache_next, map.data,
+        map.size);
+    gst_buffer_unmap (buffer, &map);
   }
+  dlna_src->cache_next += gst_buffer_get_size (buffer);
 
-  return TRUE;
+  return GST_PAD_PROBE_OK;
 }
+#endif
 
-static uri_parser_retcode dlna_src_parse_uri_get_key_val(GstDlnaSrc *dlna_src,
-                                                         gchar *uri,
-                                                         gchar *key,
-                                                         gchar *value,
-                                                         guint32 value_size)
-{
-   uri_parser_retcode ret = URI_PARSER_ERROR;
-   gint32         	 uri_parse_ret;
-   gint32         	 uri_dissect_ret;
-   UriUriA            uriParserUri;
-   UriQueryListA      *pOptionsList = NULL;
-   gint32             numOptions;
-   UriParserStateA 	 uriParserState;
-   UriQueryListA   	 *pOption = NULL;
-   gboolean           bKeyFound = FALSE;
+/**
+ * Fetch content which is not live from start on over concurrent range
+ * requests rather than the single request of souphttpsrc.  The range is
+ * split in chunks fetched on the HEAD worker over a session of its own,
+ * which an appsrc in the bin pushes downstream in order as they complete,
+ * see dlna_src_parallel_enter().  Encrypted content is not fetched in
+ * parallel since the chunks would bypass the decrypter.
+ *
+ * @param dlna_src  this element
+ * @param format    format of start
+ * @param start     position to fetch from
+ * @param seqnum    sequence number of the seek event
+ *
+ * @return  TRUE if fetching in parallel, FALSE otherwise
+ */
+static gboolean
+dlna_src_parallel_serve (GstDlnaSrc * dlna_src, GstFormat format,
+    guint64 start, guint32 seqnum)
+{
+#if GST_CHECK_VERSION(1,0,0)
+  guint64 offset = start;
 
-   do
-   {
-      if(NULL == dlna_src)
-      {
-         GST_ERROR_OBJECT(dlna_src, "Param dlna_src is NULL\n");
-         break;
-      }
-      if(NULL == uri)
-      {
-         GST_ERROR_OBJECT(dlna_src, "Param uri is NULL\n");
-         break;
-      }
-      if(NULL == key)
-      {
-         GST_ERROR_OBJECT(dlna_src, "Param key is NULL\n");
-         break;
-      }
-      if(NULL == value)
-      {
-         GST_ERROR_OBJECT(dlna_src, "Param value is NULL\n");
-         break;
-      }
+  if ((dlna_src->parallel_connections < 2) || dlna_src->is_live ||
+      !dlna_src->byte_seek_supported || !dlna_src->byte_total ||
+      dlna_src->is_encrypted || dlna_src->dtcp_decrypter ||
+      !dlna_src->head_context || !dlna_src->http_uri)
+    return FALSE;
 
-      uriParserState.uri = &uriParserUri;
-      uri_parse_ret = uriParseUriA(&uriParserState, uri);
-      if(URI_SUCCESS != uri_parse_ret)
-      {
-         GST_ERROR_OBJECT(dlna_src, "uriParseUriA(%s) failed - errcode: %d\n",
-               uri, uriParserState.errorCode);
-         if(URI_ERROR_SYNTAX == uriParserState.errorCode)
-         {
-            GST_ERROR_OBJECT(dlna_src, "URI syntax error\n");
-         }
-         break; 
-      }
+  if ((format == GST_FORMAT_TIME) &&
+      !dlna_src_convert_npt_nanos_to_bytes (dlna_src, start, &offset))
+    return FALSE;
 
-      uri_dissect_ret = uriDissectQueryMallocA(&pOptionsList, 
-            &numOptions, 
-            uriParserUri.query.first,
-            uriParserUri.query.afterLast); 
-      if(URI_SUCCESS != uri_dissect_ret)
-      {
-         GST_ERROR_OBJECT(dlna_src, "Error %d parsing uri (%s) into key/value pairs\n",
-               uri_dissect_ret, uri);
-         break;
-      }
+  if (offset >= dlna_src->byte_total)
+    return FALSE;
 
-      GST_INFO_OBJECT(dlna_src, "Total number of URI key value pairs = %d\n", numOptions);
+  GST_INFO_OBJECT (dlna_src, "Fetching from offset %" G_GUINT64_FORMAT
+      " over %u connections", offset, dlna_src->parallel_connections);
 
-      for (pOption = pOptionsList; pOption ;pOption = pOption->next) 
-      {
-         GST_INFO_OBJECT(dlna_src, "%s : %s\n", pOption->key, pOption->value);
+  return dlna_src_parallel_fetch (dlna_src, offset, PARALLEL_CHUNK_SIZE,
+      PARALLEL_CHUNK_SIZE, FALSE, 1.0, seqnum);
+#else
+  return FALSE;
+#endif
+}
 
-         if(!strcmp(pOption->key, key))
-         {
-            bKeyFound = TRUE;
-            if(strlen(pOption->value) >= value_size)
-            {
-               GST_ERROR_OBJECT(dlna_src, "size of value param is less than "
-                     "the value string for key: %s\n", key);
-               break;
-            }
-            g_strlcpy(value, pOption->value, value_size);
-            ret = URI_PARSER_SUCCESS;
-            break;
-         }
-      }
+/**
+ * Play a trick rate by fetching chunks strided over the content at 1x
+ * rather than all of it, see dlna_src_rate_ladder_plan().  Chunks are
+ * fetched and pushed like parallel range requests, each as a discontinuity.
+ * In I-frame stride mode only the part of a chunk from its first random
+ * access point on is pushed.  The segment pushed has rate 1.0 and the trick
+ * rate as applied rate, the data already plays at that rate.
+ *
+ * @param dlna_src  this element
+ * @param format    format of start
+ * @param start     position to stride from
+ * @param plan      plan of the rate, in a stride mode
+ * @param seqnum    sequence number of the seek event
+ *
+ * @return  TRUE if striding, FALSE otherwise
+ */
+static gboolean
+dlna_src_stride_serve (GstDlnaSrc * dlna_src, GstFormat format,
+    guint64 start, const GstDlnaSrcTrickPlan * plan, guint32 seqnum)
+{
+#if GST_CHECK_VERSION(1,0,0)
+  guint64 offset = start;
 
-      if(TRUE != bKeyFound)
-      {
-         ret = URI_PARSER_KEY_NOT_FOUND;
-      }
-   }while(0);
+  if (!plan->stride)
+    return FALSE;
 
-   uriFreeQueryListA(pOptionsList);
-   uriFreeUriMembersA(&uriParserUri);
+  if ((format == GST_FORMAT_TIME) &&
+      !dlna_src_convert_npt_nanos_to_bytes (dlna_src, start, &offset))
+    return FALSE;
 
-   return ret;
+  if (offset >= dlna_src->byte_total)
+    return FALSE;
+
+  GST_INFO_OBJECT (dlna_src, "Striding %" G_GINT64_FORMAT
+      " bytes from offset %" G_GUINT64_FORMAT " for rate %.2f", plan->stride,
+      offset, plan->client_factor * plan->server_rate);
+
+  return dlna_src_parallel_fetch (dlna_src, offset, plan->stride,
+      TRICK_STRIDE_CHUNK_SIZE, plan->mode == DLNA_SRC_TRICK_IFRAME_STRIDE,
+      plan->client_factor * plan->server_rate, seqnum);
+#else
+  return FALSE;
+#endif
 }
 
 #if GST_CHECK_VERSION(1,0,0)
-static guint
-gst_dlna_src_uri_get_type (GType type)
+/**
+ * Start fetching chunks of content over concurrent range requests, which
+ * the parallel appsrc pushes downstream in order.  Chunks start stride bytes
+ * apart from offset on, backwards when stride is negative, and fill the
+ * gap between them when stride is the chunk size.
+ *
+ * @param dlna_src      this element
+ * @param offset        byte offset of the first chunk
+ * @param stride        bytes from the start of a chunk to the next one
+ * @param chunk_size    bytes per chunk
+ * @param random_access push chunks of a transport stream from their first
+ *                      random access point on, drop those without one
+ * @param applied_rate  rate the chunks play at once pushed, 1.0 unless strided
+ * @param seqnum        sequence number of the seek event
+ *
+ * @return  TRUE if fetching, FALSE otherwise
+ */
+static gboolean
+dlna_src_parallel_fetch (GstDlnaSrc * dlna_src, guint64 offset,
+    gint64 stride, guint chunk_size, gboolean random_access,
+    gdouble applied_rate, guint32 seqnum)
 {
-  return GST_URI_SRC;
+  guint n_chunks;
+
+  if (stride > 0)
+    n_chunks = (dlna_src->byte_total - offset + stride - 1) / stride;
+  else
+    n_chunks = offset / (guint64) (-stride) + 1;
+
+  if (!dlna_src->parallel_session) {
+    dlna_src->parallel_session =
+        soup_session_async_new_with_options (SOUP_SESSION_ASYNC_CONTEXT,
+        dlna_src->head_context, SOUP_SESSION_TIMEOUT,
+        PARALLEL_STALL_TIMEOUT_SECS, SOUP_SESSION_MAX_CONNS,
+        dlna_src->parallel_connections, SOUP_SESSION_MAX_CONNS_PER_HOST,
+        dlna_src->parallel_connections, NULL);
+    if (!dlna_src->parallel_session) {
+      GST_WARNING_OBJECT (dlna_src, "Unable to create parallel session");
+      return FALSE;
+    }
+  }
+
+  /* Set up before the seek of the appsrc, whose flush leaves the chunks of
+   * the new fetch alone, requests of a previous fetch are ignored */
+  dlna_src_parallel_clear (dlna_src);
+
+  g_mutex_lock (&dlna_src->parallel_mutex);
+  dlna_src->parallel_generation++;
+  dlna_src->parallel_stopping = FALSE;
+  dlna_src->parallel_failed = FALSE;
+  dlna_src->parallel_seqnum = seqnum;
+  dlna_src->parallel_offset = offset;
+  dlna_src->parallel_stride = stride;
+  dlna_src->parallel_chunk_size = chunk_size;
+  dlna_src->parallel_random_access = random_access;
+  dlna_src->parallel_applied_rate = applied_rate;
+  dlna_src->parallel_n_chunks = n_chunks;
+  dlna_src->parallel_chunks = g_new0 (GBytes *, dlna_src->parallel_n_chunks);
+  dlna_src->parallel_next_fetch = 0;
+  dlna_src->parallel_next_push = 0;
+  dlna_src->parallel_in_flight = 0;
+  g_mutex_unlock (&dlna_src->parallel_mutex);
+
+  /* Requests of a previous fetch are cancelled before new ones are made */
+  g_main_context_invoke (dlna_src->head_context, dlna_src_parallel_cancel,
+      dlna_src);
+
+  if (!dlna_src_parallel_enter (dlna_src, offset, seqnum)) {
+    dlna_src_parallel_leave (dlna_src);
+    dlna_src_parallel_stop (dlna_src);
+    return FALSE;
+  }
+
+  g_main_context_invoke (dlna_src->head_context, dlna_src_parallel_fill,
+      dlna_src);
+
+  return TRUE;
 }
-#else
-static GstURIType
-gst_dlna_src_uri_get_type(void)
+
+/**
+ * Make the parallel appsrc the target of the src ghost pad in place of
+ * souphttpsrc, which is stopped rather than left holding a connection, and
+ * seek the appsrc to offset.  The appsrc is created on first use and its
+ * state is handled here rather than by the bin.  Its flushing seek carries
+ * the seqnum of the seek event through the flush and the segment.
+ *
+ * @param dlna_src  this element
+ * @param offset    byte offset of the first chunk
+ * @param seqnum    sequence number of the seek event
+ *
+ * @return  TRUE if the appsrc is in place and seeked, FALSE otherwise
+ */
+static gboolean
+dlna_src_parallel_enter (GstDlnaSrc * dlna_src, guint64 offset,
+    guint32 seqnum)
 {
-  return GST_URI_SRC;
+  GstPad *pad = NULL;
+  GstEvent *event = NULL;
+  gboolean active;
+
+  if (!dlna_src->parallel_src) {
+    dlna_src->parallel_src = gst_element_factory_make ("appsrc",
+        ELEMENT_NAME_PARALLEL_SRC);
+    if (!dlna_src->parallel_src) {
+      GST_WARNING_OBJECT (dlna_src, "Unable to create appsrc for parallel "
+          "requests");
+      return FALSE;
+    }
+
+    gst_util_set_object_arg (G_OBJECT (dlna_src->parallel_src),
+        "stream-type", "seekable");
+    g_object_set (G_OBJECT (dlna_src->parallel_src), "format",
+        GST_FORMAT_BYTES, "block", FALSE, "emit-signals", TRUE, NULL);
+    g_signal_connect (dlna_src->parallel_src, "need-data",
+        G_CALLBACK (dlna_src_parallel_need_data), dlna_src);
+    g_signal_connect (dlna_src->parallel_src, "seek-data",
+        G_CALLBACK (dlna_src_parallel_seek_data), dlna_src);
+
+    gst_element_set_locked_state (dlna_src->parallel_src, TRUE);
+    gst_bin_add (GST_BIN (&dlna_src->bin), dlna_src->parallel_src);
+  }
+  g_object_set (G_OBJECT (dlna_src->parallel_src), "size",
+      (gint64) dlna_src->byte_total, NULL);
+
+  g_mutex_lock (&dlna_src->parallel_mutex);
+  active = dlna_src->parallel_active;
+  g_mutex_unlock (&dlna_src->parallel_mutex);
+
+  if (!active) {
+    GST_INFO_OBJECT (dlna_src, "Switching from souphttpsrc to parallel "
+        "requests");
+
+    gst_element_set_locked_state (dlna_src->http_src, TRUE);
+    gst_element_set_state (dlna_src->http_src, GST_STATE_READY);
+
+    pad = gst_element_get_static_pad (dlna_src->parallel_src, "src");
+    active = gst_ghost_pad_set_target (GST_GHOST_PAD (dlna_src->src_pad),
+        pad);
+    gst_object_unref (pad);
+
+    g_mutex_lock (&dlna_src->parallel_mutex);
+    dlna_src->parallel_active = TRUE;
+    g_mutex_unlock (&dlna_src->parallel_mutex);
+
+    if (!active || (GST_STATE_CHANGE_FAILURE ==
+            gst_element_set_state (dlna_src->parallel_src,
+                GST_STATE_PAUSED))) {
+      GST_WARNING_OBJECT (dlna_src, "Unable to start appsrc for parallel "
+          "requests");
+      return FALSE;
+    }
+  }
+
+  event = gst_event_new_seek (1.0, GST_FORMAT_BYTES, GST_SEEK_FLAG_FLUSH,
+      GST_SEEK_TYPE_SET, offset, GST_SEEK_TYPE_NONE, -1);
+  gst_event_set_seqnum (event, seqnum);
+
+  return gst_element_send_event (dlna_src->parallel_src, event);
 }
 #endif
 
+/**
+ * Hand the src ghost pad back to souphttpsrc when the parallel appsrc is in
+ * place: fetching stops, the appsrc is stopped and souphttpsrc is restarted
+ * with the state of the bin.  Called before anything drives souphttpsrc.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_parallel_leave (GstDlnaSrc * dlna_src)
+{
 #if GST_CHECK_VERSION(1,0,0)
-static const gchar *const *
-gst_dlna_src_uri_get_protocols (GType type)
+  GstPad *pad = NULL;
+  gboolean active;
+
+  g_mutex_lock (&dlna_src->parallel_mutex);
+  active = dlna_src->parallel_active;
+  dlna_src->parallel_active = FALSE;
+  g_mutex_unlock (&dlna_src->parallel_mutex);
+
+  if (!active)
+    return;
+
+  GST_INFO_OBJECT (dlna_src, "Switching from parallel requests back to "
+      "souphttpsrc");
+
+  dlna_src_parallel_stop (dlna_src);
+  gst_element_set_state (dlna_src->parallel_src, GST_STATE_READY);
+
+  pad = gst_element_get_static_pad (dlna_src->http_src, "src");
+  gst_ghost_pad_set_target (GST_GHOST_PAD (dlna_src->src_pad), pad);
+  gst_object_unref (pad);
+
+  gst_element_set_locked_state (dlna_src->http_src, FALSE);
+  gst_element_sync_state_with_parent (dlna_src->http_src);
+#endif
+}
+
+/**
+ * Byte offset a chunk of the current fetch starts at, parallel_mutex held.
+ *
+ * @param dlna_src  this element
+ * @param chunk     index of the chunk from the start of the fetch
+ *
+ * @return  byte offset in the content
+ */
+static guint64
+dlna_src_parallel_chunk_start (GstDlnaSrc * dlna_src, guint chunk)
 {
-  static const gchar *protocols[] = { "dlna+http", "dlna+https", NULL };
-  return protocols;
+  return (guint64) ((gint64) dlna_src->parallel_offset +
+      (gint64) chunk * dlna_src->parallel_stride);
 }
-#else
-static gchar **
-gst_dlna_src_uri_get_protocols (void)
+
+/**
+ * Stop fetching in parallel, the appsrc stops waiting for chunks and the
+ * requests in flight are cancelled.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_parallel_stop (GstDlnaSrc * dlna_src)
 {
-  static gchar *protocols[] = { "dlna+http", "dlna+https", NULL };
-  return protocols;
+  g_mutex_lock (&dlna_src->parallel_mutex);
+  dlna_src->parallel_stopping = TRUE;
+  g_cond_broadcast (&dlna_src->parallel_cond);
+  g_mutex_unlock (&dlna_src->parallel_mutex);
+
+  if (dlna_src->head_context && dlna_src->parallel_session)
+    g_main_context_invoke (dlna_src->head_context, dlna_src_parallel_cancel,
+        dlna_src);
 }
-#endif
 
-#if GST_CHECK_VERSION(1,0,0)
-static gchar *
-gst_dlna_src_uri_get_uri (GstURIHandler * handler)
+/**
+ * Runs on the HEAD worker, requests chunks ahead of the one being pushed
+ * while fewer requests than connections are in flight.
+ */
+static gboolean
+dlna_src_parallel_fill (gpointer data)
 {
-  GstDlnaSrc *dlna_src = GST_DLNA_SRC (handler);
-  return g_strdup (dlna_src->dlna_uri);
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) data;
+  guint chunk;
+
+  if (dlna_src->head_closing)
+    return FALSE;
+
+  g_mutex_lock (&dlna_src->parallel_mutex);
+  while (!dlna_src->parallel_stopping &&
+      (dlna_src->parallel_in_flight < dlna_src->parallel_connections) &&
+      (dlna_src->parallel_next_fetch < dlna_src->parallel_n_chunks) &&
+      (dlna_src->parallel_next_fetch < dlna_src->parallel_next_push +
+          dlna_src->parallel_connections * PARALLEL_CHUNKS_AHEAD)) {
+    chunk = dlna_src->parallel_next_fetch++;
+    dlna_src->parallel_in_flight++;
+    g_mutex_unlock (&dlna_src->parallel_mutex);
+
+    dlna_src_parallel_request (dlna_src, chunk, 0);
+
+    g_mutex_lock (&dlna_src->parallel_mutex);
+  }
+  g_mutex_unlock (&dlna_src->parallel_mutex);
+
+  return FALSE;
 }
-#else
-G_CONST_RETURN gchar *
-gst_dlna_src_uri_get_uri(GstURIHandler * handler)
+
+/**
+ * Runs on the HEAD worker, makes the range request of a chunk.
+ *
+ * @param dlna_src  this element
+ * @param chunk     index of the chunk from the start of the fetch
+ * @param retries   number of times the chunk was requested before
+ */
+static void
+dlna_src_parallel_request (GstDlnaSrc * dlna_src, guint chunk, guint retries)
 {
-  GstDlnaSrc *dlna_src = GST_DLNA_SRC (handler);
-  return g_strdup (dlna_src->dlna_uri);
+  SoupMessage *msg = NULL;
+  guint generation;
+  guint64 start;
+  guint64 end;
+  gchar range[64];
+
+  g_mutex_lock (&dlna_src->parallel_mutex);
+  generation = dlna_src->parallel_generation;
+  start = dlna_src_parallel_chunk_start (dlna_src, chunk);
+  end = MIN (start + dlna_src->parallel_chunk_size, dlna_src->byte_total);
+  g_mutex_unlock (&dlna_src->parallel_mutex);
+
+  msg = soup_message_new (SOUP_METHOD_GET, dlna_src->http_uri);
+  if (!msg) {
+    GST_WARNING_OBJECT (dlna_src, "Unable to create range request");
+    g_mutex_lock (&dlna_src->parallel_mutex);
+    dlna_src->parallel_failed = TRUE;
+    dlna_src->parallel_stopping = TRUE;
+    g_cond_broadcast (&dlna_src->parallel_cond);
+    g_mutex_unlock (&dlna_src->parallel_mutex);
+    return;
+  }
+
+  g_snprintf (range, sizeof (range), "bytes=%" G_GUINT64_FORMAT "-%"
+      G_GUINT64_FORMAT, start, end - 1);
+  soup_message_headers_append (msg->request_headers,
+      HEADER_RANGE_BYTES_TITLE, range);
+  soup_message_headers_append (msg->request_headers,
+      "transferMode.dlna.org", "Streaming");
+
+  g_object_set_data (G_OBJECT (msg), "dlnasrc-generation",
+      GUINT_TO_POINTER (generation));
+  g_object_set_data (G_OBJECT (msg), "dlnasrc-chunk",
+      GUINT_TO_POINTER (chunk));
+  g_object_set_data (G_OBJECT (msg), "dlnasrc-retries",
+      GUINT_TO_POINTER (retries));
+
+  GST_LOG_OBJECT (dlna_src, "Requesting chunk %u: %s", chunk, range);
+
+  dlna_src->parallel_msgs = g_list_prepend (dlna_src->parallel_msgs, msg);
+
+  /* Counted as a HEAD request so the session outlives it */
+  g_mutex_lock (&dlna_src->head_mutex);
+  dlna_src->head_requests_pending++;
+  g_mutex_unlock (&dlna_src->head_mutex);
+
+  /* Session takes ownership of the message */
+  soup_session_queue_message (dlna_src->parallel_session, msg,
+      dlna_src_parallel_done, dlna_src);
+}
+
+/**
+ * Session callback of a chunk request.  Keeps the chunk for the parallel
+ * appsrc, or requests it again when it failed or stalled, up to
+ * PARALLEL_MAX_RETRIES times.  Requests of an earlier fetch are ignored.
+ */
+static void
+dlna_src_parallel_done (SoupSession * session, SoupMessage * soup_msg,
+    gpointer user_data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) user_data;
+  guint generation = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (soup_msg),
+          "dlnasrc-generation"));
+  guint chunk = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (soup_msg),
+          "dlnasrc-chunk"));
+  guint retries = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (soup_msg),
+          "dlnasrc-retries"));
+  SoupBuffer *body = NULL;
+  gboolean current;
+  gboolean retry = FALSE;
+  guint64 start;
+  guint64 end;
+
+  dlna_src->parallel_msgs = g_list_remove (dlna_src->parallel_msgs, soup_msg);
+
+  g_mutex_lock (&dlna_src->parallel_mutex);
+  current = (generation == dlna_src->parallel_generation) &&
+      !dlna_src->parallel_stopping;
+  if (current) {
+    start = dlna_src_parallel_chunk_start (dlna_src, chunk);
+    end = MIN (start + dlna_src->parallel_chunk_size, dlna_src->byte_total);
+
+    if ((soup_msg->status_code == HTTP_STATUS_PARTIAL) &&
+        (soup_msg->response_body->length == end - start)) {
+      body = soup_message_body_flatten (soup_msg->response_body);
+      dlna_src->parallel_chunks[chunk] = g_bytes_new_with_free_func
+          (body->data, body->length, (GDestroyNotify) soup_buffer_free, body);
+      dlna_src->parallel_in_flight--;
+      g_cond_broadcast (&dlna_src->parallel_cond);
+    } else if (retries < PARALLEL_MAX_RETRIES) {
+      GST_INFO_OBJECT (dlna_src, "Chunk %u failed: %d %s, requesting again",
+          chunk, soup_msg->status_code, soup_msg->reason_phrase);
+      retry = TRUE;
+    } else {
+      GST_WARNING_OBJECT (dlna_src, "Chunk %u failed: %d %s, giving up",
+          chunk, soup_msg->status_code, soup_msg->reason_phrase);
+      dlna_src->parallel_failed = TRUE;
+      dlna_src->parallel_stopping = TRUE;
+      g_cond_broadcast (&dlna_src->parallel_cond);
+    }
+  }
+  g_mutex_unlock (&dlna_src->parallel_mutex);
+
+  if (retry && !dlna_src->head_closing)
+    dlna_src_parallel_request (dlna_src, chunk, retries + 1);
+  else if (current)
+    dlna_src_parallel_fill (dlna_src);
+
+  g_mutex_lock (&dlna_src->head_mutex);
+  dlna_src->head_requests_pending--;
+  g_cond_broadcast (&dlna_src->head_cond);
+  g_mutex_unlock (&dlna_src->head_mutex);
+}
+
+/**
+ * Runs on the HEAD worker, cancels the chunk requests of earlier fetches,
+ * or all of them once fetching stopped.
+ */
+static gboolean
+dlna_src_parallel_cancel (gpointer data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) data;
+  GList *msgs = NULL;
+  GList *item = NULL;
+  SoupMessage *msg;
+  guint generation;
+  gboolean stopping;
+
+  if (!dlna_src->parallel_session)
+    return FALSE;
+
+  g_mutex_lock (&dlna_src->parallel_mutex);
+  generation = dlna_src->parallel_generation;
+  stopping = dlna_src->parallel_stopping;
+  g_mutex_unlock (&dlna_src->parallel_mutex);
+
+  msgs = g_list_copy (dlna_src->parallel_msgs);
+  for (item = msgs; item; item = item->next) {
+    msg = (SoupMessage *) item->data;
+    if (stopping || (generation !=
+            GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (msg),
+                    "dlnasrc-generation"))))
+      soup_session_cancel_message (dlna_src->parallel_session, msg,
+          SOUP_STATUS_CANCELLED);
+  }
+  g_list_free (msgs);
+
+  return FALSE;
+}
+
+/**
+ * Release chunks fetched in parallel which were not pushed.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_parallel_clear (GstDlnaSrc * dlna_src)
+{
+  guint i;
+
+  g_mutex_lock (&dlna_src->parallel_mutex);
+  for (i = 0; i < dlna_src->parallel_n_chunks; i++)
+    if (dlna_src->parallel_chunks[i])
+      g_bytes_unref (dlna_src->parallel_chunks[i]);
+  g_free (dlna_src->parallel_chunks);
+  dlna_src->parallel_chunks = NULL;
+  dlna_src->parallel_n_chunks = 0;
+  g_mutex_unlock (&dlna_src->parallel_mutex);
+}
+
+/**
+ * Wait for the splice thread to finish and release its data.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_splice_join (GstDlnaSrc * dlna_src)
+{
+  if (!dlna_src->splice_thread)
+    return;
+
+  g_thread_join (dlna_src->splice_thread);
+  dlna_src->splice_thread = NULL;
+
+  g_mutex_lock (&dlna_src->splice_mutex);
+  if (dlna_src->splice_data) {
+    g_bytes_unref (dlna_src->splice_data);
+    dlna_src->splice_data = NULL;
+  }
+  g_mutex_unlock (&dlna_src->splice_mutex);
+}
+
+#if GST_CHECK_VERSION(1,0,0)
+/**
+ * Push a byte segment starting at offset from the src ghost pad.
+ *
+ * @param dlna_src  this element
+ * @param offset    byte offset the segment starts at
+ * @param seqnum    sequence number of the seek event
+ *
+ * @return  GST_FLOW_OK if pushed, GST_FLOW_FLUSHING otherwise
+ */
+static GstFlowReturn
+dlna_src_splice_push_segment (GstDlnaSrc * dlna_src, guint64 offset,
+    guint32 seqnum)
+{
+  GstSegment segment;
+  GstEvent *event;
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  segment.start = offset;
+  segment.position = offset;
+  segment.time = offset;
+  event = gst_event_new_segment (&segment);
+  gst_event_set_seqnum (event, seqnum);
+
+  return gst_pad_push_event (dlna_src->src_pad, event) ? GST_FLOW_OK :
+      GST_FLOW_FLUSHING;
+}
+
+/**
+ * Push data from pos on from the src ghost pad, in buffers of the current
+ * block size which share the data.
+ *
+ * @param dlna_src      this element
+ * @param data          data to push
+ * @param pos           position in data to start from
+ * @param data_offset   byte offset of data in the content
+ * @param discont       flag the first buffer as a discontinuity
+ *
+ * @return  flow return of the last push
+ */
+static GstFlowReturn
+dlna_src_splice_push_data (GstDlnaSrc * dlna_src, GBytes * data, gsize pos,
+    guint64 data_offset, gboolean discont)
+{
+  guint chunk = dlna_src->blocksize ? dlna_src->blocksize :
+      SOUPHTTPSRC_BLOCKSIZE;
+  GstFlowReturn flow = GST_FLOW_OK;
+  GstBuffer *buffer;
+  const guint8 *bytes;
+  gsize size;
+  gsize len;
+
+  bytes = g_bytes_get_data (data, &size);
+  while ((GST_FLOW_OK == flow) && (pos < size)) {
+    len = MIN (size - pos, chunk);
+    buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+        (gpointer) bytes, size, pos, len, g_bytes_ref (data),
+        (GDestroyNotify) g_bytes_unref);
+    GST_BUFFER_OFFSET (buffer) = data_offset + pos;
+    GST_BUFFER_OFFSET_END (buffer) = GST_BUFFER_OFFSET (buffer) + len;
+    if (discont) {
+      GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
+      discont = FALSE;
+    }
+
+    flow = gst_pad_push (dlna_src->src_pad, buffer);
+    dlna_src_stats_delivered (dlna_src, len, flow);
+    pos += len;
+  }
+
+  return flow;
+}
+
+/**
+ * Splice thread, pushes a segment starting at the new position and the
+ * data held in memory from there downstream.  Stops when downstream is
+ * flushed.
+ */
+static gpointer
+dlna_src_splice_thread_func (gpointer data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) data;
+  GstFlowReturn flow;
+
+  flow = dlna_src_splice_push_segment (dlna_src, dlna_src->splice_offset,
+      dlna_src->splice_seqnum);
+  if (GST_FLOW_OK == flow)
+    flow = dlna_src_splice_push_data (dlna_src, dlna_src->splice_data,
+        dlna_src->splice_offset - dlna_src->splice_data_offset,
+        dlna_src->splice_data_offset, TRUE);
+
+  GST_DEBUG_OBJECT (dlna_src, "Splice of data in memory done: %s",
+      gst_flow_get_name (flow));
+
+  g_mutex_lock (&dlna_src->splice_mutex);
+  dlna_src->splice_pushing = FALSE;
+  g_cond_broadcast (&dlna_src->splice_cond);
+  g_mutex_unlock (&dlna_src->splice_mutex);
+
+  return NULL;
+}
+
+/**
+ * Need-data callback of the parallel appsrc, runs on its streaming thread.
+ * Waits for the next chunk fetched by parallel requests and queues it in the
+ * appsrc, ends the stream after the last chunk, or posts an error from the
+ * appsrc when a chunk cannot be fetched.  Returns without data when the
+ * appsrc is flushed or fetching stopped.
+ */
+static void
+dlna_src_parallel_need_data (GstElement * appsrc, guint length,
+    gpointer user_data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) user_data;
+  GstFlowReturn flow = GST_FLOW_OK;
+  GBytes *chunk_data;
+  GBytes *access_data;
+  const guint8 *bytes;
+  guint64 chunk_offset;
+  guint chunk;
+  gboolean queued = FALSE;
+  gboolean done = FALSE;
+  gboolean failed;
+  gboolean strided;
+  gboolean random_access;
+  gsize size;
+  gsize start;
+  gsize end;
+
+  g_mutex_lock (&dlna_src->parallel_mutex);
+  strided = (dlna_src->parallel_stride != dlna_src->parallel_chunk_size);
+  random_access = dlna_src->parallel_random_access;
+  while (!queued) {
+    while (!dlna_src->parallel_stopping && !dlna_src->parallel_flushing &&
+        (dlna_src->parallel_next_push < dlna_src->parallel_n_chunks) &&
+        !dlna_src->parallel_chunks[dlna_src->parallel_next_push])
+      g_cond_wait (&dlna_src->parallel_cond, &dlna_src->parallel_mutex);
+    if (dlna_src->parallel_stopping || dlna_src->parallel_flushing)
+      break;
+    if (dlna_src->parallel_next_push >= dlna_src->parallel_n_chunks) {
+      done = TRUE;
+      break;
+    }
+    chunk = dlna_src->parallel_next_push++;
+    chunk_data = dlna_src->parallel_chunks[chunk];
+    dlna_src->parallel_chunks[chunk] = NULL;
+    chunk_offset = dlna_src_parallel_chunk_start (dlna_src, chunk);
+    g_mutex_unlock (&dlna_src->parallel_mutex);
+
+    /* Room for another chunk ahead */
+    g_main_context_invoke (dlna_src->head_context, dlna_src_parallel_fill,
+        dlna_src);
+
+    if (random_access) {
+      bytes = g_bytes_get_data (chunk_data, &size);
+      if (!dlna_src_ts_find_random_access (bytes, size, &start, &end)) {
+        GST_LOG_OBJECT (dlna_src, "No random access point in chunk %u",
+            chunk);
+        g_bytes_unref (chunk_data);
+        g_mutex_lock (&dlna_src->parallel_mutex);
+        continue;
+      }
+      access_data = g_bytes_new_from_bytes (chunk_data, start, end - start);
+      g_bytes_unref (chunk_data);
+      chunk_data = access_data;
+      chunk_offset += start;
+    }
+
+    flow = dlna_src_parallel_push (dlna_src, chunk_data, chunk_offset,
+        (0 == chunk) || strided);
+    g_bytes_unref (chunk_data);
+    queued = TRUE;
+
+    g_mutex_lock (&dlna_src->parallel_mutex);
+  }
+  failed = dlna_src->parallel_failed;
+  if (done || failed)
+    dlna_src->parallel_stopping = TRUE;
+  g_mutex_unlock (&dlna_src->parallel_mutex);
+
+  if (GST_FLOW_OK != flow)
+    GST_DEBUG_OBJECT (dlna_src, "Queuing chunk failed: %s",
+        gst_flow_get_name (flow));
+
+  if (!done && !failed)
+    return;
+
+  GST_DEBUG_OBJECT (dlna_src, "Parallel fetch %s", failed ? "failed" : "done");
+
+  if (failed) {
+    dlna_src_trace_dump (dlna_src, "Parallel fetch failed");
+    GST_ELEMENT_ERROR (appsrc, RESOURCE, READ,
+        ("Unable to fetch content"),
+        ("Range request failed %d times", PARALLEL_MAX_RETRIES + 1));
+  }
+  g_signal_emit_by_name (appsrc, "end-of-stream", &flow);
+
+  g_main_context_invoke (dlna_src->head_context, dlna_src_parallel_cancel,
+      dlna_src);
+}
+
+/**
+ * Seek-data callback of the parallel appsrc.  The fetch from the new offset
+ * is set up by dlna_src_parallel_fetch(), chunks queued before the seek were
+ * flushed by the appsrc.
+ */
+static gboolean
+dlna_src_parallel_seek_data (GstElement * appsrc, guint64 offset,
+    gpointer user_data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) user_data;
+
+  GST_DEBUG_OBJECT (dlna_src, "Parallel appsrc seeked to offset %"
+      G_GUINT64_FORMAT, offset);
+
+  return TRUE;
+}
+
+/**
+ * Queue a chunk in the parallel appsrc, in buffers of the current block
+ * size which share the data.
+ *
+ * @param dlna_src      this element
+ * @param data          data to queue
+ * @param data_offset   byte offset of data in the content
+ * @param discont       flag the first buffer as a discontinuity
+ *
+ * @return  flow return of the last buffer queued
+ */
+static GstFlowReturn
+dlna_src_parallel_push (GstDlnaSrc * dlna_src, GBytes * data,
+    guint64 data_offset, gboolean discont)
+{
+  guint chunk = dlna_src->blocksize ? dlna_src->blocksize :
+      SOUPHTTPSRC_BLOCKSIZE;
+  GstFlowReturn flow = GST_FLOW_OK;
+  GstBuffer *buffer;
+  const guint8 *bytes;
+  gsize size;
+  gsize pos = 0;
+  gsize len;
+
+  bytes = g_bytes_get_data (data, &size);
+  while ((GST_FLOW_OK == flow) && (pos < size)) {
+    len = MIN (size - pos, chunk);
+    buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+        (gpointer) bytes, size, pos, len, g_bytes_ref (data),
+        (GDestroyNotify) g_bytes_unref);
+    GST_BUFFER_OFFSET (buffer) = data_offset + pos;
+    GST_BUFFER_OFFSET_END (buffer) = GST_BUFFER_OFFSET (buffer) + len;
+    if (discont) {
+      GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
+      discont = FALSE;
+    }
+
+    /* The appsrc takes a reference of its own */
+    g_signal_emit_by_name (dlna_src->parallel_src, "push-buffer", buffer,
+        &flow);
+    gst_buffer_unref (buffer);
+    pos += len;
+  }
+
+  return flow;
+}
+
+/**
+ * Class handler of the "fetch-previews" action signal.  Fetches a window
+ * of PREVIEW_WINDOW_SIZE bytes around each npt position over a connection
+ * of its own, leaving the stream souphttpsrc is fetching alone.  Positions
+ * are converted to bytes from the seek index where possible and the range
+ * requests of those are queued at once so they follow each other on the
+ * connection.  Other positions are converted with time seek range HEAD
+ * requests issued together on the HEAD worker, each queuing its range request
+ * once answered.  Only the caller waits for the batch, for at most
+ * PREVIEW_TIMEOUT_SECS, after which the requests still outstanding are
+ * cancelled and the windows fetched so far returned.  Windows of a transport
+ * stream start at their first random access point.
+ *
+ * @param dlna_src  this element
+ * @param positions npt positions in nanoseconds, as guint64
+ *
+ * @return  buffer per position fetched, with the position as pts and its
+ *          byte offset as offset, possibly empty
+ */
+static GstBufferList *
+gst_dlna_src_fetch_previews (GstDlnaSrc * dlna_src, GArray * positions)
+{
+  GstBufferList *list = gst_buffer_list_new ();
+  dlna_src_preview_batch *batch;
+  GstBuffer *buffer;
+  GstDlnaSrcRange *range;
+  GBytes **windows;
+  gboolean transport_stream;
+  const guint8 *bytes;
+  guint64 offset;
+  gint64 deadline;
+  gsize size;
+  gsize start;
+  gsize end;
+  guint i;
+
+  if (!positions || !positions->len || !dlna_src->http_uri ||
+      !dlna_src->head_context || !dlna_src->byte_seek_supported ||
+      dlna_src->is_encrypted) {
+    GST_INFO_OBJECT (dlna_src, "Unable to fetch previews of this content");
+    return list;
+  }
+
+  batch = dlna_src_preview_batch_new (dlna_src, positions->len);
+
+  range = dlna_src_range_get (dlna_src);
+  for (i = 0; i < batch->n_windows; i++) {
+    batch->npt_nanos[i] = g_array_index (positions, guint64, i);
+    batch->offsets[i] = PREVIEW_SKIPPED;
+    if (range->time_seek_supported) {
+      if (!dlna_src_seek_index_lookup (dlna_src, TRUE, batch->npt_nanos[i],
+              SEEK_INDEX_MAX_GAP_SECS * GST_SECOND, &offset)) {
+        batch->offsets[i] = PREVIEW_CONVERT;
+        batch->pending++;
+        continue;
+      }
+    } else if (range->byte_total && range->npt_duration_nanos)
+      offset = gst_util_uint64_scale (batch->npt_nanos[i], range->byte_total,
+          range->npt_duration_nanos);
+    else
+      continue;
+
+    offset = (offset > PREVIEW_WINDOW_SIZE / 2) ?
+        offset - PREVIEW_WINDOW_SIZE / 2 : 0;
+    if (offset >= range->byte_total)
+      continue;
+    batch->offsets[i] = offset;
+    batch->pending++;
+  }
+  dlna_src_range_unref (range);
+
+  GST_INFO_OBJECT (dlna_src, "Fetching %u of %u preview windows",
+      batch->pending, batch->n_windows);
+
+  if (batch->pending) {
+    /* Each pending window holds a reference until it completes */
+    g_atomic_int_add (&batch->refcount, batch->pending);
+    g_main_context_invoke_full (dlna_src->head_context, G_PRIORITY_DEFAULT,
+        dlna_src_preview_queue, dlna_src_preview_batch_ref (batch),
+        dlna_src_preview_batch_unref);
+
+    deadline = g_get_monotonic_time () +
+        PREVIEW_TIMEOUT_SECS * G_TIME_SPAN_SECOND;
+    g_mutex_lock (&batch->mutex);
+    while (batch->pending)
+      if (!g_cond_wait_until (&batch->cond, &batch->mutex, deadline))
+        break;
+
+    if (batch->pending) {
+      GST_WARNING_OBJECT (dlna_src, "Cancelling %u preview windows not "
+          "fetched within %d secs", batch->pending, PREVIEW_TIMEOUT_SECS);
+
+      /* Windows completing from now on are dropped */
+      batch->cancelled = TRUE;
+      g_mutex_unlock (&batch->mutex);
+
+      g_main_context_invoke_full (dlna_src->head_context, G_PRIORITY_HIGH,
+          dlna_src_preview_cancel, dlna_src_preview_batch_ref (batch),
+          dlna_src_preview_batch_unref);
+
+      deadline = g_get_monotonic_time () +
+          PREVIEW_CANCEL_TIMEOUT_SECS * G_TIME_SPAN_SECOND;
+      g_mutex_lock (&batch->mutex);
+      while (!batch->cancel_done)
+        if (!g_cond_wait_until (&batch->cond, &batch->mutex, deadline))
+          break;
+    }
+    g_mutex_unlock (&batch->mutex);
+  }
+
+  /* Take the windows which made it, late ones stay with the batch */
+  g_mutex_lock (&batch->mutex);
+  batch->cancelled = TRUE;
+  windows = batch->windows;
+  batch->windows = g_new0 (GBytes *, batch->n_windows);
+  g_mutex_unlock (&batch->mutex);
+
+  transport_stream = dlna_src_is_transport_stream (dlna_src);
+  for (i = 0; i < batch->n_windows; i++) {
+    if (!windows[i])
+      continue;
+
+    bytes = g_bytes_get_data (windows[i], &size);
+    start = 0;
+    end = size;
+    if (transport_stream &&
+        !dlna_src_ts_find_random_access (bytes, size, &start, &end)) {
+      GST_DEBUG_OBJECT (dlna_src, "No random access point in preview at %"
+          GST_TIME_FORMAT, GST_TIME_ARGS (batch->npt_nanos[i]));
+      continue;
+    }
+
+    buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+        (gpointer) bytes, size, start, end - start,
+        g_bytes_ref (windows[i]), (GDestroyNotify) g_bytes_unref);
+    GST_BUFFER_PTS (buffer) = batch->npt_nanos[i];
+    GST_BUFFER_OFFSET (buffer) = batch->offsets[i] + start;
+    GST_BUFFER_OFFSET_END (buffer) = batch->offsets[i] + end;
+    gst_buffer_list_add (list, buffer);
+  }
+
+  for (i = 0; i < batch->n_windows; i++)
+    if (windows[i])
+      g_bytes_unref (windows[i]);
+  g_free (windows);
+  dlna_src_preview_batch_unref (batch);
+
+  return list;
+}
+
+/**
+ * Creates a preview batch referenced by the caller, with every window
+ * skipped.
+ *
+ * @param dlna_src  this element
+ * @param n_windows number of windows in the batch
+ *
+ * @return  new batch
+ */
+static dlna_src_preview_batch *
+dlna_src_preview_batch_new (GstDlnaSrc * dlna_src, guint n_windows)
+{
+  dlna_src_preview_batch *batch = g_slice_new0 (dlna_src_preview_batch);
+
+  batch->dlna_src = dlna_src;
+  batch->refcount = 1;
+  batch->n_windows = n_windows;
+  batch->npt_nanos = g_new0 (guint64, n_windows);
+  batch->offsets = g_new (guint64, n_windows);
+  batch->windows = g_new0 (GBytes *, n_windows);
+  g_mutex_init (&batch->mutex);
+  g_cond_init (&batch->cond);
+
+  return batch;
+}
+
+static dlna_src_preview_batch *
+dlna_src_preview_batch_ref (dlna_src_preview_batch * batch)
+{
+  g_atomic_int_inc (&batch->refcount);
+
+  return batch;
+}
+
+static void
+dlna_src_preview_batch_unref (gpointer data)
+{
+  dlna_src_preview_batch *batch = (dlna_src_preview_batch *) data;
+  guint i;
+
+  if (!g_atomic_int_dec_and_test (&batch->refcount))
+    return;
+
+  for (i = 0; i < batch->n_windows; i++)
+    if (batch->windows[i])
+      g_bytes_unref (batch->windows[i]);
+  g_free (batch->windows);
+  g_free (batch->offsets);
+  g_free (batch->npt_nanos);
+  g_cond_clear (&batch->cond);
+  g_mutex_clear (&batch->mutex);
+  g_slice_free (dlna_src_preview_batch, batch);
+}
+
+/**
+ * Runs on the HEAD worker, queues the range requests of a preview batch
+ * whose offsets are known on the preview session, which has a single
+ * connection, and issues the HEAD requests converting the other positions.
+ */
+static gboolean
+dlna_src_preview_queue (gpointer data)
+{
+  dlna_src_preview_batch *batch = (dlna_src_preview_batch *) data;
+  GstDlnaSrc *dlna_src = batch->dlna_src;
+  guint i;
+
+  if (!dlna_src->head_closing && !dlna_src->preview_session)
+    dlna_src->preview_session =
+        soup_session_async_new_with_options (SOUP_SESSION_ASYNC_CONTEXT,
+        dlna_src->head_context, SOUP_SESSION_TIMEOUT,
+        PARALLEL_STALL_TIMEOUT_SECS, SOUP_SESSION_MAX_CONNS, 1,
+        SOUP_SESSION_MAX_CONNS_PER_HOST, 1, NULL);
+
+  for (i = 0; i < batch->n_windows; i++) {
+    if (batch->offsets[i] == PREVIEW_SKIPPED)
+      continue;
+
+    if (batch->offsets[i] == PREVIEW_CONVERT)
+      dlna_src_preview_convert (batch, i);
+    else
+      dlna_src_preview_request (batch, i, batch->offsets[i]);
+  }
+
+  return FALSE;
+}
+
+/**
+ * Runs on the HEAD worker, queues the range request of a preview window on
+ * the preview session.
+ *
+ * @param batch     batch the window belongs to
+ * @param i         index of the window in the batch
+ * @param offset    byte offset the window starts at
+ */
+static void
+dlna_src_preview_request (dlna_src_preview_batch * batch, guint i,
+    guint64 offset)
+{
+  GstDlnaSrc *dlna_src = batch->dlna_src;
+  SoupMessage *msg = NULL;
+  gchar range[64];
+
+  if (!dlna_src->head_closing && dlna_src->preview_session &&
+      !dlna_src_preview_cancelled (batch))
+    msg = soup_message_new (SOUP_METHOD_GET, dlna_src->http_uri);
+  if (!msg) {
+    dlna_src_preview_complete (batch, i, NULL);
+    return;
+  }
+
+  g_snprintf (range, sizeof (range), "bytes=%" G_GUINT64_FORMAT "-%"
+      G_GUINT64_FORMAT, offset,
+      MIN (offset + PREVIEW_WINDOW_SIZE, dlna_src->byte_total) - 1);
+  soup_message_headers_append (msg->request_headers,
+      HEADER_RANGE_BYTES_TITLE, range);
+  soup_message_headers_append (msg->request_headers,
+      "transferMode.dlna.org", "Interactive");
+  g_object_set_data (G_OBJECT (msg), "dlnasrc-preview",
+      GUINT_TO_POINTER (i));
+  g_object_set_data (G_OBJECT (msg), "dlnasrc-preview-batch", batch);
+
+  GST_LOG_OBJECT (dlna_src, "Requesting preview %u: %s", i, range);
+
+  dlna_src->preview_msgs = g_list_prepend (dlna_src->preview_msgs, msg);
+
+  /* Counted as a HEAD request so the session outlives it */
+  g_mutex_lock (&dlna_src->head_mutex);
+  dlna_src->head_requests_pending++;
+  g_mutex_unlock (&dlna_src->head_mutex);
+
+  /* Session takes ownership of the message */
+  soup_session_queue_message (dlna_src->preview_session, msg,
+      dlna_src_preview_done, batch);
+}
+
+/**
+ * Runs on the HEAD worker, issues the time seek range HEAD request which
+ * converts the position of a preview window to bytes.  Its range request is
+ * queued once the response arrives.
+ *
+ * @param batch     batch the window belongs to
+ * @param i         index of the window in the batch
+ */
+static void
+dlna_src_preview_convert (dlna_src_preview_batch * batch, guint i)
+{
+  GstDlnaSrc *dlna_src = batch->dlna_src;
+  dlna_src_preview_conversion *conversion = NULL;
+  gchar *time_seek_value = NULL;
+  gchar *time_seek_head_request_headers[][2] =
+      { {HEADER_TIME_SEEK_RANGE_TITLE, NULL} };
+  gboolean issued = FALSE;
+
+  conversion = g_slice_new0 (dlna_src_preview_conversion);
+  conversion->batch = batch;
+  conversion->i = i;
+
+  if (!dlna_src->head_closing && !dlna_src_preview_cancelled (batch) &&
+      dlna_src_head_response_init_struct (dlna_src,
+          &conversion->head_response)) {
+    time_seek_value = g_strdup_printf ("npt=%" G_GUINT64_FORMAT ".%03u-",
+        batch->npt_nanos[i] / GST_SECOND,
+        (guint) ((batch->npt_nanos[i] % GST_SECOND) / GST_MSECOND));
+    time_seek_head_request_headers[0][1] = time_seek_value;
+
+    issued = dlna_src_soup_issue_head_async (dlna_src, 1,
+        time_seek_head_request_headers, conversion->head_response, FALSE,
+        DLNA_SRC_LATENCY_HEAD_NPT_TO_BYTES, dlna_src_preview_convert_done,
+        conversion);
+    g_free (time_seek_value);
+  }
+
+  if (!issued) {
+    GST_INFO_OBJECT (dlna_src, "Unable to convert preview %u to bytes", i);
+    if (conversion->head_response)
+      dlna_src_head_response_free_struct (dlna_src, conversion->head_response);
+    g_slice_free (dlna_src_preview_conversion, conversion);
+    dlna_src_preview_complete (batch, i, NULL);
+  }
+}
+
+/**
+ * HEAD callback of a preview position conversion, queues the range request
+ * of the window.
+ */
+static void
+dlna_src_preview_convert_done (GstDlnaSrc * dlna_src, gboolean success,
+    gpointer user_data)
+{
+  dlna_src_preview_conversion *conversion =
+      (dlna_src_preview_conversion *) user_data;
+  dlna_src_preview_batch *batch = conversion->batch;
+  guint i = conversion->i;
+  guint64 offset = conversion->head_response->time_byte_seek_start;
+
+  dlna_src_head_response_free_struct (dlna_src, conversion->head_response);
+  g_slice_free (dlna_src_preview_conversion, conversion);
+
+  if (!success) {
+    GST_INFO_OBJECT (dlna_src, "Unable to convert preview %u to bytes", i);
+    dlna_src_preview_complete (batch, i, NULL);
+    return;
+  }
+
+  offset = (offset > PREVIEW_WINDOW_SIZE / 2) ?
+      offset - PREVIEW_WINDOW_SIZE / 2 : 0;
+  if (offset >= dlna_src->byte_total) {
+    dlna_src_preview_complete (batch, i, NULL);
+    return;
+  }
+
+  /* Windows are returned with the offset they were fetched from */
+  batch->offsets[i] = offset;
+  dlna_src_preview_request (batch, i, offset);
+}
+
+/**
+ * Session callback of a preview range request.
+ */
+static void
+dlna_src_preview_done (SoupSession * session, SoupMessage * soup_msg,
+    gpointer user_data)
+{
+  dlna_src_preview_batch *batch = (dlna_src_preview_batch *) user_data;
+  GstDlnaSrc *dlna_src = batch->dlna_src;
+  guint i = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (soup_msg),
+          "dlnasrc-preview"));
+  SoupBuffer *body = NULL;
+  GBytes *window = NULL;
+
+  dlna_src->preview_msgs = g_list_remove (dlna_src->preview_msgs, soup_msg);
+
+  if ((soup_msg->status_code == HTTP_STATUS_PARTIAL) &&
+      soup_msg->response_body->length) {
+    body = soup_message_body_flatten (soup_msg->response_body);
+    window = g_bytes_new_with_free_func (body->data, body->length,
+        (GDestroyNotify) soup_buffer_free, body);
+  } else
+    GST_INFO_OBJECT (dlna_src, "Preview %u failed: %d %s", i,
+        soup_msg->status_code, soup_msg->reason_phrase);
+
+  dlna_src_preview_complete (batch, i, window);
+
+  g_mutex_lock (&dlna_src->head_mutex);
+  dlna_src->head_requests_pending--;
+  g_cond_broadcast (&dlna_src->head_cond);
+  g_mutex_unlock (&dlna_src->head_mutex);
+}
+
+/**
+ * Hand a fetched window to the caller of a preview batch, waking it up
+ * once the last one is in.
+ *
+ * @param batch     batch the window belongs to
+ * @param i         index of the window in the batch
+ * @param window    data fetched, ownership is taken, NULL if failed
+ */
+static void
+dlna_src_preview_complete (dlna_src_preview_batch * batch, guint i,
+    GBytes * window)
+{
+  g_mutex_lock (&batch->mutex);
+  if (batch->cancelled && window) {
+    g_bytes_unref (window);
+    window = NULL;
+  }
+  batch->windows[i] = window;
+  batch->pending--;
+  if (!batch->pending)
+    g_cond_broadcast (&batch->cond);
+  g_mutex_unlock (&batch->mutex);
+
+  /* Drop the reference of the window */
+  dlna_src_preview_batch_unref (batch);
+}
+
+/**
+ * Checks whether the caller of a preview batch gave up on it.
+ *
+ * @param batch     batch to check
+ *
+ * @return  TRUE if windows not yet requested should not be
+ */
+static gboolean
+dlna_src_preview_cancelled (dlna_src_preview_batch * batch)
+{
+  gboolean cancelled;
+
+  g_mutex_lock (&batch->mutex);
+  cancelled = batch->cancelled;
+  g_mutex_unlock (&batch->mutex);
+
+  return cancelled;
+}
+
+/**
+ * Runs on the HEAD worker once the caller of a preview batch timed out,
+ * cancels every range request of the batch still outstanding on the
+ * preview session, then tells the caller.  Conversions still waiting for
+ * their HEAD response complete without a request once answered.
+ */
+static gboolean
+dlna_src_preview_cancel (gpointer data)
+{
+  dlna_src_preview_batch *batch = (dlna_src_preview_batch *) data;
+  GstDlnaSrc *dlna_src = batch->dlna_src;
+  GList *requests;
+  GList *request;
+
+  if (dlna_src->preview_session) {
+    requests = g_list_copy (dlna_src->preview_msgs);
+    for (request = requests; request; request = request->next)
+      if (g_object_get_data (G_OBJECT (request->data),
+              "dlnasrc-preview-batch") == batch)
+        soup_session_cancel_message (dlna_src->preview_session,
+            SOUP_MESSAGE (request->data), SOUP_STATUS_CANCELLED);
+    g_list_free (requests);
+  }
+
+  g_mutex_lock (&batch->mutex);
+  batch->cancel_done = TRUE;
+  g_cond_broadcast (&batch->cond);
+  g_mutex_unlock (&batch->mutex);
+
+  return FALSE;
+}
+
+/**
+ * Chain function of the internal pad of the src ghost pad, which counts the
+ * data souphttpsrc (or dtcpip) pushes out of the bin in the stats.
+ *
+ * @param pad       internal pad of the src ghost pad
+ * @param parent    parent of pad
+ * @param buffer    buffer to push
+ *
+ * @return  result of pushing buffer downstream
+ */
+static GstFlowReturn
+dlna_src_internal_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstDlnaSrc *dlna_src = GST_DLNA_SRC (gst_pad_get_element_private (pad));
+  gsize size = gst_buffer_get_size (buffer);
+  GstFlowReturn flow;
+
+  flow = gst_proxy_pad_chain_default (pad, parent, buffer);
+  dlna_src_stats_delivered (dlna_src, size, flow);
+
+  return flow;
+}
+
+/**
+ * Event function of the internal pad of the src ghost pad, which receives
+ * the events souphttpsrc (or dtcpip) sends downstream.  Keeps them in order
+ * with data spliced in by dlnasrc: a flush waits for the splice thread to
+ * stop, and the segment souphttpsrc sends after being restarted behind
+ * spliced data is held until that data has been pushed, then dropped.
+ * While the parallel appsrc is the target a flush wakes it from waiting for
+ * a chunk, and its segment gets the applied rate and seqnum of the fetch.
+ * Stream starts after the first one, of the appsrc or of souphttpsrc taking
+ * over again, are dropped.
+ *
+ * @param pad       internal pad of the src ghost pad
+ * @param parent    parent of pad
+ * @param event     event to process
+ *
+ * @return  true if event was handled, false otherwise
+ */
+static gboolean
+dlna_src_internal_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstDlnaSrc *dlna_src = GST_DLNA_SRC (gst_pad_get_element_private (pad));
+  GstEvent *sticky = NULL;
+  GstSegment segment;
+  gboolean drop = FALSE;
+  gboolean active;
+  gdouble applied_rate = 1.0;
+  guint32 seqnum = 0;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_STREAM_START:
+      sticky = gst_pad_get_sticky_event (dlna_src->src_pad,
+          GST_EVENT_STREAM_START, 0);
+      if (sticky) {
+        gst_event_unref (sticky);
+        drop = TRUE;
+      }
+      break;
+
+    case GST_EVENT_FLUSH_START:
+      g_mutex_lock (&dlna_src->splice_mutex);
+      if (!dlna_src->splice_seeking)
+        dlna_src->splice_pending = FALSE;
+      g_cond_broadcast (&dlna_src->splice_cond);
+      g_mutex_unlock (&dlna_src->splice_mutex);
+
+      /* Parallel appsrc may be waiting for a chunk in need-data */
+      g_mutex_lock (&dlna_src->parallel_mutex);
+      dlna_src->parallel_flushing = TRUE;
+      g_cond_broadcast (&dlna_src->parallel_cond);
+      g_mutex_unlock (&dlna_src->parallel_mutex);
+      break;
+
+    case GST_EVENT_FLUSH_STOP:
+      g_mutex_lock (&dlna_src->parallel_mutex);
+      dlna_src->parallel_flushing = FALSE;
+      g_mutex_unlock (&dlna_src->parallel_mutex);
+
+
+      /* Splice thread fails to push once flushing, let it finish first */
+      g_mutex_lock (&dlna_src->splice_mutex);
+      while (dlna_src->splice_pushing)
+        g_cond_wait (&dlna_src->splice_cond, &dlna_src->splice_mutex);
+      g_mutex_unlock (&dlna_src->splice_mutex);
+      break;
+
+    case GST_EVENT_SEGMENT:
+      g_mutex_lock (&dlna_src->parallel_mutex);
+      active = dlna_src->parallel_active;
+      if (active) {
+        applied_rate = dlna_src->parallel_applied_rate;
+        seqnum = dlna_src->parallel_seqnum;
+      }
+      g_mutex_unlock (&dlna_src->parallel_mutex);
+
+      /* Strided data already plays at the trick rate */
+      if (active) {
+        gst_event_copy_segment (event, &segment);
+        segment.applied_rate = applied_rate;
+        gst_event_unref (event);
+        event = gst_event_new_segment (&segment);
+        gst_event_set_seqnum (event, seqnum);
+        break;
+      }
+
+      g_mutex_lock (&dlna_src->splice_mutex);
+      while (dlna_src->splice_pending &&
+          (dlna_src->splice_seeking || dlna_src->splice_pushing))
+        g_cond_wait (&dlna_src->splice_cond, &dlna_src->splice_mutex);
+      drop = dlna_src->splice_pending;
+      dlna_src->splice_pending = FALSE;
+      g_mutex_unlock (&dlna_src->splice_mutex);
+      break;
+
+    default:
+      break;
+  }
+
+  if (drop) {
+    GST_DEBUG_OBJECT (dlna_src, "Dropping %s of souphttpsrc, its data "
+        "continues the stream", GST_EVENT_TYPE_NAME (event));
+    gst_event_unref (event);
+    return TRUE;
+  }
+
+  return gst_proxy_pad_event_default (pad, parent, event);
+}
+#endif
+
+static GstStateChangeReturn
+gst_dlna_src_change_state (GstElement * element, GstStateChange transition)
+{
+  GstStateChangeReturn ret = GST_STATE_CHANGE_SUCCESS;
+  GstDlnaSrc *dlna_src = GST_DLNA_SRC (element);
+
+  GST_LOG_OBJECT (dlna_src, "Changing state from %s to %s",
+      gst_element_state_get_name (GST_STATE_TRANSITION_CURRENT (transition)),
+      gst_element_state_get_name (GST_STATE_TRANSITION_NEXT (transition)));
+
+  switch (transition) {
+    case GST_STATE_CHANGE_NULL_TO_READY:
+      break;
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      {
+         if((TRUE == dlna_src->is_live) && (TRUE == dlna_src->boundary_stopped))
+         {
+            if(TRUE != dlna_src_boundary_timer_start(dlna_src))
+            {
+               GST_ERROR_OBJECT(dlna_src, "Failed to start TSB boundary timer");
+               ret = GST_STATE_CHANGE_FAILURE;
+            }
+         }
+      }
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+  if (ret == GST_STATE_CHANGE_FAILURE) {
+    GST_ERROR_OBJECT (dlna_src, "Problems with parent class state change");
+    return ret;
+  }
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      /* The GET is under way, content features are needed from here on */
+      if (TRUE == dlna_src->fast_start) {
+         g_mutex_lock (&dlna_src->head_mutex);
+         while (dlna_src->tune_pending)
+            g_cond_wait (&dlna_src->head_cond, &dlna_src->head_mutex);
+         g_mutex_unlock (&dlna_src->head_mutex);
+
+         if((TRUE == dlna_src->is_live) && (TRUE == dlna_src->boundary_stopped))
+         {
+            if(TRUE != dlna_src_boundary_timer_start(dlna_src))
+            {
+               GST_ERROR_OBJECT(dlna_src, "Failed to start TSB boundary timer");
+               return GST_STATE_CHANGE_FAILURE;
+            }
+         }
+      }
+      /* Take over from souphttpsrc with parallel requests if enabled */
+      if (dlna_src->parallel_connections > 1)
+         dlna_src_parallel_serve (dlna_src, GST_FORMAT_BYTES,
+             dlna_src->byte_start, gst_util_seqnum_next ());
+      dlna_src_stats_timer_start (dlna_src);
+      break;
+    case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      {
+         if(TRUE != dlna_src->boundary_stopped)
+         {
+            dlna_src_boundary_timer_stop(dlna_src);
+         }
+         if (!dlna_src->prefetch_stopped)
+            dlna_src_prefetch_stop (dlna_src);
+         /* Pads are inactive now, so a splice in progress fails to push */
+         dlna_src_parallel_leave (dlna_src);
+         dlna_src_parallel_stop (dlna_src);
+         dlna_src_splice_join (dlna_src);
+         dlna_src_stats_timer_stop (dlna_src);
+         dlna_src_seek_thread_stop (dlna_src);
+      }
+      break;
+    case GST_STATE_CHANGE_READY_TO_NULL:
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
+
+/**
+ * Processes the supplied event
+ *
+ * @param pad	    pad where event was received
+ * @param parent    parent of pad
+ * @param event	    received event
+ *
+ * @return	true if event was handled, false otherwise
+ */
+#if GST_CHECK_VERSION(1,0,0)
+static gboolean
+gst_dlna_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
+#else
+static gboolean
+gst_dlna_src_event (GstPad * pad, GstEvent * event)
+#endif
+{
+  gboolean ret = FALSE;
+  GstDlnaSrc *dlna_src = GST_DLNA_SRC (gst_pad_get_parent (pad));
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_SEEK:
+      GST_INFO_OBJECT (dlna_src, "Got src event: %s",
+          GST_EVENT_TYPE_NAME (event));
+      if (dlna_src_seek_schedule (dlna_src, pad, event))
+        ret = TRUE;
+      else
+        ret = dlna_src_seek_execute (dlna_src, pad, event);
+      break;
+
+    case GST_EVENT_FLUSH_START:
+      GST_DEBUG_OBJECT (dlna_src, "Got src event: %s",
+          GST_EVENT_TYPE_NAME (event));
+      break;
+
+    case GST_EVENT_FLUSH_STOP:
+      GST_DEBUG_OBJECT (dlna_src, "Got src event: %s",
+          GST_EVENT_TYPE_NAME (event));
+      break;
+
+    case GST_EVENT_QOS:
+    case GST_EVENT_LATENCY:
+    case GST_EVENT_NAVIGATION:
+#if GST_CHECK_VERSION(1,0,0)
+    case GST_EVENT_RECONFIGURE:
+#endif
+      /* Just call default handler to handle */
+      break;     
+
+    default:
+      GST_DEBUG_OBJECT (dlna_src, "Unsupported event: %s",
+          GST_EVENT_TYPE_NAME (event));
+      break;
+  }
+
+  if((!ret) && (TRUE != dlna_src->forward_event))
+  {
+     dlna_src->forward_event = TRUE;
+  }
+  else
+  {
+     /* If not handled, pass on to default pad handler */
+     if (!ret) {
+#if GST_CHECK_VERSION(1,0,0)
+        ret = gst_pad_event_default (pad, parent, event);
+#else    
+        ret = gst_pad_event_default (pad, event);
+#endif
+     }
+  }
+
+  gst_object_unref (dlna_src);
+
+  return ret;
+}
+
+/**
+ * Handles queries on the pad
+ *
+ * @param pad       pad where query was received
+ * @param parent    parent of pad
+ * @param event     received query
+ *
+ * @return true if query could be performed, false otherwise
+ */
+#if GST_CHECK_VERSION(1,0,0)
+static gboolean
+gst_dlna_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+#else
+static gboolean
+gst_dlna_src_query (GstPad * pad, GstQuery * query)
+#endif
+{
+  gboolean ret = FALSE;
+  GstDlnaSrc *dlna_src = GST_DLNA_SRC (gst_pad_get_parent (pad));
+  GstDlnaSrcRange *range = NULL;
+
+  GST_LOG_OBJECT (dlna_src, "Got src query: %s", GST_QUERY_TYPE_NAME (query));
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_DURATION:
+      ret = dlna_src_handle_query_duration (dlna_src, query);
+      break;
+
+    case GST_QUERY_SEEKING:
+      ret = dlna_src_handle_query_seeking (dlna_src, query);
+      break;
+
+    case GST_QUERY_SEGMENT:
+      ret = dlna_src_handle_query_segment (dlna_src, query);
+      break;
+
+    case GST_QUERY_CONVERT:
+      ret = dlna_src_handle_query_convert (dlna_src, query);
+      break;
+
+    case GST_QUERY_URI:
+      GST_INFO_OBJECT (dlna_src, "query uri");
+      gst_query_set_uri (query, dlna_src->dlna_uri);
+      ret = TRUE;
+      break;
+
+    case GST_QUERY_FORMATS:
+      GST_INFO_OBJECT (dlna_src, "format query");
+      gst_query_set_formats (query, 2, GST_FORMAT_BYTES, GST_FORMAT_TIME);
+      ret = TRUE;
+      break;
+
+    case GST_QUERY_LATENCY:
+      /* Don't know latency, let some other element handle this */
+      break;
+
+    case GST_QUERY_POSITION:
+      /* Don't know current position in stream, let some other element handle this */
+      break;
+      
+    case GST_QUERY_CUSTOM:
+    {
+       ret = FALSE;
+       GST_DEBUG_OBJECT(dlna_src, "Custom query");
+       GstStructure *pStruct = (GstStructure *)gst_query_get_structure(query);
+       if(gst_structure_has_name(pStruct, "getTrickSpeeds"))
+       {
+          GST_DEBUG_OBJECT(dlna_src, "getTrickSpeeds query");
+          int ii = 0;
+
+          range = dlna_src_range_get(dlna_src);
+          if(range->playspeeds_cnt <= 0)
+          {
+             GST_WARNING_OBJECT(dlna_src, "playspeeds count is <=0");
+             dlna_src_range_unref(range);
+             break;
+          }
+          
+          GString *speeds = g_string_sized_new(256);
+          if(NULL == speeds)
+          {
+             GST_WARNING_OBJECT(dlna_src, "Failed to alloc trickspeeds str");
+             dlna_src_range_unref(range);
+             break;
+          }
+          
+          GST_DEBUG_OBJECT(dlna_src, "playspeed count = %u\n", 
+                           range->playspeeds_cnt);
+         
+          if(range->playspeeds_cnt > 0)
+          {
+             for (ii = 0; ii < (gint)(range->playspeeds_cnt - 1); ii++) 
+             {
+                g_string_append_printf(speeds, "%.2f,", range->playspeeds[ii]);
+                GST_LOG_OBJECT(dlna_src, "playspeed[%d] = %f", ii, 
+                      range->playspeeds[ii]);
+             }
+             g_string_append_printf(speeds, "%.2f", range->playspeeds[ii]);
+          }
+
+          GST_INFO_OBJECT(dlna_src, "Trick Speeds str: %s\n", speeds->str);
+                
+          gst_structure_set(pStruct, "trickSpeedsStr", G_TYPE_STRING, speeds->str, NULL);
+          
+          g_string_free (speeds, TRUE);
+          dlna_src_range_unref(range);
+          ret = TRUE;
+       }
+       break;
+    }
+
+    default:
+      GST_LOG_OBJECT (dlna_src,
+          "Got unsupported src query: %s, passing to default handler",
+          GST_QUERY_TYPE_NAME (query));
+      break;
+  }
+
+  if (!ret) {
+#if GST_CHECK_VERSION(1,0,0)
+    ret = gst_pad_query_default (pad, parent, query);
+#else
+    ret = gst_pad_query_default (pad, query);
+#endif
+  }
+
+  gst_object_unref (dlna_src);
+
+  return ret;
+}
+
+/**
+ * Responds to a duration query by returning the size of content/stream
+ *
+ * @param	dlna_src	this element
+ * @param	query		received duration query to respond to
+ *
+ * @return	true if responded to query, false otherwise
+ */
+static gboolean
+dlna_src_handle_query_duration (GstDlnaSrc * dlna_src, GstQuery * query)
+{
+  gboolean ret = FALSE;
+  gint64 duration = 0;
+  GstFormat format;
+  GstDlnaSrcRange *range = NULL;
+  guint64 npt_start = 0;
+  guint64 npt_end = 0;
+  guint64 npt_duration = 0;
+
+  GST_LOG_OBJECT (dlna_src, "Called");
+
+  if ((dlna_src->dlna_uri == NULL) || (dlna_src->server_info == NULL)) {
+    GST_INFO_OBJECT (dlna_src,
+        "No URI and/or HEAD response info, unable to handle query");
+    return FALSE;
+  }
+
+  gst_query_parse_duration (query, &format, &duration);
+
+  if (format == GST_FORMAT_BYTES) {
+    range = dlna_src_range_get (dlna_src);
+    if (range->byte_total) {
+      gst_query_set_duration (query, GST_FORMAT_BYTES, range->byte_total);
+      ret = TRUE;
+      GST_DEBUG_OBJECT (dlna_src,
+          "Duration in bytes for this content on the server: %"
+          G_GUINT64_FORMAT, range->byte_total);
+    } else
+      GST_DEBUG_OBJECT (dlna_src,
+          "Duration in bytes not available for content item");
+  } else if (format == GST_FORMAT_TIME) {
+    range = dlna_src_range_get_fresh (dlna_src);
+    if (!range)
+      return FALSE;
+    dlna_src_range_extrapolate (dlna_src, range, &npt_start, &npt_end,
+        &npt_duration);
+
+    if (npt_duration) {
+      gst_query_set_duration (query, GST_FORMAT_TIME, npt_duration);
+      ret = TRUE;
+      GST_DEBUG_OBJECT (dlna_src,
+          "Duration in media time for this content on the server, npt: %"
+          GST_TIME_FORMAT ", nanosecs: %" G_GUINT64_FORMAT,
+          GST_TIME_ARGS (npt_duration), npt_duration);
+    } else
+      GST_DEBUG_OBJECT (dlna_src,
+          "Duration in media time not available for content item");
+  } else {
+    GST_DEBUG_OBJECT (dlna_src,
+        "Got duration query with non-supported format type: %s, passing to default handler",
+        gst_format_get_name (format));
+  }
+
+  if (range)
+    dlna_src_range_unref (range);
+
+  return ret;
+}
+
+/**
+ * Responds to a seeking query by returning whether or not seeking is supported
+ *
+ * @param	dlna_src	this element
+ * @param	query		received seeking query to respond to
+ *
+ * @return	true if responded to query, false otherwise
+ */
+static gboolean
+dlna_src_handle_query_seeking (GstDlnaSrc * dlna_src, GstQuery * query)
+{
+  gboolean ret = FALSE;
+  GstFormat format;
+  gboolean supports_seeking = FALSE;
+  gint64 seek_start = 0;
+  gint64 seek_end = 0;
+  GstDlnaSrcRange *range = NULL;
+  guint64 npt_start = 0;
+  guint64 npt_end = 0;
+  guint64 npt_duration = 0;
+
+  GST_DEBUG_OBJECT (dlna_src, "Called");
+
+  if ((dlna_src->dlna_uri == NULL) || (dlna_src->server_info == NULL)) {
+    GST_INFO_OBJECT (dlna_src,
+        "No URI and/or HEAD response info, unable to handle query");
+    return FALSE;
+  }
+
+  gst_query_parse_seeking (query, &format, &supports_seeking, &seek_start,
+      &seek_end);
+
+  if (format == GST_FORMAT_TIME)
+    range = dlna_src_range_get_fresh (dlna_src);
+  else
+    range = dlna_src_range_get (dlna_src);
+  if (!range)
+    return FALSE;
+
+  if (format == GST_FORMAT_BYTES) {
+    if (range->byte_seek_supported) {
+      gst_query_set_seeking (query, GST_FORMAT_BYTES, TRUE,
+          range->byte_start, range->byte_end);
+      ret = TRUE;
+
+      GST_INFO_OBJECT (dlna_src,
+          "Byte seeks supported for this content by the server, start %"
+          G_GUINT64_FORMAT ", end %" G_GUINT64_FORMAT,
+          range->byte_start, range->byte_end);
+
+    } else
+      GST_INFO_OBJECT (dlna_src,
+          "Seeking in bytes not available for content item");
+  } else if (format == GST_FORMAT_TIME) {
+    if (range->time_seek_supported) {
+      dlna_src_range_extrapolate (dlna_src, range, &npt_start, &npt_end,
+          &npt_duration);
+      gst_query_set_seeking (query, GST_FORMAT_TIME, TRUE, npt_start,
+          npt_end);
+      ret = TRUE;
+
+      GST_DEBUG_OBJECT (dlna_src,
+          "Time based seeks supported for this content by the server, start %"
+          GST_TIME_FORMAT ", end %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (npt_start), GST_TIME_ARGS (npt_end));
+    } else
+      GST_DEBUG_OBJECT (dlna_src,
+          "Seeking in media time not available for content item");
+  } else {
+    GST_DEBUG_OBJECT (dlna_src,
+        "Got seeking query with non-supported format type: %s, passing to default handler",
+        GST_QUERY_TYPE_NAME (query));
+  }
+
+  dlna_src_range_unref (range);
+
+  return ret;
+}
+
+/**
+ * Responds to a segment query by returning rate along with start and stop
+ *
+ * @param	dlna_src	this element
+ * @param	query		received segment query to respond to
+ *
+ * @return	true if responded to query, false otherwise
+ */
+static gboolean
+dlna_src_handle_query_segment (GstDlnaSrc * dlna_src, GstQuery * query)
+{
+  gboolean ret = FALSE;
+  GstFormat format;
+  gdouble rate = 1.0;
+  gint64 start = 0;
+  gint64 end = 0;
+  GstDlnaSrcRange *range = NULL;
+
+  GST_LOG_OBJECT (dlna_src, "Called");
+
+  if ((dlna_src->dlna_uri == NULL) || (dlna_src->server_info == NULL)) {
+    GST_INFO_OBJECT (dlna_src,
+        "No URI and/or HEAD response info, unable to handle query");
+    return FALSE;
+  }
+  gst_query_parse_segment (query, &rate, &format, &start, &end);
+
+  range = dlna_src_range_get (dlna_src);
+
+  if (format == GST_FORMAT_BYTES) {
+    if (range->byte_seek_supported) {
+
+      gst_query_set_segment (query, dlna_src->rate, GST_FORMAT_BYTES,
+          range->byte_start, range->byte_end);
+      ret = TRUE;
+
+      GST_DEBUG_OBJECT (dlna_src,
+          "Segment info in bytes for this content, rate %f, start %"
+          G_GUINT64_FORMAT ", end %" G_GUINT64_FORMAT,
+          dlna_src->rate, range->byte_start, range->byte_end);
+    } else
+      GST_DEBUG_OBJECT (dlna_src,
+          "Segment info in bytes not available for content item");
+  } else if (format == GST_FORMAT_TIME) {
+
+    if (range->time_seek_supported) {
+      gst_query_set_segment (query, dlna_src->rate, GST_FORMAT_TIME,
+          range->npt_start_nanos, range->npt_end_nanos);
+      ret = TRUE;
+
+      GST_DEBUG_OBJECT (dlna_src,
+          "Time based segment info for this content by the server, rate %f, start %"
+          GST_TIME_FORMAT ", end %" GST_TIME_FORMAT,
+          dlna_src->rate,
+          GST_TIME_ARGS (range->npt_start_nanos),
+          GST_TIME_ARGS (range->npt_end_nanos));
+    } else
+      GST_DEBUG_OBJECT (dlna_src,
+          "Segment info in media time not available for content item");
+  } else {
+    GST_DEBUG_OBJECT (dlna_src,
+        "Got segment query with non-supported format type: %s, passing to default handler",
+        GST_QUERY_TYPE_NAME (query));
+  }
+
+  dlna_src_range_unref (range);
+
+  return ret;
+}
+
+/**
+ * Responds to a convert query by issuing head and returning conversion value
+ *
+ * @param	dlna_src	this element
+ * @param	query		received query to respond to
+ *
+ * @return	true if responded to query, false otherwise
+ */
+static gboolean
+dlna_src_handle_query_convert (GstDlnaSrc * dlna_src, GstQuery * query)
+{
+  /* Always return true since no other element can do this */
+  gboolean ret = TRUE;
+  GstFormat src_fmt, dest_fmt;
+  gint64 src_val, dest_val;
+  gint64 start_byte = 0;
+  gint64 start_npt = 0;
+
+  GST_LOG_OBJECT (dlna_src, "Called");
+
+  if (dlna_src->dlna_uri == NULL || !dlna_src->time_seek_supported) {
+    GST_INFO_OBJECT (dlna_src, "Not enough info to handle conversion query");
+    return FALSE;
+  }
+
+  gst_query_parse_convert (query, &src_fmt, &src_val, &dest_fmt, &dest_val);
+
+  GST_DEBUG_OBJECT (dlna_src,
+      "Got conversion query: src fmt: %s, dest fmt: %s, src val: %"
+      G_GUINT64_FORMAT ", dest: val %" G_GUINT64_FORMAT,
+      gst_format_get_name (src_fmt),
+      gst_format_get_name (dest_fmt), src_val, dest_val);
+
+  if (src_fmt == GST_FORMAT_BYTES) {
+    start_byte = src_val;
+  } else if (src_fmt == GST_FORMAT_TIME) {
+    start_npt = src_val;
+  } else {
+    GST_WARNING_OBJECT (dlna_src,
+        "Got segment query with non-supported format type: %s",
+        GST_QUERY_TYPE_NAME (query));
+    return ret;
+  }
+
+  if (dest_fmt == GST_FORMAT_TIME) {
+    if (!dlna_src_convert_bytes_to_npt_nanos (dlna_src, start_byte,
+            (guint64 *) & dest_val)) {
+      GST_WARNING_OBJECT (dlna_src, "Problems converting to time");
+      return ret;
+    }
+  } else if (dest_fmt == GST_FORMAT_BYTES) {
+    if (!dlna_src_convert_npt_nanos_to_bytes (dlna_src, start_npt,
+            (guint64 *) & dest_val)) {
+      GST_WARNING_OBJECT (dlna_src, "Problems converting to bytes");
+      return ret;
+    }
+  } else {
+    GST_INFO_OBJECT (dlna_src, "Unsupported format: %s",
+        gst_format_get_name (dest_fmt));
+    return FALSE;
+  }
+
+  gst_query_set_convert (query, src_fmt, src_val, dest_fmt, dest_val);
+
+  return ret;
+}
+
+static gboolean dlna_src_send_tsb_boundary_event(GstDlnaSrc *dlna_src)
+{
+  gboolean      ret = FALSE; 
+   GstEvent     *event = NULL;
+   GstStructure *structure = NULL;
+   GstDlnaSrcRange *range = NULL;
+   guint32       start_pts;
+   guint32       end_pts;
+
+   /* Boundaries as estimated by the boundary timer */
+   range = dlna_src_range_get(dlna_src);
+   start_pts = range->start_pts;
+   end_pts = range->end_pts;
+   dlna_src_range_unref(range);
+
+   do 
+   {
+      if(MAX_PTS_45KHZ == start_pts)
+      {
+         GST_WARNING("Not sending tsb-boundary event because TSB start_pts is invalid\n");
+         ret = TRUE;
+         break;
+      }
+
+      structure = gst_structure_new("tsb-boundary",
+                                    "start-pts", G_TYPE_UINT, start_pts, 
+                                    "end-pts", G_TYPE_UINT, end_pts, 
+                                    NULL);
+      if(NULL == structure)
+      {
+         GST_WARNING("Error creating tsb-boundary structure\n");
+         break;
+      }
+
+      event = gst_event_new_custom(GST_EVENT_CUSTOM_DOWNSTREAM_OOB, structure);
+      if(NULL == event)
+      {
+         gst_structure_free(structure);
+         structure = NULL;
+         GST_WARNING("Error creating custom downstream OOB event\n");
+         break;
+      }
+
+      GST_DEBUG("Sending tsb-boundary custom downstream OOB event\n");
+
+      if (gst_pad_push_event (dlna_src->src_pad, event) != TRUE)
+      {
+         event = NULL;
+         GST_WARNING("Sending custom downstream OOB event failed!");
+         break;
+      }
+
+      ret = TRUE;
+   
+   }while(0);
+
+   return ret;
+}
+
+/**
+ * Decide whether a seek is executed right away or coalesced with the seeks
+ * following it.  The first seek after a quiet period is executed at once.
+ * Seeks arriving while one executes or within the debounce window after it
+ * are parked, and only the latest of them is executed by the seek thread
+ * once the window has passed.  A parked seek replaced by a newer one is
+ * dropped, it has already been acknowledged.  Since a parked flushing seek
+ * is acknowledged before it executes, the pipeline only gets ASYNC_DONE
+ * once the debounce window has passed.
+ *
+ * Only seeks known to be executable are parked.  Others, such as time seeks
+ * the server does not support, wait for the seek executing and are executed
+ * on the caller's thread, so that a rejection reaches upstream which then
+ * converts the seek to bytes, see issue #63.
+ *
+ * @param dlna_src  this element
+ * @param pad       pad the seek was received on
+ * @param event     seek event
+ *
+ * @return  TRUE if the seek was parked, FALSE if it is to be executed now
+ */
+static gboolean
+dlna_src_seek_schedule (GstDlnaSrc * dlna_src, GstPad * pad, GstEvent * event)
+{
+  guint32 seqnum = gst_event_get_seqnum (event);
+  gint64 now = g_get_monotonic_time ();
+  gboolean superseded = FALSE;
+
+  g_mutex_lock (&dlna_src->seek_mutex);
+
+  /* Same seek again once some element converted it, see issue #63 */
+  if (seqnum == (guint32) g_atomic_int_get (&dlna_src->seek_latest_seqnum)) {
+    if (dlna_src->seek_pending &&
+        gst_event_get_seqnum (dlna_src->seek_pending) == seqnum) {
+      gst_event_unref (dlna_src->seek_pending);
+      dlna_src->seek_pending = gst_event_ref (event);
+      g_mutex_unlock (&dlna_src->seek_mutex);
+      return TRUE;
+    }
+    g_mutex_unlock (&dlna_src->seek_mutex);
+    return FALSE;
+  }
+  g_atomic_int_set (&dlna_src->seek_latest_seqnum, (gint) seqnum);
+
+  if (!dlna_src->seek_debounce ||
+      (!dlna_src->seek_executing && !dlna_src->seek_pending &&
+          (now - dlna_src->seek_last_time >=
+              (gint64) dlna_src->seek_debounce * 1000))) {
+    dlna_src->seek_executing = TRUE;
+    dlna_src->seek_owner = g_thread_self ();
+    dlna_src->seek_executing_seqnum = seqnum;
+    g_mutex_unlock (&dlna_src->seek_mutex);
+    return FALSE;
+  }
+
+  if (dlna_src->seek_pending) {
+    GST_INFO_OBJECT (dlna_src, "Seek %u superseded by seek %u before "
+        "executing", gst_event_get_seqnum (dlna_src->seek_pending), seqnum);
+    gst_event_unref (dlna_src->seek_pending);
+    gst_object_unref (dlna_src->seek_pending_pad);
+  } else
+    GST_INFO_OBJECT (dlna_src, "Deferring seek %u, within %u ms of the last "
+        "one", seqnum, dlna_src->seek_debounce);
+
+  if (!dlna_src_seek_is_executable (dlna_src, event)) {
+    GST_INFO_OBJECT (dlna_src, "Seek %u may be rejected, executing it once "
+        "the seek executing completes", seqnum);
+    dlna_src->seek_pending = NULL;
+    dlna_src->seek_pending_pad = NULL;
+    superseded = dlna_src->seek_executing;
+    g_mutex_unlock (&dlna_src->seek_mutex);
+
+    if (superseded && dlna_src->head_context) {
+      g_mutex_lock (&dlna_src->head_mutex);
+      dlna_src->head_requests_pending++;
+      g_mutex_unlock (&dlna_src->head_mutex);
+
+      g_main_context_invoke (dlna_src->head_context,
+          dlna_src_seek_cancel_superseded, dlna_src);
+    }
+
+    g_mutex_lock (&dlna_src->seek_mutex);
+    while (dlna_src->seek_executing)
+      g_cond_wait (&dlna_src->seek_cond, &dlna_src->seek_mutex);
+
+    /* Acknowledge it if an even newer seek came in meanwhile */
+    if (seqnum != (guint32) g_atomic_int_get (&dlna_src->seek_latest_seqnum)) {
+      g_mutex_unlock (&dlna_src->seek_mutex);
+      return TRUE;
+    }
+
+    dlna_src->seek_executing = TRUE;
+    dlna_src->seek_owner = g_thread_self ();
+    dlna_src->seek_executing_seqnum = seqnum;
+    g_mutex_unlock (&dlna_src->seek_mutex);
+    return FALSE;
+  }
+
+  dlna_src->seek_pending = gst_event_ref (event);
+  dlna_src->seek_pending_pad = gst_object_ref (pad);
+  superseded = dlna_src->seek_executing;
+
+  if (!dlna_src->seek_thread) {
+    dlna_src->seek_thread = g_thread_new ("dlnasrc_seek",
+        dlna_src_seek_thread_func, dlna_src);
+  }
+  g_cond_broadcast (&dlna_src->seek_cond);
+  g_mutex_unlock (&dlna_src->seek_mutex);
+
+  /* HEAD requests of the seek executing are of no use anymore */
+  if (superseded && dlna_src->head_context) {
+    g_mutex_lock (&dlna_src->head_mutex);
+    dlna_src->head_requests_pending++;
+    g_mutex_unlock (&dlna_src->head_mutex);
+
+    g_main_context_invoke (dlna_src->head_context,
+        dlna_src_seek_cancel_superseded, dlna_src);
+  }
+
+  return TRUE;
+}
+
+/**
+ * Check without waiting for the server whether a seek would be executed
+ * rather than rejected, from the content range last received.  Live time
+ * positions are only known to be valid while the range is current.
+ *
+ * @param dlna_src  this element
+ * @param event     seek event
+ *
+ * @return  TRUE if the seek is known to be executable, FALSE otherwise
+ */
+static gboolean
+dlna_src_seek_is_executable (GstDlnaSrc * dlna_src, GstEvent * event)
+{
+  GstDlnaSrcTrickPlan plan;
+  GstDlnaSrcRange *range;
+  gdouble rate;
+  GstFormat format;
+  GstSeekFlags flags;
+  GstSeekType start_type;
+  gint64 start;
+  GstSeekType stop_type;
+  gint64 stop;
+  guint64 npt_start;
+  guint64 npt_end;
+  guint64 npt_duration;
+  gboolean executable = FALSE;
+
+  if ((dlna_src->dlna_uri == NULL) || (dlna_src->server_info == NULL))
+    return TRUE;
+
+  gst_event_parse_seek (event, &rate, &format, &flags, &start_type, &start,
+      &stop_type, &stop);
+
+  if ((start < 0) || !dlna_src_rate_ladder_plan (dlna_src, rate, &plan))
+    return FALSE;
+
+  range = dlna_src_range_get (dlna_src);
+  if (format == GST_FORMAT_BYTES)
+    executable = range->byte_seek_supported &&
+        ((guint64) start >= range->byte_start) &&
+        ((guint64) start <= range->byte_end);
+  else if ((format == GST_FORMAT_TIME) && range->time_seek_supported) {
+    /* Same error margin as when the seek is handled */
+    if ((range->npt_end_nanos > 0) && ((guint64) start > range->npt_end_nanos)
+        && ((start - range->npt_end_nanos) < 2 * GST_SECOND))
+      start = range->npt_end_nanos;
+
+    if (dlna_src->is_live || dlna_src->is_recInProgress)
+      executable = dlna_src_is_live_range_current (dlna_src, start);
+    else {
+      dlna_src_range_extrapolate (dlna_src, range, &npt_start, &npt_end,
+          &npt_duration);
+      executable = ((guint64) start >= npt_start) &&
+          ((guint64) start <= npt_end);
+    }
+  }
+  dlna_src_range_unref (range);
+
+  return executable;
+}
+
+/**
+ * Execute a seek, and release the seek scheduler if the seek was claimed
+ * for this thread.  A seek superseded while executing is acknowledged even
+ * when a HEAD request it needed was cancelled.
+ *
+ * @param dlna_src  this element
+ * @param pad       pad the seek was received on
+ * @param event     seek event
+ *
+ * @return  true if this event has been handled, false otherwise
+ */
+static gboolean
+dlna_src_seek_execute (GstDlnaSrc * dlna_src, GstPad * pad, GstEvent * event)
+{
+  guint32 seqnum = gst_event_get_seqnum (event);
+  gboolean superseded = FALSE;
+  gboolean ret = FALSE;
+
+  ret = dlna_src_handle_event_seek (dlna_src, pad, event);
+
+  g_mutex_lock (&dlna_src->seek_mutex);
+  if (dlna_src->seek_owner == g_thread_self ()) {
+    dlna_src->seek_executing = FALSE;
+    dlna_src->seek_owner = NULL;
+    dlna_src->seek_executing_seqnum = 0;
+    dlna_src->seek_last_time = g_get_monotonic_time ();
+    g_cond_broadcast (&dlna_src->seek_cond);
+  }
+  superseded =
+      (seqnum != (guint32) g_atomic_int_get (&dlna_src->seek_latest_seqnum));
+  g_mutex_unlock (&dlna_src->seek_mutex);
+
+  if (!ret && superseded) {
+    GST_INFO_OBJECT (dlna_src, "Seek %u superseded while executing", seqnum);
+    dlna_src->forward_event = TRUE;
+    ret = TRUE;
+  }
+
+  return ret;
+}
+
+/**
+ * Seek thread, executes the latest parked seek once the seek executing has
+ * completed and the debounce window after it has passed.  Parked seeks are
+ * handled like the src pad event function does, including passing them on
+ * to souphttpsrc when not handled here.
+ */
+static gpointer
+dlna_src_seek_thread_func (gpointer data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) data;
+  GstEvent *event = NULL;
+  GstPad *pad = NULL;
+  gint64 deadline;
+  guint32 seqnum;
+  gboolean ret;
+
+  /* A thread started after this one was stopped takes over */
+  g_mutex_lock (&dlna_src->seek_mutex);
+  while (dlna_src->seek_thread == g_thread_self ()) {
+    if (!dlna_src->seek_pending || dlna_src->seek_executing) {
+      g_cond_wait (&dlna_src->seek_cond, &dlna_src->seek_mutex);
+      continue;
+    }
+
+    deadline = dlna_src->seek_last_time +
+        (gint64) dlna_src->seek_debounce * 1000;
+    if (g_get_monotonic_time () < deadline) {
+      g_cond_wait_until (&dlna_src->seek_cond, &dlna_src->seek_mutex,
+          deadline);
+      continue;
+    }
+
+    event = dlna_src->seek_pending;
+    pad = dlna_src->seek_pending_pad;
+    dlna_src->seek_pending = NULL;
+    dlna_src->seek_pending_pad = NULL;
+    dlna_src->seek_executing = TRUE;
+    dlna_src->seek_owner = g_thread_self ();
+    dlna_src->seek_executing_seqnum = gst_event_get_seqnum (event);
+    g_mutex_unlock (&dlna_src->seek_mutex);
+
+    GST_INFO_OBJECT (dlna_src, "Executing deferred seek %u",
+        gst_event_get_seqnum (event));
+    seqnum = gst_event_get_seqnum (event);
+    ret = dlna_src_seek_execute (dlna_src, pad, event);
+    if (ret)
+      gst_event_unref (event);
+    else if (!dlna_src->forward_event) {
+      /* Range changed since the seek was checked when parked */
+      dlna_src->forward_event = TRUE;
+      gst_event_unref (event);
+    } else {
+#if GST_CHECK_VERSION(1,0,0)
+      ret = gst_pad_event_default (pad, GST_OBJECT (dlna_src), event);
+#else
+      ret = gst_pad_event_default (pad, event);
+#endif
+    }
+    gst_object_unref (pad);
+
+    /* The seek was acknowledged when parked, let the application know */
+    if (!ret)
+      GST_ELEMENT_WARNING (dlna_src, RESOURCE, SEEK,
+          ("Deferred seek %u failed after being acknowledged", seqnum),
+          (NULL));
+
+    g_mutex_lock (&dlna_src->seek_mutex);
+  }
+  g_mutex_unlock (&dlna_src->seek_mutex);
+
+  return NULL;
+}
+
+/**
+ * Stop the seek thread and drop the seek parked, if any.  A seek the thread
+ * is executing completes first.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_seek_thread_stop (GstDlnaSrc * dlna_src)
+{
+  GThread *thread = NULL;
+
+  g_mutex_lock (&dlna_src->seek_mutex);
+  thread = dlna_src->seek_thread;
+  dlna_src->seek_thread = NULL;
+  g_cond_broadcast (&dlna_src->seek_cond);
+  if (dlna_src->seek_pending) {
+    GST_INFO_OBJECT (dlna_src, "Dropping deferred seek %u",
+        gst_event_get_seqnum (dlna_src->seek_pending));
+    gst_event_unref (dlna_src->seek_pending);
+    gst_object_unref (dlna_src->seek_pending_pad);
+    dlna_src->seek_pending = NULL;
+    dlna_src->seek_pending_pad = NULL;
+  }
+  g_mutex_unlock (&dlna_src->seek_mutex);
+
+  if (thread)
+    g_thread_join (thread);
+}
+
+/**
+ * Runs on the HEAD worker, cancels HEAD requests issued while executing a
+ * seek which has since been superseded.  Requests other requests have
+ * joined are left to complete.
+ */
+static gboolean
+dlna_src_seek_cancel_superseded (gpointer data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) data;
+  guint32 latest = (guint32) g_atomic_int_get (&dlna_src->seek_latest_seqnum);
+  GList *requests = NULL;
+  GList *item = NULL;
+  dlna_src_head_request *request = NULL;
+  dlna_src_head_flight *flight = NULL;
+
+  requests = g_list_copy (dlna_src->head_requests);
+  for (item = requests; item && !dlna_src->head_closing; item = item->next) {
+    request = (dlna_src_head_request *) item->data;
+    if (!request->seek_seqnum || request->seek_seqnum == latest)
+      continue;
+
+    if (request->flight_key) {
+      flight = g_hash_table_lookup (dlna_src->head_flights,
+          request->flight_key);
+      if (flight && flight->followers)
+        continue;
+    }
+
+    GST_INFO_OBJECT (dlna_src, "Cancelling HEAD request of superseded seek %u",
+        request->seek_seqnum);
+    soup_session_cancel_message (dlna_src->soup_session, request->soup_msg,
+        SOUP_STATUS_CANCELLED);
+  }
+  g_list_free (requests);
+
+  /* Counted like a HEAD request so the session is not closed under it */
+  g_mutex_lock (&dlna_src->head_mutex);
+  dlna_src->head_requests_pending--;
+  g_cond_broadcast (&dlna_src->head_cond);
+  g_mutex_unlock (&dlna_src->head_mutex);
+
+  return FALSE;
+}
+
+/**
+ * Perform action necessary when seek event is received
+ *
+ * @param dlna_src		this element
+ * @param seek_event	seek event which has been received
+ *
+ * @return	true if this event has been handled, false otherwise
+ */
+static gboolean
+dlna_src_handle_event_seek (GstDlnaSrc * dlna_src, GstPad * pad,
+    GstEvent * event)
+{
+  GST_LOG_OBJECT (dlna_src, "Handle seek event");
+
+  gboolean ret = FALSE;
+  gdouble rate;
+  GstFormat format;
+  GstSeekFlags flags;
+  GstSeekType start_type;
+  gint64 start;
+  GstSeekType stop_type;
+  gint64 stop;
+  guint32 new_seqnum;
+  gboolean convert_start = FALSE;
+  GstDlnaSrcRange *range;
+  GstDlnaSrcTraceEntry trace;
+
+  if ((dlna_src->dlna_uri == NULL) || (dlna_src->server_info == NULL)) {
+    GST_INFO_OBJECT (dlna_src,
+        "No URI and/or HEAD response info, event handled");
+    return TRUE;
+  }
+
+  new_seqnum = gst_event_get_seqnum (event);
+  if (new_seqnum == dlna_src->time_seek_seqnum) {
+    if (dlna_src->handled_time_seek_seqnum) {
+      GST_INFO_OBJECT (dlna_src, "Already processed seek event %d", new_seqnum);
+      return TRUE;
+    } else
+      /* *TODO* - see dlnasrc issue #63
+         Got same event now byte based since some element converted it to bytes
+         Convert here if time seek is supported since it is more accurate */
+    if (dlna_src->time_seek_supported) {
+      convert_start = TRUE;
+      GST_INFO_OBJECT (dlna_src,
+          "Set flag to convert time based seek to byte since server does support time seeks");
+    } else
+      GST_INFO_OBJECT (dlna_src,
+          "Unable to convert time based seek to byte since server does not support time seeks");
+  } else {
+    dlna_src->handled_time_seek_seqnum = FALSE;
+    dlna_src->time_seek_seqnum = new_seqnum;
+    dlna_src->time_seek_event_start = 0;
+  }
+
+  gst_event_parse_seek (event, &rate, (GstFormat *) & format,
+      (GstSeekFlags *) & flags,
+      (GstSeekType *) & start_type, (gint64 *) & start,
+      (GstSeekType *) & stop_type, (gint64 *) & stop);
+
+  GST_INFO_OBJECT (dlna_src,
+      "Got Seek event %d: rate: %3.1f, format: %s, flags: %d, start type: %d,  start: %"
+      G_GUINT64_FORMAT ", stop type: %d, stop: %"
+      G_GUINT64_FORMAT, gst_event_get_seqnum (event), rate,
+      gst_format_get_name (format), flags, start_type, start, stop_type, stop);
+
+  if (convert_start) {
+    GST_INFO_OBJECT (dlna_src,
+        "Supplied start byte %" G_GUINT64_FORMAT
+        " ignored, converting seek event start time %" GST_TIME_FORMAT
+        " to bytes", start, GST_TIME_ARGS (dlna_src->time_seek_event_start));
+    if (!dlna_src_convert_npt_nanos_to_bytes (dlna_src,
+            dlna_src->time_seek_event_start, (guint64 *) & start)) {
+      GST_WARNING_OBJECT (dlna_src, "Problems converting to bytes");
+      return TRUE;
+    }
+  }
+  
+  /* 2 second error margin to handle double rounding errors 
+   * npt_end_nanos might be 0 initially for live content.
+   */
+  range = dlna_src_range_get (dlna_src);
+  if((range->npt_end_nanos > 0) && (start > range->npt_end_nanos) 
+     && ((gint64)(start - range->npt_end_nanos) < (gint64)(2 * GST_SECOND)))
+  {
+     start = range->npt_end_nanos;
+  }
+  dlna_src_range_unref (range);
+
+  memset (&trace, 0, sizeof (trace));
+  trace.kind = DLNA_SRC_TRACE_SEEK;
+  trace.status = format;
+  trace.rate = rate;
+  if (format == GST_FORMAT_BYTES) {
+    trace.byte_start = start;
+    trace.byte_end = stop;
+  } else {
+    trace.npt_start = start;
+    trace.npt_end = stop;
+  }
+
+  if (!dlna_src_is_change_valid
+      (dlna_src, rate, format, start, start_type, stop, stop_type)) {
+    GST_WARNING_OBJECT (dlna_src, "Requested change is invalid, event handled");
+    trace.flags |= TRACE_FLAG_REJECTED;
+    dlna_src_trace_record (dlna_src, &trace);
+
+    dlna_src->handled_time_seek_seqnum = TRUE;
+    dlna_src->forward_event = FALSE;
+    return FALSE;
+  }
+  dlna_src_trace_record (dlna_src, &trace);
+  dlna_src_stats_mark (dlna_src, (dlna_src->rate != rate) ?
+      DLNA_SRC_LATENCY_RATE_CHANGE : DLNA_SRC_LATENCY_SEEK);
+
+  /* *TODO* - is this needed here??? Assign play rate to supplied rate */
+  if (dlna_src->rate != rate) {
+    /* Throughput measured at the old rate no longer applies */
+    dlna_src->rate = rate;
+    dlna_src->throughput = 0;
+    dlna_src->throughput_start = 0;
+    dlna_src_blocksize_update (dlna_src);
+  }
+
+  /* Keep data ready where trick play is expected to be left */
+  if ((rate != 1.0) && (format == GST_FORMAT_TIME))
+    dlna_src_prefetch_start (dlna_src, start, rate);
+  else if (!dlna_src->prefetch_stopped)
+    dlna_src_prefetch_stop (dlna_src);
+
+  /* Server is asked for its part of the rate, the rest is made up here */
+  dlna_src_rate_ladder_plan (dlna_src, rate, &dlna_src->trick_plan);
+  dlna_src->requested_rate = dlna_src->trick_plan.server_rate;
+  dlna_src->requested_format = format;
+  dlna_src->requested_start = start;
+  dlna_src->requested_stop = GST_CLOCK_TIME_NONE;
+  if (stop > -1)
+    dlna_src->requested_stop = stop;
+
+  /* The commented code block below is not needed as we need to play all
+   * the data in the TSB to reach the live point.
+   * An EOS will be received when playback reaches the end of TSB.
+   * And setting the duration as stop for rewind request does not make sense.
+   */
+#if 0
+  if (dlna_src->is_live && stop < 0) {
+    dlna_src->requested_stop = dlna_src->npt_end_nanos;
+    GST_INFO_OBJECT (dlna_src,
+        "Set requested stop to end of range since content is live: %"
+        G_GUINT64_FORMAT, dlna_src->requested_stop);
+  }
+#endif
+
+  if ((dlna_src->dlna_uri) && (dlna_src->server_info) &&
+      (dlna_src->server_info->content_features != NULL)) {
+    if (!dlna_src_adjust_http_src_headers (dlna_src, dlna_src->requested_rate,
+            dlna_src->requested_format, dlna_src->requested_start,
+            dlna_src->requested_stop, new_seqnum)) {
+      GST_ERROR_OBJECT (dlna_src, "Problems adjusting soup http src headers");
+      /* Returning true to prevent further processing */
+      return TRUE;
+    }
+  } else
+    GST_INFO_OBJECT (dlna_src,
+        "No header adjustments since server only supports Range requests");
+
+  /* Souphttpsrc does not handle time based seeks, so return TRUE */
+  if(GST_FORMAT_TIME == format)
+  {
+     do 
+     {
+        /* Resume from prefetched data if it holds the new position,
+         * otherwise send a dummy bytes based request to restart the
+         * gst_pad_task in basesrc(base class of souphttpsrc) */
+        if((0 != dlna_src->trick_plan.stride) &&
+           (TRUE == dlna_src_stride_serve(dlna_src, format, start,
+                                          &dlna_src->trick_plan, new_seqnum)))
+        {
+           GST_INFO_OBJECT(dlna_src, "Striding over content for trick play");
+        }
+        else if((1.0 == rate) &&
+           (TRUE == dlna_src_prefetch_serve(dlna_src, format, start, new_seqnum)))
+        {
+           GST_INFO_OBJECT(dlna_src, "Resumed from prefetched data");
+        }
+        else if((1.0 == rate) &&
+           (TRUE == dlna_src_parallel_serve(dlna_src, format, start, new_seqnum)))
+        {
+           GST_INFO_OBJECT(dlna_src, "Resumed with parallel requests");
+        }
+        else
+        {
+           /* Souphttpsrc takes over again from parallel requests */
+           dlna_src_parallel_leave(dlna_src);
+           if(TRUE != gst_element_seek_simple(dlna_src->http_src, GST_FORMAT_BYTES, GST_SEEK_FLAG_FLUSH, 0))
+           {
+              GST_WARNING("Sending seek to basesrc(souphttpsrc) failed\n");
+              break;
+           }
+        }
+        
+        GstEvent     *event = NULL;
+        GstStructure *structure = NULL;
+        gboolean      enable = FALSE;
+        gboolean      i_only = FALSE;
+        gchar         video_mask_str[16] = "";
+
+        /* A seek will make the server stream from TSB */
+        if(dlna_src->is_live)
+        {
+           dlna_src->in_tsb = TRUE;
+        }
+        
+        /* TODO - Figure out whehter the DMS is pacing and sending I/IP/all frames during trick modes */
+        if((rate > 1.0) || (rate < -1.0))
+        {
+           i_only = TRUE;
+        }
+
+        /* Only the server playspeed part of the rate is paced by the server */
+        if(1.0 != dlna_src->trick_plan.server_rate)
+        {
+           enable = TRUE;
+        }
+
+        if(TRUE == dlna_src->is_live)
+        {
+           if(TRUE != dlna_src_send_tsb_boundary_event(dlna_src))
+           {
+              break;
+           }
+        }
+
+        structure = gst_structure_new("serverside-pacing",
+                                      "enable", G_TYPE_BOOLEAN, enable,
+                                      "rate", G_TYPE_DOUBLE, rate,
+                                      "server-rate", G_TYPE_DOUBLE,
+                                      (gdouble) dlna_src->trick_plan.server_rate,
+                                      NULL);
+        if(NULL == structure)
+        {
+           GST_WARNING("Error creating serverside-pacing structure\n");
+           break;
+        }
+
+        event = gst_event_new_custom(GST_EVENT_CUSTOM_DOWNSTREAM, structure);
+        if(NULL == event)
+        {
+           gst_structure_free(structure);
+           structure = NULL;
+           GST_WARNING("Error creating custom downstream event\n");
+           break;
+        }
+
+        GST_DEBUG("Sending serverside_pacing custom downstream event\n");
+
+        if (gst_pad_push_event (dlna_src->src_pad, event) != TRUE)
+        {
+           event = NULL;
+           GST_WARNING("Sending custom downstream event failed!");
+           break;
+        }
+
+        if(TRUE == i_only)
+        {
+           strncpy(video_mask_str, "i_only", sizeof(video_mask_str));
+        }
+        else
+        {
+           strncpy(video_mask_str, "all", sizeof(video_mask_str));
+        }
+
+        structure = gst_structure_new("video-mask", "video-mask-str", G_TYPE_STRING, video_mask_str, NULL);
+        if(NULL == structure)
+        {
+           GST_ERROR("Error creating video-mask structure\n");
+           break;
+        }
+
+        event = gst_event_new_custom(GST_EVENT_CUSTOM_DOWNSTREAM, structure);
+        if(NULL == event)
+        {
+           gst_structure_free(structure);
+           structure = NULL;
+           GST_ERROR("Error creating video-mask event\n");
+           break;
+        }
+
+        GST_DEBUG("Sending video-mask custom downstream event\n");
+
+        if (gst_pad_push_event (dlna_src->src_pad, event) != TRUE)
+        {
+           event = NULL;
+           GST_WARNING("Sending custom downstream event failed!");
+           break;
+        }
+        ret = TRUE;
+
+     }while(0);
+     
+     return ret;
+  }
+  
+  if ((1.0 == rate) && (GST_FORMAT_BYTES == format) &&
+      (flags & GST_SEEK_FLAG_FLUSH) &&
+      dlna_src_cache_serve (dlna_src, start, new_seqnum)) {
+    GST_INFO_OBJECT (dlna_src, "Served byte seek from cache");
+    return TRUE;
+  }
+
+  if ((1.0 == rate) &&
+      dlna_src_prefetch_serve (dlna_src, format, start, new_seqnum)) {
+    GST_INFO_OBJECT (dlna_src, "Served byte seek from prefetched data");
+    return TRUE;
+  }
+
+  if ((1.0 == rate) && (flags & GST_SEEK_FLAG_FLUSH) &&
+      dlna_src_parallel_serve (dlna_src, format, start, new_seqnum)) {
+    GST_INFO_OBJECT (dlna_src, "Served byte seek with parallel requests");
+    return TRUE;
+  }
+
+  if ((0 != dlna_src->trick_plan.stride) && (flags & GST_SEEK_FLAG_FLUSH) &&
+      dlna_src_stride_serve (dlna_src, format, start, &dlna_src->trick_plan,
+          new_seqnum)) {
+    GST_INFO_OBJECT (dlna_src, "Striding over content for trick play");
+    return TRUE;
+  }
+
+  dlna_src_parallel_leave (dlna_src);
+
+  GST_DEBUG_OBJECT (dlna_src,
+      "returning false to make sure souphttpsrc gets chance to process");
+  return FALSE;
+}
+
+/**
+ * Determines if the requested rate and/or position change is valid.  Seek type is
+ * ignored since the position is always treated as absolute since a position must be
+ * included as part of the HTTP request otherwise zero is assumed.
+ *
+ * @param	dlna_src    this element
+ * @param	rate        new requested rate
+ * @param	format      format of change, either bytes or time
+ * @param	start       new starting position, either in bytes or time depending on format
+ * @param   start_type  starting seek type, either none, relative or absolute
+ * @param   stop        new stop position, either in bytes or time depending on format
+ * @param   stop_type   stop seek type, either none, relative or absolute
+ *
+ * @return	true if change is valid, false otherwise
+ *
+ */
+static gboolean
+dlna_src_is_change_valid (GstDlnaSrc * dlna_src, gfloat rate,
+    GstFormat format, guint64 start,
+    GstSeekType start_type, guint64 stop, GstSeekType stop_type)
+{
+  gchar *live_content_head_request_headers[][2] =
+      { {HEADER_GET_AVAILABLE_SEEK_RANGE_TITLE,
+      HEADER_GET_AVAILABLE_SEEK_RANGE_VALUE}
+  };
+
+  gsize live_content_head_request_headers_size = 1;
+  GstDlnaSrcRange *range;
+  guint64 npt_start;
+  guint64 npt_end;
+  guint64 npt_duration;
+  GstDlnaSrcTrickPlan plan;
+
+  GST_INFO_OBJECT (dlna_src, "Called");
+
+  if (dlna_src_rate_ladder_plan (dlna_src, rate, &plan)) {
+    GST_INFO_OBJECT (dlna_src, "New rate of %4.1f is supported", rate);
+  } else {
+    GST_WARNING_OBJECT (dlna_src, "Rate of %4.1f is not supported", rate);
+    return FALSE;
+  }
+
+  if (format == GST_FORMAT_BYTES) {
+    if (dlna_src->byte_seek_supported) {
+
+      if (start < dlna_src->byte_start || start > dlna_src->byte_end) {
+        GST_WARNING_OBJECT (dlna_src,
+            "Specified start byte %" G_GUINT64_FORMAT
+            " is not valid, valid range: %" G_GUINT64_FORMAT
+            " to %" G_GUINT64_FORMAT, start,
+            dlna_src->byte_start, dlna_src->byte_end);
+        return FALSE;
+      } else
+        GST_INFO_OBJECT (dlna_src,
+            "Specified start byte %"
+            G_GUINT64_FORMAT " is valid, valid range: %" G_GUINT64_FORMAT
+            " to %" G_GUINT64_FORMAT, start,
+            dlna_src->byte_start, dlna_src->byte_end);
+    } else {
+      GST_WARNING_OBJECT (dlna_src, "Server does not support byte based seeks");
+      return FALSE;
+    }
+  } else if (format == GST_FORMAT_TIME) {
+    if (dlna_src->time_seek_supported) {
+
+      if (((dlna_src->is_live) || (dlna_src->is_recInProgress)) &&
+          dlna_src_is_live_range_current (dlna_src, start)) {
+        GST_INFO_OBJECT (dlna_src,
+            "Start is within last known live range, refresh in background");
+        dlna_src_refresh_live_info_async (dlna_src,
+            DLNA_SRC_LATENCY_HEAD_AVAILABLE_RANGE);
+      } else if ((dlna_src->is_live) || (dlna_src->is_recInProgress)) {
+        GST_INFO_OBJECT (dlna_src, "Update live content range info");
+        if (!dlna_src_soup_issue_head (dlna_src,
+                live_content_head_request_headers_size,
+                live_content_head_request_headers, dlna_src->server_info,
+                TRUE, DLNA_SRC_LATENCY_HEAD_AVAILABLE_RANGE)) {
+          GST_ERROR_OBJECT (dlna_src,
+              "Problems issuing HEAD request to get live content information");
+          return FALSE;
+        }
+
+        g_object_set (G_OBJECT (dlna_src->http_src), "content-size",
+            dlna_src->byte_total, NULL);
+        GST_INFO_OBJECT (dlna_src,
+            "Set HTTP src content size: %" G_GUINT64_FORMAT,
+            dlna_src->byte_total);
+      }
+
+      /* Live ranges have moved on since they were received */
+      range = dlna_src_range_get (dlna_src);
+      dlna_src_range_extrapolate (dlna_src, range, &npt_start, &npt_end,
+          &npt_duration);
+      dlna_src_range_unref (range);
+      if (start < npt_start || start > npt_end) {
+        GST_WARNING_OBJECT (dlna_src,
+            "Specified start time %" GST_TIME_FORMAT
+            " is not valid, valid range: %" GST_TIME_FORMAT
+            " to %" GST_TIME_FORMAT, GST_TIME_ARGS (start),
+            GST_TIME_ARGS (npt_start), GST_TIME_ARGS (npt_end));
+        return FALSE;
+      }
+    } else {
+      GST_WARNING_OBJECT (dlna_src, "Server does not support time based seeks");
+      return FALSE;
+    }
+  } else {
+    GST_WARNING_OBJECT (dlna_src, "Supplied format type is not supported: %d",
+        format);
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (dlna_src, "Requested change is valid");
+
+  return TRUE;
+}
+
+/**
+ * Plan how to play a rate.  A server playspeed equal to the rate is used
+ * as is.  Rates slower than 1x are only played that way, skipping cannot
+ * slow playback down.  Otherwise the nearest server playspeed in the same
+ * direction which is not faster (or 1x fetch going forward) is used and the
+ * rest is made up on the client by skipping to I-frames, unless striding
+ * over the content with 1x range requests would fetch fewer bytes per
+ * second.
+ * Striding over a transport stream only pushes data from the random access
+ * points found in the chunks, which also works with servers without time
+ * seek or playspeed support.
+ * Costs are estimated from the average byte rate of the content.
+ *
+ * @param dlna_src  this element
+ * @param rate      requested rate
+ * @param plan      filled in with how to play rate
+ *
+ * @return  TRUE if rate can be played, FALSE otherwise
+ */
+static gboolean
+dlna_src_rate_ladder_plan (GstDlnaSrc * dlna_src, gfloat rate,
+    GstDlnaSrcTrickPlan * plan)
+{
+  static const gchar *mode_names[] = { "none", "server", "server+skip",
+    "stride", "i-frame stride"
+  };
+  GstDlnaSrcRange *range;
+  guint64 bytes_per_sec = TRICK_DEFAULT_BYTES_PER_SEC;
+  guint64 stride_bytes;
+  guint64 stride_cost;
+  gfloat server_rate = (rate > 0) ? 1.0 : 0.0;
+  gfloat speed;
+  guint i;
+
+  memset (plan, 0, sizeof (*plan));
+  plan->mode = DLNA_SRC_TRICK_NONE;
+  plan->server_rate = 1.0;
+  plan->client_factor = 1.0;
+
+  range = dlna_src_range_get (dlna_src);
+  if (range->byte_total && range->npt_duration_nanos)
+    bytes_per_sec = gst_util_uint64_scale (range->byte_total, GST_SECOND,
+        range->npt_duration_nanos);
+  plan->cost = bytes_per_sec;
+
+  if (rate == 1.0) {
+    dlna_src_range_unref (range);
+    return TRUE;
+  }
+
+  if (range->time_seek_supported) {
+    for (i = 0; i < range->playspeeds_cnt; i++) {
+      speed = range->playspeeds[i];
+      if (speed == rate) {
+        server_rate = speed;
+        break;
+      }
+      if ((speed * rate > 0) && (ABS (speed) < ABS (rate)) &&
+          (ABS (speed) > ABS (server_rate)))
+        server_rate = speed;
+    }
+  }
+
+  if (server_rate == rate) {
+    plan->mode = DLNA_SRC_TRICK_SERVER;
+    plan->server_rate = rate;
+  } else if (ABS (rate) < 1.0) {
+    GST_INFO_OBJECT (dlna_src, "Rate %.2f is slower than 1x and not a "
+        "server playspeed", rate);
+    dlna_src_range_unref (range);
+    return FALSE;
+  } else if (server_rate != 0.0) {
+    plan->mode = DLNA_SRC_TRICK_SERVER_SKIP;
+    plan->server_rate = server_rate;
+    plan->client_factor = rate / server_rate;
+    plan->cost = (guint64) (bytes_per_sec * ABS (plan->client_factor));
+  }
+
+#if GST_CHECK_VERSION(1,0,0)
+  /* Chunks are pushed after the decrypter and the TSB moves under them */
+  if ((plan->mode != DLNA_SRC_TRICK_SERVER) && (ABS (rate) > 1.0) &&
+      range->byte_seek_supported && range->byte_total &&
+      !dlna_src->is_live && !dlna_src->is_encrypted &&
+      !dlna_src->dtcp_decrypter && dlna_src->head_context &&
+      dlna_src->http_uri) {
+    stride_bytes = (guint64) (bytes_per_sec * ABS (rate)) /
+        TRICK_STRIDE_CHUNKS_PER_SEC;
+    stride_cost = (guint64) TRICK_STRIDE_CHUNK_SIZE *
+        TRICK_STRIDE_CHUNKS_PER_SEC;
+    if ((stride_bytes > TRICK_STRIDE_CHUNK_SIZE) &&
+        ((plan->mode == DLNA_SRC_TRICK_NONE) || (stride_cost < plan->cost))) {
+      plan->mode = dlna_src_is_transport_stream (dlna_src) ?
+          DLNA_SRC_TRICK_IFRAME_STRIDE : DLNA_SRC_TRICK_STRIDE;
+      plan->server_rate = 1.0;
+      plan->client_factor = rate;
+      plan->cost = stride_cost;
+      plan->stride = (rate > 0) ? (gint64) stride_bytes :
+          -(gint64) stride_bytes;
+    }
+  }
+#endif
+  dlna_src_range_unref (range);
+
+  if (plan->mode == DLNA_SRC_TRICK_NONE) {
+    GST_INFO_OBJECT (dlna_src, "No way to play rate %.2f", rate);
+    return FALSE;
+  }
+
+  GST_INFO_OBJECT (dlna_src, "Rate %.2f: %s, server rate %.2f, client "
+      "factor %.2f, ~%" G_GUINT64_FORMAT " bytes/sec", rate,
+      mode_names[plan->mode], plan->server_rate, plan->client_factor,
+      plan->cost);
+
+  return TRUE;
+}
+
+#if GST_CHECK_VERSION(1,0,0)
+/**
+ * Find the first random access point in transport stream data, a packet
+ * whose adaptation field has the random access indicator set, which is
+ * where the next I-frame starts.  Packets of 188 bytes and timestamped
+ * packets of 192 bytes are recognized by their sync bytes.
+ *
+ * @param data  data starting anywhere in the stream
+ * @param size  number of bytes in data
+ * @param start set to the offset of the packet in data
+ * @param end   set to the end of the last whole packet in data
+ *
+ * @return  TRUE if a random access point was found, FALSE otherwise
+ */
+static gboolean
+dlna_src_ts_find_random_access (const guint8 * data, gsize size,
+    gsize * start, gsize * end)
+{
+  const guint8 *packet;
+  guint packet_size = 0;
+  guint prefix;
+  gsize sync;
+  gsize pos;
+
+  for (sync = 0; (sync < TTS_PACKET_SIZE) &&
+      (sync + 2 * TTS_PACKET_SIZE < size); sync++) {
+    if (data[sync] != TS_SYNC_BYTE)
+      continue;
+    if ((data[sync + TS_PACKET_SIZE] == TS_SYNC_BYTE) &&
+        (data[sync + 2 * TS_PACKET_SIZE] == TS_SYNC_BYTE)) {
+      packet_size = TS_PACKET_SIZE;
+      break;
+    }
+    if ((data[sync + TTS_PACKET_SIZE] == TS_SYNC_BYTE) &&
+        (data[sync + 2 * TTS_PACKET_SIZE] == TS_SYNC_BYTE)) {
+      packet_size = TTS_PACKET_SIZE;
+      break;
+    }
+  }
+  if (!packet_size)
+    return FALSE;
+
+  /* Timestamped packets start with the 4 byte timestamp */
+  prefix = packet_size - TS_PACKET_SIZE;
+  if (sync < prefix)
+    sync += packet_size;
+
+  for (pos = sync; pos + TS_PACKET_SIZE <= size; pos += packet_size) {
+    packet = data + pos;
+    if (packet[0] != TS_SYNC_BYTE)
+      return FALSE;
+
+    /* Adaptation field present, not empty, random access indicator set */
+    if ((packet[3] & 0x20) && (packet[4] > 0) && (packet[5] & 0x40)) {
+      *start = pos - prefix;
+      *end = *start + (size - *start) / packet_size * packet_size;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+#endif
+
+/**
+ * Determines if the content is an MPEG transport stream, from its DLNA
+ * profile or content type.
+ *
+ * @param dlna_src  this element
+ *
+ * @return  TRUE if content is a transport stream, FALSE otherwise
+ */
+static gboolean
+dlna_src_is_transport_stream (GstDlnaSrc * dlna_src)
+{
+  GstDlnaSrcHeadResponse *server_info = dlna_src->server_info;
+
+  if (!server_info)
+    return FALSE;
+
+  if (server_info->content_features &&
+      server_info->content_features->profile &&
+      strstr (server_info->content_features->profile, "_TS_"))
+    return TRUE;
+
+  return server_info->content_type &&
+      (strstr (server_info->content_type, "mp2t") ||
+      strstr (server_info->content_type, "mpeg-tts"));
+}
+
+/**
+ * Create extra headers to supply to soup http src based on requested starting
+ * postion and rate.  Instruct souphttpsrc to exclude range header if it conflicts
+ * with any of the extra headers which have been added.
+ *
+ * @param	dlna_src 	this element
+ * @param	rate		requested rate to include in playspeed header
+ * @param	format		create either time or byte based seek header
+ * @param	start		starting position to include, will be either bytes or time depending on format
+ * @param   stop        stopping position to include, will be -1 if unspecified
+ *
+ * @return	true if extra headers were successfully created, false otherwise
+ */
+static gboolean
+dlna_src_adjust_http_src_headers (GstDlnaSrc * dlna_src, gfloat rate,
+    GstFormat format, guint64 start, guint64 stop, guint32 new_seqnum)
+{
+  GValue struct_value = G_VALUE_INIT;
+  GstStructure *extra_headers_struct;
+
+  gboolean disable_range_header = FALSE;
+  int i = 0;
+  gchar *rateStr = NULL;
+
+  const gchar *playspeed_field_name = "PlaySpeed.dlna.org";
+  const gchar *playspeed_field_value_prefix = "speed=";
+  gchar playspeed_field_value[64] = { 0 };
+
+  const gchar *time_seek_range_field_name = "TimeSeekRange.dlna.org";
+  const gchar *time_seek_range_field_value_prefix = "npt=";
+  gchar time_seek_range_field_value[64] = { 0 };
+  guint64 start_time_nanos;
+  guint64 start_time_secs;
+  guint64 stop_time_nanos = GST_CLOCK_TIME_NONE;
+  guint64 stop_time_secs;
+
+  const gchar *range_dtcp_field_name = "Range.dtcp.com";
+  const gchar *range_dtcp_field_value_prefix = "bytes=";
+  gchar range_dtcp_field_value[64] = { 0 };
+
+  /* Make sure range header is included by default */
+  GValue boolean_value = G_VALUE_INIT;
+  g_value_init (&boolean_value, G_TYPE_BOOLEAN);
+  g_value_set_boolean (&boolean_value, FALSE);
+  g_object_set_property (G_OBJECT (dlna_src->http_src), "exclude-range-header",
+      &boolean_value);
+
+  /* Create header structure with dlna transfer mode header */
+  extra_headers_struct = gst_structure_new ("extraHeadersStruct",
+      "transferMode.dlna.org", G_TYPE_STRING, "Streaming", NULL);
+  if (extra_headers_struct == NULL) {
+    GST_WARNING_OBJECT (dlna_src, "Problems creating extra headers structure");
+    return FALSE;
+  }
+
+  /* If rate != 1.0, add playspeed header and time seek range header */
+  if (rate != 1.0) {
+    /* Get string representation of rate (use original values to make fractions easy like 1/3) */
+    for (i = 0; i < dlna_src->server_info->content_features->playspeeds_cnt;
+        i++) {
+      if (dlna_src->server_info->content_features->playspeeds[i] == rate) {
+        rateStr = dlna_src->server_info->content_features->playspeed_strs[i];
+        break;
+      }
+    }
+    if (rateStr == NULL) {
+      GST_ERROR_OBJECT (dlna_src,
+          "Unable to get string representation of supported rate: %lf", rate);
+      return FALSE;
+    }
+    g_snprintf (playspeed_field_value, 64, "%s%s",
+        playspeed_field_value_prefix, rateStr);
+
+    gst_structure_set (extra_headers_struct, playspeed_field_name,
+        G_TYPE_STRING, &playspeed_field_value, NULL);
+    GST_INFO_OBJECT (dlna_src,
+        "Adjust headers by including playspeed header value: %s",
+        playspeed_field_value);
+  }
+
+  /* Add time seek header for all non 1x rates or for time based seeks */
+  if (rate != 1.0 || (format == GST_FORMAT_TIME
+          && dlna_src->time_seek_supported)) {
+    if (format != GST_FORMAT_TIME) {
+      if (!dlna_src_convert_bytes_to_npt_nanos (dlna_src, start,
+              &start_time_nanos)) {
+        GST_WARNING_OBJECT (dlna_src,
+            "Problems converting start %" G_GUINT64_FORMAT " to npt ", start);
+        return FALSE;
+      } else
+        GST_INFO_OBJECT (dlna_src,
+            "Due to non 1x playspeed, converted start %" G_GUINT64_FORMAT
+            " bytes into time %" G_GUINT64_FORMAT, start, start_time_nanos);
+
+      if (stop > GST_CLOCK_TIME_NONE) {
+        if (!dlna_src_convert_bytes_to_npt_nanos (dlna_src, stop,
+                &stop_time_nanos)) {
+          GST_WARNING_OBJECT (dlna_src,
+              "Problems converting stop %" G_GUINT64_FORMAT " to npt ", stop);
+          return FALSE;
+        } else
+          GST_INFO_OBJECT (dlna_src,
+              "Due to non 1x playspeed, converted stop %" G_GUINT64_FORMAT
+              " bytes into time %" G_GUINT64_FORMAT, start, start_time_nanos);
+      } else
+        GST_INFO_OBJECT (dlna_src, "Stop undefined, no conversion needed");
+    } else {
+      /* Already in time format, no conversion necessary */
+      start_time_nanos = start;
+      stop_time_nanos = stop;
+      GST_INFO_OBJECT (dlna_src,
+          "Using start %" G_GUINT64_FORMAT " and stop %" G_GUINT64_FORMAT,
+          start_time_nanos, stop_time_nanos);
+    }
+
+    /* Convert time from nanos into secs for header value string */
+    start_time_secs = start_time_nanos / GST_SECOND;
+
+    if (stop_time_nanos == GST_CLOCK_TIME_NONE) {
+      GST_INFO_OBJECT (dlna_src,
+          "Stop time is undefined, just including start time");
+      g_snprintf (time_seek_range_field_value, 64,
+          "%s%" G_GUINT64_FORMAT ".0-", time_seek_range_field_value_prefix,
+          start_time_secs);
+    } else {
+      stop_time_secs = stop_time_nanos / GST_SECOND;
+      GST_INFO_OBJECT (dlna_src, "Including stop secs: %" G_GUINT64_FORMAT,
+          stop_time_secs);
+      g_snprintf (time_seek_range_field_value, 64,
+          "%s%" G_GUINT64_FORMAT ".0-%" G_GUINT64_FORMAT ".0",
+          time_seek_range_field_value_prefix, start_time_secs, stop_time_secs);
+    }
+    gst_structure_set (extra_headers_struct, time_seek_range_field_name,
+        G_TYPE_STRING, &time_seek_range_field_value, NULL);
+
+    GST_INFO_OBJECT (dlna_src,
+        "Adjust headers by including TimeSeekRange header value: %s",
+        time_seek_range_field_value);
+
+    /* Set flag so range header is not included by souphttpsrc */
+    disable_range_header = TRUE;
+
+    /* Record seqnum since have handled this event as time based seek */
+    dlna_src->handled_time_seek_seqnum = TRUE;
+  } else
+    GST_INFO_OBJECT (dlna_src,
+        "Not adjusting with playspeed or time seek range ");
+
+  if (format == GST_FORMAT_TIME && !dlna_src->time_seek_supported) {
+    GST_INFO_OBJECT (dlna_src,
+        "Saving start time incase get this event again in bytes in order to do acurate conversion");
+    dlna_src->time_seek_event_start = start;
+  }
+
+  /* If dtcp protected content and rate = 1.0, add range.dtcp.com header */
+  if (rate == 1.0 && format == GST_FORMAT_BYTES
+      && dlna_src->is_encrypted && dlna_src->byte_seek_supported) {
+    g_snprintf (range_dtcp_field_value, 64, "%s%" G_GUINT64_FORMAT "-",
+        range_dtcp_field_value_prefix, start);
+
+    gst_structure_set (extra_headers_struct, range_dtcp_field_name,
+        G_TYPE_STRING, &range_dtcp_field_value, NULL);
+
+    GST_INFO_OBJECT (dlna_src,
+        "Adjust headers by including Range.dtcp.com header value: %s",
+        range_dtcp_field_value);
+
+    /* Set flag so range header is not included by souphttpsrc */
+    disable_range_header = TRUE;
+  } else
+    GST_INFO_OBJECT (dlna_src, "Not adjusting with range.dtcp.com");
+
+  g_value_init (&struct_value, GST_TYPE_STRUCTURE);
+  gst_value_set_structure (&struct_value, extra_headers_struct);
+  g_object_set_property (G_OBJECT (dlna_src->http_src), "extra-headers",
+      &struct_value);
+  gst_structure_free (extra_headers_struct);
+
+  if(GST_FORMAT_TIME == format)
+  {
+     g_value_set_boolean (&boolean_value, TRUE);
+     g_object_set_property (G_OBJECT (dlna_src->http_src),
+           "dlna-time-seek", &boolean_value);
+  }
+
+  /* Disable range header if necessary */
+  if (disable_range_header || !dlna_src->byte_seek_supported) {
+    g_value_set_boolean (&boolean_value, TRUE);
+    g_object_set_property (G_OBJECT (dlna_src->http_src),
+        "exclude-range-header", &boolean_value);
+    GST_INFO_OBJECT (dlna_src,
+        "Adjust headers by excluding range header, flag: %d, supported: %d",
+        disable_range_header, dlna_src->byte_seek_supported);
+  }
+
+  return TRUE;
+}
+
+static uri_parser_retcode dlna_src_parse_uri_get_key_val(GstDlnaSrc *dlna_src,
+                                                         gchar *uri,
+                                                         gchar *key,
+                                                         gchar *value,
+                                                         guint32 value_size)
+{
+   uri_parser_retcode ret = URI_PARSER_ERROR;
+   gint32         	 uri_parse_ret;
+   gint32         	 uri_dissect_ret;
+   UriUriA            uriParserUri;
+   UriQueryListA      *pOptionsList = NULL;
+   gint32             numOptions;
+   UriParserStateA 	 uriParserState;
+   UriQueryListA   	 *pOption = NULL;
+   gboolean           bKeyFound = FALSE;
+
+   do
+   {
+      if(NULL == dlna_src)
+      {
+         GST_ERROR_OBJECT(dlna_src, "Param dlna_src is NULL\n");
+         break;
+      }
+      if(NULL == uri)
+      {
+         GST_ERROR_OBJECT(dlna_src, "Param uri is NULL\n");
+         break;
+      }
+      if(NULL == key)
+      {
+         GST_ERROR_OBJECT(dlna_src, "Param key is NULL\n");
+         break;
+      }
+      if(NULL == value)
+      {
+         GST_ERROR_OBJECT(dlna_src, "Param value is NULL\n");
+         break;
+      }
+
+      uriParserState.uri = &uriParserUri;
+      uri_parse_ret = uriParseUriA(&uriParserState, uri);
+      if(URI_SUCCESS != uri_parse_ret)
+      {
+         GST_ERROR_OBJECT(dlna_src, "uriParseUriA(%s) failed - errcode: %d\n",
+               uri, uriParserState.errorCode);
+         if(URI_ERROR_SYNTAX == uriParserState.errorCode)
+         {
+            GST_ERROR_OBJECT(dlna_src, "URI syntax error\n");
+         }
+         break; 
+      }
+
+      uri_dissect_ret = uriDissectQueryMallocA(&pOptionsList, 
+            &numOptions, 
+            uriParserUri.query.first,
+            uriParserUri.query.afterLast); 
+      if(URI_SUCCESS != uri_dissect_ret)
+      {
+         GST_ERROR_OBJECT(dlna_src, "Error %d parsing uri (%s) into key/value pairs\n",
+               uri_dissect_ret, uri);
+         break;
+      }
+
+      GST_INFO_OBJECT(dlna_src, "Total number of URI key value pairs = %d\n", numOptions);
+
+      for (pOption = pOptionsList; pOption ;pOption = pOption->next) 
+      {
+         GST_INFO_OBJECT(dlna_src, "%s : %s\n", pOption->key, pOption->value);
+
+         if(!strcmp(pOption->key, key))
+         {
+            bKeyFound = TRUE;
+            if(strlen(pOption->value) >= value_size)
+            {
+               GST_ERROR_OBJECT(dlna_src, "size of value param is less than "
+                     "the value string for key: %s\n", key);
+               break;
+            }
+            g_strlcpy(value, pOption->value, value_size);
+            ret = URI_PARSER_SUCCESS;
+            break;
+         }
+      }
+
+      if(TRUE != bKeyFound)
+      {
+         ret = URI_PARSER_KEY_NOT_FOUND;
+      }
+   }while(0);
+
+   uriFreeQueryListA(pOptionsList);
+   uriFreeUriMembersA(&uriParserUri);
+
+   return ret;
+}
+
+#if GST_CHECK_VERSION(1,0,0)
+static guint
+gst_dlna_src_uri_get_type (GType type)
+{
+  return GST_URI_SRC;
+}
+#else
+static GstURIType
+gst_dlna_src_uri_get_type(void)
+{
+  return GST_URI_SRC;
+}
+#endif
+
+#if GST_CHECK_VERSION(1,0,0)
+static const gchar *const *
+gst_dlna_src_uri_get_protocols (GType type)
+{
+  static const gchar *protocols[] = { "dlna+http", "dlna+https", NULL };
+  return protocols;
+}
+#else
+static gchar **
+gst_dlna_src_uri_get_protocols (void)
+{
+  static gchar *protocols[] = { "dlna+http", "dlna+https", NULL };
+  return protocols;
+}
+#endif
+
+#if GST_CHECK_VERSION(1,0,0)
+static gchar *
+gst_dlna_src_uri_get_uri (GstURIHandler * handler)
+{
+  GstDlnaSrc *dlna_src = GST_DLNA_SRC (handler);
+  return g_strdup (dlna_src->dlna_uri);
+}
+#else
+G_CONST_RETURN gchar *
+gst_dlna_src_uri_get_uri(GstURIHandler * handler)
+{
+  GstDlnaSrc *dlna_src = GST_DLNA_SRC (handler);
+  return g_strdup (dlna_src->dlna_uri);
+}
+#endif
+
+#if GST_CHECK_VERSION(1,0,0)
+static gboolean
+gst_dlna_src_uri_set_uri (GstURIHandler * handler, const gchar * uri,
+    GError ** error)
+{
+  GstDlnaSrc *dlna_src = GST_DLNA_SRC (handler);
+
+  GST_INFO_OBJECT (dlna_src, "uri handler called to set uri: %s, current: %s",
+      uri, dlna_src->dlna_uri);
+
+  return dlna_src_uri_assign (dlna_src, uri, error);
+}
+#else
+static gboolean
+gst_dlna_src_uri_set_uri(GstURIHandler * handler, const gchar * uri)
+{
+  GstDlnaSrc *dlna_src = GST_DLNA_SRC (handler);
+
+  GST_INFO_OBJECT (dlna_src, "uri handler called to set uri: %s, current: %s",
+      uri, dlna_src->dlna_uri);
+
+  return dlna_src_uri_assign (dlna_src, uri);
+}
+#endif
+
+static void
+gst_dlna_src_uri_handler_init (gpointer g_iface, gpointer iface_data)
+{
+  GstURIHandlerInterface *iface = (GstURIHandlerInterface *) g_iface;
+
+  iface->get_type = gst_dlna_src_uri_get_type;
+  iface->get_protocols = gst_dlna_src_uri_get_protocols;
+  iface->get_uri = gst_dlna_src_uri_get_uri;
+  iface->set_uri = gst_dlna_src_uri_set_uri;
+}
+
+/**
+ * Sets the URI property to the supplied value.  It is called either via the URI
+ * handler interface set method or via setting the element's property.  The
+ * additional setup (issuing HEAD and setting up souphttpsrc for GET) for the URI
+ * is suppose to be performed when state changes from READY->PAUSED but it seems
+ * that it must be performed here otherwise we get an error and playback fails due
+ * to unlinked.
+ */
+static gboolean
+#if GST_CHECK_VERSION(1,0,0)
+dlna_src_uri_assign (GstDlnaSrc * dlna_src, const gchar * uri, GError ** error)
+#else
+dlna_src_uri_assign (GstDlnaSrc * dlna_src, const gchar * uri)
+#endif
+{
+  gboolean ret = FALSE;
+  gchar *dlna_prefix = "dlna+";
+  GString *http_uri;
+
+
+  if (uri == NULL)
+  {
+#if GST_CHECK_VERSION(1,0,0)
+    g_set_error (error, GST_URI_ERROR, GST_URI_ERROR_BAD_URI, "Bad URI passed");
+#endif
+    return FALSE;
+  }
+
+  if (dlna_src->dlna_uri) {
+    dlna_src_head_response_free_struct (dlna_src, dlna_src->server_info);
+    dlna_src->server_info = NULL;
+    /* HEAD responses of the previous URI must not be shared */
+    g_atomic_int_inc (&dlna_src->head_flights_generation);
+    g_free (dlna_src->dlna_uri);
+    dlna_src->dlna_uri = NULL;
+    g_free (dlna_src->http_uri);
+    dlna_src->http_uri = NULL;
+    g_free (dlna_src->server_key);
+    dlna_src->server_key = NULL;
+  }
+  dlna_src_seek_index_clear (dlna_src);
+  dlna_src_prefetch_clear (dlna_src);
+  dlna_src_cache_clear (dlna_src);
+
+  dlna_src->dlna_uri = g_strdup (uri);
+  if (g_ascii_strncasecmp (dlna_src->dlna_uri, dlna_prefix,
+          strlen (dlna_prefix)) == 0) {
+    http_uri = g_string_new (dlna_src->dlna_uri);
+    http_uri = g_string_erase (http_uri, 0, strlen (dlna_prefix));
+    dlna_src->http_uri = g_string_free (http_uri, FALSE);
+    GST_INFO_OBJECT (dlna_src, "Set http URI: %s, based on dlna URI: %s",
+        dlna_src->http_uri, dlna_src->dlna_uri);
+  } else {
+    dlna_src->http_uri = g_strdup (uri);
+    GST_INFO_OBJECT (dlna_src, "URI did not have dlna prepended: %s",
+        dlna_src->http_uri);
+  }
+
+  ret = dlna_src_uri_init (dlna_src);
+#if GST_CHECK_VERSION(1,0,0)
+  if (ret != TRUE)
+  {
+     g_set_error (error, GST_URI_ERROR, GST_URI_ERROR_UNSUPPORTED_PROTOCOL,
+                  "Source doesn't support the requested protocol");
+  }
+#endif
+  return ret;
+}
+
+/**
+ * Gathers the info about the URI and then sets up the bin, either including the
+ * dtcp decrypter element or not based on HEAD response.
+ */
+static gboolean
+dlna_src_uri_init (GstDlnaSrc * dlna_src)
+{
+  GST_DEBUG_OBJECT (dlna_src, "Initializing URI");
+
+  if (dlna_src->is_uri_initialized) {
+    GST_DEBUG_OBJECT (dlna_src, "Returning since URI is already initialized");
+    return TRUE;
+  }
+
+  if (!dlna_src_uri_gather_info (dlna_src)) {
+    GST_ERROR_OBJECT (dlna_src, "Problems gathering URI info");
+    return FALSE;
+  }
+ 
+  if (!dlna_src_uri_parse_max_tsb_duration (dlna_src))
+     return FALSE;
+
+  if (!dlna_src_setup_bin (dlna_src)) {
+    GST_ERROR_OBJECT (dlna_src, "Problems setting up dtcp elements");
+    return FALSE;
+  }
+
+  dlna_src->is_uri_initialized = TRUE;
+
+  return TRUE;
+}
+
+/**
+ * Take the maximum TSB duration of live content from the tsb parameter of
+ * the URI, if it has one.
+ *
+ * @param dlna_src	this element
+ *
+ * @return	false if the parameter could not be parsed, true otherwise
+ */
+static gboolean
+dlna_src_uri_parse_max_tsb_duration (GstDlnaSrc * dlna_src)
+{
+  gchar              max_tsb_duration_str[8] = "1";
+  uri_parser_retcode ret = URI_PARSER_ERROR;
+  guint32            tmp_max_tsb_duration = 0;
+
+  if(TRUE == dlna_src->is_live)
+  {
+     ret = dlna_src_parse_uri_get_key_val(dlna_src, 
+                                          dlna_src->http_uri, 
+                                          "tsb", 
+                                          max_tsb_duration_str,
+                                          8);
+     if(URI_PARSER_SUCCESS == ret)
+     {
+        GST_DEBUG_OBJECT(dlna_src, "max_tsb_duration_str : %s\n", max_tsb_duration_str);
+        tmp_max_tsb_duration = strtoul(max_tsb_duration_str, NULL, 10);
+        GST_WARNING_OBJECT(dlna_src, "max_tsb_duration from URI in secs: %u\n", 
+              tmp_max_tsb_duration * 60);
+        
+        /* TODO - Remove this check when tsb=1 URI means 1 minute long TSB.
+         * i.e when the TSB duration is not read from rmconfig.ini */
+        if(1 != tmp_max_tsb_duration)
+        {
+           /* convert to seconds */
+           dlna_src->max_tsb_duration = tmp_max_tsb_duration * 60;
+        }
+     }
+     else if(URI_PARSER_KEY_NOT_FOUND == ret)
+     {
+        GST_WARNING_OBJECT(dlna_src, "URI does not have the tsb max duration value\n");
+     }
+     else
+     {
+        GST_ERROR_OBJECT(dlna_src, "Unable to get the TSB max duration value from the URI\n");
+        return FALSE;
+     }
+  }
+
+  return TRUE;
+}
+
+/**
+ * Size the blocks souphttpsrc reads so each holds the configured duration of
+ * content at the average bitrate of the content.  The measured throughput
+ * only caps the size, so a block never takes longer than its duration to
+ * arrive on a slow link.  Trick play rates are capped to small blocks to
+ * keep latency low.  Without a bitrate or when adaptation is disabled, the
+ * fixed default block size is used.  With dtcpip in the bin the DTCP block
+ * size is always used, dtcpip relies on it.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_blocksize_update (GstDlnaSrc * dlna_src)
+{
+  GstDlnaSrcRange *range;
+  guint64 bytes_per_sec = 0;
+  guint64 blocksize = 0;
+  guint max_blocksize = MAX_ADAPTIVE_BLOCKSIZE;
+
+  if (!dlna_src->http_src)
+    return;
+
+  range = dlna_src_range_get (dlna_src);
+  if (range->byte_total && range->npt_duration_nanos)
+    bytes_per_sec = gst_util_uint64_scale (range->byte_total, GST_SECOND,
+        range->npt_duration_nanos);
+  dlna_src_range_unref (range);
+
+  if (dlna_src->dtcp_decrypter) {
+    if (dlna_src->blocksize == dlna_src->dtcp_blocksize)
+      return;
+    blocksize = dlna_src->dtcp_blocksize;
+  } else if (!dlna_src->block_duration || !bytes_per_sec)
+    blocksize = SOUPHTTPSRC_BLOCKSIZE;
+  else {
+    if ((dlna_src->rate > 1.0) || (dlna_src->rate < 1.0))
+      max_blocksize = MIN (max_blocksize, MAX_TRICK_BLOCKSIZE);
+
+    blocksize = (bytes_per_sec * dlna_src->block_duration) / 1000;
+    if (dlna_src->throughput)
+      blocksize = MIN (blocksize,
+          (dlna_src->throughput * dlna_src->block_duration) / 1000);
+    blocksize = CLAMP (blocksize, MIN_ADAPTIVE_BLOCKSIZE, max_blocksize);
+    blocksize -= blocksize % ADAPTIVE_BLOCKSIZE_ALIGN;
+
+    /* Avoid resizing back and forth on small throughput changes */
+    if (dlna_src->blocksize &&
+        (ABS ((gint64) blocksize - (gint64) dlna_src->blocksize) * 100 <
+            (gint64) dlna_src->blocksize * BLOCKSIZE_HYSTERESIS_PCT))
+      return;
+  }
+
+  GST_INFO_OBJECT (dlna_src, "Setting blocksize to %" G_GUINT64_FORMAT
+      " for content of %" G_GUINT64_FORMAT " bytes/sec, throughput %"
+      G_GUINT64_FORMAT " bytes/sec at rate %.1f", blocksize, bytes_per_sec,
+      (guint64) dlna_src->throughput, dlna_src->rate);
+
+  dlna_src->blocksize = (guint) blocksize;
+  g_object_set (dlna_src->http_src, "blocksize", dlna_src->blocksize, NULL);
+
+#if GST_CHECK_VERSION(1,0,0)
+  /* Blocks no longer fit in pooled buffers, have a new pool negotiated */
+  if (dlna_src->buffer_pool_size &&
+      (dlna_src->blocksize > dlna_src->buffer_pool_size)) {
+    GstPad *pad = gst_element_get_static_pad (dlna_src->http_src, "src");
+    if (pad) {
+      GST_DEBUG_OBJECT (dlna_src, "Blocksize %u exceeds pool buffer size %u, "
+          "reconfiguring", dlna_src->blocksize, dlna_src->buffer_pool_size);
+      gst_pad_mark_reconfigure (pad);
+      gst_object_unref (pad);
+    }
+  }
+#endif
+}
+
+#if GST_CHECK_VERSION(1,0,0)
+/**
+ * Query function of the internal pad of the src ghost pad, which receives
+ * the queries souphttpsrc (or dtcpip) sends downstream.  Queries are passed
+ * on downstream first.  If no element downstream offered a buffer pool in
+ * an ALLOCATION query, dlnasrc offers its own.
+ *
+ * @param pad       internal pad of the src ghost pad
+ * @param parent    parent of pad
+ * @param query     query to process
+ *
+ * @return  true if query was answered, false otherwise
+ */
+static gboolean
+dlna_src_internal_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstDlnaSrc *dlna_src = GST_DLNA_SRC (gst_pad_get_element_private (pad));
+  gboolean ret;
+
+  ret = gst_proxy_pad_query_default (pad, parent, query);
+
+  if (GST_QUERY_TYPE (query) != GST_QUERY_ALLOCATION)
+    return ret;
+
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    GST_DEBUG_OBJECT (dlna_src, "Using buffer pool provided by downstream");
+    return ret;
+  }
+
+  return dlna_src_propose_allocation (dlna_src, query);
+}
+
+/**
+ * Adds a buffer pool to the ALLOCATION query which holds buffers of the
+ * current blocksize, rounded up to and aligned on the DTCP AES block size.
+ * A new pool is created each time so it matches the caps of the query; the
+ * previous pool is released by souphttpsrc once it switches over.
+ *
+ * @param dlna_src  this element
+ * @param query     ALLOCATION query to answer
+ *
+ * @return  true if a pool was added, false otherwise
+ */
+static gboolean
+dlna_src_propose_allocation (GstDlnaSrc * dlna_src, GstQuery * query)
+{
+  GstBufferPool *pool = NULL;
+  GstStructure *config = NULL;
+  GstCaps *caps = NULL;
+  gboolean need_pool = FALSE;
+  GstAllocationParams params;
+  guint size;
+
+  gst_query_parse_allocation (query, &caps, &need_pool);
+
+  size = dlna_src->blocksize ? dlna_src->blocksize : SOUPHTTPSRC_BLOCKSIZE;
+  size = GST_ROUND_UP_N (size, DTCP_AES_BLOCK_SIZE);
+
+  gst_allocation_params_init (&params);
+  params.align = DTCP_AES_BLOCK_SIZE - 1;
+
+  pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, caps, size,
+      BUFFER_POOL_MIN_BUFFERS, 0);
+  gst_buffer_pool_config_set_allocator (config, NULL, &params);
+  if (!gst_buffer_pool_set_config (pool, config)) {
+    GST_WARNING_OBJECT (dlna_src, "Unable to configure buffer pool");
+    gst_object_unref (pool);
+    return FALSE;
+  }
+
+  GST_INFO_OBJECT (dlna_src, "Offering buffer pool of %u byte buffers", size);
+
+  gst_query_add_allocation_pool (query, pool, size, BUFFER_POOL_MIN_BUFFERS,
+      0);
+  gst_query_add_allocation_param (query, NULL, &params);
+  gst_object_unref (pool);
+
+  dlna_src->buffer_pool_size = size;
+
+  return TRUE;
+}
+#endif
+
+/**
+ * Buffer probe on the souphttpsrc src pad which measures the throughput of
+ * data read from the server, smoothed over successive intervals, and adapts
+ * the block size to it.
+ */
+#if GST_CHECK_VERSION(1,0,0)
+static GstPadProbeReturn
+dlna_src_throughput_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+#else
+static gboolean
+dlna_src_throughput_probe (GstPad * pad, GstBuffer * buffer,
+    gpointer user_data)
+#endif
+{
+  GstDlnaSrc *dlna_src = GST_DLNA_SRC (user_data);
+  gint64 now = g_get_monotonic_time ();
+  gint64 elapsed;
+  guint64 bytes_per_sec;
+
+#if GST_CHECK_VERSION(1,0,0)
+  dlna_src->throughput_bytes +=
+      gst_buffer_get_size (GST_PAD_PROBE_INFO_BUFFER (info));
+#else
+  dlna_src->throughput_bytes += GST_BUFFER_SIZE (buffer);
+#endif
+
+  if (!dlna_src->throughput_start) {
+    dlna_src->throughput_start = now;
+    dlna_src->throughput_bytes = 0;
+  }
+
+  elapsed = now - dlna_src->throughput_start;
+  if (dlna_src->block_duration &&
+      (elapsed >= THROUGHPUT_INTERVAL_MSECS * G_TIME_SPAN_MILLISECOND)) {
+    bytes_per_sec = (dlna_src->throughput_bytes * G_TIME_SPAN_SECOND) /
+        elapsed;
+    if (dlna_src->throughput)
+      dlna_src->throughput = (dlna_src->throughput + bytes_per_sec) / 2;
+    else
+      dlna_src->throughput = bytes_per_sec;
+
+    dlna_src->throughput_start = now;
+    dlna_src->throughput_bytes = 0;
+
+    dlna_src_blocksize_update (dlna_src);
+  }
+
+#if GST_CHECK_VERSION(1,0,0)
+  return GST_PAD_PROBE_OK;
+#else
+  return TRUE;
+#endif
+}
+
+/**
+ * Perform actions necessary based on supplied URI which is called by
+ * playbin when this element is selected as source.
+ *
+ * @param dlna_src	this element
+ * @param value		specified URI to use
+ *
+ * @return	true if uri is set without problems, false otherwise
+ */
+static gboolean
+dlna_src_setup_bin (GstDlnaSrc * dlna_src)
+{
+  guint64 content_size;
+  GstPad *pad = NULL;
+#if GST_CHECK_VERSION(1,0,0)
+  GstPad *internal_pad = NULL;
+#endif
+  GValue boolean_value = G_VALUE_INIT;
+  GstStructure *extra_headers = NULL;
+
+  GST_INFO_OBJECT (dlna_src, "called");
+  /* Setup souphttpsrc as source element for this bin */
+  dlna_src->http_src =
+      gst_element_factory_make ("souphttpsrc", ELEMENT_NAME_SOUP_HTTP_SRC);
+  if (!dlna_src->http_src) {
+    GST_ERROR_OBJECT (dlna_src,
+        "The http soup source element could not be created.");
+    return FALSE;
+  }
+
+  gst_bin_add (GST_BIN (&dlna_src->bin), dlna_src->http_src);
+
+  if (dlna_src->http_uri) {
+    GST_INFO_OBJECT (dlna_src, "Setting URI of souphttpsrc");
+    g_object_set (G_OBJECT (dlna_src->http_src), "location",
+        dlna_src->http_uri, NULL);
+  } else
+    GST_INFO_OBJECT (dlna_src, "Not setting URI of souphttpsrc");
+
+  /* Setup the block size, adapted to content once it is known */
+  dlna_src->blocksize = 0;
+  dlna_src_blocksize_update (dlna_src);
+
+  /* Without content features yet, ask for streaming transfer up front */
+  if (dlna_src->fast_start) {
+    extra_headers = gst_structure_new ("extraHeadersStruct",
+        "transferMode.dlna.org", G_TYPE_STRING, "Streaming", NULL);
+    g_object_set (G_OBJECT (dlna_src->http_src), "extra-headers",
+        extra_headers, NULL);
+    gst_structure_free (extra_headers);
+  }
+  
+  g_value_init (&boolean_value, G_TYPE_BOOLEAN);
+  g_value_set_boolean (&boolean_value, FALSE);
+  g_object_set_property (G_OBJECT (dlna_src->http_src), "reconnect",
+      &boolean_value);
+
+  /* Setup dtcp element regardless */
+  /*
+   * Need to make this dependant on whether DTCP markers are present in uri
+   */
+//  if (!dlna_src_setup_dtcp (dlna_src)) {
+//    GST_ERROR_OBJECT (dlna_src, "Problems setting up dtcp elements");
+//    return FALSE;
+//  }
+
+  /* Create src ghost pad of dlna src so playbin will recognize element as a src */
+  GST_DEBUG_OBJECT (dlna_src, "Getting http src pad");
+//  pad = gst_element_get_static_pad (dlna_src->dtcp_decrypter, "src");
+  pad = gst_element_get_static_pad (dlna_src->http_src, "src");
+  if (!pad) {
+    GST_ERROR_OBJECT (dlna_src,
+        "Could not get pad to ghost pad for dlnasrc. Exiting.");
+    return FALSE;
+  }
+
+  /* Measure throughput of data read from server to adapt the block size */
+#if GST_CHECK_VERSION(1,0,0)
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) dlna_src_throughput_probe, dlna_src, NULL);
+#else
+  gst_pad_add_buffer_probe (pad, G_CALLBACK (dlna_src_throughput_probe),
+      dlna_src);
+#endif
+
+  GST_DEBUG_OBJECT (dlna_src, "Got src pad to use for ghostpad of dlnasrc bin");
+  dlna_src->src_pad = gst_ghost_pad_new ("src", pad);
+  gst_pad_set_active (dlna_src->src_pad, TRUE);
+
+  gst_element_add_pad (GST_ELEMENT (&dlna_src->bin), dlna_src->src_pad);
+  gst_object_unref (pad);
+
+  gst_pad_set_event_function (dlna_src->src_pad,
+      (GstPadEventFunction) gst_dlna_src_event);
+
+  gst_pad_set_query_function (dlna_src->src_pad,
+      (GstPadQueryFunction) gst_dlna_src_query);
+
+#if GST_CHECK_VERSION(1,0,0)
+  /* Answer ALLOCATION queries from souphttpsrc when downstream does not,
+   * keep spliced data in order and cache data on its way out */
+  internal_pad =
+      GST_PAD (gst_proxy_pad_get_internal (GST_PROXY_PAD (dlna_src->src_pad)));
+  if (internal_pad) {
+    gst_pad_set_element_private (internal_pad, dlna_src);
+    gst_pad_set_query_function (internal_pad,
+        (GstPadQueryFunction) dlna_src_internal_query);
+    gst_pad_set_event_function (internal_pad,
+        (GstPadEventFunction) dlna_src_internal_event);
+    gst_pad_set_chain_function (internal_pad,
+        (GstPadChainFunction) dlna_src_internal_chain);
+    gst_pad_add_probe (internal_pad, GST_PAD_PROBE_TYPE_BUFFER |
+        GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+        (GstPadProbeCallback) dlna_src_cache_probe, dlna_src, NULL);
+    gst_object_unref (internal_pad);
+  }
+#endif
+
+  if (dlna_src->byte_total && dlna_src->http_src) {
+    content_size = dlna_src->byte_total;
+
+    g_object_set (G_OBJECT (dlna_src->http_src), "content-size", content_size,
+        NULL);
+    GST_INFO_OBJECT (dlna_src, "Set HTTP src content size: %" G_GUINT64_FORMAT,
+        content_size);
+  }
+
+  return TRUE;
+}
+
+/**
+ * Setup dtcp decoder element and add to src in order to handle DTCP encrypted
+ * content
+ *
+ * @param dlna_src	this element
+ *
+ * @return	true if successfully setup, false otherwise
+ */
+static gboolean
+dlna_src_setup_dtcp (GstDlnaSrc * dlna_src)
+{
+  GST_INFO_OBJECT (dlna_src, "Setup for dtcp content");
+
+  if (dlna_src->dtcp_decrypter) {
+    GST_INFO_OBJECT (dlna_src, "Already setup for dtcp content");
+    return TRUE;
+  }
+
+  GST_INFO_OBJECT (dlna_src, "Creating dtcp decrypter");
+  dlna_src->dtcp_decrypter = gst_element_factory_make ("dtcpip",
+      ELEMENT_NAME_DTCP_DECRYPTER);
+  if (!dlna_src->dtcp_decrypter) {
+    GST_ERROR_OBJECT (dlna_src,
+        "The dtcp decrypter element could not be created. Exiting.");
+    return FALSE;
+  }
+
+  if (dlna_src->is_encrypted) {
+  g_object_set (G_OBJECT (dlna_src->dtcp_decrypter), "dtcp1host",
+      dlna_src->server_info->dtcp_host, NULL);
+
+  g_object_set (G_OBJECT (dlna_src->dtcp_decrypter), "dtcp1port",
+      dlna_src->server_info->dtcp_port, NULL);
+  }
+
+  gst_bin_add (GST_BIN (&dlna_src->bin), dlna_src->dtcp_decrypter);
+
+  if (!gst_element_link_many
+      (dlna_src->http_src, dlna_src->dtcp_decrypter, NULL)) {
+    GST_ERROR_OBJECT (dlna_src, "Problems linking elements in src. Exiting.");
+    return FALSE;
+  }
+  /* Setup the block size for dtcp */
+  dlna_src->blocksize = 0;
+  dlna_src_blocksize_update (dlna_src);
+
+  /* Make sure passthru mode is either disabled or enabled depending on content encryption */
+  g_object_set (dlna_src->dtcp_decrypter, "passthru-mode",
+      !dlna_src->is_encrypted, NULL);
+
+  return TRUE;
+}
+
+#if GST_CHECK_VERSION(1,0,0)
+/**
+ * Insert the dtcp decrypter between souphttpsrc and the src ghost pad once
+ * the GET response of a fast start tune shows DTCP content.  Runs on the
+ * streaming thread of souphttpsrc before it pushes any data.
+ *
+ * @param dlna_src	this element
+ * @param content_type	Content-Type of the GET response
+ *
+ * @return	true if the decrypter is in place, false otherwise
+ */
+static gboolean
+dlna_src_setup_dtcp_lazy (GstDlnaSrc * dlna_src, const gchar * content_type)
+{
+  GstPad *pad = NULL;
+  gboolean ret = FALSE;
+
+  if (dlna_src->dtcp_decrypter)
+    return TRUE;
+
+  GST_INFO_OBJECT (dlna_src, "GET response has DTCP content type: %s",
+      content_type);
+
+  g_mutex_lock (&dlna_src->parse_msg_mutex);
+  dlna_src_head_response_parse_content_type (dlna_src, dlna_src->server_info,
+      HEADER_INDEX_CONTENT_TYPE, content_type);
+  dlna_src->is_encrypted = TRUE;
+
+  gst_ghost_pad_set_target (GST_GHOST_PAD (dlna_src->src_pad), NULL);
+  if (dlna_src_setup_dtcp (dlna_src)) {
+    pad = gst_element_get_static_pad (dlna_src->dtcp_decrypter, "src");
+    ret = gst_ghost_pad_set_target (GST_GHOST_PAD (dlna_src->src_pad), pad);
+    gst_object_unref (pad);
+  }
+  g_mutex_unlock (&dlna_src->parse_msg_mutex);
+
+  if (!ret) {
+    GST_ERROR_OBJECT (dlna_src, "Problems inserting dtcp decrypter");
+    return FALSE;
+  }
+
+  return gst_element_sync_state_with_parent (dlna_src->dtcp_decrypter);
+}
+
+/**
+ * Bin message handler which looks at the response headers souphttpsrc
+ * posts for the GET request before passing messages on.
+ */
+static void
+gst_dlna_src_handle_message (GstBin * bin, GstMessage * message)
+{
+  GstDlnaSrc *dlna_src = GST_DLNA_SRC (bin);
+  const GstStructure *structure = NULL;
+  const GValue *value = NULL;
+  const GstStructure *headers = NULL;
+  const gchar *content_type = NULL;
+
+  if ((GST_MESSAGE_TYPE (message) == GST_MESSAGE_ELEMENT) &&
+      dlna_src->http_src &&
+      (GST_MESSAGE_SRC (message) == GST_OBJECT_CAST (dlna_src->http_src))) {
+    structure = gst_message_get_structure (message);
+    if (gst_structure_has_name (structure, "http-headers") &&
+        (value = gst_structure_get_value (structure, "response-headers")))
+      headers = gst_value_get_structure (value);
+
+    if (headers && dlna_src->server_info) {
+      content_type = gst_structure_get_string (headers, "Content-Type");
+      if (dlna_src->fast_start && content_type &&
+          dlna_src_find_token (content_type,
+              CONTENT_TYPE_HEADERS[HEADER_INDEX_APP_DTCP]))
+        dlna_src_setup_dtcp_lazy (dlna_src, content_type);
+
+      dlna_src_harvest_response_headers (dlna_src, headers);
+    }
+  }
+
+  GST_BIN_CLASS (parent_class)->handle_message (bin, message);
+}
+#endif
+
+/**
+ * Initialize the URI which includes formulating a HEAD request
+ * and parsing the response to get needed info about the URI.
+ *
+ * Unless disabled, the first HEAD request carries all the discovery headers
+ * so that most content needs a single round trip.  Servers which reject the
+ * combined request are retried with fewer headers, and the accepted
+ * combination is remembered per server for later tunes.
+ *
+ * @param dlna_src	this element
+ * @param value		specified URI to use
+ *
+ * @return	true if no problems encountered, false otherwise
+ */
+static gboolean
+dlna_src_uri_gather_info (GstDlnaSrc * dlna_src)
+{
+  head_probe_level probe_level = HEAD_PROBE_LEGACY;
+  head_probe_level host_level;
+
+  GST_DEBUG_OBJECT (dlna_src, "Gathering info about URI");
+
+  if (!dlna_src->dlna_uri) {
+    GST_DEBUG_OBJECT (dlna_src, "No URI set yet");
+    return TRUE;
+  }
+
+  /* Make sure a soup session is open */
+  if (!dlna_src_soup_session_open (dlna_src)) {
+    GST_ERROR_OBJECT (dlna_src,
+        "Problems initializing struct to store HEAD response");
+    return FALSE;
+  }
+
+  /* Initialize server info */
+  if (!dlna_src_head_response_init_struct (dlna_src, &dlna_src->server_info)) {
+    GST_ERROR_OBJECT (dlna_src,
+        "Problems initializing struct to store HEAD response");
+    return FALSE;
+  }
+
+  g_free (dlna_src->server_key);
+  dlna_src->server_key = dlna_src_server_key (dlna_src);
+
+  if (dlna_src->pipelined_head) {
+    probe_level = dlna_src_head_probe_cache_lookup (dlna_src->server_key);
+    if (HEAD_PROBE_UNKNOWN == probe_level)
+      probe_level = HEAD_PROBE_FULL;
+  }
+  host_level = probe_level;
+
+  /* Known URI, set up right away and confirm in background */
+  if (dlna_src_caps_cache_apply (dlna_src)) {
+    GST_INFO_OBJECT (dlna_src,
+        "Using cached server capabilities, revalidating in background");
+    if (!dlna_src_uri_revalidate_async (dlna_src, probe_level, host_level))
+      GST_WARNING_OBJECT (dlna_src,
+          "Problems issuing HEAD request to revalidate server capabilities");
+    return TRUE;
+  }
+
+  /* Have the GET start with the bin and learn content features meanwhile */
+  if (dlna_src->fast_start) {
+    GST_INFO_OBJECT (dlna_src,
+        "Fast start, gathering content features while streaming");
+    dlna_src->tune_pending = TRUE;
+    if (!dlna_src_uri_revalidate_async (dlna_src, probe_level, host_level)) {
+      dlna_src->tune_pending = FALSE;
+      GST_ERROR_OBJECT (dlna_src,
+          "Problems issuing HEAD request to get content features");
+      return FALSE;
+    }
+    return TRUE;
+  }
+
+  /* Issue first head with content features to determine what server supports */
+  while (TRUE) {
+    GST_INFO_OBJECT (dlna_src,
+        "Issuing HEAD Request with %d discovery header(s) to determine what server supports",
+        probe_level);
+
+    if (dlna_src_soup_issue_head (dlna_src, probe_level,
+            PROBE_HEAD_REQUEST_HEADERS, dlna_src->server_info, TRUE,
+            DLNA_SRC_LATENCY_HEAD_CONTENT_FEATURES))
+      break;
+
+    /* Only step down when the server answered and refused the headers,
+     * transport problems are not a property of the server */
+    if ((HEAD_PROBE_LEGACY == probe_level) ||
+        (dlna_src->server_info->ret_code < HTTP_STATUS_BAD_REQUEST)) {
+      GST_ERROR_OBJECT (dlna_src,
+          "Problems issuing HEAD request to get content features");
+      return FALSE;
+    }
+
+    GST_WARNING_OBJECT (dlna_src,
+        "Server rejected HEAD with %d discovery headers (%d), retrying with fewer",
+        probe_level, dlna_src->server_info->ret_code);
+    probe_level--;
+    if (!dlna_src_head_probe_refused_by_item (dlna_src))
+      host_level = MIN (host_level, probe_level);
+  }
+
+  if (dlna_src->pipelined_head && dlna_src->server_key)
+    dlna_src_head_probe_cache_store (dlna_src->server_key, host_level);
+
+  if (!dlna_src_uri_gather_remaining_info (dlna_src, probe_level))
+    return FALSE;
+
+  dlna_src_caps_cache_store (dlna_src, dlna_src->server_info);
+ 
+  /* Print out results of HEAD request, the trace ring has the gist */
+  if (gst_debug_category_get_threshold(gst_dlna_src_debug) >= GST_LEVEL_LOG)
+  {
+    GString *struct_str = g_string_sized_new (MAX_HTTP_BUF_SIZE);
+    dlna_src_head_response_struct_to_str (dlna_src, dlna_src->server_info,
+        struct_str);
+
+    GST_LOG_OBJECT (dlna_src, "Parsed HEAD Response into struct: %s",
+        struct_str->str);
+
+    g_string_free (struct_str, TRUE);
+  }
+
+  return TRUE;
+}
+
+/**
+ * Determine which second HEAD request is needed based on what the first
+ * response said the server supports.  Requests are skipped when the
+ * information they would return was already part of the first response.
+ *
+ * @param dlna_src	this element
+ * @param probe_level	discovery headers which were sent in the first HEAD
+ *
+ * @return	index into REMAINING_HEAD_REQUEST_HEADERS, -1 if none needed
+ */
+static gint
+dlna_src_uri_remaining_head_idx (GstDlnaSrc * dlna_src,
+    head_probe_level probe_level)
+{
+  gboolean combined = (probe_level > HEAD_PROBE_LEGACY);
+
+  if ((dlna_src->is_live) || (dlna_src->is_recInProgress)) {
+    if (probe_level >= HEAD_PROBE_SEEK_RANGE) {
+      GST_INFO_OBJECT (dlna_src,
+          "Live/recInProgess content info returned by first HEAD request");
+      return -1;
+    }
+    return REMAINING_HEAD_LIVE;
+  } else if (dlna_src->time_seek_supported) {
+    if (probe_level >= HEAD_PROBE_FULL) {
+      GST_INFO_OBJECT (dlna_src,
+          "Time seek info returned by first HEAD request");
+      return -1;
+    }
+    return REMAINING_HEAD_TIME_SEEK;
+  } else if (dlna_src->byte_seek_supported && dlna_src->is_encrypted) {
+    if (combined && dlna_src->server_info->available_seek_cleartext_end) {
+      GST_INFO_OBJECT (dlna_src,
+          "Cleartext range info returned by first HEAD request");
+      return -1;
+    }
+    return REMAINING_HEAD_DTCP_RANGE;
+  } else if (dlna_src->byte_seek_supported) {
+    if (combined && dlna_src->byte_total) {
+      GST_INFO_OBJECT (dlna_src,
+          "Range info returned by first HEAD request");
+      return -1;
+    }
+    return REMAINING_HEAD_RANGE;
+  }
+
+  GST_INFO_OBJECT (dlna_src, "Not issuing another HEAD request");
+  return -1;
+}
+
+/**
+ * Issue the second HEAD request, if any is needed, and wait for it.
+ *
+ * @param dlna_src	this element
+ * @param probe_level	discovery headers which were sent in the first HEAD
+ *
+ * @return	true if no problems encountered, false otherwise
+ */
+static gboolean
+dlna_src_uri_gather_remaining_info (GstDlnaSrc * dlna_src,
+    head_probe_level probe_level)
+{
+  gint idx = dlna_src_uri_remaining_head_idx (dlna_src, probe_level);
+
+  if (idx < 0)
+    return TRUE;
+
+  GST_INFO_OBJECT (dlna_src, "Issuing another HEAD request to get %s info",
+      REMAINING_HEAD_DESCRIPTIONS[idx]);
+  if (!dlna_src_soup_issue_head (dlna_src, 1,
+          &REMAINING_HEAD_REQUEST_HEADERS[idx], dlna_src->server_info, TRUE,
+          REMAINING_HEAD_LATENCIES[idx])) {
+    GST_ERROR_OBJECT (dlna_src,
+        "Problems issuing HEAD request to get %s information",
+        REMAINING_HEAD_DESCRIPTIONS[idx]);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * Confirm capabilities taken from the cache by issuing the discovery HEAD
+ * requests without waiting for them.  The element's info and the cache are
+ * updated as responses arrive.
+ *
+ * @param dlna_src	this element
+ * @param probe_level	discovery headers to send in the first HEAD
+ * @param host_level	discovery headers the server is known to accept
+ *
+ * @return	true if request was issued, false otherwise
+ */
+static gboolean
+dlna_src_uri_revalidate_async (GstDlnaSrc * dlna_src,
+    head_probe_level probe_level, head_probe_level host_level)
+{
+  return dlna_src_soup_issue_head_async (dlna_src, probe_level,
+      PROBE_HEAD_REQUEST_HEADERS, dlna_src->server_info, TRUE,
+      DLNA_SRC_LATENCY_HEAD_CONTENT_FEATURES, dlna_src_uri_revalidate_done,
+      HEAD_PROBE_PACK (probe_level, host_level));
+}
+
+/**
+ * Completion of a background revalidation HEAD request, runs on the HEAD
+ * worker.  Steps down the probe like the synchronous path and chains the
+ * second HEAD request when one is needed.
+ */
+static void
+dlna_src_uri_revalidate_done (GstDlnaSrc * dlna_src, gboolean success,
+    gpointer user_data)
+{
+  head_probe_level probe_level = HEAD_PROBE_SENT (user_data);
+  head_probe_level host_level = HEAD_PROBE_HOST (user_data);
+  gint idx;
+
+  if (!success) {
+    if ((probe_level > HEAD_PROBE_LEGACY) && !dlna_src->head_closing &&
+        (dlna_src->server_info->ret_code >= HTTP_STATUS_BAD_REQUEST)) {
+      GST_WARNING_OBJECT (dlna_src,
+          "Server rejected HEAD with %d discovery headers (%d), retrying with fewer",
+          probe_level, dlna_src->server_info->ret_code);
+      if (!dlna_src_head_probe_refused_by_item (dlna_src))
+        host_level = MIN (host_level, probe_level - 1);
+      if (!dlna_src_uri_revalidate_async (dlna_src, probe_level - 1,
+              host_level))
+        GST_WARNING_OBJECT (dlna_src, "Problems revalidating capabilities");
+    } else {
+      GST_WARNING_OBJECT (dlna_src,
+          "Unable to revalidate cached server capabilities");
+      dlna_src_fast_start_done (dlna_src);
+    }
+    return;
+  }
+
+  if (dlna_src->pipelined_head && dlna_src->server_key)
+    dlna_src_head_probe_cache_store (dlna_src->server_key, host_level);
+
+  idx = dlna_src_uri_remaining_head_idx (dlna_src, probe_level);
+  if (idx < 0) {
+    dlna_src_caps_cache_store (dlna_src, dlna_src->server_info);
+    dlna_src_fast_start_done (dlna_src);
+    return;
+  }
+
+  GST_INFO_OBJECT (dlna_src, "Issuing another HEAD request to get %s info",
+      REMAINING_HEAD_DESCRIPTIONS[idx]);
+  if (!dlna_src_soup_issue_head_async (dlna_src, 1,
+          &REMAINING_HEAD_REQUEST_HEADERS[idx], dlna_src->server_info, TRUE,
+          REMAINING_HEAD_LATENCIES[idx],
+          dlna_src_uri_revalidate_remaining_done, NULL)) {
+    GST_WARNING_OBJECT (dlna_src,
+        "Problems issuing HEAD request to get %s information",
+        REMAINING_HEAD_DESCRIPTIONS[idx]);
+    dlna_src_fast_start_done (dlna_src);
+  }
+}
+
+static void
+dlna_src_uri_revalidate_remaining_done (GstDlnaSrc * dlna_src,
+    gboolean success, gpointer user_data)
+{
+  if (success)
+    dlna_src_caps_cache_store (dlna_src, dlna_src->server_info);
+  else
+    GST_WARNING_OBJECT (dlna_src,
+        "Unable to revalidate cached server capabilities");
+  dlna_src_fast_start_done (dlna_src);
 }
-#endif
 
-#if GST_CHECK_VERSION(1,0,0)
-static gboolean
-gst_dlna_src_uri_set_uri (GstURIHandler * handler, const gchar * uri,
-    GError ** error)
+/**
+ * Called on the HEAD worker once the HEAD requests of a fast start tune
+ * have completed, successfully or not.  Finishes what the URI setup could
+ * not do without content features and releases a pending state change.
+ *
+ * @param dlna_src	this element
+ */
+static void
+dlna_src_fast_start_done (GstDlnaSrc * dlna_src)
 {
-  GstDlnaSrc *dlna_src = GST_DLNA_SRC (handler);
+  if (!dlna_src->tune_pending)
+    return;
 
-  GST_INFO_OBJECT (dlna_src, "uri handler called to set uri: %s, current: %s",
-      uri, dlna_src->dlna_uri);
+  GST_INFO_OBJECT (dlna_src, "Content features of fast start tune received");
+  if (!dlna_src_uri_parse_max_tsb_duration (dlna_src))
+    GST_WARNING_OBJECT (dlna_src, "Problems parsing TSB max duration");
 
-  return dlna_src_uri_assign (dlna_src, uri, error);
+  g_mutex_lock (&dlna_src->head_mutex);
+  dlna_src->tune_pending = FALSE;
+  g_cond_broadcast (&dlna_src->head_cond);
+  g_mutex_unlock (&dlna_src->head_mutex);
 }
-#else
-static gboolean
-gst_dlna_src_uri_set_uri(GstURIHandler * handler, const gchar * uri)
+
+/**
+ * Build the key identifying the server of the current URI in the process
+ * wide HEAD probe and capability caches.
+ *
+ * @param dlna_src	this element
+ *
+ * @return	newly allocated "host:port" string, NULL if URI can't be parsed
+ */
+static gchar *
+dlna_src_server_key (GstDlnaSrc * dlna_src)
 {
-  GstDlnaSrc *dlna_src = GST_DLNA_SRC (handler);
+  SoupURI *soup_uri = NULL;
+  gchar *key = NULL;
 
-  GST_INFO_OBJECT (dlna_src, "uri handler called to set uri: %s, current: %s",
-      uri, dlna_src->dlna_uri);
+  soup_uri = soup_uri_new (dlna_src->http_uri);
+  if (!soup_uri) {
+    GST_WARNING_OBJECT (dlna_src, "Unable to parse URI for HEAD probe cache");
+    return NULL;
+  }
 
-  return dlna_src_uri_assign (dlna_src, uri);
+  if (soup_uri->host)
+    key = g_strdup_printf ("%s:%u", soup_uri->host, soup_uri->port);
+
+  soup_uri_free (soup_uri);
+
+  return key;
 }
-#endif
 
-static void
-gst_dlna_src_uri_handler_init (gpointer g_iface, gpointer iface_data)
+/**
+ * Look up which discovery headers the server last accepted.
+ *
+ * @param key	server key, may be NULL
+ *
+ * @return	cached probe level or HEAD_PROBE_UNKNOWN
+ */
+static head_probe_level
+dlna_src_head_probe_cache_lookup (const gchar * key)
 {
-  GstURIHandlerInterface *iface = (GstURIHandlerInterface *) g_iface;
+  head_probe_level probe_level = HEAD_PROBE_UNKNOWN;
+  dlna_src_head_probe_entry *entry = NULL;
+
+  if (!key)
+    return HEAD_PROBE_UNKNOWN;
+
+  G_LOCK (head_probe_cache);
+  if (head_probe_cache)
+    entry = g_hash_table_lookup (head_probe_cache, key);
+  if (entry && (g_get_monotonic_time () - entry->store_time >
+          HEAD_PROBE_CACHE_TTL_SECS * G_TIME_SPAN_SECOND)) {
+    g_hash_table_remove (head_probe_cache, key);
+    entry = NULL;
+  }
+  if (entry)
+    probe_level = entry->probe_level;
+  G_UNLOCK (head_probe_cache);
 
-  iface->get_type = gst_dlna_src_uri_get_type;
-  iface->get_protocols = gst_dlna_src_uri_get_protocols;
-  iface->get_uri = gst_dlna_src_uri_get_uri;
-  iface->set_uri = gst_dlna_src_uri_set_uri;
+  return probe_level;
 }
 
 /**
- * Sets the URI property to the supplied value.  It is called either via the URI
- * handler interface set method or via setting the element's property.  The
- * additional setup (issuing HEAD and setting up souphttpsrc for GET) for the URI
- * is suppose to be performed when state changes from READY->PAUSED but it seems
- * that it must be performed here otherwise we get an error and playback fails due
- * to unlinked.
+ * Whether the last discovery HEAD was refused because of the content rather
+ * than the server.  DLNA servers answer 406 to TimeSeekRange on content
+ * which has no time seek, the server still accepts the headers for others.
+ *
+ * @param dlna_src	this element
+ *
+ * @return	true if the refusal says nothing about the server
  */
 static gboolean
-#if GST_CHECK_VERSION(1,0,0)
-dlna_src_uri_assign (GstDlnaSrc * dlna_src, const gchar * uri, GError ** error)
-#else
-dlna_src_uri_assign (GstDlnaSrc * dlna_src, const gchar * uri)
-#endif
+dlna_src_head_probe_refused_by_item (GstDlnaSrc * dlna_src)
 {
-  gboolean ret = FALSE;
-  gchar *dlna_prefix = "dlna+";
-  GString *http_uri;
+  return dlna_src->server_info->ret_code == HTTP_STATUS_NOT_ACCEPTABLE;
+}
 
+/**
+ * Remember which discovery headers the server accepted.  Refusals caused by
+ * the content rather than the server are not taken into account by callers.
+ *
+ * @param key		server key
+ * @param probe_level	accepted probe level
+ */
+static void
+dlna_src_head_probe_cache_store (const gchar * key,
+    head_probe_level probe_level)
+{
+  dlna_src_head_probe_entry *entry = NULL;
+
+  G_LOCK (head_probe_cache);
+  if (!head_probe_cache)
+    head_probe_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+        g_free, g_free);
+  entry = g_new (dlna_src_head_probe_entry, 1);
+  entry->probe_level = probe_level;
+  entry->store_time = g_get_monotonic_time ();
+  g_hash_table_replace (head_probe_cache, g_strdup (key), entry);
+  G_UNLOCK (head_probe_cache);
+}
 
-  if (uri == NULL)
-  {
-#if GST_CHECK_VERSION(1,0,0)
-    g_set_error (error, GST_URI_ERROR, GST_URI_ERROR_BAD_URI, "Bad URI passed");
-#endif
-    return FALSE;
-  }
+/**
+ * Build the capability cache key of this element's URI, the server key
+ * followed by a digest of the URI so keys are valid key file group names.
+ *
+ * @param dlna_src	this element
+ *
+ * @return	newly allocated key, NULL if the server is unknown
+ */
+static gchar *
+dlna_src_caps_cache_key (GstDlnaSrc * dlna_src)
+{
+  gchar *digest = NULL;
+  gchar *key = NULL;
 
-  if (dlna_src->dlna_uri) {
-    dlna_src_head_response_free_struct (dlna_src, dlna_src->server_info);
-    dlna_src->server_info = NULL;
-    g_free (dlna_src->dlna_uri);
-    dlna_src->dlna_uri = NULL;
-    g_free (dlna_src->http_uri);
-    dlna_src->http_uri = NULL;
-  }
+  if (!dlna_src->server_key || !dlna_src->http_uri)
+    return NULL;
 
-  dlna_src->dlna_uri = g_strdup (uri);
-  if (g_ascii_strncasecmp (dlna_src->dlna_uri, dlna_prefix,
-          strlen (dlna_prefix)) == 0) {
-    http_uri = g_string_new (dlna_src->dlna_uri);
-    http_uri = g_string_erase (http_uri, 0, strlen (dlna_prefix));
-    dlna_src->http_uri = g_string_free (http_uri, FALSE);
-    GST_INFO_OBJECT (dlna_src, "Set http URI: %s, based on dlna URI: %s",
-        dlna_src->http_uri, dlna_src->dlna_uri);
-  } else {
-    dlna_src->http_uri = g_strdup (uri);
-    GST_INFO_OBJECT (dlna_src, "URI did not have dlna prepended: %s",
-        dlna_src->http_uri);
-  }
+  digest = g_compute_checksum_for_string (G_CHECKSUM_SHA1,
+      dlna_src->http_uri, -1);
+  key = g_strdup_printf ("%s|%s", dlna_src->server_key, digest);
+  g_free (digest);
 
-  ret = dlna_src_uri_init (dlna_src);
-#if GST_CHECK_VERSION(1,0,0)
-  if (ret != TRUE)
-  {
-     g_set_error (error, GST_URI_ERROR, GST_URI_ERROR_UNSUPPORTED_PROTOCOL,
-                  "Source doesn't support the requested protocol");
-  }
-#endif
-  return ret;
+  return key;
 }
 
 /**
- * Gathers the info about the URI and then sets up the bin, either including the
- * dtcp decrypter element or not based on HEAD response.
+ * Take the capabilities of this element's URI from the capability cache, if
+ * a fresh entry exists.  The element's info is updated from them as if a HEAD
+ * response had been received.  Entries of content that is neither live nor
+ * in progress are only used if they know its size, the duration is taken
+ * from the entry when known.
+ *
+ * @param dlna_src	this element
+ *
+ * @return	true if cached capabilities were applied, false otherwise
  */
 static gboolean
-dlna_src_uri_init (GstDlnaSrc * dlna_src)
+dlna_src_caps_cache_apply (GstDlnaSrc * dlna_src)
 {
-  gchar              max_tsb_duration_str[8] = "1";
-  uri_parser_retcode ret = URI_PARSER_ERROR;
-  guint32            tmp_max_tsb_duration = 0;
+  dlna_src_caps_entry *entry = NULL;
+  GstDlnaSrcHeadResponseContentFeatures *content_features = NULL;
+  gchar *dtcp_host = NULL;
+  guint dtcp_port = 0;
+  guint64 byte_total = 0;
+  guint64 npt_duration_nanos = 0;
+  GString *npt_str = NULL;
+  gchar *key = NULL;
+  gint64 now;
+
+  if (!dlna_src->caps_cache_ttl)
+    return FALSE;
 
-  GST_DEBUG_OBJECT (dlna_src, "Initializing URI");
+  key = dlna_src_caps_cache_key (dlna_src);
+  if (!key)
+    return FALSE;
 
-  if (dlna_src->is_uri_initialized) {
-    GST_DEBUG_OBJECT (dlna_src, "Returning since URI is already initialized");
-    return TRUE;
-  }
+  G_LOCK (caps_cache);
+  dlna_src_caps_cache_load_locked (dlna_src->caps_cache_ttl);
+  entry = g_hash_table_lookup (caps_cache, key);
 
-  if (!dlna_src_uri_gather_info (dlna_src)) {
-    GST_ERROR_OBJECT (dlna_src, "Problems gathering URI info");
-    return FALSE;
+  now = g_get_real_time ();
+  if (entry && ((now - entry->store_time) >
+          ((gint64) dlna_src->caps_cache_ttl * G_TIME_SPAN_SECOND))) {
+    GST_INFO_OBJECT (dlna_src, "Cached capabilities of %s expired", key);
+    g_hash_table_remove (caps_cache, key);
+    entry = NULL;
   }
- 
-  if(TRUE == dlna_src->is_live)
-  {
-     ret = dlna_src_parse_uri_get_key_val(dlna_src, 
-                                          dlna_src->http_uri, 
-                                          "tsb", 
-                                          max_tsb_duration_str,
-                                          8);
-     if(URI_PARSER_SUCCESS == ret)
-     {
-        GST_DEBUG_OBJECT(dlna_src, "max_tsb_duration_str : %s\n", max_tsb_duration_str);
-        tmp_max_tsb_duration = strtoul(max_tsb_duration_str, NULL, 10);
-        GST_WARNING_OBJECT(dlna_src, "max_tsb_duration from URI in secs: %u\n", 
-              tmp_max_tsb_duration * 60);
-        
-        /* TODO - Remove this check when tsb=1 URI means 1 minute long TSB.
-         * i.e when the TSB duration is not read from rmconfig.ini */
-        if(1 != tmp_max_tsb_duration)
-        {
-           /* convert to seconds */
-           dlna_src->max_tsb_duration = tmp_max_tsb_duration * 60;
-        }
-     }
-     else if(URI_PARSER_KEY_NOT_FOUND == ret)
-     {
-        GST_WARNING_OBJECT(dlna_src, "URI does not have the tsb max duration value\n");
-     }
-     else
-     {
-        GST_ERROR_OBJECT(dlna_src, "Unable to get the TSB max duration value from the URI\n");
-        return FALSE;
-     }
+
+  if (entry && !entry->byte_total &&
+      !DLNA_SRC_CF_IS_SET (entry->content_features,
+          DLNA_SRC_CF_SN_INCREASING)) {
+    GST_INFO_OBJECT (dlna_src, "Cached capabilities of %s lack content size",
+        key);
+    entry = NULL;
   }
 
-  if (!dlna_src_setup_bin (dlna_src)) {
-    GST_ERROR_OBJECT (dlna_src, "Problems setting up dtcp elements");
-    return FALSE;
+  if (entry) {
+    entry->use_time = now;
+    content_features = dlna_src_content_features_copy (entry->content_features);
+    dtcp_host = g_strdup (entry->dtcp_host);
+    dtcp_port = entry->dtcp_port;
+    byte_total = entry->byte_total;
+    npt_duration_nanos = entry->npt_duration_nanos;
+  }
+  G_UNLOCK (caps_cache);
+
+  if (content_features) {
+    g_mutex_lock (&dlna_src->parse_msg_mutex);
+    dlna_src_content_features_free (dlna_src->server_info->content_features);
+    dlna_src->server_info->content_features = content_features;
+    g_free (dlna_src->server_info->dtcp_host);
+    dlna_src->server_info->dtcp_host = dtcp_host;
+    dlna_src->server_info->dtcp_port = dtcp_port;
+    dlna_src->server_info->content_length = byte_total;
+    dlna_src_update_overall_info (dlna_src, dlna_src->server_info);
+
+    /* Revalidation replaces these with the current range */
+    if (npt_duration_nanos && !dlna_src->npt_duration_nanos) {
+      npt_str = g_string_sized_new (64);
+      dlna_src->npt_start_nanos = 0;
+      dlna_src->npt_end_nanos = npt_duration_nanos;
+      dlna_src->npt_duration_nanos = npt_duration_nanos;
+      dlna_src_nanos_to_npt (dlna_src, 0, npt_str);
+      g_free (dlna_src->npt_start_str);
+      dlna_src->npt_start_str = g_strdup (npt_str->str);
+      dlna_src_nanos_to_npt (dlna_src, npt_duration_nanos, npt_str);
+      g_free (dlna_src->npt_end_str);
+      dlna_src->npt_end_str = g_strdup (npt_str->str);
+      g_free (dlna_src->npt_duration_str);
+      dlna_src->npt_duration_str = g_strdup (npt_str->str);
+      g_string_free (npt_str, TRUE);
+      dlna_src_range_publish (dlna_src);
+    }
+    g_mutex_unlock (&dlna_src->parse_msg_mutex);
+    GST_INFO_OBJECT (dlna_src, "Applied cached capabilities of %s", key);
   }
 
-  dlna_src->is_uri_initialized = TRUE;
+  g_free (key);
 
-  return TRUE;
+  return (content_features != NULL);
 }
 
 /**
- * Perform actions necessary based on supplied URI which is called by
- * playbin when this element is selected as source.
+ * Store the capabilities from a HEAD response in the capability cache,
+ * keyed by server and URI, along with the content size and duration learned
+ * so far.  Nothing is stored for responses without a profile.
  *
  * @param dlna_src	this element
- * @param value		specified URI to use
- *
- * @return	true if uri is set without problems, false otherwise
+ * @param head_response	parsed HEAD response holding the capabilities
  */
-static gboolean
-dlna_src_setup_bin (GstDlnaSrc * dlna_src)
+static void
+dlna_src_caps_cache_store (GstDlnaSrc * dlna_src,
+    GstDlnaSrcHeadResponse * head_response)
 {
-  guint64 content_size;
-  GstPad *pad = NULL;
-  GValue boolean_value = G_VALUE_INIT;
+  dlna_src_caps_entry *entry = NULL;
+  gchar *key = NULL;
 
-  GST_INFO_OBJECT (dlna_src, "called");
-  /* Setup souphttpsrc as source element for this bin */
-  dlna_src->http_src =
-      gst_element_factory_make ("souphttpsrc", ELEMENT_NAME_SOUP_HTTP_SRC);
-  if (!dlna_src->http_src) {
-    GST_ERROR_OBJECT (dlna_src,
-        "The http soup source element could not be created.");
-    return FALSE;
+  if (!dlna_src->caps_cache_ttl || !head_response->content_features)
+    return;
+
+  if (!head_response->content_features->profile) {
+    GST_DEBUG_OBJECT (dlna_src, "No DLNA profile, capabilities not cached");
+    return;
   }
 
-  gst_bin_add (GST_BIN (&dlna_src->bin), dlna_src->http_src);
+  key = dlna_src_caps_cache_key (dlna_src);
+  if (!key)
+    return;
+
+  entry = g_slice_new0 (dlna_src_caps_entry);
+  entry->store_time = g_get_real_time ();
+  entry->use_time = entry->store_time;
+  entry->content_features =
+      dlna_src_content_features_copy (head_response->content_features);
+  entry->dtcp_host = g_strdup (head_response->dtcp_host);
+  entry->dtcp_port = head_response->dtcp_port;
+  entry->byte_total = dlna_src->byte_total;
+  entry->npt_duration_nanos = dlna_src->npt_duration_nanos;
+
+  GST_DEBUG_OBJECT (dlna_src, "Cached capabilities of %s", key);
+
+  G_LOCK (caps_cache);
+  dlna_src_caps_cache_load_locked (dlna_src->caps_cache_ttl);
+  g_hash_table_replace (caps_cache, key, entry);
+  dlna_src_caps_cache_trim_locked ();
+  dlna_src_caps_cache_save_locked ();
+  G_UNLOCK (caps_cache);
+}
 
-  if (dlna_src->http_uri) {
-    GST_INFO_OBJECT (dlna_src, "Setting URI of souphttpsrc");
-    g_object_set (G_OBJECT (dlna_src->http_src), "location",
-        dlna_src->http_uri, NULL);
-  } else
-    GST_INFO_OBJECT (dlna_src, "Not setting URI of souphttpsrc");
+/**
+ * Drop all cached capabilities of a server, called when it answers with an
+ * error so the next tune learns them again.
+ *
+ * @param server_key	server whose entries are dropped, may be NULL
+ */
+static void
+dlna_src_caps_cache_invalidate (const gchar * server_key)
+{
+  GHashTableIter iter;
+  gpointer key;
+  gsize key_len;
+  gboolean removed = FALSE;
+
+  if (!server_key)
+    return;
+
+  key_len = strlen (server_key);
+
+  G_LOCK (caps_cache);
+  if (caps_cache) {
+    g_hash_table_iter_init (&iter, caps_cache);
+    while (g_hash_table_iter_next (&iter, &key, NULL)) {
+      if ((strncmp ((const gchar *) key, server_key, key_len) == 0) &&
+          (((const gchar *) key)[key_len] == '|')) {
+        g_hash_table_iter_remove (&iter);
+        removed = TRUE;
+      }
+    }
+    if (removed) {
+      GST_INFO ("Invalidated cached capabilities of %s", server_key);
+      dlna_src_caps_cache_save_locked ();
+    }
+  }
+  G_UNLOCK (caps_cache);
+}
 
-  /* Setup the block default block size */
-  g_print("Setting blocksize in libsoup to %u\n", SOUPHTTPSRC_BLOCKSIZE);
-  g_object_set (dlna_src->http_src, "blocksize", SOUPHTTPSRC_BLOCKSIZE, NULL);
-  
-  g_value_init (&boolean_value, G_TYPE_BOOLEAN);
-  g_value_set_boolean (&boolean_value, FALSE);
-  g_object_set_property (G_OBJECT (dlna_src->http_src), "reconnect",
-      &boolean_value);
+/**
+ * Set the file the capability cache is persisted to, shared by all instances
+ * in the process.  The file is read the next time the cache is used.
+ *
+ * @param file	path of cache file, NULL to keep the cache in memory only
+ */
+static void
+dlna_src_caps_cache_set_file (const gchar * file)
+{
+  G_LOCK (caps_cache);
+  if (g_strcmp0 (file, caps_cache_file) != 0) {
+    g_free (caps_cache_file);
+    caps_cache_file = g_strdup (file);
+    caps_cache_loaded = FALSE;
+  }
+  G_UNLOCK (caps_cache);
+}
 
-  /* Setup dtcp element regardless */
-  /*
-   * Need to make this dependant on whether DTCP markers are present in uri
-   */
-//  if (!dlna_src_setup_dtcp (dlna_src)) {
-//    GST_ERROR_OBJECT (dlna_src, "Problems setting up dtcp elements");
-//    return FALSE;
-//  }
+/**
+ * Create the capability cache tables if needed and merge in entries from the
+ * cache file if one is set and has not been read yet, leaving out those
+ * which expired.  Cache lock must be held.
+ *
+ * @param ttl	seconds an entry stays fresh
+ */
+static void
+dlna_src_caps_cache_load_locked (guint ttl)
+{
+  GKeyFile *key_file = NULL;
+  gchar **groups = NULL;
+  gchar **group = NULL;
+  gchar **playspeed_strs = NULL;
+  gdouble *playspeeds = NULL;
+  gsize playspeeds_cnt = 0;
+  gsize i;
+  dlna_src_caps_entry *entry = NULL;
+  GstDlnaSrcHeadResponseContentFeatures *content_features = NULL;
+  gchar *profile = NULL;
+  gint64 store_time;
+  gint64 now;
+
+  if (!caps_cache)
+    caps_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+        (GDestroyNotify) dlna_src_caps_entry_free);
+
+  if (caps_cache_loaded || !caps_cache_file)
+    return;
+  caps_cache_loaded = TRUE;
+
+  key_file = g_key_file_new ();
+  if (!g_key_file_load_from_file (key_file, caps_cache_file, G_KEY_FILE_NONE,
+          NULL)) {
+    GST_INFO ("No capability cache loaded from %s", caps_cache_file);
+    g_key_file_free (key_file);
+    return;
+  }
 
-  /* Create src ghost pad of dlna src so playbin will recognize element as a src */
-  GST_DEBUG_OBJECT (dlna_src, "Getting http src pad");
-//  pad = gst_element_get_static_pad (dlna_src->dtcp_decrypter, "src");
-  pad = gst_element_get_static_pad (dlna_src->http_src, "src");
-  if (!pad) {
-    GST_ERROR_OBJECT (dlna_src,
-        "Could not get pad to ghost pad for dlnasrc. Exiting.");
-    return FALSE;
+  now = g_get_real_time ();
+  groups = g_key_file_get_groups (key_file, NULL);
+  for (group = groups; *group; group++) {
+    /* Groups are named server|uri digest */
+    if (!strchr (*group, '|') || g_hash_table_lookup (caps_cache, *group))
+      continue;
+    store_time = g_key_file_get_int64 (key_file, *group, "time", NULL);
+    if ((now - store_time) > ((gint64) ttl * G_TIME_SPAN_SECOND))
+      continue;
+    profile = g_key_file_get_string (key_file, *group, "profile", NULL);
+    if (!profile)
+      continue;
+
+    content_features = dlna_src_content_features_new ();
+    content_features->profile = profile;
+    if (g_key_file_get_boolean (key_file, *group, "op_time_seek", NULL))
+      content_features->flags |= DLNA_SRC_CF_OP_TIME_SEEK;
+    if (g_key_file_get_boolean (key_file, *group, "op_range", NULL))
+      content_features->flags |= DLNA_SRC_CF_OP_RANGE;
+    dlna_src_content_features_set_flags (content_features,
+        (guint32) g_key_file_get_int64 (key_file, *group, "flags", NULL));
+    content_features->is_converted =
+        g_key_file_get_boolean (key_file, *group, "converted", NULL);
+
+    playspeed_strs = g_key_file_get_string_list (key_file, *group,
+        "playspeed_strs", NULL, NULL);
+    playspeeds = g_key_file_get_double_list (key_file, *group, "playspeeds",
+        &playspeeds_cnt, NULL);
+    if (playspeed_strs && playspeeds &&
+        (g_strv_length (playspeed_strs) == playspeeds_cnt)) {
+      for (i = 0; (i < playspeeds_cnt) && (i < PLAYSPEEDS_MAX_CNT); i++) {
+        content_features->playspeed_strs[i] = g_strdup (playspeed_strs[i]);
+        content_features->playspeeds[i] = (gfloat) playspeeds[i];
+      }
+      content_features->playspeeds_cnt = i;
+    }
+    g_strfreev (playspeed_strs);
+    g_free (playspeeds);
+
+    entry = g_slice_new0 (dlna_src_caps_entry);
+    entry->store_time = store_time;
+    entry->use_time = g_key_file_get_int64 (key_file, *group, "used", NULL);
+    if (entry->use_time < store_time)
+      entry->use_time = store_time;
+    entry->content_features = content_features;
+    entry->dtcp_host = g_key_file_get_string (key_file, *group, "dtcp_host",
+        NULL);
+    entry->dtcp_port = g_key_file_get_integer (key_file, *group, "dtcp_port",
+        NULL);
+    entry->byte_total = g_key_file_get_uint64 (key_file, *group, "bytes",
+        NULL);
+    entry->npt_duration_nanos = g_key_file_get_uint64 (key_file, *group,
+        "duration", NULL);
+
+    g_hash_table_replace (caps_cache, g_strdup (*group), entry);
+  }
+  g_strfreev (groups);
+  g_key_file_free (key_file);
+  dlna_src_caps_cache_trim_locked ();
+
+  GST_INFO ("Loaded %u cached capabilities from %s",
+      g_hash_table_size (caps_cache), caps_cache_file);
+}
+
+/**
+ * Drop the least recently used capability cache entries beyond
+ * CAPS_CACHE_MAX_ENTRIES.  Cache lock must be held.
+ */
+static void
+dlna_src_caps_cache_trim_locked (void)
+{
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  gpointer oldest_key;
+  gint64 oldest_time;
+
+  while (g_hash_table_size (caps_cache) > CAPS_CACHE_MAX_ENTRIES) {
+    oldest_key = NULL;
+    oldest_time = G_MAXINT64;
+    g_hash_table_iter_init (&iter, caps_cache);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+      if (((dlna_src_caps_entry *) value)->use_time < oldest_time) {
+        oldest_time = ((dlna_src_caps_entry *) value)->use_time;
+        oldest_key = key;
+      }
+    }
+    GST_DEBUG ("Dropping least recently used capabilities of %s",
+        (const gchar *) oldest_key);
+    g_hash_table_remove (caps_cache, oldest_key);
   }
+}
 
-  GST_DEBUG_OBJECT (dlna_src, "Got src pad to use for ghostpad of dlnasrc bin");
-  dlna_src->src_pad = gst_ghost_pad_new ("src", pad);
-  gst_pad_set_active (dlna_src->src_pad, TRUE);
+/**
+ * Have the capability cache written to the cache file, if one is set.
+ * Changes are collected for CAPS_CACHE_SAVE_DELAY_MSECS and written by a
+ * thread of their own, so neither the HEAD worker nor the cache lock wait
+ * for the file.  Cache lock must be held.
+ */
+static void
+dlna_src_caps_cache_save_locked (void)
+{
+  GThread *thread = NULL;
 
-  gst_element_add_pad (GST_ELEMENT (&dlna_src->bin), dlna_src->src_pad);
-  gst_object_unref (pad);
+  if (!caps_cache_file || !caps_cache)
+    return;
 
-  gst_pad_set_event_function (dlna_src->src_pad,
-      (GstPadEventFunction) gst_dlna_src_event);
+  caps_cache_save_pending = TRUE;
+  if (caps_cache_saving)
+    return;
 
-  gst_pad_set_query_function (dlna_src->src_pad,
-      (GstPadQueryFunction) gst_dlna_src_query);
+  caps_cache_saving = TRUE;
+  thread = g_thread_new ("dlnasrc_caps_save",
+      dlna_src_caps_cache_save_thread_func, NULL);
+  g_thread_unref (thread);
+}
 
-  if (dlna_src->byte_total && dlna_src->http_src) {
-    content_size = dlna_src->byte_total;
+/**
+ * Capability cache save thread, writes the cache file with the changes made
+ * over CAPS_CACHE_SAVE_DELAY_MSECS and exits when no change is left.
+ */
+static gpointer
+dlna_src_caps_cache_save_thread_func (gpointer data)
+{
+  gchar *file = NULL;
+  gchar *contents = NULL;
+  gsize length = 0;
+  GError *error = NULL;
+
+  G_LOCK (caps_cache);
+  while (caps_cache_save_pending) {
+    /* Changes made while waiting are written along */
+    G_UNLOCK (caps_cache);
+    g_usleep (CAPS_CACHE_SAVE_DELAY_MSECS * 1000);
+    G_LOCK (caps_cache);
+    caps_cache_save_pending = FALSE;
+
+    if (!caps_cache_file || !caps_cache)
+      break;
+    file = g_strdup (caps_cache_file);
+    contents = dlna_src_caps_cache_to_data_locked (&length);
+    G_UNLOCK (caps_cache);
+
+    if (!g_file_set_contents (file, contents, length, &error)) {
+      GST_WARNING ("Unable to write capability cache to %s: %s", file,
+          error->message);
+      g_clear_error (&error);
+    } else
+      GST_DEBUG ("Wrote capability cache to %s", file);
+    g_free (contents);
+    g_free (file);
 
-    g_object_set (G_OBJECT (dlna_src->http_src), "content-size", content_size,
-        NULL);
-    GST_INFO_OBJECT (dlna_src, "Set HTTP src content size: %" G_GUINT64_FORMAT,
-        content_size);
+    G_LOCK (caps_cache);
   }
+  caps_cache_saving = FALSE;
+  G_UNLOCK (caps_cache);
 
-  return TRUE;
+  return NULL;
 }
 
 /**
- * Setup dtcp decoder element and add to src in order to handle DTCP encrypted
- * content
+ * Serialize the capability cache in key file format.  Cache lock must be
+ * held.
  *
- * @param dlna_src	this element
+ * @param length	returns the length of the data
  *
- * @return	true if successfully setup, false otherwise
+ * @return	newly allocated data
  */
-static gboolean
-dlna_src_setup_dtcp (GstDlnaSrc * dlna_src)
+static gchar *
+dlna_src_caps_cache_to_data_locked (gsize * length)
 {
-  GST_INFO_OBJECT (dlna_src, "Setup for dtcp content");
-
-  if (dlna_src->dtcp_decrypter) {
-    GST_INFO_OBJECT (dlna_src, "Already setup for dtcp content");
-    return TRUE;
+  GKeyFile *key_file = NULL;
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  dlna_src_caps_entry *entry = NULL;
+  GstDlnaSrcHeadResponseContentFeatures *content_features = NULL;
+  gdouble playspeeds[PLAYSPEEDS_MAX_CNT];
+  gchar *data = NULL;
+  guint i;
+
+  key_file = g_key_file_new ();
+  g_hash_table_iter_init (&iter, caps_cache);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    entry = (dlna_src_caps_entry *) value;
+    content_features = entry->content_features;
+
+    g_key_file_set_int64 (key_file, key, "time", entry->store_time);
+    g_key_file_set_int64 (key_file, key, "used", entry->use_time);
+    g_key_file_set_string (key_file, key, "profile",
+        content_features->profile);
+    g_key_file_set_boolean (key_file, key, "op_time_seek",
+        DLNA_SRC_CF_IS_SET (content_features, DLNA_SRC_CF_OP_TIME_SEEK));
+    g_key_file_set_boolean (key_file, key, "op_range",
+        DLNA_SRC_CF_IS_SET (content_features, DLNA_SRC_CF_OP_RANGE));
+    g_key_file_set_int64 (key_file, key, "flags",
+        dlna_src_content_features_get_flags (content_features));
+    g_key_file_set_boolean (key_file, key, "converted",
+        content_features->is_converted);
+    if (content_features->playspeeds_cnt) {
+      for (i = 0; i < content_features->playspeeds_cnt; i++)
+        playspeeds[i] = content_features->playspeeds[i];
+      g_key_file_set_string_list (key_file, key, "playspeed_strs",
+          (const gchar * const *) content_features->playspeed_strs,
+          content_features->playspeeds_cnt);
+      g_key_file_set_double_list (key_file, key, "playspeeds", playspeeds,
+          content_features->playspeeds_cnt);
+    }
+    if (entry->dtcp_host) {
+      g_key_file_set_string (key_file, key, "dtcp_host", entry->dtcp_host);
+      g_key_file_set_integer (key_file, key, "dtcp_port", entry->dtcp_port);
+    }
+    if (entry->byte_total)
+      g_key_file_set_uint64 (key_file, key, "bytes", entry->byte_total);
+    if (entry->npt_duration_nanos)
+      g_key_file_set_uint64 (key_file, key, "duration",
+          entry->npt_duration_nanos);
   }
 
-  GST_INFO_OBJECT (dlna_src, "Creating dtcp decrypter");
-  dlna_src->dtcp_decrypter = gst_element_factory_make ("dtcpip",
-      ELEMENT_NAME_DTCP_DECRYPTER);
-  if (!dlna_src->dtcp_decrypter) {
+  data = g_key_file_to_data (key_file, length, NULL);
+  g_key_file_free (key_file);
+
+  return data;
+}
+
+static void
+dlna_src_caps_entry_free (dlna_src_caps_entry * entry)
+{
+  dlna_src_content_features_free (entry->content_features);
+  g_free (entry->dtcp_host);
+  g_slice_free (dlna_src_caps_entry, entry);
+}
+
+/**
+ * Issue a HEAD request and wait for its response to be processed.  The request
+ * is handled by the HEAD worker, this only blocks the calling thread.  Must not
+ * be called from a completion callback.
+ *
+ * Callers still waiting here: the discovery HEAD requests of a tune without
+ * fast-start or cached capabilities, npt to byte conversions missing from the
+ * seek index, and live range refreshes when the last known range is older
+ * than max-staleness or does not hold a requested time seek.
+ *
+ * @param dlna_src			this element
+ * @param header_array_size		number of headers supplied
+ * @param headers			header name & value pairs to add to request
+ * @param head_response			struct to store parsed response into
+ * @param do_update_overall_info	update element's info from response
+ * @param purpose			latency histogram the request is recorded in
+ *
+ * @return	true if response was successful and parsed, false otherwise
+ */
+static gboolean
+dlna_src_soup_issue_head (GstDlnaSrc * dlna_src, gsize header_array_size,
+    gchar * headers[][2], GstDlnaSrcHeadResponse * head_response,
+    gboolean do_update_overall_info, GstDlnaSrcLatency purpose)
+{
+  dlna_src_head_future future;
+
+  if (!dlna_src->head_context ||
+      g_main_context_is_owner (dlna_src->head_context)) {
     GST_ERROR_OBJECT (dlna_src,
-        "The dtcp decrypter element could not be created. Exiting.");
+        "Unable to wait for HEAD response from this thread");
     return FALSE;
   }
 
-  if (dlna_src->is_encrypted) {
-  g_object_set (G_OBJECT (dlna_src->dtcp_decrypter), "dtcp1host",
-      dlna_src->server_info->dtcp_host, NULL);
-
-  g_object_set (G_OBJECT (dlna_src->dtcp_decrypter), "dtcp1port",
-      dlna_src->server_info->dtcp_port, NULL);
+  g_mutex_init (&future.mutex);
+  g_cond_init (&future.cond);
+  future.done = FALSE;
+  future.success = FALSE;
+
+  if (dlna_src_soup_issue_head_async (dlna_src, header_array_size, headers,
+          head_response, do_update_overall_info, purpose,
+          dlna_src_head_future_complete, &future)) {
+    g_mutex_lock (&future.mutex);
+    while (!future.done)
+      g_cond_wait (&future.cond, &future.mutex);
+    g_mutex_unlock (&future.mutex);
   }
 
-  gst_bin_add (GST_BIN (&dlna_src->bin), dlna_src->dtcp_decrypter);
+  g_cond_clear (&future.cond);
+  g_mutex_clear (&future.mutex);
 
-  if (!gst_element_link_many
-      (dlna_src->http_src, dlna_src->dtcp_decrypter, NULL)) {
-    GST_ERROR_OBJECT (dlna_src, "Problems linking elements in src. Exiting.");
-    return FALSE;
-  }
-  /* Setup the block size for dtcp */
-  g_object_set (dlna_src->http_src, "blocksize", dlna_src->dtcp_blocksize,
-      NULL);
+  return future.success;
+}
 
-  /* Make sure passthru mode is either disabled or enabled depending on content encryption */
-  g_object_set (dlna_src->dtcp_decrypter, "passthru-mode",
-      !dlna_src->is_encrypted, NULL);
+/**
+ * Completion callback of synchronous HEAD requests, wakes up the caller.
+ */
+static void
+dlna_src_head_future_complete (GstDlnaSrc * dlna_src, gboolean success,
+    gpointer user_data)
+{
+  dlna_src_head_future *future = (dlna_src_head_future *) user_data;
 
-  return TRUE;
+  g_mutex_lock (&future->mutex);
+  future->success = success;
+  future->done = TRUE;
+  g_cond_signal (&future->cond);
+  g_mutex_unlock (&future->mutex);
 }
 
 /**
- * Initialize the URI which includes formulating a HEAD request
- * and parsing the response to get needed info about the URI.
+ * Issue a HEAD request without waiting for the response.  The response is
+ * parsed on the HEAD worker thread and the callback is then called from there,
+ * also when the request fails or is cancelled.  The headers are copied into
+ * the request before returning.
  *
- * @param dlna_src	this element
- * @param value		specified URI to use
+ * @param dlna_src			this element
+ * @param header_array_size		number of headers supplied
+ * @param headers			header name & value pairs to add to request
+ * @param head_response			struct to store parsed response into
+ * @param do_update_overall_info	update element's info from response
+ * @param purpose			latency histogram the request is recorded in
+ * @param callback			called once request has completed, may be NULL
+ * @param user_data			passed to callback
  *
- * @return	true if no problems encountered, false otherwise
+ * @return	true if request was queued, false if callback will not be called
  */
 static gboolean
-dlna_src_uri_gather_info (GstDlnaSrc * dlna_src)
+dlna_src_soup_issue_head_async (GstDlnaSrc * dlna_src, gsize header_array_size,
+    gchar * headers[][2], GstDlnaSrcHeadResponse * head_response,
+    gboolean do_update_overall_info, GstDlnaSrcLatency purpose,
+    dlna_src_head_callback callback, gpointer user_data)
 {
+  gint i;
+  dlna_src_head_request *request = NULL;
+  GString *flight_key = NULL;
 
-  gchar *content_features_head_request_headers[][2] =
-      { {HEADER_GET_CONTENT_FEATURES_TITLE,
-      HEADER_GET_CONTENT_FEATURES_VALUE}
-  };
-  gsize content_features_head_request_headers_array_size = 1;
-
-  gchar *live_content_head_request_headers[][2] =
-      { {HEADER_GET_AVAILABLE_SEEK_RANGE_TITLE,
-      HEADER_GET_AVAILABLE_SEEK_RANGE_VALUE}
-  };
-  gsize live_content_head_request_headers_array_size = 1;
-
-  gchar *time_seek_head_request_headers[][2] =
-      { {HEADER_TIME_SEEK_RANGE_TITLE, HEADER_TIME_SEEK_RANGE_VALUE} };
-  gsize time_seek_head_request_headers_array_size = 1;
-
-  gchar *range_head_request_headers[][2] =
-      { {HEADER_RANGE_BYTES_TITLE, HEADER_RANGE_BYTES_VALUE} };
-  gsize range_head_request_headers_array_size = 1;
-
-  gchar *dtcp_range_head_request_headers[][2] =
-      { {HEADER_DTCP_RANGE_BYTES_TITLE, HEADER_DTCP_RANGE_BYTES_VALUE} };
-  gsize dtcp_range_head_request_headers_array_size = 1;
-
-  GST_DEBUG_OBJECT (dlna_src, "Gathering info about URI");
-
-  if (!dlna_src->dlna_uri) {
-    GST_DEBUG_OBJECT (dlna_src, "No URI set yet");
-    return TRUE;
+  if (!dlna_src->head_context) {
+    GST_WARNING_OBJECT (dlna_src, "No HEAD worker, session is not open");
+    return FALSE;
   }
 
-  /* Make sure a soup session is open */
-  if (!dlna_src_soup_session_open (dlna_src)) {
-    GST_ERROR_OBJECT (dlna_src,
-        "Problems initializing struct to store HEAD response");
+  GST_DEBUG_OBJECT (dlna_src, "Creating soup message");
+  request = g_slice_new0 (dlna_src_head_request);
+  request->soup_msg = soup_message_new (SOUP_METHOD_HEAD, dlna_src->http_uri);
+  if (!request->soup_msg) {
+    GST_WARNING_OBJECT (dlna_src,
+        "Unable to create soup message for HEAD request");
+    g_slice_free (dlna_src_head_request, request);
     return FALSE;
   }
 
-  /* Initialize server info */
-  if (!dlna_src_head_response_init_struct (dlna_src, &dlna_src->server_info)) {
-    GST_ERROR_OBJECT (dlna_src,
-        "Problems initializing struct to store HEAD response");
-    return FALSE;
+  GST_DEBUG_OBJECT (dlna_src, "Adding headers to soup message");
+  for (i = 0; i < header_array_size; i++)
+    soup_message_headers_append (request->soup_msg->request_headers,
+        headers[i][0], headers[i][1]);
+
+  request->dlna_src = dlna_src;
+  request->head_response = head_response;
+  request->do_update_overall_info = do_update_overall_info;
+  request->callback = callback;
+  request->user_data = user_data;
+  request->purpose = purpose;
+  request->issue_time = g_get_monotonic_time ();
+  /* HEAD requests made while executing a seek are cancelled once a newer
+   * seek supersedes it */
+  if (dlna_src->seek_owner == g_thread_self ())
+    request->seek_seqnum = dlna_src->seek_executing_seqnum;
+
+  /* Requests parsed into the element's own info are identical when their
+   * headers are, so they can share a response */
+  if (head_response == dlna_src->server_info) {
+    flight_key = g_string_new (NULL);
+    g_string_append_printf (flight_key, "%d|%d",
+        g_atomic_int_get (&dlna_src->head_flights_generation),
+        do_update_overall_info);
+    for (i = 0; i < header_array_size; i++)
+      g_string_append_printf (flight_key, "|%s: %s", headers[i][0],
+          headers[i][1]);
+    request->flight_key = g_string_free (flight_key, FALSE);
   }
 
-  /* Issue first head with just content features to determine what server supports */
-  GST_INFO_OBJECT (dlna_src,
-      "Issuing HEAD Request with content features to determine what server supports");
+  g_mutex_lock (&dlna_src->head_mutex);
+  dlna_src->head_requests_pending++;
+  g_mutex_unlock (&dlna_src->head_mutex);
 
-  if (!dlna_src_soup_issue_head (dlna_src,
-          content_features_head_request_headers_array_size,
-          content_features_head_request_headers, dlna_src->server_info, TRUE)) {
-    GST_ERROR_OBJECT (dlna_src,
-        "Problems issuing HEAD request to get content features");
+  g_main_context_invoke (dlna_src->head_context, dlna_src_head_request_queue,
+      request);
+
+  return TRUE;
+}
+
+/**
+ * Runs on the HEAD worker context and hands the request to the session.
+ */
+static gboolean
+dlna_src_head_request_queue (gpointer data)
+{
+  dlna_src_head_request *request = (dlna_src_head_request *) data;
+  GstDlnaSrc *dlna_src = request->dlna_src;
+  dlna_src_head_flight *flight = NULL;
+
+  if (dlna_src->head_closing) {
+    GST_INFO_OBJECT (dlna_src, "Session is closing, dropping HEAD request");
+    request->head_response->ret_code = SOUP_STATUS_CANCELLED;
+    g_object_unref (request->soup_msg);
+    dlna_src_head_request_complete (request, FALSE);
     return FALSE;
   }
 
-  /* Formulate second HEAD request to gather more info */
-  if ((dlna_src->is_live) || (dlna_src->is_recInProgress)) {
-
-    GST_INFO_OBJECT (dlna_src,
-        "Issuing another HEAD request to get live/recInProgess content info");
-    if (!dlna_src_soup_issue_head (dlna_src,
-            live_content_head_request_headers_array_size,
-            live_content_head_request_headers, dlna_src->server_info, TRUE)) {
-      GST_ERROR_OBJECT (dlna_src,
-          "Problems issuing HEAD request to get live/recInProgess content information");
-      return FALSE;
-    }
-  } else if (dlna_src->time_seek_supported) {
-    GST_INFO_OBJECT (dlna_src,
-        "Issuing another HEAD request to get time seek info");
-    if (!dlna_src_soup_issue_head (dlna_src,
-            time_seek_head_request_headers_array_size,
-            time_seek_head_request_headers, dlna_src->server_info, TRUE)) {
-      GST_ERROR_OBJECT (dlna_src,
-          "Problems issuing HEAD request to get time seek information");
-      return FALSE;
-    }
-  } else if (dlna_src->byte_seek_supported && dlna_src->is_encrypted) {
-    GST_INFO_OBJECT (dlna_src,
-        "Issuing another HEAD request to get dtcp range info");
-    if (!dlna_src_soup_issue_head (dlna_src,
-            dtcp_range_head_request_headers_array_size,
-            dtcp_range_head_request_headers, dlna_src->server_info, TRUE)) {
-      GST_ERROR_OBJECT (dlna_src,
-          "Problems issuing HEAD request to get range information");
+  if (request->flight_key) {
+    g_hash_table_foreach_remove (dlna_src->head_flights,
+        dlna_src_head_flight_expired, dlna_src);
+    flight = g_hash_table_lookup (dlna_src->head_flights,
+        request->flight_key);
+
+    if (flight && flight->in_flight) {
+      GST_DEBUG_OBJECT (dlna_src, "Joining identical HEAD request in flight");
+      g_object_unref (request->soup_msg);
+      request->soup_msg = NULL;
+      flight->followers = g_list_prepend (flight->followers, request);
       return FALSE;
     }
-  } else if (dlna_src->byte_seek_supported) {
-    GST_INFO_OBJECT (dlna_src,
-        "Issuing another HEAD request to get range info");
-    if (!dlna_src_soup_issue_head (dlna_src,
-            range_head_request_headers_array_size,
-            range_head_request_headers, dlna_src->server_info, TRUE)) {
-      GST_ERROR_OBJECT (dlna_src,
-          "Problems issuing HEAD request to get range information");
+
+    if (flight) {
+      GST_DEBUG_OBJECT (dlna_src, "Reusing HEAD response received %"
+          G_GINT64_FORMAT " ms ago",
+          (g_get_monotonic_time () - flight->land_time) / 1000);
+      g_object_unref (request->soup_msg);
+      request->soup_msg = NULL;
+      dlna_src_head_request_complete (request, TRUE);
       return FALSE;
     }
-  } else {
-    GST_INFO_OBJECT (dlna_src, "Not issuing another HEAD request");
+
+    flight = g_slice_new0 (dlna_src_head_flight);
+    flight->in_flight = TRUE;
+    g_hash_table_replace (dlna_src->head_flights,
+        g_strdup (request->flight_key), flight);
   }
- 
-  /* Print out results of HEAD request */
-  if (gst_debug_category_get_threshold(gst_dlna_src_debug) >= GST_LEVEL_INFO)
+
+  GST_DEBUG_OBJECT (dlna_src, "Sending soup message");
+  dlna_src->head_requests = g_list_prepend (dlna_src->head_requests, request);
+  /* Session takes ownership of the message */
+  soup_session_queue_message (dlna_src->soup_session, request->soup_msg,
+      dlna_src_head_request_done, request);
+
+  return FALSE;
+}
+
+/**
+ * Session callback of a HEAD request, parses the response into the request's
+ * head response struct.
+ */
+static void
+dlna_src_head_request_done (SoupSession * session, SoupMessage * soup_msg,
+    gpointer user_data)
+{
+  dlna_src_head_request *request = (dlna_src_head_request *) user_data;
+  GstDlnaSrc *dlna_src = request->dlna_src;
+  GstDlnaSrcHeadResponse *head_response = request->head_response;
+  gboolean ret = FALSE;
+  gint64 usecs = g_get_monotonic_time () - request->issue_time;
+
+  dlna_src->head_requests = g_list_remove (dlna_src->head_requests, request);
+
+  if (soup_msg->status_code != SOUP_STATUS_CANCELLED)
+     dlna_src_stats_record (dlna_src, request->purpose, usecs);
+
+  do
   {
-    GString *struct_str = g_string_sized_new (MAX_HTTP_BUF_SIZE);
-    dlna_src_head_response_struct_to_str (dlna_src, dlna_src->server_info,
-        struct_str);
+     head_response->ret_code = soup_msg->status_code;
 
-    GST_INFO_OBJECT (dlna_src, "Parsed HEAD Response into struct: %s",
-        struct_str->str);
+     /* Capabilities learned from a server which now fails may be stale */
+     if ((SOUP_STATUS_IS_TRANSPORT_ERROR (soup_msg->status_code) &&
+              soup_msg->status_code != SOUP_STATUS_CANCELLED) ||
+           SOUP_STATUS_IS_SERVER_ERROR (soup_msg->status_code))
+        dlna_src_caps_cache_invalidate (dlna_src->server_key);
 
-    g_string_free (struct_str, TRUE);
+     /* Print out HEAD request & response, the trace ring has the gist */
+     if (gst_debug_category_get_threshold(gst_dlna_src_debug) >= GST_LEVEL_LOG)
+        dlna_src_soup_log_msg (dlna_src, soup_msg);
+
+     /* Make sure return code from HEAD response is some form of success */
+     if (head_response->ret_code != HTTP_STATUS_OK &&
+           head_response->ret_code != HTTP_STATUS_CREATED &&
+           head_response->ret_code != HTTP_STATUS_PARTIAL) {
+
+        GST_WARNING_OBJECT (dlna_src,
+              "Error code received in HEAD response: %d %s",
+              head_response->ret_code, head_response->ret_msg);
+        break;
+     }
+     
+     g_mutex_lock(&dlna_src->parse_msg_mutex);
+     /* Parse HEAD response to gather info about URI content item */
+     if (!dlna_src_head_response_parse (dlna_src, soup_msg, head_response)) {
+        GST_WARNING_OBJECT (dlna_src, "Problems parsing HEAD response");
+        g_mutex_unlock(&dlna_src->parse_msg_mutex);
+        break;
+     }
+
+     if (request->do_update_overall_info) {
+        GST_INFO_OBJECT (dlna_src, "Updating overall info");
+        /* Update info based on response to HEAD info */
+        if (!dlna_src_update_overall_info (dlna_src, head_response))
+           GST_WARNING_OBJECT (dlna_src, "Problems initializing content info");
+     } else
+        GST_INFO_OBJECT (dlna_src, "Not updating overall info");
+     
+     g_mutex_unlock(&dlna_src->parse_msg_mutex);
+     ret = TRUE;
+
+  }while(0);
+
+  dlna_src_trace_head (dlna_src, request->purpose, soup_msg->status_code,
+        usecs, ret ? head_response : NULL);
+  if (!ret && soup_msg->status_code != SOUP_STATUS_CANCELLED)
+     dlna_src_trace_dump (dlna_src, "HEAD request failed");
+
+  dlna_src_head_flight_land (request, ret);
+  dlna_src_head_request_complete (request, ret);
+}
+
+/**
+ * Report the outcome of a HEAD request to its issuer and free it.
+ */
+static void
+dlna_src_head_request_complete (dlna_src_head_request * request,
+    gboolean success)
+{
+  GstDlnaSrc *dlna_src = request->dlna_src;
+
+  if (request->callback)
+    request->callback (dlna_src, success, request->user_data);
+
+  g_free (request->flight_key);
+  g_slice_free (dlna_src_head_request, request);
+
+  /* Element may be finalized as soon as pending count drops to zero */
+  g_mutex_lock (&dlna_src->head_mutex);
+  dlna_src->head_requests_pending--;
+  g_cond_broadcast (&dlna_src->head_cond);
+  g_mutex_unlock (&dlna_src->head_mutex);
+}
+
+/**
+ * Complete the requests which joined a HEAD request once it has landed.
+ * A successful response is kept to answer identical requests while it is
+ * fresh, see dlna_src_head_flight_expired().
+ *
+ * @param request	request which was sent to the server
+ * @param success	outcome of the request
+ */
+static void
+dlna_src_head_flight_land (dlna_src_head_request * request, gboolean success)
+{
+  GstDlnaSrc *dlna_src = request->dlna_src;
+  dlna_src_head_flight *flight = NULL;
+  GList *followers = NULL;
+  GList *item = NULL;
+
+  if (!request->flight_key)
+    return;
+
+  flight = g_hash_table_lookup (dlna_src->head_flights, request->flight_key);
+  if (!flight)
+    return;
+
+  followers = g_list_reverse (flight->followers);
+  flight->followers = NULL;
+  flight->in_flight = FALSE;
+  flight->land_time = g_get_monotonic_time ();
+  if (!success)
+    g_hash_table_remove (dlna_src->head_flights, request->flight_key);
+
+  if (followers)
+    GST_DEBUG_OBJECT (dlna_src, "HEAD response shared with %u request(s)",
+        g_list_length (followers));
+  for (item = followers; item; item = item->next)
+    dlna_src_head_request_complete ((dlna_src_head_request *) item->data,
+        success);
+  g_list_free (followers);
+}
+
+/**
+ * Hash table foreach function, selects landed HEAD requests whose response
+ * is older than the freshness window.
+ */
+static gboolean
+dlna_src_head_flight_expired (gpointer key, gpointer value,
+    gpointer user_data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) user_data;
+  dlna_src_head_flight *flight = (dlna_src_head_flight *) value;
+
+  return (!flight->in_flight &&
+      ((g_get_monotonic_time () - flight->land_time) >=
+          ((gint64) dlna_src->head_freshness * 1000)));
+}
+
+static void
+dlna_src_head_flight_free (dlna_src_head_flight * flight)
+{
+  g_list_free (flight->followers);
+  g_slice_free (dlna_src_head_flight, flight);
+}
+
+/**
+ * Refresh the range info of live/recInProgress content in the background so
+ * queries and seeks can be answered from the last known values.  Only one
+ * refresh is outstanding at a time.
+ *
+ * @param dlna_src	this element
+ * @param purpose	latency histogram the request is recorded in
+ */
+static void
+dlna_src_refresh_live_info_async (GstDlnaSrc * dlna_src,
+    GstDlnaSrcLatency purpose)
+{
+  gchar *live_content_head_request_headers[][2] =
+      { {HEADER_GET_AVAILABLE_SEEK_RANGE_TITLE,
+      HEADER_GET_AVAILABLE_SEEK_RANGE_VALUE}
+  };
+  gsize live_content_head_request_headers_size = 1;
+
+  if (!g_atomic_int_compare_and_exchange (&dlna_src->head_refresh_pending,
+          0, 1)) {
+    GST_LOG_OBJECT (dlna_src, "Live content info refresh already pending");
+    return;
   }
 
-  return TRUE;
+  if (!dlna_src_soup_issue_head_async (dlna_src,
+          live_content_head_request_headers_size,
+          live_content_head_request_headers, dlna_src->server_info, TRUE,
+          purpose, dlna_src_refresh_live_info_done, NULL)) {
+    GST_WARNING_OBJECT (dlna_src,
+        "Problems issuing HEAD request to refresh live content information");
+    g_atomic_int_set (&dlna_src->head_refresh_pending, 0);
+  }
 }
 
-static gboolean
-dlna_src_soup_issue_head (GstDlnaSrc * dlna_src, gsize header_array_size,
-    gchar * headers[][2], GstDlnaSrcHeadResponse * head_response,
-    gboolean do_update_overall_info)
+static void
+dlna_src_refresh_live_info_done (GstDlnaSrc * dlna_src, gboolean success,
+    gpointer user_data)
 {
-  gint i;
-  gboolean ret = FALSE;
-  SoupMessage *soup_msg = NULL;
-
-  do
-  {
-     GST_DEBUG_OBJECT (dlna_src, "Creating soup message");
-     soup_msg = soup_message_new (SOUP_METHOD_HEAD, dlna_src->http_uri);
-     if (!soup_msg) {
-        GST_WARNING_OBJECT (dlna_src,
-              "Unable to create soup message for HEAD request");
-        break;
-     }
-
-     GST_DEBUG_OBJECT (dlna_src, "Adding headers to soup message");
-     for (i = 0; i < header_array_size; i++)
-        soup_message_headers_append (soup_msg->request_headers,
-              headers[i][0], headers[i][1]);
-
-     GST_DEBUG_OBJECT (dlna_src, "Sending soup message");
-     head_response->ret_code =
-        soup_session_send_message (dlna_src->soup_session, soup_msg);
-
-     /* Print out HEAD request & response */
-     if (gst_debug_category_get_threshold(gst_dlna_src_debug) >= GST_LEVEL_INFO)
-        dlna_src_soup_log_msg (dlna_src, soup_msg);
+  if (!success)
+    GST_WARNING_OBJECT (dlna_src,
+        "Problems refreshing live/recInProgress content information");
+  else
+    dlna_src_boundary_sync (dlna_src);
 
-     /* Make sure return code from HEAD response is some form of success */
-     if (head_response->ret_code != HTTP_STATUS_OK &&
-           head_response->ret_code != HTTP_STATUS_CREATED &&
-           head_response->ret_code != HTTP_STATUS_PARTIAL) {
+  g_atomic_int_set (&dlna_src->head_refresh_pending, 0);
+}
 
-        GST_WARNING_OBJECT (dlna_src,
-              "Error code received in HEAD response: %d %s",
-              head_response->ret_code, head_response->ret_msg);
-        break;
-     }
-     
-     g_mutex_lock(&dlna_src->parse_msg_mutex);
-     /* Parse HEAD response to gather info about URI content item */
-     if (!dlna_src_head_response_parse (dlna_src, soup_msg, head_response)) {
-        GST_WARNING_OBJECT (dlna_src, "Problems parsing HEAD response");
-        g_mutex_unlock(&dlna_src->parse_msg_mutex);
-        break;
-     }
+/**
+ * Determines if a time position can be validated against the last known range
+ * of live content without asking the server.  The range is extrapolated to
+ * now, as long as it is no older than max-staleness.
+ *
+ * @param dlna_src	this element
+ * @param npt_nanos	requested position
+ *
+ * @return	true if position is known to be within range
+ */
+static gboolean
+dlna_src_is_live_range_current (GstDlnaSrc * dlna_src, guint64 npt_nanos)
+{
+  GstDlnaSrcRange *range;
+  guint64 npt_start;
+  guint64 npt_end;
+  guint64 npt_duration;
+  gint64 age_msecs;
+  gboolean current = FALSE;
+
+  range = dlna_src_range_get (dlna_src);
+  age_msecs = (g_get_monotonic_time () - range->update_time) / 1000;
+  if (range->update_time && range->npt_end_nanos &&
+      (age_msecs <= dlna_src->max_staleness)) {
+    dlna_src_range_extrapolate (dlna_src, range, &npt_start, &npt_end,
+        &npt_duration);
+    current = ((npt_nanos >= npt_start) && (npt_nanos <= npt_end));
+  }
+  dlna_src_range_unref (range);
 
-     if (do_update_overall_info) {
-        GST_INFO_OBJECT (dlna_src, "Updating overall info");
-        /* Update info based on response to HEAD info */
-        if (!dlna_src_update_overall_info (dlna_src, head_response))
-           GST_WARNING_OBJECT (dlna_src, "Problems initializing content info");
-     } else
-        GST_INFO_OBJECT (dlna_src, "Not updating overall info");
-     
-     g_mutex_unlock(&dlna_src->parse_msg_mutex);
-     ret = TRUE;
+  return current;
+}
 
-  }while(0);
+/**
+ * Get the content range to answer a query with.  The last known range of
+ * live/recInProgress content is used as long as it is no older than
+ * max-staleness, and refreshed in the background.  Otherwise the caller
+ * waits for the server.
+ *
+ * @param dlna_src	this element
+ *
+ * @return	snapshot to release with dlna_src_range_unref(), NULL if the
+ *		range could not be received
+ */
+static GstDlnaSrcRange *
+dlna_src_range_get_fresh (GstDlnaSrc * dlna_src)
+{
+  gchar *live_content_head_request_headers[][2] =
+      { {HEADER_GET_AVAILABLE_SEEK_RANGE_TITLE,
+      HEADER_GET_AVAILABLE_SEEK_RANGE_VALUE}
+  };
+  gsize live_content_head_request_headers_size = 1;
+  GstDlnaSrcRange *range;
+  gint64 age_msecs;
+
+  range = dlna_src_range_get (dlna_src);
+  if (!dlna_src->is_live && !dlna_src->is_recInProgress)
+    return range;
+
+  age_msecs = (g_get_monotonic_time () - range->update_time) / 1000;
+  if (range->update_time && range->npt_duration_nanos &&
+      (age_msecs <= dlna_src->max_staleness)) {
+    /* Answer with last known range rather than stall the caller */
+    GST_LOG_OBJECT (dlna_src, "Using range received %" G_GINT64_FORMAT
+        " ms ago, refresh in background", age_msecs);
+    dlna_src_refresh_live_info_async (dlna_src,
+        DLNA_SRC_LATENCY_HEAD_AVAILABLE_RANGE);
+    return range;
+  }
+  dlna_src_range_unref (range);
 
-  if (soup_msg) {
-    GST_DEBUG_OBJECT (dlna_src, "Freeing soup message");
-    g_object_unref (soup_msg);
-    soup_msg = NULL;
+  GST_INFO_OBJECT (dlna_src, "Update live/recInProgress content range info");
+  if (!dlna_src_soup_issue_head (dlna_src,
+          live_content_head_request_headers_size,
+          live_content_head_request_headers, dlna_src->server_info, TRUE,
+          DLNA_SRC_LATENCY_HEAD_AVAILABLE_RANGE)) {
+    GST_ERROR_OBJECT (dlna_src,
+        "Problems issuing HEAD request to get live/recInProgress content information");
+    return NULL;
   }
 
-  return ret;
+  return dlna_src_range_get (dlna_src);
+}
+
+/**
+ * Estimate the current npt range of live/recInProgress content from a range
+ * received earlier.  The end moves forward in real time, and so does the
+ * start once the TSB holds its maximum duration.  Other content is returned
+ * as is.
+ *
+ * @param dlna_src	this element
+ * @param range		range received from the server
+ * @param npt_start	estimated start
+ * @param npt_end	estimated end
+ * @param npt_duration	estimated duration
+ */
+static void
+dlna_src_range_extrapolate (GstDlnaSrc * dlna_src, GstDlnaSrcRange * range,
+    guint64 * npt_start, guint64 * npt_end, guint64 * npt_duration)
+{
+  guint64 elapsed_nanos;
+
+  *npt_start = range->npt_start_nanos;
+  *npt_end = range->npt_end_nanos;
+  *npt_duration = range->npt_duration_nanos;
+
+  if ((!dlna_src->is_live && !dlna_src->is_recInProgress) ||
+      !range->update_time || !range->npt_end_nanos)
+    return;
+
+  elapsed_nanos = (g_get_monotonic_time () - range->update_time) *
+      GST_USECOND;
+  *npt_end += elapsed_nanos;
+  if (dlna_src->is_live &&
+      ((range->npt_duration_nanos / GST_SECOND) >= dlna_src->max_tsb_duration))
+    *npt_start += elapsed_nanos;
+  else
+    *npt_duration += elapsed_nanos;
 }
 
 /**
@@ -2805,16 +9017,21 @@ dlna_src_update_overall_info (GstDlnaSrc * dlna_src,
 
   if (head_response->content_features) {
 
-    if (head_response->content_features->flag_so_increasing_set
-        && head_response->content_features->flag_sn_increasing_set) {
+    if (DLNA_SRC_CF_IS_SET (head_response->content_features,
+            DLNA_SRC_CF_SO_INCREASING)
+        && DLNA_SRC_CF_IS_SET (head_response->content_features,
+            DLNA_SRC_CF_SN_INCREASING)) {
       dlna_src->is_live = TRUE;
       GST_INFO_OBJECT (dlna_src, "Content is live since s0 and sN is increasing");
-    } else if (!(head_response->content_features->flag_so_increasing_set)
-        && head_response->content_features->flag_sn_increasing_set) {
+    } else if (!DLNA_SRC_CF_IS_SET (head_response->content_features,
+            DLNA_SRC_CF_SO_INCREASING)
+        && DLNA_SRC_CF_IS_SET (head_response->content_features,
+            DLNA_SRC_CF_SN_INCREASING)) {
       dlna_src->is_recInProgress = TRUE;
     }
 
-    if (head_response->content_features->flag_link_protected_set) {
+    if (DLNA_SRC_CF_IS_SET (head_response->content_features,
+            DLNA_SRC_CF_LINK_PROTECTED)) {
       dlna_src->is_encrypted = TRUE;
       GST_INFO_OBJECT (dlna_src,
           "Content is encrypted since link protected flag is set");
@@ -2912,14 +9129,14 @@ dlna_src_update_overall_info (GstDlnaSrc * dlna_src,
       GST_INFO_OBJECT (dlna_src, "Byte seek range values not available");
   }
 
-  if (head_response->content_features->op_time_seek_supported ||
-      head_response->content_features->flag_limited_time_seek_set) {
+  if (DLNA_SRC_CF_IS_SET (head_response->content_features,
+          DLNA_SRC_CF_OP_TIME_SEEK | DLNA_SRC_CF_LIMITED_TIME_SEEK)) {
     dlna_src->time_seek_supported = TRUE;
   }
 
-  if (head_response->content_features->op_range_supported ||
-      head_response->content_features->flag_full_clear_text_set ||
-      head_response->content_features->flag_limited_byte_seek_set ||
+  if (DLNA_SRC_CF_IS_SET (head_response->content_features,
+          DLNA_SRC_CF_OP_RANGE | DLNA_SRC_CF_FULL_CLEAR_TEXT |
+          DLNA_SRC_CF_LIMITED_BYTE_SEEK) ||
       head_response->accept_byte_ranges)
     dlna_src->byte_seek_supported = TRUE;
 
@@ -2945,9 +9162,153 @@ dlna_src_update_overall_info (GstDlnaSrc * dlna_src,
      dlna_src->tune_start_pts = head_response->start_pts;
   }
 
+  dlna_src->head_update_time = g_get_monotonic_time ();
+
+  dlna_src_range_publish (dlna_src);
+
   return TRUE;
 }
 
+/**
+ * Publish the current content range as a new snapshot.  Snapshots are never
+ * modified once published, so readers such as query handlers use them
+ * without waiting for a HEAD response to be parsed.  The previous snapshot
+ * is released once the last reader holding it lets go.
+ *
+ * @param dlna_src  this element
+ */
+static void
+dlna_src_range_publish (GstDlnaSrc * dlna_src)
+{
+  GstDlnaSrcRange *range;
+  GstDlnaSrcHeadResponseContentFeatures *features = NULL;
+  guint i;
+
+  range = g_slice_new0 (GstDlnaSrcRange);
+  range->ref_count = 1;
+  range->byte_seek_supported = dlna_src->byte_seek_supported;
+  range->byte_start = dlna_src->byte_start;
+  range->byte_end = dlna_src->byte_end;
+  range->byte_total = dlna_src->byte_total;
+  range->time_seek_supported = dlna_src->time_seek_supported;
+  range->npt_start_nanos = dlna_src->npt_start_nanos;
+  range->npt_end_nanos = dlna_src->npt_end_nanos;
+  range->npt_duration_nanos = dlna_src->npt_duration_nanos;
+  range->tune_start_pts = dlna_src->tune_start_pts;
+  range->start_pts = dlna_src->start_pts;
+  range->end_pts = dlna_src->end_pts;
+  range->update_time = dlna_src->head_update_time;
+
+  if (dlna_src->server_info)
+    features = dlna_src->server_info->content_features;
+  if (features && (features->playspeeds_cnt > 0)) {
+    range->playspeeds_cnt = MIN (features->playspeeds_cnt, PLAYSPEEDS_MAX_CNT);
+    for (i = 0; i < range->playspeeds_cnt; i++)
+      range->playspeeds[i] = features->playspeeds[i];
+  }
+
+  dlna_src_range_swap (dlna_src, range);
+}
+
+/**
+ * Publish the current content range with estimated TSB boundaries.  Only
+ * the snapshot carries the estimate, the boundaries last received from the
+ * server are left as they are.
+ *
+ * @param dlna_src  this element
+ * @param start_pts estimated start PTS
+ * @param end_pts   estimated end PTS
+ */
+static void
+dlna_src_range_publish_pts (GstDlnaSrc * dlna_src, guint32 start_pts,
+    guint32 end_pts)
+{
+  GstDlnaSrcRange *range;
+  GstDlnaSrcRange *current;
+
+  /* Ordered with snapshots published from a parsed response */
+  g_mutex_lock (&dlna_src->parse_msg_mutex);
+  current = dlna_src_range_get (dlna_src);
+  range = g_slice_dup (GstDlnaSrcRange, current);
+  dlna_src_range_unref (current);
+  range->ref_count = 1;
+  range->start_pts = start_pts;
+  range->end_pts = end_pts;
+  dlna_src_range_swap (dlna_src, range);
+  g_mutex_unlock (&dlna_src->parse_msg_mutex);
+}
+
+/**
+ * Make range the current snapshot and drop the reference of the element to
+ * the previous one, which readers may still hold.  The TSB slide of range is
+ * derived from its PTS, keeping the previous value when those are invalid.
+ *
+ * @param dlna_src  this element
+ * @param range     snapshot to publish, ownership is taken
+ */
+static void
+dlna_src_range_swap (GstDlnaSrc * dlna_src, GstDlnaSrcRange * range)
+{
+  GstDlnaSrcRange *old;
+
+  g_mutex_lock (&dlna_src->range_mutex);
+  old = dlna_src->range;
+
+  range->tsb_slide = 0;
+  if (MAX_PTS_45KHZ != range->tune_start_pts) {
+    if (range->start_pts >= range->tune_start_pts)
+      range->tsb_slide = (range->start_pts - range->tune_start_pts) / 45000;
+    else if ((range->tune_start_pts - range->start_pts) > (MAX_PTS_45KHZ / 2))
+      range->tsb_slide = (range->start_pts +
+          (MAX_PTS_45KHZ - range->tune_start_pts)) / 45000;
+    else {
+      GST_WARNING_OBJECT (dlna_src, "Invalid TSB current start PTS: 0x%x > "
+          "tune tsb start pts: 0x%x, keeping old TSB slide",
+          range->start_pts, range->tune_start_pts);
+      range->tsb_slide = old ? old->tsb_slide : 0;
+    }
+  }
+
+  dlna_src->range = range;
+  g_mutex_unlock (&dlna_src->range_mutex);
+
+  dlna_src_range_unref (old);
+}
+
+/**
+ * Get a reference to the most recently published content range.
+ *
+ * @param dlna_src  this element
+ *
+ * @return  snapshot to release with dlna_src_range_unref()
+ */
+static GstDlnaSrcRange *
+dlna_src_range_get (GstDlnaSrc * dlna_src)
+{
+  GstDlnaSrcRange *range;
+
+  /* Held only to load and reference the pointer, so a swap can never
+   * release the snapshot in between */
+  g_mutex_lock (&dlna_src->range_mutex);
+  range = dlna_src->range;
+  g_atomic_int_inc (&range->ref_count);
+  g_mutex_unlock (&dlna_src->range_mutex);
+
+  return range;
+}
+
+/**
+ * Release a reference to a content range snapshot.
+ *
+ * @param range  snapshot, may be NULL
+ */
+static void
+dlna_src_range_unref (GstDlnaSrcRange * range)
+{
+  if (range && g_atomic_int_dec_and_test (&range->ref_count))
+    g_slice_free (GstDlnaSrcRange, range);
+}
+
 /**
  * Free the memory allocated to store head response.
  *
@@ -2958,17 +9319,8 @@ static void
 dlna_src_head_response_free_struct (GstDlnaSrc * dlna_src,
     GstDlnaSrcHeadResponse * head_response)
 {
-  int i = 0;
   if (head_response) {
-    if (head_response->content_features) {
-      g_free (head_response->content_features->profile);
-
-      for (i = 0; i < PLAYSPEEDS_MAX_CNT; i++)
-        g_free (head_response->content_features->playspeed_strs[i]);
-
-      g_slice_free (GstDlnaSrcHeadResponseContentFeatures,
-          head_response->content_features);
-    }
+    dlna_src_content_features_free (head_response->content_features);
 
     g_free (head_response->http_rev);
     g_free (head_response->ret_msg);
@@ -2989,6 +9341,104 @@ dlna_src_head_response_free_struct (GstDlnaSrc * dlna_src,
   }
 }
 
+/**
+ * Allocate content features with nothing set.
+ */
+static GstDlnaSrcHeadResponseContentFeatures *
+dlna_src_content_features_new (void)
+{
+  GstDlnaSrcHeadResponseContentFeatures *content_features =
+      g_slice_new0 (GstDlnaSrcHeadResponseContentFeatures);
+
+  content_features->profile_idx = HEADER_INDEX_PN;
+  content_features->operations_idx = HEADER_INDEX_OP;
+  content_features->playspeeds_idx = HEADER_INDEX_PS;
+  content_features->flags_idx = HEADER_INDEX_FLAGS;
+  content_features->conversion_idx = HEADER_INDEX_CI;
+
+  return content_features;
+}
+
+/**
+ * Deep copy of content features, as needed to keep them beyond the life of
+ * the HEAD response they were parsed from.
+ */
+static GstDlnaSrcHeadResponseContentFeatures *
+dlna_src_content_features_copy (const GstDlnaSrcHeadResponseContentFeatures *
+    content_features)
+{
+  GstDlnaSrcHeadResponseContentFeatures *copy =
+      g_slice_dup (GstDlnaSrcHeadResponseContentFeatures, content_features);
+  guint i;
+
+  copy->profile = g_strdup (content_features->profile);
+  for (i = 0; i < PLAYSPEEDS_MAX_CNT; i++)
+    copy->playspeed_strs[i] = g_strdup (content_features->playspeed_strs[i]);
+
+  return copy;
+}
+
+static void
+dlna_src_content_features_free (GstDlnaSrcHeadResponseContentFeatures *
+    content_features)
+{
+  gint i;
+
+  if (content_features) {
+    g_free (content_features->profile);
+
+    for (i = 0; i < PLAYSPEEDS_MAX_CNT; i++)
+      g_free (content_features->playspeed_strs[i]);
+
+    g_slice_free (GstDlnaSrcHeadResponseContentFeatures, content_features);
+  }
+}
+
+/**
+ * Pack the DLNA flags of content features back into their primary flags
+ * bit representation.
+ */
+static guint32
+dlna_src_content_features_get_flags (const
+    GstDlnaSrcHeadResponseContentFeatures * content_features)
+{
+  guint32 flags = 0;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (CONTENT_FLAGS); i++)
+    if (content_features->flags & CONTENT_FLAGS[i].flag)
+      flags |= CONTENT_FLAGS[i].primary;
+
+  return flags;
+}
+
+/**
+ * Set the DLNA flags of content features from their primary flags bit
+ * representation, expanding them through the content flags table.
+ */
+static void
+dlna_src_content_features_set_flags (GstDlnaSrcHeadResponseContentFeatures *
+    content_features, guint32 flags)
+{
+  guint i;
+
+  content_features->flags &= ~DLNA_SRC_CF_PRIMARY_FLAGS;
+  for (i = 0; i < G_N_ELEMENTS (CONTENT_FLAGS); i++)
+    if (flags & CONTENT_FLAGS[i].primary)
+      content_features->flags |= CONTENT_FLAGS[i].flag;
+}
+
+/**
+ * Attach this element to the HEAD session shared by all instances in the
+ * process, creating it if needed.  The session is asynchronous and runs on a
+ * dedicated worker thread with its own main context, so callers are never
+ * blocked inside libsoup, and its connections are kept alive across
+ * instances so a new URI on a known server reuses a warm connection.
+ *
+ * @param dlna_src	this element
+ *
+ * @return	true if session is open, false otherwise
+ */
 static gboolean
 dlna_src_soup_session_open (GstDlnaSrc * dlna_src)
 {
@@ -2998,25 +9448,245 @@ dlna_src_soup_session_open (GstDlnaSrc * dlna_src)
     GST_DEBUG_OBJECT (dlna_src, "Session is already open");
     return TRUE;
   }
-  /* *TODO* - dlnasrc issue #94 - Old version (need to upgrade to Libsoup 2.44)
-     Creating sync version since need to wait for HEAD responses */
-  dlna_src->soup_session = soup_session_sync_new ();
 
-  if (!dlna_src->soup_session) {
-    GST_ERROR_OBJECT (dlna_src, "Failed to create soup session");
-    return FALSE;
+  G_LOCK (session_pool);
+  if (!session_pool) {
+    session_pool = g_slice_new0 (dlna_src_session_pool);
+    session_pool->context = g_main_context_new ();
+    session_pool->loop = g_main_loop_new (session_pool->context, FALSE);
+    session_pool->session =
+        soup_session_async_new_with_options (SOUP_SESSION_ASYNC_CONTEXT,
+        session_pool->context, SOUP_SESSION_TIMEOUT, HEAD_REQUEST_TIMEOUT_SECS,
+        SOUP_SESSION_MAX_CONNS_PER_HOST, session_max_conns_per_host,
+        SOUP_SESSION_IDLE_TIMEOUT, session_idle_timeout, NULL);
+    if (session_pool->session)
+      session_pool->thread = g_thread_new ("dlnasrc_head",
+          dlna_src_session_pool_thread_func, session_pool);
+
+    if (!session_pool->session || !session_pool->thread) {
+      G_UNLOCK (session_pool);
+      GST_ERROR_OBJECT (dlna_src, "Failed to create shared soup session");
+      dlna_src_session_pool_free (session_pool);
+      session_pool = NULL;
+      return FALSE;
+    }
+    GST_INFO_OBJECT (dlna_src, "Created shared soup session");
+  }
+  session_pool->refcount++;
+  dlna_src->soup_session = session_pool->session;
+  dlna_src->head_context = session_pool->context;
+  G_UNLOCK (session_pool);
+
+  dlna_src->head_closing = FALSE;
+
+  return TRUE;
+}
+
+/**
+ * Cancel this element's outstanding HEAD requests and detach from the shared
+ * session.  The last instance to detach stops the worker and frees it.
+ *
+ * @param dlna_src	this element
+ */
+static void
+dlna_src_soup_session_close (GstDlnaSrc * dlna_src)
+{
+  dlna_src_session_pool *pool = NULL;
+
+  if (!dlna_src->soup_session)
+    return;
+
+  /* Cancel on the worker, callbacks of this instance's requests are called
+   * from there and must all have completed before returning */
+  g_mutex_lock (&dlna_src->head_mutex);
+  dlna_src->head_cancel_done = FALSE;
+  g_mutex_unlock (&dlna_src->head_mutex);
+
+  g_main_context_invoke (dlna_src->head_context, dlna_src_head_cancel_all,
+      dlna_src);
+
+  g_mutex_lock (&dlna_src->head_mutex);
+  while (!dlna_src->head_cancel_done || dlna_src->head_requests_pending)
+    g_cond_wait (&dlna_src->head_cond, &dlna_src->head_mutex);
+  g_mutex_unlock (&dlna_src->head_mutex);
+
+  dlna_src->soup_session = NULL;
+  dlna_src->head_context = NULL;
+
+  G_LOCK (session_pool);
+  if (--session_pool->refcount == 0) {
+    pool = session_pool;
+    session_pool = NULL;
+  }
+  G_UNLOCK (session_pool);
+
+  if (pool) {
+    GST_INFO_OBJECT (dlna_src, "Last user, closing shared soup session");
+    dlna_src_session_pool_free (pool);
+  }
+}
+
+/**
+ * Runs on the HEAD worker context, cancels this element's outstanding HEAD
+ * requests and refuses new ones.
+ */
+static gboolean
+dlna_src_head_cancel_all (gpointer data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) data;
+  GList *requests = NULL;
+  GList *item = NULL;
+  dlna_src_head_request *request = NULL;
+
+  dlna_src->head_closing = TRUE;
+
+  requests = g_list_copy (dlna_src->head_requests);
+  for (item = requests; item; item = item->next) {
+    request = (dlna_src_head_request *) item->data;
+    soup_session_cancel_message (dlna_src->soup_session, request->soup_msg,
+        SOUP_STATUS_CANCELLED);
+  }
+  g_list_free (requests);
+
+  if (dlna_src->prefetch_session) {
+    if (dlna_src->prefetch_msg)
+      soup_session_cancel_message (dlna_src->prefetch_session,
+          dlna_src->prefetch_msg, SOUP_STATUS_CANCELLED);
+    soup_session_abort (dlna_src->prefetch_session);
+    g_object_unref (dlna_src->prefetch_session);
+    dlna_src->prefetch_session = NULL;
+  }
+
+  /* Cancelled from this context, so their callbacks have run on return */
+  if (dlna_src->parallel_session) {
+    g_mutex_lock (&dlna_src->parallel_mutex);
+    dlna_src->parallel_stopping = TRUE;
+    g_cond_broadcast (&dlna_src->parallel_cond);
+    g_mutex_unlock (&dlna_src->parallel_mutex);
+    dlna_src_parallel_cancel (dlna_src);
+    soup_session_abort (dlna_src->parallel_session);
+    g_object_unref (dlna_src->parallel_session);
+    dlna_src->parallel_session = NULL;
+  }
+
+  if (dlna_src->preview_session) {
+    requests = g_list_copy (dlna_src->preview_msgs);
+    for (item = requests; item; item = item->next)
+      soup_session_cancel_message (dlna_src->preview_session,
+          (SoupMessage *) item->data, SOUP_STATUS_CANCELLED);
+    g_list_free (requests);
+    soup_session_abort (dlna_src->preview_session);
+    g_object_unref (dlna_src->preview_session);
+    dlna_src->preview_session = NULL;
+  }
+
+  /* Requests which joined a cancelled one have completed along with it */
+  g_hash_table_remove_all (dlna_src->head_flights);
+
+  g_mutex_lock (&dlna_src->head_mutex);
+  dlna_src->head_cancel_done = TRUE;
+  g_cond_broadcast (&dlna_src->head_cond);
+  g_mutex_unlock (&dlna_src->head_mutex);
+
+  return FALSE;
+}
+
+/**
+ * Stop the worker of a shared session which is no longer used and free it.
+ */
+static void
+dlna_src_session_pool_free (dlna_src_session_pool * pool)
+{
+  if (pool->thread) {
+    g_main_context_invoke (pool->context, dlna_src_session_pool_thread_stop,
+        pool);
+    g_thread_join (pool->thread);
+  }
+
+  if (pool->session)
+    g_object_unref (pool->session);
+
+  g_main_loop_unref (pool->loop);
+  g_main_context_unref (pool->context);
+  g_slice_free (dlna_src_session_pool, pool);
+}
+
+/**
+ * Main function of the HEAD worker thread.
+ */
+static gpointer
+dlna_src_session_pool_thread_func (gpointer data)
+{
+  dlna_src_session_pool *pool = (dlna_src_session_pool *) data;
+
+  GST_INFO ("HEAD worker started");
+
+  g_main_context_push_thread_default (pool->context);
+  g_main_loop_run (pool->loop);
+  g_main_context_pop_thread_default (pool->context);
+
+  GST_INFO ("HEAD worker exiting");
+
+  return NULL;
+}
+
+/**
+ * Runs on the HEAD worker context, closes idle connections and stops the
+ * worker's loop.
+ */
+static gboolean
+dlna_src_session_pool_thread_stop (gpointer data)
+{
+  dlna_src_session_pool *pool = (dlna_src_session_pool *) data;
+
+  soup_session_abort (pool->session);
+  g_main_loop_quit (pool->loop);
+
+  return FALSE;
+}
+
+/**
+ * Apply the connection limits set through the properties to the shared
+ * session, for all instances in the process.  A session already created is
+ * changed from its worker, which is the only thread using it.
+ *
+ * @param dlna_src	element whose property was set
+ */
+static void
+dlna_src_session_pool_configure (GstDlnaSrc * dlna_src)
+{
+  GMainContext *context = NULL;
+
+  G_LOCK (session_pool);
+  GST_INFO_OBJECT (dlna_src,
+      "Shared soup session max conns per host: %u, idle timeout: %u",
+      session_max_conns_per_host, session_idle_timeout);
+  if (session_pool)
+    context = g_main_context_ref (session_pool->context);
+  G_UNLOCK (session_pool);
+
+  if (context) {
+    g_main_context_invoke (context, dlna_src_session_pool_apply, NULL);
+    g_main_context_unref (context);
   }
-  return TRUE;
 }
 
-static void
-dlna_src_soup_session_close (GstDlnaSrc * dlna_src)
+/**
+ * Runs on the HEAD worker, applies the connection limits to the session.  A
+ * session which replaced the one of this worker is left alone, it was
+ * created with the current limits.
+ */
+static gboolean
+dlna_src_session_pool_apply (gpointer data)
 {
-  if (dlna_src->soup_session) {
-    soup_session_abort (dlna_src->soup_session);
-    g_object_unref (dlna_src->soup_session);
-    dlna_src->soup_session = NULL;
-  }
+  G_LOCK (session_pool);
+  if (session_pool && g_main_context_is_owner (session_pool->context))
+    g_object_set (session_pool->session,
+        SOUP_SESSION_MAX_CONNS_PER_HOST, session_max_conns_per_host,
+        SOUP_SESSION_IDLE_TIMEOUT, session_idle_timeout, NULL);
+  G_UNLOCK (session_pool);
+
+  return FALSE;
 }
 
 static void
@@ -3025,12 +9695,13 @@ dlna_src_soup_log_msg (GstDlnaSrc * dlna_src, SoupMessage *soup_msg)
   const gchar *header_name, *header_value;
   SoupMessageHeadersIter iter;
   GString *log_str = g_string_sized_new (256);
+  gchar *uri_str;
 
   if (soup_msg) {
+    uri_str = soup_uri_to_string (soup_message_get_uri (soup_msg), TRUE);
     g_string_append_printf (log_str, "\nREQUEST: %s %s HTTP/1.%d\n",
-        soup_msg->method,
-        soup_uri_to_string (soup_message_get_uri (soup_msg), TRUE),
-        soup_message_get_http_version (soup_msg));
+        soup_msg->method, uri_str, soup_message_get_http_version (soup_msg));
+    g_free (uri_str);
 
     log_str = g_string_append (log_str, "REQUEST HEADERS:\n");
     soup_message_headers_iter_init (&iter, soup_msg->request_headers);
@@ -3085,21 +9756,157 @@ dlna_src_head_response_parse (GstDlnaSrc * dlna_src, SoupMessage *soup_msg,
     if (idx != -1)
       field_values[idx] = header_value;
     else
-      GST_INFO_OBJECT (dlna_src, "No Idx found for Field:%s", header_name);
+      GST_LOG_OBJECT (dlna_src, "No Idx found for Field:%s", header_name);
   }
 
-  
-  /* Parse value from each field header string */
+  dlna_src_head_response_assign_fields (dlna_src, head_response,
+      field_values);
+
+  return TRUE;
+}
+
+/**
+ * Parse the value of each field header found in a response.
+ *
+ * @param	dlna_src	this element instance
+ * @param	head_response	struct to store parsed values into
+ * @param	field_values	value of each field header, NULL if not found
+ */
+static void
+dlna_src_head_response_assign_fields (GstDlnaSrc * dlna_src,
+    GstDlnaSrcHeadResponse * head_response, const gchar ** field_values)
+{
+  int i = 0;
+
   for (i = 0; i < HEAD_RESPONSE_HEADERS_CNT; i++) {
     if (field_values[i] != NULL) {
       dlna_src_head_response_assign_field_value (dlna_src, head_response, i,
           field_values[i]);
     }
   }
-  
-  return TRUE;
 }
 
+#if GST_CHECK_VERSION(1,0,0)
+/**
+ * Learn about the content from the response to the GET request of
+ * souphttpsrc, which carries the same DLNA headers as HEAD responses.  The
+ * time and byte ranges of the response describe what was requested, so
+ * they only feed the seek index.  The available seek range of live
+ * content replaces the last known one, so that after a seek the new range
+ * is known without a HEAD request.  Runs on the streaming thread of
+ * souphttpsrc.
+ *
+ * @param	dlna_src	this element instance
+ * @param	headers		response headers posted by souphttpsrc
+ */
+static void
+dlna_src_harvest_response_headers (GstDlnaSrc * dlna_src,
+    const GstStructure * headers)
+{
+  GstDlnaSrcHeadResponse *response = NULL;
+  GstDlnaSrcHeadResponse *server_info = NULL;
+  const gchar *field_values[HEAD_RESPONSE_HEADERS_CNT];
+  const gchar *name = NULL;
+  const GValue *value = NULL;
+  GstDlnaSrcTraceEntry trace;
+  gboolean updated = FALSE;
+  gint idx;
+  gint i;
+
+  if (!dlna_src_head_response_init_struct (dlna_src, &response))
+    return;
+
+  for (i = 0; i < HEAD_RESPONSE_HEADERS_CNT; i++)
+    field_values[i] = NULL;
+
+  for (i = 0; i < gst_structure_n_fields (headers); i++) {
+    name = gst_structure_nth_field_name (headers, i);
+    value = gst_structure_get_value (headers, name);
+    if (!G_VALUE_HOLDS_STRING (value))
+      continue;
+
+    idx = dlna_src_head_response_get_field_idx (dlna_src, name);
+    if (idx != -1)
+      field_values[idx] = g_value_get_string (value);
+  }
+
+  g_mutex_lock (&dlna_src->parse_msg_mutex);
+  dlna_src_head_response_assign_fields (dlna_src, response, field_values);
+
+  memset (&trace, 0, sizeof (trace));
+  trace.kind = DLNA_SRC_TRACE_GET;
+  trace.byte_start = response->content_range_start;
+  trace.byte_end = response->content_range_end;
+  trace.byte_total = response->content_range_total ?
+      response->content_range_total : response->content_length;
+  if (response->available_seek_npt_end_str) {
+    trace.flags |= TRACE_FLAG_AVAILABLE_RANGE;
+    trace.npt_start = response->available_seek_npt_start;
+    trace.npt_end = response->available_seek_npt_end;
+  }
+  dlna_src_trace_record (dlna_src, &trace);
+
+  server_info = dlna_src->server_info;
+  if (server_info && response->available_seek_npt_end_str) {
+    GST_DEBUG_OBJECT (dlna_src,
+        "Taking available seek range from GET response");
+    g_free (server_info->available_seek_npt_start_str);
+    server_info->available_seek_npt_start_str =
+        g_strdup (response->available_seek_npt_start_str);
+    g_free (server_info->available_seek_npt_end_str);
+    server_info->available_seek_npt_end_str =
+        g_strdup (response->available_seek_npt_end_str);
+    server_info->available_seek_npt_start = response->available_seek_npt_start;
+    server_info->available_seek_npt_end = response->available_seek_npt_end;
+    server_info->available_seek_start = response->available_seek_start;
+    server_info->available_seek_end = response->available_seek_end;
+    server_info->available_seek_cleartext_start =
+        response->available_seek_cleartext_start;
+    server_info->available_seek_cleartext_end =
+        response->available_seek_cleartext_end;
+    if (response->start_pts != response->end_pts) {
+      server_info->start_pts = response->start_pts;
+      server_info->end_pts = response->end_pts;
+    }
+    updated = dlna_src_update_overall_info (dlna_src, server_info);
+  }
+  g_mutex_unlock (&dlna_src->parse_msg_mutex);
+
+  dlna_src_head_response_free_struct (dlna_src, response);
+
+  /* TSB boundaries are tracked on the HEAD worker */
+  if (updated && dlna_src->is_live && dlna_src->head_context) {
+    g_mutex_lock (&dlna_src->head_mutex);
+    dlna_src->head_requests_pending++;
+    g_mutex_unlock (&dlna_src->head_mutex);
+
+    g_main_context_invoke (dlna_src->head_context,
+        dlna_src_harvest_boundary_sync, dlna_src);
+  }
+}
+
+/**
+ * Runs on the HEAD worker, restarts the TSB window estimate from a range
+ * taken from a GET response.
+ */
+static gboolean
+dlna_src_harvest_boundary_sync (gpointer data)
+{
+  GstDlnaSrc *dlna_src = (GstDlnaSrc *) data;
+
+  if (!dlna_src->head_closing)
+    dlna_src_boundary_sync (dlna_src);
+
+  /* Counted like a HEAD request so the session is not closed under it */
+  g_mutex_lock (&dlna_src->head_mutex);
+  dlna_src->head_requests_pending--;
+  g_cond_broadcast (&dlna_src->head_cond);
+  g_mutex_unlock (&dlna_src->head_mutex);
+
+  return FALSE;
+}
+#endif
+
 /**
  * Initialize structure to store HEAD Response
  *
@@ -3213,8 +10020,6 @@ dlna_src_head_response_init_struct (GstDlnaSrc * dlna_src,
 
   /* DLNA.ORG_OP */
   head_response->content_features->operations_idx = HEADER_INDEX_OP;
-  head_response->content_features->op_time_seek_supported = FALSE;
-  head_response->content_features->op_range_supported = FALSE;
 
   /* DLNA.ORG_PS */
   head_response->content_features->playspeeds_idx = HEADER_INDEX_PS;
@@ -3224,21 +10029,7 @@ dlna_src_head_response_init_struct (GstDlnaSrc * dlna_src,
 
   /* DLNA.ORG_FLAGS */
   head_response->content_features->flags_idx = HEADER_INDEX_FLAGS;
-  head_response->content_features->flag_sender_paced_set = FALSE;
-  head_response->content_features->flag_limited_time_seek_set = FALSE;
-  head_response->content_features->flag_limited_byte_seek_set = FALSE;
-  head_response->content_features->flag_play_container_set = FALSE;
-  head_response->content_features->flag_so_increasing_set = FALSE;
-  head_response->content_features->flag_sn_increasing_set = FALSE;
-  head_response->content_features->flag_rtsp_pause_set = FALSE;
-  head_response->content_features->flag_streaming_mode_set = FALSE;
-  head_response->content_features->flag_interactive_mode_set = FALSE;
-  head_response->content_features->flag_background_mode_set = FALSE;
-  head_response->content_features->flag_stalling_set = FALSE;
-  head_response->content_features->flag_dlna_v15_set = FALSE;
-  head_response->content_features->flag_link_protected_set = FALSE;
-  head_response->content_features->flag_full_clear_text_set = FALSE;
-  head_response->content_features->flag_limited_clear_text_set = FALSE;
+  head_response->content_features->flags = 0;
 
   /* DLNA.ORG_CI */
   head_response->content_features->conversion_idx = HEADER_INDEX_CI;
@@ -3266,23 +10057,185 @@ dlna_src_head_response_get_field_idx (GstDlnaSrc * dlna_src,
     const gchar * field_str)
 {
   gint idx = -1;
-  int i = 0;
-  gchar * tmp_ascii=g_ascii_strup (field_str, strlen (field_str));
-  
+
   GST_LOG_OBJECT (dlna_src, "Determine associated HEAD response field: %s",
       field_str);
 
-  for (i = 0; i < HEAD_RESPONSE_HEADERS_CNT; i++) {
-    if (strstr (tmp_ascii,
-            HEAD_RESPONSE_HEADERS[i]) != NULL) {
-      idx = i;
+  if (g_ascii_strncasecmp (field_str, HEAD_RESPONSE_HEADERS[HEADER_INDEX_HTTP],
+          strlen (HEAD_RESPONSE_HEADERS[HEADER_INDEX_HTTP])) == 0)
+    return HEADER_INDEX_HTTP;
+
+  /* Length and first character single out at most one candidate, which is
+   * then compared in full, so no copy of the name is needed */
+  switch (strlen (field_str)) {
+    case 4:
+      if (g_ascii_toupper (field_str[0]) == 'D')
+        idx = HEADER_INDEX_DATE;
+      else
+        idx = HEADER_INDEX_VARY;
+      break;
+    case 6:
+      if (g_ascii_toupper (field_str[0]) == 'P')
+        idx = HEADER_INDEX_PRAGMA;
+      else
+        idx = HEADER_INDEX_SERVER;
+      break;
+    case 12:
+      idx = HEADER_INDEX_CONTENT_TYPE;
+      break;
+    case 13:
+      if (g_ascii_toupper (field_str[0]) == 'A')
+        idx = HEADER_INDEX_ACCEPT_RANGES;
+      else if (g_ascii_toupper (field_str[1]) == 'A')
+        idx = HEADER_INDEX_CACHE_CONTROL;
+      else
+        idx = HEADER_INDEX_CONTENT_RANGE;
+      break;
+    case 14:
+      idx = HEADER_INDEX_CONTENT_LENGTH;
+      break;
+    case 17:
+      idx = HEADER_INDEX_TRANSFER_ENCODING;
+      break;
+    case 21:
+      idx = HEADER_INDEX_TRANSFERMODE;
+      break;
+    case 22:
+      if (g_ascii_toupper (field_str[0]) == 'C')
+        idx = HEADER_INDEX_DTCP_RANGE;
+      else
+        idx = HEADER_INDEX_TIMESEEKRANGE;
+      break;
+    case 24:
+      idx = HEADER_INDEX_CONTENTFEATURES;
+      break;
+    case 27:
+      idx = HEADER_INDEX_AVAILABLE_RANGE;
+      break;
+    case 31:
+      idx = HEADER_INDEX_PRESENTATIONTIMESTAMPS;
+      break;
+    default:
       break;
-    }
   }
-  g_free(tmp_ascii);
+
+  if ((idx != -1) &&
+      (g_ascii_strcasecmp (field_str, HEAD_RESPONSE_HEADERS[idx]) != 0))
+    idx = -1;
+
   return idx;
 }
 
+/**
+ * Case insensitive search for a sub field name, such as "BYTES", in a HEAD
+ * response field value.  Only matches at the start of a word so a name is not
+ * found inside a longer one, e.g. "BYTES" in "CLEARTEXTBYTES".
+ *
+ * @param   str     HEAD response field value
+ * @param   token   upper case sub field name to look for
+ *
+ * @return  pointer to sub field name within str, NULL if not found
+ */
+static const gchar *
+dlna_src_find_token (const gchar * str, const gchar * token)
+{
+  const gchar *ptr;
+  gsize len = strlen (token);
+
+  for (ptr = str; *ptr; ptr++) {
+    if ((g_ascii_toupper (*ptr) == token[0]) &&
+        ((ptr == str) || !g_ascii_isalnum (*(ptr - 1))) &&
+        (g_ascii_strncasecmp (ptr, token, len) == 0))
+      return ptr;
+  }
+
+  return NULL;
+}
+
+/**
+ * Scan an unsigned decimal number, skipping leading spaces.
+ *
+ * @param   str     position in string to scan from, advanced past the number
+ * @param   value   returns the number scanned
+ *
+ * @return  TRUE if at least one digit was scanned and the value did not
+ *          overflow, FALSE otherwise
+ */
+static gboolean
+dlna_src_scan_guint64 (const gchar ** str, guint64 * value)
+{
+  const gchar *ptr = *str;
+  guint64 result = 0;
+  guint digit;
+
+  while (*ptr == ' ')
+    ptr++;
+
+  if (!g_ascii_isdigit (*ptr))
+    return FALSE;
+
+  for (; g_ascii_isdigit (*ptr); ptr++) {
+    digit = *ptr - '0';
+    if (result > (G_MAXUINT64 - digit) / 10)
+      return FALSE;
+    result = result * 10 + digit;
+  }
+
+  *str = ptr;
+  *value = result;
+  return TRUE;
+}
+
+/**
+ * Scan an unsigned hexadecimal 32 bit number, skipping leading spaces.
+ *
+ * @param   str     position in string to scan from, advanced past the number
+ * @param   value   returns the number scanned
+ *
+ * @return  TRUE if at least one digit was scanned and the value did not
+ *          overflow, FALSE otherwise
+ */
+static gboolean
+dlna_src_scan_hex32 (const gchar ** str, guint32 * value)
+{
+  const gchar *ptr = *str;
+  guint32 result = 0;
+
+  while (*ptr == ' ')
+    ptr++;
+
+  if (!g_ascii_isxdigit (*ptr))
+    return FALSE;
+
+  for (; g_ascii_isxdigit (*ptr); ptr++) {
+    if (result > (G_MAXUINT32 >> 4))
+      return FALSE;
+    result = (result << 4) | g_ascii_xdigit_value (*ptr);
+  }
+
+  *str = ptr;
+  *value = result;
+  return TRUE;
+}
+
+/**
+ * Store a span of a HEAD response field value as a string, only allocating
+ * when it differs from the string already stored.
+ *
+ * @param   str     stored string, replaced if different
+ * @param   start   start of span
+ * @param   len     length of span
+ */
+static void
+dlna_src_assign_span (gchar ** str, const gchar * start, gsize len)
+{
+  if (*str && (strncmp (*str, start, len) == 0) && ((*str)[len] == '\0'))
+    return;
+
+  g_free (*str);
+  *str = g_strndup (start, len);
+}
+
 /**
  * Initialize associated value in HEAD response struct
  *
@@ -3302,7 +10255,7 @@ dlna_src_head_response_assign_field_value (GstDlnaSrc * dlna_src,
   gint int_value = 0;
   gint ret_code = 0;
   guint64 guint64_value = 0;
-  gchar * tmp_ascii=NULL;
+  const gchar *value_ptr = NULL;
 
   GST_LOG_OBJECT (dlna_src,
       "Store value received in HEAD response field for field %d - %s, value: %s",
@@ -3330,11 +10283,11 @@ dlna_src_head_response_assign_field_value (GstDlnaSrc * dlna_src,
       break;
 
     case HEADER_INDEX_CONTENT_LENGTH:
-      if ((ret_code =
-              sscanf (field_value, "%" G_GUINT64_FORMAT, &guint64_value)) != 1)
+      value_ptr = field_value;
+      if (!dlna_src_scan_guint64 (&value_ptr, &guint64_value))
         GST_WARNING_OBJECT (dlna_src,
-            "Problems parsing Content Length from HEAD response field header %s, value: %s, retcode: %d",
-            HEAD_RESPONSE_HEADERS[idx], field_value, ret_code);
+            "Problems parsing Content Length from HEAD response field header %s, value: %s",
+            HEAD_RESPONSE_HEADERS[idx], field_value);
       else
         head_response->content_length = guint64_value;
       break;
@@ -3342,10 +10295,8 @@ dlna_src_head_response_assign_field_value (GstDlnaSrc * dlna_src,
     case HEADER_INDEX_ACCEPT_RANGES:
       g_free (head_response->accept_ranges);
       head_response->accept_ranges = g_strdup (field_value);
-      tmp_ascii=g_ascii_strup (head_response->accept_ranges,strlen (head_response->accept_ranges));
-      if (strstr (tmp_ascii, ACCEPT_RANGES_BYTES))
+      if (dlna_src_find_token (field_value, ACCEPT_RANGES_BYTES))
         head_response->accept_byte_ranges = TRUE;
-      g_free(tmp_ascii);
       break;
 
     case HEADER_INDEX_CONTENT_RANGE:
@@ -3462,7 +10413,6 @@ dlna_src_head_response_parse_time_seek (GstDlnaSrc * dlna_src,
     GstDlnaSrcHeadResponse * head_response, gint idx, const gchar * field_str)
 {
    gboolean ret=TRUE;
-   gchar * tmp_ascii=NULL;
   /* Extract start and end NPT from TimeSeekRange header */
   if (!dlna_src_parse_npt_range (dlna_src, field_str,
           &head_response->time_seek_npt_start_str,
@@ -3473,17 +10423,20 @@ dlna_src_head_response_parse_time_seek (GstDlnaSrc * dlna_src,
           &head_response->time_seek_npt_duration))
     /* Just return, errors which have been logged already */
     return FALSE;
-    tmp_ascii=g_ascii_strup (field_str, strlen (field_str));
   /* Extract start and end bytes from TimeSeekRange header if present */
-  if (strstr (tmp_ascii,
-          RANGE_HEADERS[HEADER_INDEX_BYTES])) {
+  if (dlna_src_find_token (field_str, RANGE_HEADERS[HEADER_INDEX_BYTES])) {
     if (!dlna_src_parse_byte_range (dlna_src, field_str, HEADER_INDEX_BYTES,
             &head_response->time_byte_seek_start,
             &head_response->time_byte_seek_end,
             &head_response->time_byte_seek_total))
       ret= FALSE;
+    else {
+      dlna_src_seek_index_add (dlna_src, head_response->time_seek_npt_start,
+          head_response->time_byte_seek_start);
+      dlna_src_seek_index_add (dlna_src, head_response->time_seek_npt_end,
+          head_response->time_byte_seek_end);
+    }
   }
-  g_free(tmp_ascii);
   return ret;
 }
 
@@ -3511,7 +10464,6 @@ dlna_src_head_response_parse_available_range (GstDlnaSrc * dlna_src,
     GstDlnaSrcHeadResponse * head_response, gint idx, const gchar * field_str)
 {  
    gboolean ret=TRUE;
-   gchar * tmp_ascii=NULL;
   /* Extract start and end NPT from availableSeekRange header */
   if (!dlna_src_parse_npt_range (dlna_src, field_str,
           &head_response->available_seek_npt_start_str,
@@ -3521,22 +10473,29 @@ dlna_src_head_response_parse_available_range (GstDlnaSrc * dlna_src,
           &head_response->available_seek_npt_end, NULL))
     /* Just return, errors which have been logged already */
     return FALSE;
+
+  /* Positions which slid out of the time shift buffer are of no more use */
+  dlna_src_seek_index_prune (dlna_src, head_response->available_seek_npt_start);
     
-  tmp_ascii=g_ascii_strup (field_str, strlen (field_str));
   /* Extract start and end bytes from availableSeekRange header if present*/
-  if (strstr (tmp_ascii,
-          RANGE_HEADERS[HEADER_INDEX_BYTES])) {
+  if (dlna_src_find_token (field_str, RANGE_HEADERS[HEADER_INDEX_BYTES])) {
   if (!dlna_src_parse_byte_range (dlna_src, field_str,
           HEADER_INDEX_BYTES, &head_response->available_seek_start,
           &head_response->available_seek_end, NULL))
     /* Just return, errors which have been logged already */
     ret=FALSE;
+  else {
+    dlna_src_seek_index_add (dlna_src, head_response->available_seek_npt_start,
+        head_response->available_seek_start);
+    dlna_src_seek_index_add (dlna_src, head_response->available_seek_npt_end,
+        head_response->available_seek_end);
+  }
   }
   
   if (ret==TRUE)
   {
       /* Extract start and end bytes from availableSeekRange header using clear text bytes if present */
-      if (strstr (tmp_ascii,
+      if (dlna_src_find_token (field_str,
               RANGE_HEADERS[HEADER_INDEX_CLEAR_TEXT])) {
       if (!dlna_src_parse_byte_range (dlna_src, field_str,
               HEADER_INDEX_CLEAR_TEXT,
@@ -3546,7 +10505,6 @@ dlna_src_head_response_parse_available_range (GstDlnaSrc * dlna_src,
         ret=FALSE;
       }
   }
-  g_free(tmp_ascii);
   return ret;
 }
 
@@ -3575,74 +10533,62 @@ dlna_src_parse_byte_range (GstDlnaSrc * dlna_src,
     const gchar * field_str, gint header_index, guint64 * start_byte,
     guint64 * end_byte, guint64 * total_bytes)
 {
-  gchar *header = NULL;
-  gchar *header_value = NULL;
+  const gchar *header = NULL;
+  const gchar *header_value = NULL;
 
-  gint ret_code = 0;
   guint64 ullong1 = 0;
   guint64 ullong2 = 0;
   guint64 ullong3 = 0;
-  gboolean ret=TRUE;
-  gchar * tmp_ascii=g_ascii_strup (field_str, strlen (field_str));
-  /* Extract BYTES portion of header value */
-  header =
-      strstr (tmp_ascii,
-      RANGE_HEADERS[header_index]);
+  gboolean ret = FALSE;
 
-  if (header)
-    header_value = strstr (header, "=");
-  if (header && !header_value)
-    header_value = strstr (header, " ");
-  if (header_value)
-    header_value++;
-  else {
+  /* Extract BYTES portion of header value, either "bytes=" or "bytes " */
+  header = dlna_src_find_token (field_str, RANGE_HEADERS[header_index]);
+  if (header) {
+    header_value = header + strlen (RANGE_HEADERS[header_index]);
+    while (*header_value == ' ')
+      header_value++;
+    if (*header_value == '=')
+      header_value++;
+    else if (header_value == header + strlen (RANGE_HEADERS[header_index]))
+      header_value = NULL;
+  }
+  if (!header_value) {
     GST_WARNING_OBJECT (dlna_src,
         "Bytes not included in header from HEAD response field header value: %s",
         field_str);
-    ret=FALSE;
+    return FALSE;
   }
-  if (ret==TRUE)
-  {
-      /* Determine if byte string includes total which is not an * */
-      if (strstr (header_value, "/") && !strstr (header_value, "*")) {
-        /* Extract start and end and total BYTES */
-        if ((ret_code =
-                sscanf (header_value,
-                    "%" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT "/%"
-                    G_GUINT64_FORMAT, &ullong1, &ullong2, &ullong3)) != 3) {
-          GST_WARNING_OBJECT (dlna_src,
-              "Problems parsing BYTES from HEAD response field header %s, value: %s, retcode: %d, ullong: %"
-              G_GUINT64_FORMAT ", %" G_GUINT64_FORMAT
-              ", %" G_GUINT64_FORMAT,
-              field_str, header_value, ret_code, ullong1, ullong2, ullong3);
-          ret=FALSE;
-        }
-      } else {
-        /* Extract start and end (there is no total) BYTES */
-        if ((ret_code =
-                sscanf (header_value,
-                    "%" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT, &ullong1,
-                    &ullong2)) != 2) {
-          GST_WARNING_OBJECT (dlna_src,
-              "Problems parsing BYTES from HEAD response field header %s, value: %s, retcode: %d, ullong: %"
-              G_GUINT64_FORMAT ", %" G_GUINT64_FORMAT, field_str, header_value,
-              ret_code, ullong1, ullong2);
-          ret=FALSE;
-        }
-      }
-      
-      if (ret==TRUE)
-      {
-          if (start_byte)
-            *start_byte = ullong1;
-          if (end_byte)
-            *end_byte = ullong2;
-          if (total_bytes)
-            *total_bytes = ullong3;
-      }
+
+  /* Extract start and end BYTES */
+  ret = dlna_src_scan_guint64 (&header_value, &ullong1) &&
+      (*header_value == '-');
+  if (ret) {
+    header_value++;
+    ret = dlna_src_scan_guint64 (&header_value, &ullong2);
   }
-  g_free(tmp_ascii);
-  return ret;
+
+  /* Extract total BYTES if included and not a * */
+  if (ret && (*header_value == '/')) {
+    header_value++;
+    if (*header_value != '*')
+      ret = dlna_src_scan_guint64 (&header_value, &ullong3);
+  }
+
+  if (!ret) {
+    GST_WARNING_OBJECT (dlna_src,
+        "Problems parsing BYTES from HEAD response field header %s, value: %s",
+        field_str, header);
+    return FALSE;
+  }
+
+  if (start_byte)
+    *start_byte = ullong1;
+  if (end_byte)
+    *end_byte = ullong2;
+  if (total_bytes)
+    *total_bytes = ullong3;
+
+  return TRUE;
 }
 
 /**
@@ -3668,81 +10614,76 @@ dlna_src_parse_npt_range (GstDlnaSrc * dlna_src, const gchar * field_str,
     gchar ** start_str, gchar ** stop_str, gchar ** total_str,
     guint64 * start, guint64 * stop, guint64 * total)
 {
-  gchar *header = NULL;
-  gchar *header_value = NULL;
-
-  gint ret_code = 0;
-  gchar tmp1[32] = { 0 };
-  gchar tmp2[32] = { 0 };
-  gchar tmp3[32] = { 0 };
-  gboolean ret=TRUE;
-  gchar * tmp_ascii=g_ascii_strup (field_str, strlen (field_str));
+  const gchar *header = NULL;
+  const gchar *header_value = NULL;
+  gsize len = 0;
 
   /* Extract NPT portion of header value */
-  header =
-      strstr (tmp_ascii,
-      RANGE_HEADERS[HEADER_INDEX_NPT]);
+  header = dlna_src_find_token (field_str, RANGE_HEADERS[HEADER_INDEX_NPT]);
   if (header)
-    header_value = strstr (header, "=");
+    header_value = strchr (header, '=');
   if (header_value)
     header_value++;
   else {
     GST_WARNING_OBJECT (dlna_src,
         "Problems parsing npt from HEAD response field header value: %s",
         field_str);
-    ret=FALSE;
+    return FALSE;
   }
-  if (ret==TRUE)
-  {
-      /* Determine if npt string includes total */
-      if (strstr (header_value, "/")) {
-        /* Extract start and end and total NPT */
-        if ((ret_code =
-                sscanf (header_value, "%31[^-]-%31[^/]/%31s %*s", tmp1, tmp2,
-                    tmp3)) != 3) {
-          GST_WARNING_OBJECT (dlna_src,
-              "Problems parsing NPT from HEAD response field header %s, value: %s, retcode: %d, tmp: %s, %s, %s",
-              field_str, header_value, ret_code, tmp1, tmp2, tmp3);
-          ret=FALSE;
-        }
-        else
-        {
-            g_free (*total_str);
-            *total_str = g_strdup (tmp3);
-            if (strcmp (*total_str, "*") != 0)
-              if (!dlna_src_npt_to_nanos (dlna_src, *total_str, total))
-                ret=FALSE;
-        }
-      } else {
-        /* Extract start and end (there is no total) NPT */
-        if ((ret_code = sscanf (header_value, "%31[^-]-%31s %*s", tmp1, tmp2)) != 2) {
-          GST_WARNING_OBJECT (dlna_src,
-              "Problems parsing NPT from HEAD response field header %s, value: %s, retcode: %d, tmp: %s, %s",
-              field_str, header_value, ret_code, tmp1, tmp2);
-          ret=FALSE;
-        }
-      }
-      if (ret==TRUE)
-      {
-          g_free (*start_str);
-          *start_str = g_strdup (tmp1);
-          if (!dlna_src_npt_to_nanos (dlna_src, *start_str, start))
-            ret=FALSE;
-      }
-      if (ret==TRUE)
-      {
-          g_free (*stop_str);
-          *stop_str = g_strdup (tmp2);
-          if (!dlna_src_npt_to_nanos (dlna_src, *stop_str, stop))
-            ret=FALSE;
-      }
+
+  /* Extract start, end and total (if included) NPT, strings are only
+   * reallocated when their value changed since the last response */
+  while (*header_value == ' ')
+    header_value++;
+  len = strcspn (header_value, "- ");
+  if ((len == 0) || (header_value[len] != '-')) {
+    GST_WARNING_OBJECT (dlna_src,
+        "Problems parsing NPT from HEAD response field header %s, value: %s",
+        field_str, header_value);
+    return FALSE;
   }
-  g_free(tmp_ascii);
-  return ret;
+  dlna_src_assign_span (start_str, header_value, len);
+  header_value += len + 1;
+
+  len = strcspn (header_value, "/ ");
+  if (len == 0) {
+    GST_WARNING_OBJECT (dlna_src,
+        "Problems parsing NPT from HEAD response field header %s, value: %s",
+        field_str, header_value);
+    return FALSE;
+  }
+  dlna_src_assign_span (stop_str, header_value, len);
+  header_value += len;
+
+  if ((*header_value == '/') && total_str) {
+    header_value++;
+    len = strcspn (header_value, " ");
+    if (len == 0) {
+      GST_WARNING_OBJECT (dlna_src,
+          "Problems parsing NPT from HEAD response field header %s, value: %s",
+          field_str, header_value);
+      return FALSE;
+    }
+    dlna_src_assign_span (total_str, header_value, len);
+    if (strcmp (*total_str, "*") != 0)
+      if (!dlna_src_npt_to_nanos (dlna_src, *total_str, total))
+        return FALSE;
+  }
+
+  if (!dlna_src_npt_to_nanos (dlna_src, *start_str, start))
+    return FALSE;
+
+  if (!dlna_src_npt_to_nanos (dlna_src, *stop_str, stop))
+    return FALSE;
+
+  return TRUE;
 }
 
 /**
- * Extract values from content features header in HEAD Response
+ * Extract values from content features header in HEAD Response.  The value
+ * is walked once, sub fields separated by ";" are matched by name in place
+ * and handed to their parsers as spans of the value, nothing is copied
+ * unless it is stored.
  *
  * @param	dlna_src	this element
  * @param	idx			index into array of header strings
@@ -3754,111 +10695,82 @@ static gboolean
 dlna_src_head_response_parse_content_features (GstDlnaSrc * dlna_src,
     GstDlnaSrcHeadResponse * head_response, gint idx, const gchar * field_value)
 {
+  /* Sub fields of CONTENTFEATURES.DLNA.ORG by HEADER_INDEX_*, parsed in
+     that order once all are found */
+  const gchar *values[G_N_ELEMENTS (CONTENT_FEATURES_HEADERS)] = { NULL };
+  gsize lens[G_N_ELEMENTS (CONTENT_FEATURES_HEADERS)] = { 0 };
+  const gchar *ptr = field_value;
+  const gchar *field;
+  const gchar *field_end;
+  const gchar *eq;
+  gsize name_len;
+  guint i;
+
   GST_LOG_OBJECT (dlna_src, "Called with field str: %s", field_value);
 
-  /* Split CONTENTFEATURES.DLNA.ORG into following sub-fields using ";" as deliminator
-     "DLNA.ORG_PN"
-     "DLNA.ORG_OP"
-     "DLNA.ORG_PS"
-     "DLNA.ORG_FLAGS"
-     "DLNA.ORG_CI"
-   */
-  gchar *pn_str = NULL;
-  gchar *op_str = NULL;
-  gchar *ps_str = NULL;
-  gchar *flags_str = NULL;
-  gchar *ci_str = NULL;
-  gchar **tokens = NULL;
-  gchar *tmp_str = NULL;
-  gchar *tmp_ascii = NULL;
-  tokens = g_strsplit (field_value, ";", 0);
-  gchar **ptr;
-  for (ptr = tokens; *ptr; ptr++) {
-    if (strlen (*ptr) > 0) {
-          tmp_ascii=g_ascii_strup (*ptr, strlen (*ptr));
-      /* DLNA.ORG_PN */
-      if ((tmp_str =
-              strstr (tmp_ascii,
-                  CONTENT_FEATURES_HEADERS[HEADER_INDEX_PN])) != NULL) {
-        GST_LOG_OBJECT (dlna_src, "Found field: %s",
-            CONTENT_FEATURES_HEADERS[HEADER_INDEX_PN]);
-        pn_str = *ptr;
-      }
-      /* DLNA.ORG_OP */
-      else if ((tmp_str =
-              strstr (tmp_ascii,
-                  CONTENT_FEATURES_HEADERS[HEADER_INDEX_OP])) != NULL) {
-        GST_LOG_OBJECT (dlna_src, "Found field: %s",
-            CONTENT_FEATURES_HEADERS[HEADER_INDEX_OP]);
-        op_str = *ptr;
-      }
-      /* DLNA.ORG_PS */
-      else if ((tmp_str =
-              strstr (tmp_ascii,
-                  CONTENT_FEATURES_HEADERS[HEADER_INDEX_PS])) != NULL) {
-        GST_LOG_OBJECT (dlna_src, "Found field: %s",
-            CONTENT_FEATURES_HEADERS[HEADER_INDEX_PS]);
-        ps_str = *ptr;
-      }
-      /* DLNA.ORG_FLAGS */
-      else if ((tmp_str =
-              strstr (tmp_ascii,
-                  CONTENT_FEATURES_HEADERS[HEADER_INDEX_FLAGS])) != NULL) {
-        GST_LOG_OBJECT (dlna_src, "Found field: %s",
-            CONTENT_FEATURES_HEADERS[HEADER_INDEX_FLAGS]);
-        flags_str = *ptr;
-      }
-      /* DLNA.ORG_CI */
-      else if ((tmp_str =
-              strstr (tmp_ascii,
-                  CONTENT_FEATURES_HEADERS[HEADER_INDEX_CI])) != NULL) {
-        GST_LOG_OBJECT (dlna_src, "Found field: %s",
-            CONTENT_FEATURES_HEADERS[HEADER_INDEX_CI]);
-        ci_str = *ptr;
-      } else {
-        GST_WARNING_OBJECT (dlna_src, "Unrecognized sub field:%s", *ptr);
-      }
-      g_free(tmp_ascii);
-      tmp_ascii=NULL;
+  while (*ptr) {
+    while (*ptr == ' ')
+      ptr++;
+    field = ptr;
+    while (*ptr && (*ptr != ';'))
+      ptr++;
+    field_end = ptr;
+    if (*ptr)
+      ptr++;
+
+    while ((field_end > field) && (*(field_end - 1) == ' '))
+      field_end--;
+    if (field_end == field)
+      continue;
+
+    eq = memchr (field, '=', field_end - field);
+    name_len = eq ? (gsize) (eq - field) : 0;
+    for (i = 0; i < G_N_ELEMENTS (CONTENT_FEATURES_HEADERS); i++) {
+      if (eq && (strlen (CONTENT_FEATURES_HEADERS[i]) == name_len) &&
+          (g_ascii_strncasecmp (field, CONTENT_FEATURES_HEADERS[i],
+                  name_len) == 0))
+        break;
     }
-  }
 
-  if (pn_str != NULL) {
-    if (!dlna_src_head_response_parse_profile (dlna_src, head_response, idx,
-            pn_str)) {
-      GST_WARNING_OBJECT (dlna_src, "Problems parsing profile sub field: %s",
-          pn_str);
-    }
-  }
-  if (op_str != NULL) {
-    if (!dlna_src_head_response_parse_operations (dlna_src, head_response, idx,
-            op_str)) {
-      GST_WARNING_OBJECT (dlna_src, "Problems parsing operations sub field: %s",
-          op_str);
-    }
-  }
-  if (ps_str != NULL) {
-    if (!dlna_src_head_response_parse_playspeeds (dlna_src, head_response, idx,
-            ps_str)) {
-      GST_WARNING_OBJECT (dlna_src, "Problems parsing playspeeds sub field: %s",
-          ps_str);
-    }
-  }
-  if (flags_str != NULL) {
-    if (!dlna_src_head_response_parse_flags (dlna_src, head_response, idx,
-            flags_str)) {
-      GST_WARNING_OBJECT (dlna_src, "Problems parsing flags sub field: %s",
-          flags_str);
-    }
-  }
-  if (ci_str != NULL) {
-    if (!dlna_src_head_response_parse_conversion_indicator (dlna_src,
-            head_response, idx, ci_str)) {
-      GST_WARNING_OBJECT (dlna_src,
-          "Problems parsing conversion indicator sub field: %s", ci_str);
-    }
+    if (i < G_N_ELEMENTS (CONTENT_FEATURES_HEADERS)) {
+      GST_LOG_OBJECT (dlna_src, "Found field: %s",
+          CONTENT_FEATURES_HEADERS[i]);
+      values[i] = eq + 1;
+      lens[i] = field_end - (eq + 1);
+    } else
+      GST_WARNING_OBJECT (dlna_src, "Unrecognized sub field:%.*s",
+          (gint) (field_end - field), field);
   }
-  g_strfreev (tokens);
+
+  if (values[HEADER_INDEX_PN] &&
+      !dlna_src_head_response_parse_profile (dlna_src, head_response,
+          values[HEADER_INDEX_PN], lens[HEADER_INDEX_PN]))
+    GST_WARNING_OBJECT (dlna_src, "Problems parsing profile sub field of %s",
+        HEAD_RESPONSE_HEADERS[idx]);
+  if (values[HEADER_INDEX_OP] &&
+      !dlna_src_head_response_parse_operations (dlna_src, head_response,
+          values[HEADER_INDEX_OP], lens[HEADER_INDEX_OP]))
+    GST_WARNING_OBJECT (dlna_src,
+        "Problems parsing operations sub field of %s",
+        HEAD_RESPONSE_HEADERS[idx]);
+  if (values[HEADER_INDEX_PS] &&
+      !dlna_src_head_response_parse_playspeeds (dlna_src, head_response,
+          values[HEADER_INDEX_PS], lens[HEADER_INDEX_PS]))
+    GST_WARNING_OBJECT (dlna_src,
+        "Problems parsing playspeeds sub field of %s",
+        HEAD_RESPONSE_HEADERS[idx]);
+  if (values[HEADER_INDEX_FLAGS] &&
+      !dlna_src_head_response_parse_flags (dlna_src, head_response,
+          values[HEADER_INDEX_FLAGS], lens[HEADER_INDEX_FLAGS]))
+    GST_WARNING_OBJECT (dlna_src, "Problems parsing flags sub field of %s",
+        HEAD_RESPONSE_HEADERS[idx]);
+  if (values[HEADER_INDEX_CI] &&
+      !dlna_src_head_response_parse_conversion_indicator (dlna_src,
+          head_response, values[HEADER_INDEX_CI], lens[HEADER_INDEX_CI]))
+    GST_WARNING_OBJECT (dlna_src,
+        "Problems parsing conversion indicator sub field of %s",
+        HEAD_RESPONSE_HEADERS[idx]);
+
   return TRUE;
 }
 
@@ -3866,29 +10778,22 @@ dlna_src_head_response_parse_content_features (GstDlnaSrc * dlna_src,
  * Parse DLNA profile identified by DLNA.ORG_PN header.
  *
  * @param	dlna_src	this element
- * @param	idx			index into array of header strings
- * @param	field_str	sub field string containing DLNA.ORG_PN field
+ * @param	value		value of the DLNA.ORG_PN sub field
+ * @param	len			length of value
  *
- * @return	TRUE
+ * @return	TRUE if the value is not empty
  */
 static gboolean
 dlna_src_head_response_parse_profile (GstDlnaSrc * dlna_src,
-    GstDlnaSrcHeadResponse * head_response, gint idx, const gchar * field_str)
+    GstDlnaSrcHeadResponse * head_response, const gchar * value, gsize len)
 {
-  gint ret_code = 0;
-  gchar tmp1[256] = { 0 };
-  gchar tmp2[256] = { 0 };
+  GST_LOG_OBJECT (dlna_src, "Found PN Field: %.*s", (gint) len, value);
 
-  GST_LOG_OBJECT (dlna_src, "Found PN Field: %s", field_str);
+  if (!len)
+    return FALSE;
 
-  if ((ret_code = sscanf (field_str, "%255[^=]=%255s", tmp1, tmp2)) != 2) {
-    GST_WARNING_OBJECT (dlna_src,
-        "Problems parsing DLNA.ORG_PN from HEAD response field header %s, value: %s, retcode: %d, tmp: %s, %s",
-        HEAD_RESPONSE_HEADERS[idx], field_str, ret_code, tmp1, tmp2);
-  } else {
-    g_free (head_response->content_features->profile);
-    head_response->content_features->profile = g_strdup (tmp2);
-  }
+  dlna_src_assign_span (&head_response->content_features->profile, value,
+      len);
   return TRUE;
 }
 
@@ -3896,60 +10801,38 @@ dlna_src_head_response_parse_profile (GstDlnaSrc * dlna_src,
  * Parse DLNA supported operations sub field identified by DLNA.ORG_OP header.
  *
  * @param	dlna_src	this element
- * @param	idx			index into array of header strings
- * @param	field_str	sub field string containing DLNA.ORG_OP field
+ * @param	value		value of the DLNA.ORG_OP sub field
+ * @param	len			length of value
  *
- * @return	TRUE
+ * @return	TRUE if the value has the expected length
  */
 static gboolean
 dlna_src_head_response_parse_operations (GstDlnaSrc * dlna_src,
-    GstDlnaSrcHeadResponse * head_response, gint idx, const gchar * field_str)
+    GstDlnaSrcHeadResponse * head_response, const gchar * value, gsize len)
 {
-  gint ret_code = 0;
-  gchar tmp1[256] = { 0 };
-  gchar tmp2[256] = { 0 };
+  guint i;
 
-  GST_LOG_OBJECT (dlna_src, "Found OP Field: %s", field_str);
+  GST_LOG_OBJECT (dlna_src, "OP Field value: %.*s", (gint) len, value);
 
-  if ((ret_code = sscanf (field_str, "%255[^=]=%255s", tmp1, tmp2)) != 2) {
+  if (len != G_N_ELEMENTS (OPERATIONS_FLAGS)) {
     GST_WARNING_OBJECT (dlna_src,
-        "Problems parsing DLNA.ORG_OP from HEAD response field header %s, value: %s, retcode: %d, tmp: %s, %s",
-        HEAD_RESPONSE_HEADERS[idx], field_str, ret_code, tmp1, tmp2);
-  } else {
-    GST_LOG_OBJECT (dlna_src, "OP Field value: %s", tmp2);
+        "DLNA.ORG_OP value: %.*s, is not at expected len of 2", (gint) len,
+        value);
+    return FALSE;
+  }
 
-    if (strlen (tmp2) != 2) {
+  /* Chars represent time seek and byte range support, in order */
+  for (i = 0; i < G_N_ELEMENTS (OPERATIONS_FLAGS); i++) {
+    if (value[i] == '0')
+      head_response->content_features->flags &= ~OPERATIONS_FLAGS[i];
+    else if (value[i] == '1')
+      head_response->content_features->flags |= OPERATIONS_FLAGS[i];
+    else
       GST_WARNING_OBJECT (dlna_src,
-          "DLNA.ORG_OP from HEAD response sub field %s value: %s, is not at expected len of 2",
-          field_str, tmp2);
-    } else {
-      /* First char represents time seek support */
-      if ((tmp2[0] == '0') || (tmp2[0] == '1')) {
-        if (tmp2[0] == '0') {
-          head_response->content_features->op_time_seek_supported = FALSE;
-        } else {
-          head_response->content_features->op_time_seek_supported = TRUE;
-        }
-      } else {
-        GST_WARNING_OBJECT (dlna_src,
-            "DLNA.ORG_OP Time Seek Flag from HEAD response sub field %s value: %s, is not 0 or 1",
-            field_str, tmp2);
-      }
-
-      /* Second char represents byte range support */
-      if ((tmp2[1] == '0') || (tmp2[1] == '1')) {
-        if (tmp2[1] == '0') {
-          head_response->content_features->op_range_supported = FALSE;
-        } else {
-          head_response->content_features->op_range_supported = TRUE;
-        }
-      } else {
-        GST_WARNING_OBJECT (dlna_src,
-            "DLNA.ORG_OP Range Flag from HEAD response sub field %s value: %s, is not 0 or 1",
-            field_str, tmp2);
-      }
-    }
+          "DLNA.ORG_OP flag %u value: %.*s, is not 0 or 1", i, (gint) len,
+          value);
   }
+
   return TRUE;
 }
 
@@ -3957,80 +10840,114 @@ dlna_src_head_response_parse_operations (GstDlnaSrc * dlna_src,
  * Parse DLNA playspeeds sub field identified by DLNA.ORG_PS header.
  *
  * @param	dlna_src	this element
- * @param	idx			index into array of header strings
- * @param	field_str	sub field string containing DLNA.ORG_PS field
+ * @param	value		value of the DLNA.ORG_PS sub field, a comma
+ *				separated list
+ * @param	len			length of value
  *
- * @return	TRUE
+ * @return	TRUE if every playspeed listed could be converted
  */
 static gboolean
 dlna_src_head_response_parse_playspeeds (GstDlnaSrc * dlna_src,
-    GstDlnaSrcHeadResponse * head_response, gint idx, const gchar * field_str)
+    GstDlnaSrcHeadResponse * head_response, const gchar * value, gsize len)
 {
-  gint ret_code = 0;
-  gchar tmp1[256] = { 0 };
-  gchar tmp2[256] = { 0 };
+  GstDlnaSrcHeadResponseContentFeatures *features =
+      head_response->content_features;
+  const gchar *end = value + len;
+  const gchar *ptr = value;
+  const gchar *speed;
+  gsize speed_len;
   gfloat rate = 0;
-  int d;
-  int n;
-  gchar **tokens;
-  gchar **ptr;
+  guint i;
 
-  GST_LOG_OBJECT (dlna_src, "Found PS Field: %s", field_str);
+  GST_LOG_OBJECT (dlna_src, "PS Field value: %.*s", (gint) len, value);
 
-  if ((ret_code = sscanf (field_str, "%255[^=]=%255s", tmp1, tmp2)) != 2) {
-    GST_WARNING_OBJECT (dlna_src,
-        "Problems parsing DLNA.ORG_PS from HEAD response field header %s, value: %s, retcode: %d, tmp: %s, %s",
-        HEAD_RESPONSE_HEADERS[idx], field_str, ret_code, tmp1, tmp2);
-    return FALSE;
-  } else {
-    GST_LOG_OBJECT (dlna_src, "PS Field value: %s", tmp2);
+  /* Start over in case this response is parsed again */
+  features->playspeeds_cnt = 0;
 
-    /* Tokenize list of comma separated playspeeds */
-    tokens = g_strsplit (tmp2, ",", PLAYSPEEDS_MAX_CNT);
-    for (ptr = tokens; *ptr; ptr++) {
-      if (strlen (*ptr) > 0) {
-        GST_LOG_OBJECT (dlna_src, "Found PS: %s", *ptr);
-
-        /* Store string representation to facilitate fractional string conversion */
-        g_free (head_response->content_features->playspeed_strs
-            [head_response->content_features->playspeeds_cnt]);
-        head_response->content_features->playspeed_strs
-            [head_response->content_features->playspeeds_cnt]
-            = g_strdup (*ptr);
-
-        /* Check if this is a non-fractional value */
-        if (strstr (*ptr, "/") == NULL) {
-          /* Convert str to numeric value */
-          if ((ret_code = sscanf (*ptr, "%f", &rate)) != 1) {
-            GST_WARNING_OBJECT (dlna_src,
-                "Problems converting playspeed %s into numeric value", *ptr);
-            return FALSE;
-          } else {
-            head_response->content_features->
-                playspeeds[head_response->content_features->playspeeds_cnt] =
-                rate;
-          }
-        } else {
-          /* Handle conversion of fractional string into float, needed when specifying rate */
-          if ((ret_code = sscanf (*ptr, "%d/%d", &n, &d)) != 2) {
-            GST_WARNING_OBJECT (dlna_src,
-                "Problems converting fractional playspeed %s into numeric value",
-                *ptr);
-            return FALSE;
-          } else {
-            rate = (gfloat) n / (gfloat) d;
+  while ((ptr < end) && (features->playspeeds_cnt < PLAYSPEEDS_MAX_CNT)) {
+    speed = ptr;
+    while ((ptr < end) && (*ptr != ','))
+      ptr++;
+    speed_len = ptr - speed;
+    if (ptr < end)
+      ptr++;
+    if (!speed_len)
+      continue;
 
-            head_response->content_features->
-                playspeeds[head_response->content_features->playspeeds_cnt] =
-                rate;
-          }
-        }
-        head_response->content_features->playspeeds_cnt++;
-      }
+    GST_LOG_OBJECT (dlna_src, "Found PS: %.*s", (gint) speed_len, speed);
+
+    /* Playspeeds defined by DLNA need no conversion */
+    for (i = 0; i < G_N_ELEMENTS (DLNA_PLAYSPEEDS); i++)
+      if ((strlen (DLNA_PLAYSPEEDS[i].str) == speed_len) &&
+          (strncmp (speed, DLNA_PLAYSPEEDS[i].str, speed_len) == 0))
+        break;
+
+    if (i < G_N_ELEMENTS (DLNA_PLAYSPEEDS))
+      rate = DLNA_PLAYSPEEDS[i].rate;
+    else if (!dlna_src_scan_playspeed (speed, speed_len, &rate)) {
+      GST_WARNING_OBJECT (dlna_src,
+          "Problems converting playspeed %.*s into numeric value",
+          (gint) speed_len, speed);
+      return FALSE;
     }
-    g_strfreev (tokens);
+
+    /* Store string representation to facilitate fractional string
+     * conversion */
+    dlna_src_assign_span (&features->playspeed_strs[features->playspeeds_cnt],
+        speed, speed_len);
+    features->playspeeds[features->playspeeds_cnt] = rate;
+    features->playspeeds_cnt++;
+  }
+
+  return TRUE;
+}
+
+/**
+ * Scan a playspeed other than those in DLNA_PLAYSPEEDS, either a decimal
+ * number such as "-2.5" or a fraction such as "3/4".
+ *
+ * @param   str     playspeed string, not terminated
+ * @param   len     length of str
+ * @param   rate    returns the rate
+ *
+ * @return  TRUE if all of str was scanned, FALSE otherwise
+ */
+static gboolean
+dlna_src_scan_playspeed (const gchar * str, gsize len, gfloat * rate)
+{
+  const gchar *end = str + len;
+  gboolean negative = FALSE;
+  gdouble value = 0;
+  gdouble scale;
+  guint64 denominator = 0;
+
+  if ((str < end) && ((*str == '-') || (*str == '+')))
+    negative = (*str++ == '-');
+
+  if ((str == end) || !g_ascii_isdigit (*str))
+    return FALSE;
+  for (; (str < end) && g_ascii_isdigit (*str); str++)
+    value = value * 10 + (*str - '0');
+
+  if ((str < end) && (*str == '.')) {
+    for (str++, scale = 0.1; (str < end) && g_ascii_isdigit (*str);
+        str++, scale /= 10)
+      value += (*str - '0') * scale;
+  } else if ((str < end) && (*str == '/')) {
+    for (str++; (str < end) && g_ascii_isdigit (*str); str++) {
+      if (denominator > G_MAXUINT32)
+        return FALSE;
+      denominator = denominator * 10 + (*str - '0');
+    }
+    if (!denominator)
+      return FALSE;
+    value /= denominator;
   }
 
+  if (str != end)
+    return FALSE;
+
+  *rate = (gfloat) (negative ? -value : value);
   return TRUE;
 }
 
@@ -4038,61 +10955,24 @@ dlna_src_head_response_parse_playspeeds (GstDlnaSrc * dlna_src,
  * Parse DLNA flags sub field identified by DLNA.ORG_FLAGS header.
  *
  * @param	dlna_src	this element
- * @param	idx			index into array of header strings
- * @param	field_str	sub field string containing DLNA.ORG_FLAGS field
+ * @param	value		value of the DLNA.ORG_FLAGS sub field
+ * @param	len			length of value
  *
  * @return	TRUE
  */
 static gboolean
 dlna_src_head_response_parse_flags (GstDlnaSrc * dlna_src,
-    GstDlnaSrcHeadResponse * head_response, gint idx, const gchar * field_str)
+    GstDlnaSrcHeadResponse * head_response, const gchar * value, gsize len)
 {
-  gint ret_code = 0;
-  gchar tmp1[256] = { 0 };
-  gchar tmp2[256] = { 0 };
+  guint32 primary = 0;
 
-  GST_LOG_OBJECT (dlna_src, "Found Flags Field: %s", field_str);
+  GST_LOG_OBJECT (dlna_src, "FLAGS Field value: %.*s", (gint) len, value);
 
-  if ((ret_code = sscanf (field_str, "%255[^=]=%255s", tmp1, tmp2)) != 2) {
-    GST_WARNING_OBJECT (dlna_src,
-        "Problems parsing DLNA.ORG_FLAGS from HEAD response field header %s, value: %s, retcode: %d, tmp: %s, %s",
-        HEAD_RESPONSE_HEADERS[idx], field_str, ret_code, tmp1, tmp2);
-  } else {
-    GST_LOG_OBJECT (dlna_src, "FLAGS Field value: %s", tmp2);
-
-    head_response->content_features->flag_sender_paced_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2, SP_FLAG);
-    head_response->content_features->flag_limited_time_seek_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2, LOP_NPT);
-    head_response->content_features->flag_limited_byte_seek_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2, LOP_BYTES);
-    head_response->content_features->flag_play_container_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2,
-        PLAYCONTAINER_PARAM);
-    head_response->content_features->flag_so_increasing_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2, S0_INCREASING);
-    head_response->content_features->flag_sn_increasing_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2, SN_INCREASING);
-    head_response->content_features->flag_rtsp_pause_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2, RTSP_PAUSE);
-    head_response->content_features->flag_streaming_mode_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2, TM_S);
-    head_response->content_features->flag_interactive_mode_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2, TM_I);
-    head_response->content_features->flag_background_mode_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2, TM_B);
-    head_response->content_features->flag_stalling_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2, HTTP_STALLING);
-    head_response->content_features->flag_dlna_v15_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2, DLNA_V15_FLAG);
-    head_response->content_features->flag_link_protected_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2, LP_FLAG);
-    head_response->content_features->flag_full_clear_text_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2,
-        CLEARTEXTBYTESEEK_FULL_FLAG);
-    head_response->content_features->flag_limited_clear_text_set =
-        dlna_src_head_response_is_flag_set (dlna_src, tmp2, LOP_CLEARTEXTBYTES);
-  }
+  /* Primary flags are parsed once and expanded through the table, all
+   * clear if they cannot be parsed */
+  dlna_src_head_response_parse_primary_flags (dlna_src, value, len, &primary);
+  dlna_src_content_features_set_flags (head_response->content_features,
+      primary);
 
   return TRUE;
 }
@@ -4101,32 +10981,21 @@ dlna_src_head_response_parse_flags (GstDlnaSrc * dlna_src,
  * Parse DLNA conversion indicator sub field identified by DLNA.ORG_CI header.
  *
  * @param   dlna_src    this element
- * @param   idx         index into array of header strings
- * @param   field_str   sub field string containing DLNA.ORG_CI field
+ * @param   value       value of the DLNA.ORG_CI sub field
+ * @param   len         length of value
  *
- * @return  TRUE
+ * @return  TRUE if the value is not empty
  */
 static gboolean
 dlna_src_head_response_parse_conversion_indicator (GstDlnaSrc * dlna_src,
-    GstDlnaSrcHeadResponse * head_response, gint idx, const gchar * field_str)
+    GstDlnaSrcHeadResponse * head_response, const gchar * value, gsize len)
 {
-  gint ret_code = 0;
-  gchar header[256] = { 0 };
-  gchar value[256] = { 0 };
+  GST_LOG_OBJECT (dlna_src, "Found CI Field: %.*s", (gint) len, value);
 
-  GST_LOG_OBJECT (dlna_src, "Found CI Field: %s", field_str);
+  if (!len)
+    return FALSE;
 
-  if ((ret_code = sscanf (field_str, "%255[^=]=%s", header, value)) != 2) {
-    GST_WARNING_OBJECT (dlna_src,
-        "Problems parsing DLNA.ORG_CI from HEAD response field header %s, value: %s, retcode: %d, tmp: %s, %s",
-        HEAD_RESPONSE_HEADERS[idx], field_str, ret_code, header, value);
-  } else {
-    if (value[0] == '1') {
-      head_response->content_features->is_converted = TRUE;
-    } else {
-      head_response->content_features->is_converted = FALSE;
-    }
-  }
+  head_response->content_features->is_converted = (value[0] == '1');
 
   return TRUE;
 }
@@ -4150,17 +11019,13 @@ dlna_src_head_response_parse_content_type (GstDlnaSrc * dlna_src,
   gchar tmp2[32] = { 0 };
   gchar tmp3[32] = { 0 };
   gchar **tokens = NULL;
-  gchar *tmp_str;
+  const gchar *tmp_str;
   gchar **ptr;
-  gchar * tmp_ascii=NULL;
   
   GST_LOG_OBJECT (dlna_src, "Found Content Type Field: %s", field_value);
   
-  tmp_ascii=g_ascii_strup (field_value, strlen (field_value));
-  
   /* If not DTCP content, this field is mime-type */
-  if (strstr (tmp_ascii,
-          "DTCP") == NULL) {
+  if (dlna_src_find_token (field_value, "DTCP") == NULL) {
     g_free (head_response->content_type);
     head_response->content_type = g_strdup (field_value);
   } else {
@@ -4176,10 +11041,8 @@ dlna_src_head_response_parse_content_type (GstDlnaSrc * dlna_src,
     for (ptr = tokens; *ptr; ptr++) {
       if (strlen (*ptr) > 0) {
         /* DTCP1HOST */
-        g_free(tmp_ascii); 
-        tmp_ascii=g_ascii_strup (*ptr, strlen (*ptr));
         if ((tmp_str =
-                strstr (tmp_ascii,
+                dlna_src_find_token (*ptr,
                     CONTENT_TYPE_HEADERS[HEADER_INDEX_DTCP_HOST])) != NULL) {
           GST_LOG_OBJECT (dlna_src, "Found field: %s",
               CONTENT_TYPE_HEADERS[HEADER_INDEX_DTCP_HOST]);
@@ -4188,7 +11051,7 @@ dlna_src_head_response_parse_content_type (GstDlnaSrc * dlna_src,
         }
         /* DTCP1PORT */
         else if ((tmp_str =
-                strstr (tmp_ascii,
+                dlna_src_find_token (*ptr,
                     CONTENT_TYPE_HEADERS[HEADER_INDEX_DTCP_PORT])) != NULL) {
           if ((ret_code = sscanf (tmp_str, "%31[^=]=%d", tmp1,
                       &head_response->dtcp_port)) != 2) {
@@ -4202,7 +11065,7 @@ dlna_src_head_response_parse_content_type (GstDlnaSrc * dlna_src,
         }
         /* CONTENTFORMAT */
         else if ((tmp_str =
-                strstr (tmp_ascii,
+                dlna_src_find_token (*ptr,
                     CONTENT_TYPE_HEADERS[HEADER_INDEX_CONTENT_FORMAT])) !=
             NULL) {
 
@@ -4220,7 +11083,7 @@ dlna_src_head_response_parse_content_type (GstDlnaSrc * dlna_src,
         }
         /*  APPLICATION/X-DTCP1a */
         else if ((tmp_str =
-                strstr (tmp_ascii,
+                dlna_src_find_token (*ptr,
                     CONTENT_TYPE_HEADERS[HEADER_INDEX_APP_DTCP])) != NULL) {
           /* Ignoring this field */
         } else {
@@ -4230,7 +11093,6 @@ dlna_src_head_response_parse_content_type (GstDlnaSrc * dlna_src,
     }
     g_strfreev (tokens);
   }
-  g_free(tmp_ascii);
   return TRUE;
 }
 
@@ -4253,97 +11115,88 @@ static gboolean
 dlna_src_head_response_parse_presentation_timestamps (GstDlnaSrc * dlna_src, const gchar * field_str,    
     guint32 * start_pts, guint32 * end_pts)
 {
-  gchar *header = NULL;
-  gchar *header_value = NULL;
-  gint ret_code = 0;
-  gboolean ret=TRUE;
-  gchar * tmp_ascii=g_ascii_strup (field_str, strlen (field_str));
+  const gchar *header = NULL;
+  const gchar *header_value = NULL;
+
   /* Extract start PTS portion of header value */
-  header =
-      strstr (tmp_ascii,
+  header = dlna_src_find_token (field_str,
       RANGE_HEADERS[HEADER_INDEX_START_PTS]);
   if (header)
-    header_value = strstr (header, "=");
+    header_value = strchr (header, '=');
   if (header_value)
     header_value++;
   else {
     GST_WARNING_OBJECT (dlna_src,
         "Problems parsing start PTS from HEAD response field header value: %s",
         field_str);
-    ret=FALSE;
+    return FALSE;
   }
-  if (ret==TRUE)
-  {
-      if ((ret_code = sscanf (header_value, "%X", start_pts)) != 1) {
-        GST_WARNING_OBJECT (dlna_src,
-            "Problems parsing start PTS from HEAD response field header %s, value: %s, retcode: %d",
-            field_str, header_value, ret_code);
-        ret=FALSE;
-      }
-      if (ret==TRUE)
-      {
-          /* Extract end PTS portion of header value */
-          header =
-              strstr (header_value,
-              RANGE_HEADERS[HEADER_INDEX_END_PTS]);
-          if (header)
-            header_value = strstr (header, "=");
-          if (header_value)
-            header_value++;
-          else {
-            GST_WARNING_OBJECT (dlna_src,
-                "Problems parsing end PTS from HEAD response field header value: %s",
-                field_str);
-            ret=FALSE;
-          }
-          if (ret==TRUE)
-          {
-              if ((ret_code = sscanf (header_value, "%X", end_pts)) != 1) {
-                GST_WARNING_OBJECT (dlna_src,
-                    "Problems parsing end PTS from HEAD response field header %s, value: %s, retcode: %d",
-                    field_str, header_value, ret_code);
-                ret=FALSE;
-              }
-          }
-      }
+  if (!dlna_src_scan_hex32 (&header_value, start_pts)) {
+    GST_WARNING_OBJECT (dlna_src,
+        "Problems parsing start PTS from HEAD response field header %s, value: %s",
+        field_str, header_value);
+    return FALSE;
   }
-  g_free(tmp_ascii);
-  return ret;
+
+  /* Extract end PTS portion of header value */
+  header = dlna_src_find_token (header_value,
+      RANGE_HEADERS[HEADER_INDEX_END_PTS]);
+  header_value = NULL;
+  if (header)
+    header_value = strchr (header, '=');
+  if (header_value)
+    header_value++;
+  else {
+    GST_WARNING_OBJECT (dlna_src,
+        "Problems parsing end PTS from HEAD response field header value: %s",
+        field_str);
+    return FALSE;
+  }
+  if (!dlna_src_scan_hex32 (&header_value, end_pts)) {
+    GST_WARNING_OBJECT (dlna_src,
+        "Problems parsing end PTS from HEAD response field header %s, value: %s",
+        field_str, header_value);
+    return FALSE;
+  }
+
+  return TRUE;
 }
 
 /**
- * Utility method which determines if a given flag is set in the flags string.
+ * Utility method which parses the primary flags out of the flags string.
  *
  * @param dlna_src  this element
  * @param flagsStr  the fourth field of a protocolInfo string
- * @param flag      determines if this flag is set in supplied string
+ * @param len       length of flagsStr, which need not be terminated
+ * @param primary   set to the 32 primary flags
  *
- * @return TRUE if flag is set, FALSE otherwise
+ * @return TRUE if flags string could be parsed, FALSE otherwise
  */
 static gboolean
-dlna_src_head_response_is_flag_set (GstDlnaSrc * dlna_src,
-    const gchar * flags_str, gint flag)
+dlna_src_head_response_parse_primary_flags (GstDlnaSrc * dlna_src,
+    const gchar * flags_str, gsize len, guint32 * primary)
 {
-  gint64 value;
-  gchar *tmp_str;
-  gsize len;
+  gsize i;
+  gint digit;
 
-  if ((flags_str == NULL) || (strlen (flags_str) <= RESERVED_FLAGS_LENGTH)) {
+  if ((flags_str == NULL) || (len <= RESERVED_FLAGS_LENGTH)) {
     GST_WARNING_OBJECT (dlna_src,
-        "FLAGS Field value null or too short : %s", flags_str);
+        "FLAGS Field value null or too short : %.*s", (gint) len,
+        flags_str ? flags_str : "");
     return FALSE;
   }
   /* Drop reserved flags off of value (prepended zeros will be ignored) */
-  tmp_str = g_strdup (flags_str);
-  len = strlen (tmp_str);
-  tmp_str[len - RESERVED_FLAGS_LENGTH] = '\0';
+  len -= RESERVED_FLAGS_LENGTH;
 
-  /* Convert into long using hexidecimal format */
-  value = strtoll (tmp_str, NULL, 16);
-
-  g_free (tmp_str);
+  /* Convert using hexidecimal format, up to the first other char */
+  *primary = 0;
+  for (i = 0; i < len; i++) {
+    if ((digit = g_ascii_xdigit_value (flags_str[i])) < 0)
+      break;
+    *primary = (*primary << 4) | digit;
+  }
 
-  return (value & flag) == flag;
+  return TRUE;
 }
 
 /**
@@ -4517,71 +11370,11 @@ dlna_src_head_response_struct_to_str (GstDlnaSrc * dlna_src,
   dlna_src_struct_append_header_value_bool (struct_str,
       "Conversion Indicator?: ", head_response->content_features->is_converted);
 
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Time Seek Supported Flag?: ",
-      head_response->content_features->op_time_seek_supported);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Byte Seek Supported Flag?: ",
-      head_response->content_features->op_range_supported);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Sender Paced?: ",
-      head_response->content_features->flag_sender_paced_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Limited Time Seek?: ",
-      head_response->content_features->flag_limited_time_seek_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Limited Byte Seek?: ",
-      head_response->content_features->flag_limited_byte_seek_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Play Container?: ",
-      head_response->content_features->flag_play_container_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "S0 Increasing?: ",
-      head_response->content_features->flag_so_increasing_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Sn Increasing?: ",
-      head_response->content_features->flag_sn_increasing_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "RTSP Pause?: ", head_response->content_features->flag_rtsp_pause_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Streaming Mode Supported?: ",
-      head_response->content_features->flag_streaming_mode_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Interactive Mode Supported?: ",
-      head_response->content_features->flag_interactive_mode_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Background Mode Supported?: ",
-      head_response->content_features->flag_background_mode_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Connection Stalling Supported?: ",
-      head_response->content_features->flag_stalling_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "DLNA Ver. 1.5?: ", head_response->content_features->flag_dlna_v15_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Link Protected?: ",
-      head_response->content_features->flag_link_protected_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Full Clear Text?: ",
-      head_response->content_features->flag_full_clear_text_set);
-
-  dlna_src_struct_append_header_value_bool (struct_str,
-      "Limited Clear Text?: ",
-      head_response->content_features->flag_limited_clear_text_set);
+  for (i = 0; i < G_N_ELEMENTS (CONTENT_FLAGS); i++)
+    dlna_src_struct_append_header_value_bool (struct_str,
+        (gchar *) CONTENT_FLAGS[i].title,
+        DLNA_SRC_CF_IS_SET (head_response->content_features,
+            CONTENT_FLAGS[i].flag));
 }
 
 /**
@@ -4715,17 +11508,38 @@ static gboolean
 dlna_src_convert_bytes_to_npt_nanos (GstDlnaSrc * dlna_src, guint64 bytes,
     guint64 * npt_nanos)
 {
+  GstDlnaSrcRange *range;
+
   /* Unable to issue time seek range header with bytes and get back npt
-     so just using the time seek range results from previous head to estimate
-     what npt would be for supplied byte
+     so interpolate between the closest positions known from previous
+     responses, or failing that estimate from the overall time seek range
    */
-  *npt_nanos = (bytes * dlna_src->npt_duration_nanos) / dlna_src->byte_total;
+  if (dlna_src_seek_index_lookup (dlna_src, FALSE, bytes, G_MAXUINT64,
+          npt_nanos)) {
+    GST_INFO_OBJECT (dlna_src,
+        "Converted %" G_GUINT64_FORMAT " bytes to %" GST_TIME_FORMAT
+        " npt using seek index", bytes, GST_TIME_ARGS (*npt_nanos));
+    return TRUE;
+  }
+
+  range = dlna_src_range_get (dlna_src);
+  if (range->byte_total == 0) {
+    GST_WARNING_OBJECT (dlna_src,
+        "Unable to convert %" G_GUINT64_FORMAT " bytes to npt, total unknown",
+        bytes);
+    dlna_src_range_unref (range);
+    return FALSE;
+  }
+
+  *npt_nanos = gst_util_uint64_scale (bytes, range->npt_duration_nanos,
+      range->byte_total);
 
   GST_INFO_OBJECT (dlna_src,
       "Converted %" G_GUINT64_FORMAT " bytes to %" GST_TIME_FORMAT
       " npt using total bytes=%" G_GUINT64_FORMAT " total npt=%"
       GST_TIME_FORMAT, bytes, GST_TIME_ARGS (*npt_nanos),
-      dlna_src->byte_total, GST_TIME_ARGS (dlna_src->npt_duration_nanos));
+      range->byte_total, GST_TIME_ARGS (range->npt_duration_nanos));
+  dlna_src_range_unref (range);
 
   return TRUE;
 }
@@ -4733,6 +11547,9 @@ dlna_src_convert_bytes_to_npt_nanos (GstDlnaSrc * dlna_src, guint64 bytes,
 /**
  * Utility function which uses server info from time seek range in order
  * to convert supplied normal play time (npt) in nanoseconds to corresponding byte position.
+ * Positions close to ones already known are interpolated from the seek index,
+ * otherwise a HEAD request with a time seek range is issued, whose response
+ * also adds the position to the index.
  *
  * @param   dlna_src    this element instance
  * @param   npt_nanos   npt in nanoseconds to convert to byte position
@@ -4744,48 +11561,39 @@ static gboolean
 dlna_src_convert_npt_nanos_to_bytes (GstDlnaSrc * dlna_src, guint64 npt_nanos,
     guint64 * bytes)
 {
-  /* Issue head to get conversion info */
   GstDlnaSrcHeadResponse *head_response = NULL;
-  GString *head_request_str = g_string_sized_new(MAX_HTTP_BUF_SIZE);
-  gchar tmpStr[32] = { 0 };
-  gsize tmp_str_max_size = 32;
+  gchar *time_seek_value = NULL;
   gchar *time_seek_head_request_headers[][2] =
-      { {HEADER_TIME_SEEK_RANGE_TITLE, HEADER_TIME_SEEK_RANGE_VALUE} };
+      { {HEADER_TIME_SEEK_RANGE_TITLE, NULL} };
   gsize time_seek_head_request_headers_array_size = 1;
-  
-  /* Convert start time from nanos into secs string */
-  guint64 npt_secs = npt_nanos / GST_SECOND;
 
+  if (dlna_src_seek_index_lookup (dlna_src, TRUE, npt_nanos,
+          SEEK_INDEX_MAX_GAP_SECS * GST_SECOND, bytes)) {
+    GST_INFO_OBJECT (dlna_src,
+        "Converted %" GST_TIME_FORMAT " npt to %" G_GUINT64_FORMAT
+        " bytes using seek index", GST_TIME_ARGS (npt_nanos), *bytes);
+    return TRUE;
+  }
+
+  /* Issue head to get conversion info */
   if (!dlna_src_head_response_init_struct (dlna_src, &head_response)) {
     GST_ERROR_OBJECT (dlna_src,
         "Problems initializing struct to store HEAD response");
-    g_string_free(head_request_str, TRUE);
     return FALSE;
   }
 
-  /* Include time seek range to get conversion values */
-  if (g_strlcat (head_request_str->str, "TimeSeekRange.dlna.org: npt=",
-          head_request_str->allocated_len) >= head_request_str->allocated_len)
-    goto overflow;
-
   /* Include starting npt (since bytes are only included in response) */
-  g_snprintf (tmpStr, tmp_str_max_size, "%" G_GUINT64_FORMAT, npt_secs);
-  if (g_strlcat (head_request_str->str, tmpStr,
-          head_request_str->allocated_len) >= head_request_str->allocated_len)
-    goto overflow;
-
-  if (g_strlcat (head_request_str->str, "-",
-          head_request_str->allocated_len) >= head_request_str->allocated_len)
-    goto overflow;
-  if (g_strlcat (head_request_str->str, CRLF,
-          head_request_str->allocated_len) >= head_request_str->allocated_len)
-    goto overflow;
+  time_seek_value = g_strdup_printf ("npt=%" G_GUINT64_FORMAT ".%03u-",
+      npt_nanos / GST_SECOND, (guint) ((npt_nanos % GST_SECOND) / GST_MSECOND));
+  time_seek_head_request_headers[0][1] = time_seek_value;
 
   if (!dlna_src_soup_issue_head (dlna_src,
           time_seek_head_request_headers_array_size,
-          time_seek_head_request_headers, head_response, FALSE)) {
+          time_seek_head_request_headers, head_response, FALSE,
+          DLNA_SRC_LATENCY_HEAD_NPT_TO_BYTES)) {
     GST_WARNING_OBJECT (dlna_src, "Problems with HEAD request");
-    g_string_free(head_request_str, TRUE);
+    dlna_src_head_response_free_struct (dlna_src, head_response);
+    g_free (time_seek_value);
     return FALSE;
   }
 
@@ -4795,16 +11603,187 @@ dlna_src_convert_npt_nanos_to_bytes (GstDlnaSrc * dlna_src, guint64 npt_nanos,
       GST_TIME_ARGS (npt_nanos), *bytes);
 
   dlna_src_head_response_free_struct (dlna_src, head_response);
-  g_string_free(head_request_str, TRUE);
+  g_free (time_seek_value);
 
   return TRUE;
+}
 
-overflow:
-  GST_ERROR_OBJECT (dlna_src,
-      "Overflow - exceeded head request string size of: %d",
-      head_request_str->allocated_len);
-  g_string_free(head_request_str, TRUE);
-  return FALSE;
+/**
+ * Record a known npt to byte position pair of the current content in the
+ * seek index, which is kept sorted by npt.  Points which contradict the new
+ * one, i.e. are not increasing in both npt and bytes, are dropped.
+ *
+ * @param   dlna_src    this element instance
+ * @param   npt_nanos   npt of position
+ * @param   bytes       byte offset of position
+ */
+static void
+dlna_src_seek_index_add (GstDlnaSrc * dlna_src, guint64 npt_nanos,
+    guint64 bytes)
+{
+  GArray *index = dlna_src->seek_index;
+  dlna_src_seek_point point = { npt_nanos, bytes };
+  dlna_src_seek_point *other;
+  guint pos;
+  guint i;
+  guint drop = 0;
+  guint64 gap;
+  guint64 min_gap = G_MAXUINT64;
+
+  g_mutex_lock (&dlna_src->seek_index_mutex);
+
+  pos = dlna_src_seek_index_find (index, TRUE, npt_nanos);
+  if ((pos < index->len) &&
+      (g_array_index (index, dlna_src_seek_point, pos).npt_nanos == npt_nanos))
+    g_array_index (index, dlna_src_seek_point, pos).bytes = bytes;
+  else
+    g_array_insert_val (index, pos, point);
+
+  /* Drop neighbours which are out of order with the new point */
+  while (pos > 0) {
+    other = &g_array_index (index, dlna_src_seek_point, pos - 1);
+    if (other->bytes <= bytes)
+      break;
+    g_array_remove_index (index, pos - 1);
+    pos--;
+  }
+  while (pos + 1 < index->len) {
+    other = &g_array_index (index, dlna_src_seek_point, pos + 1);
+    if (other->bytes >= bytes)
+      break;
+    g_array_remove_index (index, pos + 1);
+  }
+
+  /* When full, drop the point closest to its predecessor, which loses the
+   * least resolution */
+  if (index->len > SEEK_INDEX_MAX_POINTS) {
+    for (i = 1; i < index->len - 1; i++) {
+      gap = g_array_index (index, dlna_src_seek_point, i).npt_nanos -
+          g_array_index (index, dlna_src_seek_point, i - 1).npt_nanos;
+      if (gap < min_gap) {
+        min_gap = gap;
+        drop = i;
+      }
+    }
+    g_array_remove_index (index, drop);
+  }
+
+  GST_LOG_OBJECT (dlna_src,
+      "Seek index point %" GST_TIME_FORMAT " = %" G_GUINT64_FORMAT
+      " bytes, %u points", GST_TIME_ARGS (npt_nanos), bytes, index->len);
+
+  g_mutex_unlock (&dlna_src->seek_index_mutex);
+}
+
+/**
+ * Drop seek index points before supplied npt, used when the start of the
+ * time shift buffer slides forward.
+ */
+static void
+dlna_src_seek_index_prune (GstDlnaSrc * dlna_src, guint64 npt_nanos)
+{
+  guint pos;
+
+  g_mutex_lock (&dlna_src->seek_index_mutex);
+  pos = dlna_src_seek_index_find (dlna_src->seek_index, TRUE, npt_nanos);
+  if (pos > 0)
+    g_array_remove_range (dlna_src->seek_index, 0, pos);
+  g_mutex_unlock (&dlna_src->seek_index_mutex);
+}
+
+/**
+ * Forget all seek index points, used when the content changes.
+ */
+static void
+dlna_src_seek_index_clear (GstDlnaSrc * dlna_src)
+{
+  g_mutex_lock (&dlna_src->seek_index_mutex);
+  g_array_set_size (dlna_src->seek_index, 0);
+  g_mutex_unlock (&dlna_src->seek_index_mutex);
+}
+
+/**
+ * Binary search of the seek index, which is increasing in both npt and
+ * bytes.  Seek index mutex must be held.
+ *
+ * @param   index       seek index
+ * @param   by_npt      TRUE if value is an npt, FALSE if it is a byte offset
+ * @param   value       npt or byte offset to look for
+ *
+ * @return  position of first point not before value, index length if none
+ */
+static guint
+dlna_src_seek_index_find (GArray * index, gboolean by_npt, guint64 value)
+{
+  guint low = 0;
+  guint high = index->len;
+  guint mid;
+  dlna_src_seek_point *point;
+
+  while (low < high) {
+    mid = low + (high - low) / 2;
+    point = &g_array_index (index, dlna_src_seek_point, mid);
+    if ((by_npt ? point->npt_nanos : point->bytes) < value)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  return low;
+}
+
+/**
+ * Convert between npt and bytes by interpolating between the two seek index
+ * points around the supplied value.
+ *
+ * @param   dlna_src    this element instance
+ * @param   from_npt    TRUE to convert npt to bytes, FALSE bytes to npt
+ * @param   value       npt or byte offset to convert
+ * @param   max_gap     furthest apart in npt the surrounding points may be
+ * @param   result      converted byte offset or npt
+ *
+ * @return  TRUE if converted, FALSE if the index has no close enough points
+ */
+static gboolean
+dlna_src_seek_index_lookup (GstDlnaSrc * dlna_src, gboolean from_npt,
+    guint64 value, guint64 max_gap, guint64 * result)
+{
+  GArray *index = dlna_src->seek_index;
+  dlna_src_seek_point *before;
+  dlna_src_seek_point *after;
+  guint64 from_start;
+  guint64 from_span;
+  guint64 to_start;
+  guint64 to_span;
+  gboolean found = FALSE;
+  guint pos;
+
+  g_mutex_lock (&dlna_src->seek_index_mutex);
+
+  pos = dlna_src_seek_index_find (index, from_npt, value);
+  if (pos < index->len) {
+    after = &g_array_index (index, dlna_src_seek_point, pos);
+    if ((from_npt ? after->npt_nanos : after->bytes) == value) {
+      *result = from_npt ? after->bytes : after->npt_nanos;
+      found = TRUE;
+    } else if ((pos > 0) &&
+        ((after->npt_nanos -
+                g_array_index (index, dlna_src_seek_point,
+                    pos - 1).npt_nanos) <= max_gap)) {
+      before = &g_array_index (index, dlna_src_seek_point, pos - 1);
+      from_start = from_npt ? before->npt_nanos : before->bytes;
+      from_span = (from_npt ? after->npt_nanos : after->bytes) - from_start;
+      to_start = from_npt ? before->bytes : before->npt_nanos;
+      to_span = (from_npt ? after->bytes : after->npt_nanos) - to_start;
+      *result = to_start + gst_util_uint64_scale (value - from_start, to_span,
+          from_span);
+      found = TRUE;
+    }
+  }
+
+  g_mutex_unlock (&dlna_src->seek_index_mutex);
+
+  return found;
 }
 
 /**
@@ -4829,35 +11808,54 @@ static gboolean
 dlna_src_npt_to_nanos (GstDlnaSrc * dlna_src, gchar * string,
     guint64 * media_time_nanos)
 {
-  gboolean ret = FALSE;
+  const gchar *ptr = string;
+  guint64 parts[3] = { 0, 0, 0 };
+  guint parts_cnt = 0;
+  guint64 frac_nanos = 0;
+  guint64 scale = GST_SECOND;
+
+  /* Either long form H:MM:SS[.fff] or short form SECS[.fff], each part is an
+   * unsigned integer so the fraction is kept exactly */
+  while (parts_cnt < 3) {
+    if (!dlna_src_scan_guint64 (&ptr, &parts[parts_cnt]))
+      break;
+    parts_cnt++;
+    if ((*ptr != ':') || (parts_cnt == 3))
+      break;
+    ptr++;
+  }
+
+  if ((parts_cnt != 1) && (parts_cnt != 3)) {
+    GST_ERROR_OBJECT (dlna_src,
+        "Problems converting npt str into nanosecs: %s", string);
+    return FALSE;
+  }
 
-  guint hours = 0;
-  guint mins = 0;
-  float secs = 0.;
+  if (*ptr == '.') {
+    for (ptr++; g_ascii_isdigit (*ptr); ptr++) {
+      if (scale >= 10) {
+        scale /= 10;
+        frac_nanos += (*ptr - '0') * scale;
+      }
+    }
+  }
 
-  if (sscanf (string, "%u:%u:%f", &hours, &mins, &secs) == 3) {
-    /* Long form */
+  if (parts_cnt == 3) {
     *media_time_nanos =
-        ((hours * 60 * 60 * 1000) + (mins * 60 * 1000) +
-        (secs * 1000)) * 1000000L;
-    ret = TRUE;
-
-    GST_LOG_OBJECT (dlna_src,
-        "Convert npt str %s hr=%d:mn=%d:s=%f into nanosecs: %"
-        G_GUINT64_FORMAT, string, hours, mins, secs, *media_time_nanos);
-  } else if (sscanf (string, "%f", &secs) == 1) {
-    /* Short form */
-    *media_time_nanos = (secs * 1000) * 1000000L;
-    ret = TRUE;
+        ((parts[0] * 60 * 60) + (parts[1] * 60) + parts[2]) * GST_SECOND +
+        frac_nanos;
     GST_LOG_OBJECT (dlna_src,
-        "Convert npt str %s secs=%f into nanosecs: %"
-        G_GUINT64_FORMAT, string, secs, *media_time_nanos);
+        "Convert npt str %s hr=%" G_GUINT64_FORMAT ":mn=%" G_GUINT64_FORMAT
+        ":s=%" G_GUINT64_FORMAT " into nanosecs: %" G_GUINT64_FORMAT, string,
+        parts[0], parts[1], parts[2], *media_time_nanos);
   } else {
-    GST_ERROR_OBJECT (dlna_src,
-        "Problems converting npt str into nanosecs: %s", string);
+    *media_time_nanos = parts[0] * GST_SECOND + frac_nanos;
+    GST_LOG_OBJECT (dlna_src,
+        "Convert npt str %s secs=%" G_GUINT64_FORMAT " into nanosecs: %"
+        G_GUINT64_FORMAT, string, parts[0], *media_time_nanos);
   }
 
-  return ret;
+  return TRUE;
 }
 
 /**
@@ -49,6 +49,131 @@ typedef struct _GstDlnaSrcClass GstDlnaSrcClass;
 
 typedef struct _GstDlnaSrcHeadResponse GstDlnaSrcHeadResponse;
 typedef struct _GstDlnaSrcHeadResponseContentFeatures GstDlnaSrcHeadResponseContentFeatures;
+typedef struct _GstDlnaSrcRange GstDlnaSrcRange;
+typedef struct _GstDlnaSrcHistogram GstDlnaSrcHistogram;
+typedef struct _GstDlnaSrcTraceEntry GstDlnaSrcTraceEntry;
+typedef struct _GstDlnaSrcTrickPlan GstDlnaSrcTrickPlan;
+
+/* Content features packed from DLNA.ORG_OP and DLNA.ORG_FLAGS, see
+ * DLNA_SRC_CF_IS_SET() */
+typedef enum
+{
+    DLNA_SRC_CF_OP_TIME_SEEK        = 1 << 0,
+    DLNA_SRC_CF_OP_RANGE            = 1 << 1,
+    DLNA_SRC_CF_SENDER_PACED        = 1 << 2,
+    DLNA_SRC_CF_LIMITED_TIME_SEEK   = 1 << 3,
+    DLNA_SRC_CF_LIMITED_BYTE_SEEK   = 1 << 4,
+    DLNA_SRC_CF_PLAY_CONTAINER      = 1 << 5,
+    DLNA_SRC_CF_SO_INCREASING       = 1 << 6,
+    DLNA_SRC_CF_SN_INCREASING       = 1 << 7,
+    DLNA_SRC_CF_RTSP_PAUSE          = 1 << 8,
+    DLNA_SRC_CF_STREAMING_MODE      = 1 << 9,
+    DLNA_SRC_CF_INTERACTIVE_MODE    = 1 << 10,
+    DLNA_SRC_CF_BACKGROUND_MODE     = 1 << 11,
+    DLNA_SRC_CF_STALLING            = 1 << 12,
+    DLNA_SRC_CF_DLNA_V15            = 1 << 13,
+    DLNA_SRC_CF_LINK_PROTECTED      = 1 << 14,
+    DLNA_SRC_CF_FULL_CLEAR_TEXT     = 1 << 15,
+    DLNA_SRC_CF_LIMITED_CLEAR_TEXT  = 1 << 16
+} GstDlnaSrcContentFlags;
+
+/* Bits expanded from the primary flags of DLNA.ORG_FLAGS */
+#define DLNA_SRC_CF_PRIMARY_FLAGS \
+        ((DLNA_SRC_CF_LIMITED_CLEAR_TEXT << 1) - DLNA_SRC_CF_SENDER_PACED)
+
+/* TRUE if any of the flags is set in the content features */
+#define DLNA_SRC_CF_IS_SET(content_features, flag) \
+        (((content_features)->flags & (flag)) != 0)
+
+/* How a rate is played, see dlna_src_rate_ladder_plan() */
+typedef enum
+{
+    DLNA_SRC_TRICK_NONE,            /* 1x */
+    DLNA_SRC_TRICK_SERVER,          /* server playspeed equal to the rate */
+    DLNA_SRC_TRICK_SERVER_SKIP,     /* nearest server playspeed (or 1x),
+                                     * rest made up by skipping to I-frames */
+    DLNA_SRC_TRICK_STRIDE,          /* 1x range requests strided over the
+                                     * content */
+    DLNA_SRC_TRICK_IFRAME_STRIDE    /* strided over a transport stream,
+                                     * pushed from random access points */
+} GstDlnaSrcTrickMode;
+
+struct _GstDlnaSrcTrickPlan
+{
+    GstDlnaSrcTrickMode mode;
+    gfloat server_rate;         /* playspeed asked of the server */
+    gfloat client_factor;       /* rate made up on the client */
+    guint64 cost;               /* estimated bytes fetched per second */
+    gint64 stride;              /* bytes between chunks when striding */
+};
+
+/* Operations whose latency is recorded, see the "stats" property */
+typedef enum
+{
+    DLNA_SRC_LATENCY_HEAD_CONTENT_FEATURES,
+    DLNA_SRC_LATENCY_HEAD_TIME_SEEK,
+    DLNA_SRC_LATENCY_HEAD_BYTE_RANGE,
+    DLNA_SRC_LATENCY_HEAD_AVAILABLE_RANGE,
+    DLNA_SRC_LATENCY_HEAD_NPT_TO_BYTES,
+    DLNA_SRC_LATENCY_HEAD_BOUNDARY_POLL,
+    DLNA_SRC_LATENCY_SEEK,
+    DLNA_SRC_LATENCY_RATE_CHANGE,
+    DLNA_SRC_LATENCY_CNT
+} GstDlnaSrcLatency;
+
+/* Latency histograms count microseconds in buckets which are 1/8 of a power
+ * of two wide, for a relative precision of 12.5% up to 2^35 usecs */
+#define LATENCY_SUB_BUCKET_BITS 3
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_MAX_BITS 35
+#define LATENCY_HISTOGRAM_BUCKETS \
+        ((LATENCY_MAX_BITS - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+struct _GstDlnaSrcHistogram
+{
+    guint64 count;
+    guint64 sum;
+    guint64 min;
+    guint64 max;
+    guint32 buckets[LATENCY_HISTOGRAM_BUCKETS];
+};
+
+/* Kinds of entries in the trace ring, see the "trace" property */
+typedef enum
+{
+    DLNA_SRC_TRACE_HEAD,
+    DLNA_SRC_TRACE_GET,
+    DLNA_SRC_TRACE_SEEK
+} GstDlnaSrcTraceKind;
+
+/* Number of entries kept in the trace ring, must be a power of two */
+#define TRACE_RING_SIZE 128
+
+#define TRACE_FLAG_BYTE_SEEK        (1 << 0)
+#define TRACE_FLAG_TIME_SEEK        (1 << 1)
+#define TRACE_FLAG_ENCRYPTED        (1 << 2)
+#define TRACE_FLAG_AVAILABLE_RANGE  (1 << 3)
+#define TRACE_FLAG_PARSE_FAILED     (1 << 4)
+#define TRACE_FLAG_REJECTED         (1 << 5)
+
+/* Seeks keep their format in status and their positions in byte or npt
+ * start and end depending on it */
+struct _GstDlnaSrcTraceEntry
+{
+    volatile gint seq;
+    GstDlnaSrcTraceKind kind;
+    GstDlnaSrcLatency purpose;
+    guint status;
+    guint32 usecs;
+    guint32 flags;
+    gfloat rate;
+    gint64 time;
+    guint64 byte_start;
+    guint64 byte_end;
+    guint64 byte_total;
+    guint64 npt_start;
+    guint64 npt_end;
+};
 
 struct _GstDlnaSrc
 {
@@ -59,17 +184,49 @@ struct _GstDlnaSrc
     GstPad* src_pad;
 
     guint dtcp_blocksize;
+    guint block_duration;
+    guint blocksize;
+    guint64 throughput_bytes;
+    gint64 throughput_start;
+    guint64 throughput;
+    guint buffer_pool_size;
     gchar* dtcp_key_storage;
 
     gchar *dlna_uri;
     gchar *http_uri;
 
     SoupSession *soup_session;
+    GMainContext *head_context;
+    gboolean head_closing;
+    GList *head_requests;
+    gint head_requests_pending;
+    gboolean head_cancel_done;
+    GMutex head_mutex;
+    GCond head_cond;
+    volatile gint head_refresh_pending;
+    gint64 head_update_time;
+    GHashTable *head_flights;
+    volatile gint head_flights_generation;
+    guint head_freshness;
+    guint max_staleness;
+
+    guint stats_interval;
+    GMutex stats_mutex;
+    GstDlnaSrcHistogram stats_latency[DLNA_SRC_LATENCY_CNT];
+    guint64 stats_bytes_delivered;
+    guint64 stats_bytes_dropped;
+    GstDlnaSrcLatency stats_mark;
+    gint64 stats_mark_time;
+    GSource *stats_source;
+
+    GstDlnaSrcTraceEntry trace_ring[TRACE_RING_SIZE];
+    volatile gint trace_next;
 
     GstDlnaSrcHeadResponse* server_info;
 
     gfloat rate;
     gfloat requested_rate;
+    GstDlnaSrcTrickPlan trick_plan;
     GstFormat requested_format;
     guint64 requested_start;
     guint64 requested_stop;
@@ -78,6 +235,18 @@ struct _GstDlnaSrc
     guint64 time_seek_event_start;
     gboolean handled_time_seek_seqnum;
 
+    guint seek_debounce;
+    GThread *seek_thread;
+    GMutex seek_mutex;
+    GCond seek_cond;
+    gboolean seek_executing;
+    GThread *seek_owner;
+    guint32 seek_executing_seqnum;
+    volatile gint seek_latest_seqnum;
+    GstEvent *seek_pending;
+    GstPad *seek_pending_pad;
+    gint64 seek_last_time;
+
     gboolean is_uri_initialized;
     gboolean is_live;
     gboolean is_recInProgress;
@@ -105,15 +274,94 @@ struct _GstDlnaSrc
     guint32 start_pts;
     guint32 end_pts;
 
+    GSource *boundary_source;
+    GCond boundary_cond;
+    GMutex boundary_mutex;
+    gboolean boundary_stopped;
+    gint64 boundary_base_time;
+    guint32 boundary_base_start_pts;
+    guint32 boundary_base_end_pts;
+    gboolean boundary_resync;
     GThread *boundary_thread;
-    GCond boundary_thread_cond;
-    GMutex boundary_thread_mutex;
-    gboolean kill_boundary_thread;
+    gboolean boundary_report_pending;
+    volatile gint boundary_interval;
 
     guint32 max_tsb_duration;
-    guint32 last_tsb_slide;
 
     GMutex parse_msg_mutex;
+
+    GMutex range_mutex;
+    GstDlnaSrcRange *range;
+
+    gboolean pipelined_head;
+    gboolean fast_start;
+    gboolean tune_pending;
+
+    gchar *server_key;
+    guint caps_cache_ttl;
+
+    GArray *seek_index;
+    GMutex seek_index_mutex;
+
+    guint prefetch_duration;
+    GMutex prefetch_mutex;
+    GCond prefetch_cond;
+    GSource *prefetch_source;
+    gboolean prefetch_stopped;
+    SoupSession *prefetch_session;
+    SoupMessage *prefetch_msg;
+    guint64 prefetch_aim_start;
+    guint64 prefetch_aim_end;
+    gint64 prefetch_base_time;
+    guint64 prefetch_base_npt;
+    gfloat prefetch_rate;
+    GBytes *prefetch_data;
+    guint64 prefetch_offset;
+
+    GThread *splice_thread;
+    GMutex splice_mutex;
+    GCond splice_cond;
+    gboolean splice_pending;
+    gboolean splice_pushing;
+    gboolean splice_seeking;
+    GBytes *splice_data;
+    guint64 splice_data_offset;
+    guint64 splice_offset;
+    guint32 splice_seqnum;
+
+    guint cache_size;
+    GMutex cache_mutex;
+    guint8 *cache_data;
+    gsize cache_head;
+    gsize cache_fill;
+    guint64 cache_end;
+    guint64 cache_next;
+
+    guint parallel_connections;
+    SoupSession *parallel_session;
+    GstElement *parallel_src;
+    GMutex parallel_mutex;
+    GCond parallel_cond;
+    guint parallel_generation;
+    gboolean parallel_active;
+    gboolean parallel_stopping;
+    gboolean parallel_flushing;
+    gboolean parallel_failed;
+    guint32 parallel_seqnum;
+    guint64 parallel_offset;
+    gint64 parallel_stride;
+    guint parallel_chunk_size;
+    gboolean parallel_random_access;
+    gdouble parallel_applied_rate;
+
+    SoupSession *preview_session;
+    GList *preview_msgs;
+    GBytes **parallel_chunks;
+    guint parallel_n_chunks;
+    guint parallel_next_fetch;
+    guint parallel_next_push;
+    guint parallel_in_flight;
+    GList *parallel_msgs;
 };
 
 struct _GstDlnaSrcHeadResponse
@@ -205,8 +453,6 @@ struct _GstDlnaSrcHeadResponseContentFeatures
     gchar* profile;
 
     gint  operations_idx;
-    gboolean op_time_seek_supported;
-    gboolean op_range_supported;
 
     gint playspeeds_idx;
     guint playspeeds_cnt;
@@ -214,29 +460,48 @@ struct _GstDlnaSrcHeadResponseContentFeatures
     gfloat playspeeds[PLAYSPEEDS_MAX_CNT];
 
     gint  flags_idx;
-    gboolean flag_sender_paced_set;
-    gboolean flag_limited_time_seek_set;
-    gboolean flag_limited_byte_seek_set;
-    gboolean flag_play_container_set;
-    gboolean flag_so_increasing_set;
-    gboolean flag_sn_increasing_set;
-    gboolean flag_rtsp_pause_set;
-    gboolean flag_streaming_mode_set;
-    gboolean flag_interactive_mode_set;
-    gboolean flag_background_mode_set;
-    gboolean flag_stalling_set;
-    gboolean flag_dlna_v15_set;
-    gboolean flag_link_protected_set;
-    gboolean flag_full_clear_text_set;
-    gboolean flag_limited_clear_text_set;
+    guint32 flags;              /* GstDlnaSrcContentFlags */
 
     gint  conversion_idx;
     gboolean is_converted;
 };
 
+/* Snapshot of the content range for readers outside the HEAD worker,
+ * never modified once published */
+struct _GstDlnaSrcRange
+{
+    volatile gint ref_count;
+
+    gboolean byte_seek_supported;
+    guint64 byte_start;
+    guint64 byte_end;
+    guint64 byte_total;
+
+    gboolean time_seek_supported;
+    guint64 npt_start_nanos;
+    guint64 npt_end_nanos;
+    guint64 npt_duration_nanos;
+
+    guint32 tune_start_pts;
+    guint32 start_pts;
+    guint32 end_pts;
+    guint32 tsb_slide;          /* secs, last valid value */
+
+    gint64 update_time;
+
+    guint playspeeds_cnt;
+    gfloat playspeeds[PLAYSPEEDS_MAX_CNT];
+};
+
 struct _GstDlnaSrcClass
 {
     GstBinClass parent_class;
+
+#if GST_CHECK_VERSION(1,0,0)
+    /* Actions */
+    GstBufferList *(*fetch_previews) (GstDlnaSrc * dlna_src,
+        GArray * positions);
+#endif
 };
 
 GType gst_dlna_src_get_type (void);
@@ -0,0 +1,1118 @@
+/* Copyright (C) 2013 Cable Television Laboratories, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS
+ * IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL CABLE TELEVISION LABS INC. OR ITS
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * dlnasrc-bench: a small local DMS emulator plus a benchmark driver which
+ * measures tune, seek and trick play latency of dlnasrc against it.
+ *
+ * The emulator serves two content items of synthetic MPEG-TS null packets
+ * at a constant bitrate:
+ *
+ *   /vod.ts   fixed length content supporting time and byte based seeks
+ *             and the play speeds listed in DLNA.ORG_PS
+ *   /live.ts  live content whose time shift buffer grows with wall clock
+ *             time up to a fixed window, then slides
+ *
+ * HEAD and GET requests honour getcontentFeatures.dlna.org,
+ * getAvailableSeekRange.dlna.org, TimeSeekRange.dlna.org, PlaySpeed.dlna.org,
+ * Range and Range.dtcp.com.  The payload is never encrypted.
+ *
+ * The plugin must be on the plugin path, e.g. from the top of the tree:
+ *
+ *   GST_PLUGIN_PATH=src/.libs tools/dlnasrc-bench
+ *
+ * With --check the seek, prefetch, parallel fetch or cache path is run
+ * against the emulator instead and the exit status tells whether every
+ * operation delivered data, this is what "make check" runs.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gst/gst.h>
+#include <libsoup/soup.h>
+
+#define TS_PACKET_SIZE              (188)
+#define TS_NULL_PID_HI              (0x1F)
+#define TS_NULL_PID_LO              (0xFF)
+
+/* Bytes appended to a response body at a time, a whole number of packets */
+#define DMS_CHUNK_PACKETS           (348)
+#define DMS_CHUNK_SIZE              (DMS_CHUNK_PACKETS * TS_PACKET_SIZE)
+
+/* How often a live response which caught up with the live point resumes */
+#define DMS_PACE_MSECS              (20)
+
+/* Primary flags: TM_S | TM_B | DLNA_V15, plus s0 and sN increasing for live */
+#define DMS_VOD_FLAGS               (0x01500000)
+#define DMS_LIVE_FLAGS              (0x0D500000)
+#define DMS_PLAYSPEEDS              "-16,-4,-2,-1/2,1/2,2,4,16"
+
+#define DEFAULT_BITRATE_KBPS        (8000)
+#define DEFAULT_DURATION_SECS       (600)
+#define DEFAULT_TSB_SECS            (300)
+#define DEFAULT_ITERATIONS          (5)
+#define DEFAULT_THROUGHPUT_SECS     (5)
+#define DEFAULT_TIMEOUT_SECS        (10)
+
+typedef struct _DmsEmulator DmsEmulator;
+typedef struct _DmsStream DmsStream;
+typedef struct _BenchPlayer BenchPlayer;
+
+struct _DmsEmulator
+{
+  SoupServer *server;
+  GMainContext *context;
+  GMainLoop *loop;
+  GThread *thread;
+  guint port;
+
+  guint64 byte_rate;
+  guint64 vod_bytes;
+  guint64 vod_msecs;
+  guint64 tsb_msecs;
+  gint64 live_start;
+
+  volatile gint head_count;
+  volatile gint get_count;
+};
+
+struct _DmsStream
+{
+  DmsEmulator *dms;
+  SoupMessage *msg;
+  gboolean live;
+  guint64 offset;
+  guint64 end;
+  GSource *pace_source;
+};
+
+struct _BenchPlayer
+{
+  GstElement *pipeline;
+  GMutex lock;
+  GCond cond;
+  gboolean armed;
+  guint32 seqnum;
+  gboolean synced;
+  gint64 first_buffer_time;
+  guint64 bytes;
+};
+
+static guint8 dms_packets[DMS_CHUNK_SIZE];
+
+static gint bitrate_kbps = DEFAULT_BITRATE_KBPS;
+static gint duration_secs = DEFAULT_DURATION_SECS;
+static gint tsb_secs = DEFAULT_TSB_SECS;
+static gint iterations = DEFAULT_ITERATIONS;
+static gint throughput_secs = DEFAULT_THROUGHPUT_SECS;
+static gint port = 0;
+static gchar *external_uri = NULL;
+static gboolean serve_only = FALSE;
+static gchar *dlnasrc_properties = NULL;
+static gchar *check_path = NULL;
+
+static GOptionEntry options[] = {
+  {"bitrate", 'b', 0, G_OPTION_ARG_INT, &bitrate_kbps,
+      "Content bitrate in kbps", "KBPS"},
+  {"duration", 'd', 0, G_OPTION_ARG_INT, &duration_secs,
+      "Duration of VOD content in seconds", "SECS"},
+  {"tsb", 't', 0, G_OPTION_ARG_INT, &tsb_secs,
+      "Time shift buffer window of live content in seconds", "SECS"},
+  {"iterations", 'n', 0, G_OPTION_ARG_INT, &iterations,
+      "Number of times each operation is measured", "N"},
+  {"throughput-time", 0, 0, G_OPTION_ARG_INT, &throughput_secs,
+      "Seconds over which sustained throughput is measured", "SECS"},
+  {"port", 'p', 0, G_OPTION_ARG_INT, &port,
+      "Port the emulator listens on (0 = any free port)", "PORT"},
+  {"uri", 'u', 0, G_OPTION_ARG_STRING, &external_uri,
+      "Benchmark this VOD URI instead of the emulator", "URI"},
+  {"serve", 's', 0, G_OPTION_ARG_NONE, &serve_only,
+      "Only run the emulator, e.g. for use with gst-launch", NULL},
+  {"properties", 'o', 0, G_OPTION_ARG_STRING, &dlnasrc_properties,
+      "Properties set on dlnasrc, e.g. \"connections=4\"", "PROPS"},
+  {"check", 'c', 0, G_OPTION_ARG_STRING, &check_path,
+      "Check one path against the emulator: seek, prefetch, parallel or "
+      "cache", "PATH"},
+  {NULL}
+};
+
+/*
+ * DMS emulator
+ */
+
+/**
+ * Converts a content time to a byte offset at the emulated bitrate, on a
+ * packet boundary.
+ */
+static guint64
+dms_msecs_to_bytes (DmsEmulator * dms, guint64 msecs)
+{
+  guint64 bytes = (msecs * dms->byte_rate) / 1000;
+
+  return bytes - (bytes % TS_PACKET_SIZE);
+}
+
+/**
+ * Returns the currently available range of the content, in milliseconds
+ * since its beginning.  Live content grows with wall clock time and only
+ * keeps the last tsb window.
+ */
+static void
+dms_available_range (DmsEmulator * dms, gboolean live, guint64 * start_msecs,
+    guint64 * end_msecs)
+{
+  guint64 elapsed;
+
+  if (!live) {
+    *start_msecs = 0;
+    *end_msecs = dms->vod_msecs;
+    return;
+  }
+
+  elapsed = (g_get_monotonic_time () - dms->live_start) / 1000;
+  *end_msecs = elapsed;
+  *start_msecs = (elapsed > dms->tsb_msecs) ? elapsed - dms->tsb_msecs : 0;
+}
+
+/**
+ * Parses the start (and optional end) of "npt=S[-E]" or "bytes=S[-E]".
+ * NPT values are returned in milliseconds.
+ *
+ * @return  true if a start was found, false otherwise
+ */
+static gboolean
+dms_parse_range (const gchar * value, const gchar * prefix, gboolean npt,
+    guint64 * start, guint64 * end)
+{
+  const gchar *p;
+  gchar *next = NULL;
+
+  if (!value || !(p = strstr (value, prefix)))
+    return FALSE;
+  p += strlen (prefix);
+
+  if (npt)
+    *start = (guint64) (g_ascii_strtod (p, &next) * 1000);
+  else
+    *start = g_ascii_strtoull (p, &next, 10);
+  if (next == p)
+    return FALSE;
+
+  *end = G_MAXUINT64;
+  if (*next == '-' && g_ascii_isdigit (next[1])) {
+    p = next + 1;
+    if (npt)
+      *end = (guint64) (g_ascii_strtod (p, NULL) * 1000);
+    else
+      *end = g_ascii_strtoull (p, NULL, 10);
+  }
+
+  return TRUE;
+}
+
+/**
+ * Adds the DLNA headers which describe the content and the requested range
+ * to a HEAD or GET response.
+ *
+ * @return  status code to respond with
+ */
+static guint
+dms_add_headers (DmsEmulator * dms, SoupMessage * msg, gboolean live,
+    guint64 * first_byte, guint64 * last_byte)
+{
+  SoupMessageHeaders *req = msg->request_headers;
+  SoupMessageHeaders *resp = msg->response_headers;
+  const gchar *value;
+  guint64 avail_start, avail_end, start, end;
+  guint64 total = live ? G_MAXUINT64 : dms->vod_bytes;
+  guint status = SOUP_STATUS_OK;
+  gchar *str;
+
+  dms_available_range (dms, live, &avail_start, &avail_end);
+  *first_byte = 0;
+  *last_byte = live ? G_MAXUINT64 : total - 1;
+
+  soup_message_headers_replace (resp, "Content-Type", "video/mpeg");
+  soup_message_headers_replace (resp, "transferMode.dlna.org", "Streaming");
+  soup_message_headers_replace (resp, "Accept-Ranges", "bytes");
+
+  if (soup_message_headers_get_one (req, "getcontentFeatures.dlna.org")) {
+    str = g_strdup_printf ("DLNA.ORG_PN=MPEG_TS_SD_NA_ISO;DLNA.ORG_OP=11;"
+        "DLNA.ORG_PS=%s;DLNA.ORG_FLAGS=%08x%024d", DMS_PLAYSPEEDS,
+        live ? DMS_LIVE_FLAGS : DMS_VOD_FLAGS, 0);
+    soup_message_headers_replace (resp, "contentFeatures.dlna.org", str);
+    g_free (str);
+  }
+
+  if (soup_message_headers_get_one (req, "getAvailableSeekRange.dlna.org")) {
+    str = g_strdup_printf ("1 npt=%" G_GUINT64_FORMAT ".%03u-%"
+        G_GUINT64_FORMAT ".%03u bytes=%" G_GUINT64_FORMAT "-%"
+        G_GUINT64_FORMAT, avail_start / 1000, (guint) (avail_start % 1000),
+        avail_end / 1000, (guint) (avail_end % 1000),
+        dms_msecs_to_bytes (dms, avail_start),
+        dms_msecs_to_bytes (dms, avail_end));
+    soup_message_headers_replace (resp, "availableSeekRange.dlna.org", str);
+    g_free (str);
+  }
+
+  if (live) {
+    /* 45 kHz presentation timestamps of the available range */
+    str = g_strdup_printf ("startPTS=%08x endPTS=%08x",
+        (guint32) (avail_start * 45), (guint32) (avail_end * 45));
+    soup_message_headers_replace (resp, "PresentationTimeStamps.ochn.org",
+        str);
+    g_free (str);
+  }
+
+  if ((value = soup_message_headers_get_one (req, "PlaySpeed.dlna.org")))
+    soup_message_headers_replace (resp, "PlaySpeed.dlna.org", value);
+
+  value = soup_message_headers_get_one (req, "TimeSeekRange.dlna.org");
+  if (dms_parse_range (value, "npt=", TRUE, &start, &end)) {
+    if (start < avail_start || start > avail_end ||
+        (!live && start >= avail_end))
+      return SOUP_STATUS_REQUESTED_RANGE_NOT_SATISFIABLE;
+    if (end == G_MAXUINT64 || end > avail_end)
+      end = avail_end;
+
+    *first_byte = dms_msecs_to_bytes (dms, start);
+    if (!live)
+      *last_byte = dms_msecs_to_bytes (dms, end) - 1;
+
+    if (live)
+      str = g_strdup_printf ("npt=%" G_GUINT64_FORMAT ".%03u-%"
+          G_GUINT64_FORMAT ".%03u/* bytes=%" G_GUINT64_FORMAT "-%"
+          G_GUINT64_FORMAT "/*", start / 1000, (guint) (start % 1000),
+          end / 1000, (guint) (end % 1000), *first_byte,
+          dms_msecs_to_bytes (dms, end) - 1);
+    else
+      str = g_strdup_printf ("npt=%" G_GUINT64_FORMAT ".%03u-%"
+          G_GUINT64_FORMAT ".%03u/%" G_GUINT64_FORMAT ".%03u bytes=%"
+          G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT "/%" G_GUINT64_FORMAT,
+          start / 1000, (guint) (start % 1000), end / 1000,
+          (guint) (end % 1000), dms->vod_msecs / 1000,
+          (guint) (dms->vod_msecs % 1000), *first_byte, *last_byte, total);
+    soup_message_headers_replace (resp, "TimeSeekRange.dlna.org", str);
+    g_free (str);
+    status = SOUP_STATUS_OK;
+  }
+
+  /* Byte ranges, either clear text or DTCP */
+  value = soup_message_headers_get_one (req, "Range.dtcp.com");
+  if (!value)
+    value = soup_message_headers_get_one (req, "Range");
+  if (dms_parse_range (value, "bytes=", FALSE, &start, &end)) {
+    if (!live && start >= total)
+      return SOUP_STATUS_REQUESTED_RANGE_NOT_SATISFIABLE;
+    *first_byte = start;
+    if (!live && end < total)
+      *last_byte = end;
+
+    if (live)
+      str = g_strdup_printf ("bytes %" G_GUINT64_FORMAT "-*/*", start);
+    else
+      str = g_strdup_printf ("bytes %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT
+          "/%" G_GUINT64_FORMAT, *first_byte, *last_byte, total);
+    soup_message_headers_replace (resp,
+        soup_message_headers_get_one (req, "Range.dtcp.com") ?
+        "Content-Range.dtcp.com" : "Content-Range", str);
+    g_free (str);
+    status = SOUP_STATUS_PARTIAL_CONTENT;
+  }
+
+  return status;
+}
+
+static void dms_stream_write (DmsStream * stream);
+
+static gboolean
+dms_stream_resume (gpointer user_data)
+{
+  DmsStream *stream = user_data;
+
+  g_source_unref (stream->pace_source);
+  stream->pace_source = NULL;
+
+  dms_stream_write (stream);
+  soup_server_unpause_message (stream->dms->server, stream->msg);
+
+  return FALSE;
+}
+
+/**
+ * Appends the next chunk of the response body.  Fixed length content is
+ * sent as fast as the client reads it.  Live content can not be sent past
+ * the live point, so once it is reached the response is paused and resumed
+ * shortly after.
+ */
+static void
+dms_stream_write (DmsStream * stream)
+{
+  DmsEmulator *dms = stream->dms;
+  guint64 avail = stream->end;
+  guint64 start_msecs, end_msecs;
+  guint skip;
+  guint len;
+
+  if (stream->offset >= stream->end) {
+    soup_message_body_complete (stream->msg->response_body);
+    return;
+  }
+
+  if (stream->live) {
+    dms_available_range (dms, TRUE, &start_msecs, &end_msecs);
+    avail = MIN (avail, dms_msecs_to_bytes (dms, end_msecs));
+  }
+
+  if (stream->offset >= avail) {
+    soup_server_pause_message (dms->server, stream->msg);
+    stream->pace_source = g_timeout_source_new (DMS_PACE_MSECS);
+    g_source_set_callback (stream->pace_source, dms_stream_resume, stream,
+        NULL);
+    g_source_attach (stream->pace_source, dms->context);
+    return;
+  }
+
+  skip = stream->offset % TS_PACKET_SIZE;
+  len = (guint) MIN (avail - stream->offset, (guint64) (DMS_CHUNK_SIZE - skip));
+  soup_message_body_append (stream->msg->response_body, SOUP_MEMORY_STATIC,
+      dms_packets + skip, len);
+  stream->offset += len;
+}
+
+static void
+dms_stream_wrote_chunk (SoupMessage * msg, gpointer user_data)
+{
+  dms_stream_write (user_data);
+}
+
+static void
+dms_stream_finished (SoupMessage * msg, gpointer user_data)
+{
+  DmsStream *stream = user_data;
+
+  if (stream->pace_source) {
+    g_source_destroy (stream->pace_source);
+    g_source_unref (stream->pace_source);
+  }
+  g_slice_free (DmsStream, stream);
+}
+
+static void
+dms_server_callback (SoupServer * server, SoupMessage * msg,
+    const char *path, GHashTable * query, SoupClientContext * client,
+    gpointer user_data)
+{
+  DmsEmulator *dms = user_data;
+  DmsStream *stream;
+  gboolean live;
+  guint64 first_byte, last_byte;
+  guint status;
+
+  if (!g_strcmp0 (path, "/vod.ts"))
+    live = FALSE;
+  else if (!g_strcmp0 (path, "/live.ts"))
+    live = TRUE;
+  else {
+    soup_message_set_status (msg, SOUP_STATUS_NOT_FOUND);
+    return;
+  }
+
+  if (msg->method == SOUP_METHOD_HEAD)
+    g_atomic_int_inc (&dms->head_count);
+  else if (msg->method == SOUP_METHOD_GET)
+    g_atomic_int_inc (&dms->get_count);
+  else {
+    soup_message_set_status (msg, SOUP_STATUS_NOT_IMPLEMENTED);
+    return;
+  }
+
+  status = dms_add_headers (dms, msg, live, &first_byte, &last_byte);
+  soup_message_set_status (msg, status);
+  if (!SOUP_STATUS_IS_SUCCESSFUL (status))
+    return;
+
+  if (live)
+    soup_message_headers_set_encoding (msg->response_headers,
+        SOUP_ENCODING_CHUNKED);
+  else
+    soup_message_headers_set_content_length (msg->response_headers,
+        last_byte - first_byte + 1);
+
+  if (msg->method == SOUP_METHOD_HEAD)
+    return;
+
+  stream = g_slice_new0 (DmsStream);
+  stream->dms = dms;
+  stream->msg = msg;
+  stream->live = live;
+  stream->offset = first_byte;
+  stream->end = live ? G_MAXUINT64 : last_byte + 1;
+
+  soup_message_body_set_accumulate (msg->response_body, FALSE);
+  g_signal_connect (msg, "wrote-chunk", G_CALLBACK (dms_stream_wrote_chunk),
+      stream);
+  g_signal_connect (msg, "finished", G_CALLBACK (dms_stream_finished),
+      stream);
+
+  dms_stream_write (stream);
+}
+
+static gpointer
+dms_thread_func (gpointer user_data)
+{
+  DmsEmulator *dms = user_data;
+
+  g_main_context_push_thread_default (dms->context);
+  g_main_loop_run (dms->loop);
+  g_main_context_pop_thread_default (dms->context);
+
+  return NULL;
+}
+
+/**
+ * Starts the emulator on its own thread.
+ *
+ * @return  emulator, or NULL if the server could not be started
+ */
+static DmsEmulator *
+dms_emulator_start (guint listen_port)
+{
+  DmsEmulator *dms = g_new0 (DmsEmulator, 1);
+  guint i;
+
+  /* Null packets: sync byte, PID 0x1FFF, payload only, 0xFF stuffing */
+  memset (dms_packets, 0xFF, sizeof (dms_packets));
+  for (i = 0; i < DMS_CHUNK_PACKETS; i++) {
+    dms_packets[i * TS_PACKET_SIZE] = 0x47;
+    dms_packets[i * TS_PACKET_SIZE + 1] = TS_NULL_PID_HI;
+    dms_packets[i * TS_PACKET_SIZE + 2] = TS_NULL_PID_LO;
+    dms_packets[i * TS_PACKET_SIZE + 3] = 0x10 | (i & 0x0F);
+  }
+
+  dms->byte_rate = ((guint64) bitrate_kbps * 1000) / 8;
+  dms->vod_msecs = (guint64) duration_secs * 1000;
+  dms->vod_bytes = dms_msecs_to_bytes (dms, dms->vod_msecs);
+  dms->tsb_msecs = (guint64) tsb_secs * 1000;
+  dms->live_start = g_get_monotonic_time ();
+
+  dms->context = g_main_context_new ();
+  dms->loop = g_main_loop_new (dms->context, FALSE);
+  dms->server = soup_server_new (SOUP_SERVER_PORT, listen_port,
+      SOUP_SERVER_ASYNC_CONTEXT, dms->context, NULL);
+  if (!dms->server) {
+    g_printerr ("Unable to start DMS emulator on port %u\n", listen_port);
+    g_main_loop_unref (dms->loop);
+    g_main_context_unref (dms->context);
+    g_free (dms);
+    return NULL;
+  }
+  dms->port = soup_server_get_port (dms->server);
+
+  soup_server_add_handler (dms->server, NULL, dms_server_callback, dms, NULL);
+  soup_server_run_async (dms->server);
+
+  dms->thread = g_thread_new ("dms_emulator", dms_thread_func, dms);
+
+  return dms;
+}
+
+static void
+dms_emulator_stop (DmsEmulator * dms)
+{
+  g_main_loop_quit (dms->loop);
+  g_thread_join (dms->thread);
+
+  soup_server_quit (dms->server);
+  g_object_unref (dms->server);
+  g_main_loop_unref (dms->loop);
+  g_main_context_unref (dms->context);
+  g_free (dms);
+}
+
+static gint
+dms_head_count (DmsEmulator * dms)
+{
+  return dms ? g_atomic_int_get (&dms->head_count) : 0;
+}
+
+/*
+ * Benchmark driver
+ */
+
+/**
+ * Counts the buffers reaching the sink and stamps the first one which
+ * follows the flush or segment of the seek the player was armed for, so
+ * data still draining from before the seek is never measured.
+ */
+static void
+bench_sink_buffer (BenchPlayer * player, GstBuffer * buffer)
+{
+  g_mutex_lock (&player->lock);
+#if GST_CHECK_VERSION(1,0,0)
+  player->bytes += gst_buffer_get_size (buffer);
+#else
+  player->bytes += GST_BUFFER_SIZE (buffer);
+#endif
+  if (player->armed && player->synced && !player->first_buffer_time) {
+    player->first_buffer_time = g_get_monotonic_time ();
+    g_cond_signal (&player->cond);
+  }
+  g_mutex_unlock (&player->lock);
+}
+
+static void
+bench_sink_event (BenchPlayer * player, GstEvent * event)
+{
+#if GST_CHECK_VERSION(1,0,0)
+  if (GST_EVENT_TYPE (event) != GST_EVENT_FLUSH_STOP &&
+      GST_EVENT_TYPE (event) != GST_EVENT_SEGMENT)
+    return;
+#else
+  if (GST_EVENT_TYPE (event) != GST_EVENT_FLUSH_STOP &&
+      GST_EVENT_TYPE (event) != GST_EVENT_NEWSEGMENT)
+    return;
+#endif
+
+  g_mutex_lock (&player->lock);
+  if (player->armed && player->seqnum &&
+      gst_event_get_seqnum (event) == player->seqnum)
+    player->synced = TRUE;
+  g_mutex_unlock (&player->lock);
+}
+
+#if GST_CHECK_VERSION(1,0,0)
+static GstPadProbeReturn
+bench_sink_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER)
+    bench_sink_buffer (user_data, GST_PAD_PROBE_INFO_BUFFER (info));
+  else if (GST_PAD_PROBE_INFO_TYPE (info) &
+      GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM)
+    bench_sink_event (user_data, GST_PAD_PROBE_INFO_EVENT (info));
+
+  return GST_PAD_PROBE_OK;
+}
+#else
+static gboolean
+bench_sink_buffer_probe (GstPad * pad, GstBuffer * buffer, gpointer user_data)
+{
+  bench_sink_buffer (user_data, buffer);
+  return TRUE;
+}
+
+static gboolean
+bench_sink_event_probe (GstPad * pad, GstEvent * event, gpointer user_data)
+{
+  bench_sink_event (user_data, event);
+  return TRUE;
+}
+#endif
+
+/**
+ * Arms the player to stamp the first buffer following the seek with the
+ * given seqnum.  Must be called before the seek is sent, otherwise a fast
+ * seek can deliver its first buffer before the player is armed.
+ */
+static void
+bench_player_arm (BenchPlayer * player, guint32 seqnum)
+{
+  g_mutex_lock (&player->lock);
+  player->armed = TRUE;
+  player->seqnum = seqnum;
+  player->synced = FALSE;
+  player->first_buffer_time = 0;
+  g_mutex_unlock (&player->lock);
+}
+
+/**
+ * Arms the player for the seek and sends it to the pipeline.
+ *
+ * @return  TRUE if the seek was handled
+ */
+static gboolean
+bench_player_seek (BenchPlayer * player, gdouble rate, GstSeekType start_type,
+    gint64 start, GstSeekType stop_type, gint64 stop)
+{
+  GstEvent *event;
+
+  event = gst_event_new_seek (rate, GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH,
+      start_type, start, stop_type, stop);
+  bench_player_arm (player, gst_event_get_seqnum (event));
+
+  if (gst_element_send_event (player->pipeline, event))
+    return TRUE;
+
+  g_mutex_lock (&player->lock);
+  player->armed = FALSE;
+  g_mutex_unlock (&player->lock);
+
+  return FALSE;
+}
+
+/**
+ * Creates a playing pipeline of dlnasrc feeding a fakesink which counts
+ * the buffers it receives.
+ */
+static BenchPlayer *
+bench_player_new (const gchar * uri)
+{
+  BenchPlayer *player = g_new0 (BenchPlayer, 1);
+  GstElement *sink;
+  GstPad *pad;
+  GError *error = NULL;
+  gchar *desc;
+
+  g_mutex_init (&player->lock);
+  g_cond_init (&player->cond);
+
+  /* Initial playback has no seek to wait for */
+  player->armed = TRUE;
+  player->synced = TRUE;
+
+  desc = g_strdup_printf ("dlnasrc uri=%s %s ! fakesink name=sink "
+      "sync=false", uri, dlnasrc_properties ? dlnasrc_properties : "");
+  player->pipeline = gst_parse_launch (desc, &error);
+  g_free (desc);
+  if (!player->pipeline) {
+    g_printerr ("Unable to create pipeline: %s\n",
+        error ? error->message : "unknown error");
+    g_clear_error (&error);
+    g_free (player);
+    return NULL;
+  }
+
+  sink = gst_bin_get_by_name (GST_BIN (player->pipeline), "sink");
+  pad = gst_element_get_static_pad (sink, "sink");
+#if GST_CHECK_VERSION(1,0,0)
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, bench_sink_probe, player, NULL);
+#else
+  gst_pad_add_buffer_probe (pad, G_CALLBACK (bench_sink_buffer_probe), player);
+  gst_pad_add_event_probe (pad, G_CALLBACK (bench_sink_event_probe), player);
+#endif
+  gst_object_unref (pad);
+  gst_object_unref (sink);
+
+  gst_element_set_state (player->pipeline, GST_STATE_PLAYING);
+
+  return player;
+}
+
+static void
+bench_player_free (BenchPlayer * player)
+{
+  gst_element_set_state (player->pipeline, GST_STATE_NULL);
+  gst_object_unref (player->pipeline);
+  g_mutex_clear (&player->lock);
+  g_cond_clear (&player->cond);
+  g_free (player);
+}
+
+/**
+ * Waits for the first buffer since the player was armed.
+ *
+ * @return  milliseconds from start until that buffer, or -1 on error or
+ *          timeout
+ */
+static gdouble
+bench_player_wait (BenchPlayer * player, gint64 start)
+{
+  GstBus *bus = gst_element_get_bus (player->pipeline);
+  gint64 deadline = start + DEFAULT_TIMEOUT_SECS * G_TIME_SPAN_SECOND;
+  GstMessage *message;
+  gdouble msecs = -1.0;
+
+  g_mutex_lock (&player->lock);
+  while (!player->first_buffer_time && g_get_monotonic_time () < deadline) {
+    g_cond_wait_until (&player->cond, &player->lock,
+        MIN (deadline, g_get_monotonic_time () + 50 * G_TIME_SPAN_MILLISECOND));
+
+    message = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR);
+    if (message) {
+      GError *error = NULL;
+
+      gst_message_parse_error (message, &error, NULL);
+      g_printerr ("Pipeline error: %s\n", error->message);
+      g_error_free (error);
+      gst_message_unref (message);
+      break;
+    }
+  }
+  if (player->first_buffer_time)
+    msecs = (player->first_buffer_time - start) / 1000.0;
+  player->armed = FALSE;
+  g_mutex_unlock (&player->lock);
+
+  gst_object_unref (bus);
+
+  return msecs;
+}
+
+static gint
+bench_compare_samples (gconstpointer a, gconstpointer b)
+{
+  gdouble x = *(const gdouble *) a;
+  gdouble y = *(const gdouble *) b;
+
+  return (x > y) - (x < y);
+}
+
+/**
+ * Prints min, median and max of the samples along with the number of HEAD
+ * requests per operation (or per second when per_second is set), one line
+ * per metric so it is easy to track between releases.
+ */
+static void
+bench_report (const gchar * name, GArray * samples, gint heads, gdouble ops,
+    gboolean per_second, const gchar * unit)
+{
+  gdouble *v;
+
+  if (!samples->len) {
+    g_print ("%-24s no samples\n", name);
+    return;
+  }
+
+  g_array_sort (samples, bench_compare_samples);
+  v = (gdouble *) samples->data;
+
+  g_print ("%-24s min %9.1f  median %9.1f  max %9.1f %s", name, v[0],
+      v[samples->len / 2], v[samples->len - 1], unit);
+  if (heads >= 0 && ops > 0)
+    g_print ("  heads/%s %.2f", per_second ? "s" : "op", heads / ops);
+  g_print ("\n");
+}
+
+/**
+ * @return  TRUE if every tune delivered a first buffer
+ */
+static gboolean
+bench_tune (DmsEmulator * dms, const gchar * name, const gchar * uri)
+{
+  gboolean complete;
+  GArray *samples = g_array_new (FALSE, FALSE, sizeof (gdouble));
+  gint heads = dms_head_count (dms);
+  BenchPlayer *player;
+  gdouble msecs;
+  gint64 start;
+  gint i;
+
+  for (i = 0; i < iterations; i++) {
+    /* dlnasrc issues its HEAD when the uri is set, so include creation */
+    start = g_get_monotonic_time ();
+    player = bench_player_new (uri);
+    if (!player)
+      break;
+    msecs = bench_player_wait (player, start);
+    bench_player_free (player);
+    if (msecs >= 0)
+      g_array_append_val (samples, msecs);
+  }
+
+  bench_report (name, samples, dms ? dms_head_count (dms) - heads : -1,
+      iterations, FALSE, "ms");
+  complete = (samples->len == (guint) iterations);
+  g_array_free (samples, TRUE);
+
+  return complete;
+}
+
+/**
+ * @return  TRUE if every seek delivered a first buffer
+ */
+static gboolean
+bench_seek (DmsEmulator * dms, const gchar * uri)
+{
+  GArray *samples = g_array_new (FALSE, FALSE, sizeof (gdouble));
+  BenchPlayer *player;
+  gboolean complete;
+  gint heads;
+  gdouble msecs;
+  gint64 start;
+  gint64 position;
+  gint i;
+
+  player = bench_player_new (uri);
+  if (!player || bench_player_wait (player, g_get_monotonic_time ()) < 0) {
+    g_print ("%-24s unable to start playback\n", "seek_to_first_buffer");
+    if (player)
+      bench_player_free (player);
+    g_array_free (samples, TRUE);
+    return FALSE;
+  }
+
+  heads = dms_head_count (dms);
+  for (i = 0; i < iterations; i++) {
+    /* Spread positions over the content, alternating forward and back */
+    position = (gint64) duration_secs * GST_SECOND *
+        ((i % 2) ? (iterations - i) : (i + 1)) / (iterations + 1);
+
+    start = g_get_monotonic_time ();
+    if (!bench_player_seek (player, 1.0, GST_SEEK_TYPE_SET, position,
+            GST_SEEK_TYPE_NONE, -1))
+      continue;
+    msecs = bench_player_wait (player, start);
+    if (msecs >= 0)
+      g_array_append_val (samples, msecs);
+  }
+
+  bench_report ("seek_to_first_buffer", samples,
+      dms ? dms_head_count (dms) - heads : -1, iterations, FALSE,
+      "ms");
+  complete = (samples->len == (guint) iterations);
+  g_array_free (samples, TRUE);
+  bench_player_free (player);
+
+  return complete;
+}
+
+/**
+ * @return  TRUE if every rate change delivered a first buffer
+ */
+static gboolean
+bench_rate_change (DmsEmulator * dms, const gchar * uri)
+{
+  static const gdouble rates[] = { 2.0, 4.0, 16.0, -2.0, -4.0, -16.0 };
+  GArray *samples = g_array_new (FALSE, FALSE, sizeof (gdouble));
+  BenchPlayer *player;
+  gboolean complete;
+  gint heads;
+  gint ops = 0;
+  gdouble msecs;
+  gint64 start;
+  gint64 position = (gint64) duration_secs * GST_SECOND / 2;
+  guint i;
+  gint n;
+
+  player = bench_player_new (uri);
+  if (!player || bench_player_wait (player, g_get_monotonic_time ()) < 0) {
+    g_print ("%-24s unable to start playback\n", "rate_change");
+    if (player)
+      bench_player_free (player);
+    g_array_free (samples, TRUE);
+    return FALSE;
+  }
+
+  heads = dms_head_count (dms);
+  for (n = 0; n < iterations; n++) {
+    for (i = 0; i < G_N_ELEMENTS (rates); i++) {
+      start = g_get_monotonic_time ();
+      ops++;
+      if (rates[i] > 0) {
+        if (!bench_player_seek (player, rates[i], GST_SEEK_TYPE_SET, position,
+                GST_SEEK_TYPE_NONE, -1))
+          continue;
+      } else {
+        if (!bench_player_seek (player, rates[i], GST_SEEK_TYPE_SET, 0,
+                GST_SEEK_TYPE_SET, position))
+          continue;
+      }
+      msecs = bench_player_wait (player, start);
+      if (msecs >= 0)
+        g_array_append_val (samples, msecs);
+    }
+  }
+
+  bench_report ("rate_change", samples,
+      dms ? dms_head_count (dms) - heads : -1, ops, FALSE, "ms");
+  complete = (samples->len == (guint) ops);
+  g_array_free (samples, TRUE);
+  bench_player_free (player);
+
+  return complete;
+}
+
+/**
+ * @return  TRUE if data kept flowing
+ */
+static gboolean
+bench_throughput (DmsEmulator * dms, const gchar * name, const gchar * uri)
+{
+  GArray *samples = g_array_new (FALSE, FALSE, sizeof (gdouble));
+  BenchPlayer *player;
+  gint heads;
+  guint64 bytes;
+  gdouble mbps;
+  gint64 start;
+  gdouble secs;
+
+  player = bench_player_new (uri);
+  if (!player || bench_player_wait (player, g_get_monotonic_time ()) < 0) {
+    g_print ("%-24s unable to start playback\n", name);
+    if (player)
+      bench_player_free (player);
+    g_array_free (samples, TRUE);
+    return FALSE;
+  }
+
+  heads = dms_head_count (dms);
+  g_mutex_lock (&player->lock);
+  player->bytes = 0;
+  g_mutex_unlock (&player->lock);
+  start = g_get_monotonic_time ();
+
+  g_usleep ((gulong) throughput_secs * G_USEC_PER_SEC);
+
+  g_mutex_lock (&player->lock);
+  bytes = player->bytes;
+  g_mutex_unlock (&player->lock);
+
+  secs = (gdouble) (g_get_monotonic_time () - start) / G_USEC_PER_SEC;
+  mbps = (bytes * 8.0) / (secs * G_USEC_PER_SEC);
+  g_array_append_val (samples, mbps);
+
+  /* HEAD requests per second while playing steadily, e.g. live boundary
+   * tracking */
+  bench_report (name, samples, dms ? dms_head_count (dms) - heads : -1,
+      secs, TRUE, "Mbps");
+  g_array_free (samples, TRUE);
+  bench_player_free (player);
+
+  return bytes > 0;
+}
+
+/**
+ * Runs the operations exercising one path of dlnasrc against the emulator,
+ * with the properties enabling that path unless some were given.
+ *
+ * @param dms   emulator serving uri
+ * @param path  "seek", "prefetch", "parallel" or "cache"
+ * @param uri   VOD URI of the emulator
+ *
+ * @return  TRUE if every operation delivered data
+ */
+static gboolean
+bench_check (DmsEmulator * dms, const gchar * path, const gchar * uri)
+{
+  gboolean ok;
+
+  if (!strcmp (path, "seek")) {
+    ok = bench_tune (dms, "time_to_first_buffer", uri);
+    ok = bench_seek (dms, uri) && ok;
+  } else if (!strcmp (path, "prefetch")) {
+    /* Trick play predicts the landing position, 1x seeks resume there */
+    if (!dlnasrc_properties)
+      dlnasrc_properties = g_strdup ("prefetch-duration=2000");
+    ok = bench_rate_change (dms, uri);
+    ok = bench_seek (dms, uri) && ok;
+  } else if (!strcmp (path, "parallel")) {
+    if (!dlnasrc_properties)
+      dlnasrc_properties = g_strdup ("connections=4");
+    ok = bench_seek (dms, uri);
+    ok = bench_throughput (dms, "throughput", uri) && ok;
+  } else if (!strcmp (path, "cache")) {
+    /* Seeks alternate forward and back, the latter into played data */
+    if (!dlnasrc_properties)
+      dlnasrc_properties = g_strdup ("cache-size=16777216");
+    ok = bench_seek (dms, uri);
+    ok = bench_rate_change (dms, uri) && ok;
+  } else {
+    g_printerr ("Unknown check: %s\n", path);
+    return FALSE;
+  }
+
+  g_print ("%-24s %s\n", path, ok ? "PASS" : "FAIL");
+
+  return ok;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *ctx;
+  GError *error = NULL;
+  DmsEmulator *dms = NULL;
+  gchar *vod_uri;
+  gchar *live_uri = NULL;
+  gint status = 0;
+
+  ctx = g_option_context_new ("- DLNA server emulator and dlnasrc benchmark");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &error)) {
+    g_printerr ("%s\n", error->message);
+    g_error_free (error);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (bitrate_kbps <= 0 || duration_secs <= 0 || iterations <= 0) {
+    g_printerr ("Bitrate, duration and iterations must be positive\n");
+    return 1;
+  }
+
+  if (check_path && (external_uri || serve_only)) {
+    g_printerr ("Checks run against the emulator only\n");
+    return 1;
+  }
+
+  gst_init (&argc, &argv);
+
+  if (external_uri) {
+    vod_uri = g_strdup (external_uri);
+  } else {
+    dms = dms_emulator_start (port);
+    if (!dms)
+      return 1;
+    vod_uri = g_strdup_printf ("http://127.0.0.1:%u/vod.ts", dms->port);
+    live_uri = g_strdup_printf ("http://127.0.0.1:%u/live.ts", dms->port);
+    g_print ("DMS emulator serving %s and %s\n", vod_uri, live_uri);
+  }
+
+  if (serve_only) {
+    GMainLoop *loop = g_main_loop_new (NULL, FALSE);
+    g_main_loop_run (loop);
+    g_main_loop_unref (loop);
+  } else if (check_path) {
+    if (!bench_check (dms, check_path, vod_uri))
+      status = 1;
+  } else {
+    g_print ("%d kbps, %d iterations\n", bitrate_kbps, iterations);
+    bench_tune (dms, "time_to_first_buffer", vod_uri);
+    bench_seek (dms, vod_uri);
+    bench_rate_change (dms, vod_uri);
+    bench_throughput (dms, "throughput", vod_uri);
+    if (live_uri) {
+      bench_tune (dms, "live_time_to_first_buffer", live_uri);
+      bench_throughput (dms, "live_throughput", live_uri);
+    }
+  }
+
+  g_free (vod_uri);
+  g_free (live_uri);
+  if (dms)
+    dms_emulator_stop (dms);
+  g_free (dlnasrc_properties);
+  g_free (check_path);
+
+  return status;
+}